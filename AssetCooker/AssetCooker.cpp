@@ -0,0 +1,645 @@
+/*
+Headless converter for the game's assets; it never opens a window or
+touches the GPU, so it runs on a build machine. With no file arguments it
+converts every text .msh and .anm under the mesh directory to the binary
+formats MshLoader and MeshAnimation map at runtime, cooks every image
+under the texture directory for TextureLoader, and cooks every level and
+room for LevelCooker and every level's navmesh into RecastBuilder's cache.
+Otherwise it converts the named files, given relative to the mesh or
+texture directory, and the levels and rooms named by --level and the
+levels' navmeshes named by --navmesh, given relative to the asset root.
+
+    AssetCooker [-j jobs] [--force] [--pack] [--level file]... [--navmesh level]... [files...]
+
+Each source's content hash is kept in a manifest in the asset root, and a
+source is only cooked again when its hash changes or its cooked file is
+missing. Cooking runs across the JobSystem, -j threads in all.
+With --pack, everything the game loads is then packed into PACK_PATH for
+AssetPack to mount, leaving out any source that has a cooked copy.
+Compressed animations and textures are decompressed again and checked
+against their source. An animation fails to convert if any joint is further
+out than MeshAnimation::MAX_JOINT_ERROR, and a texture if its top level
+comes back below MIN_TEXTURE_PSNR. Levels and navmeshes are built from
+CSC8503CoreClasses, so a COOKER_ONLY build leaves them out.
+*/
+#include "AssetPack.h"
+#include "Assets.h"
+#include "CookedTexture.h"
+#include "JobSystem.h"
+#include "MappedFile.h"
+#include "Mesh.h"
+#include "MeshAnimation.h"
+#include "MshLoader.h"
+#include "TextureLoader.h"
+
+#ifdef COOK_LEVELS
+#include "JsonParser.h"
+#include "Level.h"
+#include "LevelCooker.h"
+#include "NavigationGeometry.h"
+#include "RecastBuilder.h"
+#endif
+
+#include <cmath>
+#include <filesystem>
+#include <iomanip>
+#include <limits>
+#include <mutex>
+
+using namespace NCL;
+using namespace Rendering;
+#ifdef COOK_LEVELS
+using namespace CSC8503;
+#endif
+
+namespace {
+	constexpr double MIN_TEXTURE_PSNR = 30.0;
+
+	//Part of every content hash, so raising it cooks everything again after
+	//a change to one of the cooked formats or to how they're built
+	constexpr uint64_t COOK_VERSION = 1;
+
+	const std::string MANIFEST_PATH = Assets::ASSETROOT + "CookManifest.txt";
+	const std::string PACK_PATH = Assets::ASSETROOT + "Assets.pak";
+	const std::string LEVELDIR = Assets::ASSETROOT + "Levels/Levels/";
+	const std::string ROOMDIR = Assets::ASSETROOT + "Levels/Rooms/";
+
+	enum class SourceKind {
+		Mesh,
+		Animation,
+		Texture,
+		Level,
+	};
+
+	struct Source {
+		std::string name;		//relative to its asset directory, as the loaders take it
+		std::string path;
+		std::string cookedPath;
+		std::string manifestKey;	//relative to the asset root
+		SourceKind	kind;
+		uint64_t	hash	= 0;
+		bool		hashed	= false;
+		bool		stale	= true;
+		bool		cooked	= false;
+	};
+
+	//Converting never touches the GPU, so the mesh only has to hold the data
+	class CookMesh : public Mesh {
+	public:
+		CookMesh() {}
+		~CookMesh() {}
+
+		void UploadToGPU(RendererBase*) override {}
+	};
+
+	bool IsTexture(const std::filesystem::path& path) {
+		std::string extension = path.extension().string();
+		std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char c) { return (char)std::tolower(c); });
+		return extension == ".png" || extension == ".tga" || extension == ".jpg";
+	}
+
+	std::vector<std::string> FindJsonFiles(const std::string& directory) {
+		std::vector<std::string> names;
+		std::error_code error;
+		for (const auto& entry : std::filesystem::directory_iterator(directory, error)) {
+			if (entry.path().extension() == ".json") {
+				names.push_back(std::filesystem::relative(entry.path(), Assets::ASSETROOT).generic_string());
+			}
+		}
+		return names;
+	}
+
+	std::vector<std::string> FindSources() {
+		std::vector<std::string> names;
+		for (const auto& entry : std::filesystem::recursive_directory_iterator(Assets::MESHDIR)) {
+			if (entry.is_regular_file() && (entry.path().extension() == ".msh" || entry.path().extension() == ".anm")) {
+				names.push_back(std::filesystem::relative(entry.path(), Assets::MESHDIR).generic_string());
+			}
+		}
+		for (const auto& entry : std::filesystem::recursive_directory_iterator(Assets::TEXTUREDIR)) {
+			if (entry.is_regular_file() && IsTexture(entry.path())) {
+				names.push_back(std::filesystem::relative(entry.path(), Assets::TEXTUREDIR).generic_string());
+			}
+		}
+		return names;
+	}
+
+	const char* GetFormatName(TextureFormat format) {
+		switch (format) {
+		case TextureFormat::BC1:	return "BC1";
+		case TextureFormat::BC3:	return "BC3";
+		case TextureFormat::BC5:	return "BC5";
+		default:					return "RGBA8";
+		}
+	}
+
+	//BC5 only stores red and green, so the other channels aren't compared
+	double GetPSNR(const char* source, const uint8_t* cooked, int width, int height, TextureFormat format) {
+		int channels = format == TextureFormat::BC5 ? 2 : 4;
+		double squaredError = 0.0;
+		size_t texelCount = (size_t)width * height;
+		for (size_t i = 0; i < texelCount; ++i) {
+			for (int c = 0; c < channels; ++c) {
+				double difference = (double)(uint8_t)source[i * 4 + c] - cooked[i * 4 + c];
+				squaredError += difference * difference;
+			}
+		}
+		double meanSquaredError = squaredError / (texelCount * channels);
+		return meanSquaredError > 0.0 ? 10.0 * std::log10(255.0 * 255.0 / meanSquaredError) : std::numeric_limits<double>::infinity();
+	}
+
+	bool ConvertMesh(const std::string& name, std::ostream& log) {
+		auto start = std::chrono::high_resolution_clock::now();
+
+		CookMesh mesh;
+		if (!MshLoader::LoadTextMesh(name, mesh) || !MshLoader::WriteBinaryMesh(name, mesh)) {
+			log << "Failed to convert " << name << "\n";
+			return false;
+		}
+
+		std::chrono::duration<double, std::milli> time = std::chrono::high_resolution_clock::now() - start;
+		std::error_code error;
+		uintmax_t sourceSize = std::filesystem::file_size(Assets::MESHDIR + name, error);
+		uintmax_t binarySize = std::filesystem::file_size(MshLoader::GetBinaryMeshPath(name), error);
+		log << name << ": " << mesh.GetVertexCount() << " vertices, " << sourceSize / 1024 << "KB -> "
+			<< binarySize / 1024 << "KB in " << time.count() << "ms\n";
+		return true;
+	}
+
+	bool ConvertAnimation(const std::string& name, std::ostream& log) {
+		auto start = std::chrono::high_resolution_clock::now();
+
+		MeshAnimation source;
+		if (!source.LoadTextAnimation(name) || !source.WriteBinaryAnimation(name)) {
+			log << "Failed to convert " << name << "\n";
+			return false;
+		}
+
+		std::chrono::duration<double, std::milli> time = std::chrono::high_resolution_clock::now() - start;
+
+		MeshAnimation cooked;
+		if (!cooked.LoadBinaryAnimation(name)) {
+			log << "Failed to load back " << name << "\n";
+			return false;
+		}
+		float error = MeshAnimation::GetMaxJointError(source, cooked);
+
+		std::error_code fileError;
+		uintmax_t sourceSize = std::filesystem::file_size(Assets::MESHDIR + name, fileError);
+		uintmax_t binarySize = std::filesystem::file_size(MeshAnimation::GetBinaryAnimationPath(name), fileError);
+		log << name << ": " << source.GetFrameCount() << " frames of " << source.GetJointCount() << " joints, "
+			<< sourceSize / 1024 << "KB -> " << binarySize / 1024 << "KB in " << time.count() << "ms, max error " << error << "\n";
+
+		if (error > MeshAnimation::MAX_JOINT_ERROR) {
+			log << name << " is outside the error bound of " << MeshAnimation::MAX_JOINT_ERROR << "\n";
+			std::filesystem::remove(MeshAnimation::GetBinaryAnimationPath(name), fileError);
+			return false;
+		}
+		return true;
+	}
+
+	bool CookTexture(const std::string& name, std::ostream& log) {
+		auto start = std::chrono::high_resolution_clock::now();
+
+		CookedTexture cooked;
+		if (!TextureLoader::CookTexture(name, cooked)) {
+			log << "Failed to cook " << name << "\n";
+			return false;
+		}
+
+		std::chrono::duration<double, std::milli> time = std::chrono::high_resolution_clock::now() - start;
+
+		char* source = nullptr;
+		int width = 0;
+		int height = 0;
+		int channels = 0;
+		int flags = 0;
+		if (!TextureLoader::LoadTexture(name, source, width, height, channels, flags)) {
+			return false;
+		}
+		const CookedTexture::Level& top = cooked.GetLevels()[0];
+		std::vector<uint8_t> decoded((size_t)width * height * 4);
+		TextureCompressor::Decompress(cooked.GetFormat(), (const uint8_t*)top.data, top.width, top.height, decoded.data());
+		double psnr = GetPSNR(source, decoded.data(), width, height, cooked.GetFormat());
+		TextureLoader::DeleteTextureData(source);
+
+		log << name << ": " << width << "x" << height << " " << GetFormatName(cooked.GetFormat()) << ", "
+			<< cooked.GetLevels().size() << " levels, " << (size_t)width * height * 4 * 4 / 3 / 1024 << "KB -> "
+			<< cooked.GetPayloadSize() / 1024 << "KB in " << time.count() << "ms, " << psnr << "dB\n";
+
+		if (psnr < MIN_TEXTURE_PSNR) {
+			log << name << " is below " << MIN_TEXTURE_PSNR << "dB\n";
+			std::error_code fileError;
+			std::filesystem::remove(TextureLoader::GetCookedTexturePath(name), fileError);
+			return false;
+		}
+		return true;
+	}
+
+#ifdef COOK_LEVELS
+	bool CookLevel(const std::string& name, std::ostream& log) {
+		auto start = std::chrono::high_resolution_clock::now();
+
+		std::string path = Assets::ASSETROOT + name;
+		std::string json;
+		if (!Assets::ReadTextFile(path, json)) {
+			log << "Can't read " << name << "\n";
+			return false;
+		}
+		uint64_t sourceHash = LevelCooker::HashSource(json);
+		std::string cookedPath = LevelCooker::GetCookedPath(path);
+		JsonParser parser;
+		bool cooked = false;
+		// LevelManager loads everything in the room directory as a room
+		if (std::filesystem::path(path).parent_path() == std::filesystem::path(ROOMDIR).parent_path()) {
+			Room room;
+			cooked = parser.ParseJson(json, nullptr, &room, path) && LevelCooker::Cook(room, sourceHash, cookedPath);
+		}
+		else {
+			Level level;
+			cooked = parser.ParseJson(json, &level, nullptr, path) && LevelCooker::Cook(level, sourceHash, cookedPath);
+		}
+		if (!cooked) {
+			log << "Failed to cook " << name << "\n";
+			return false;
+		}
+
+		std::chrono::duration<double, std::milli> time = std::chrono::high_resolution_clock::now() - start;
+		std::error_code error;
+		log << name << ": " << json.size() / 1024 << "KB -> " << std::filesystem::file_size(cookedPath, error) / 1024
+			<< "KB in " << time.count() << "ms\n";
+		return true;
+	}
+
+	/*
+	Builds a level's navmesh from the geometry the game builds it from, so the
+	game finds the cache on load and never runs Recast. The cache is named after
+	a hash of that geometry and every build parameter, so it's up to date
+	whenever it's there. RecastBuilder spreads the build over the JobSystem
+	itself, so this runs on the calling thread.
+	*/
+	bool CookNavMesh(const std::string& name, bool force, std::ostream& log) {
+		auto start = std::chrono::high_resolution_clock::now();
+
+		// the game's room list, in the order LevelManager loads it
+		std::vector<std::unique_ptr<Room>> roomStorage;
+		std::vector<Room*> rooms;
+		for (const std::string& roomName : FindJsonFiles(ROOMDIR)) {
+			roomStorage.push_back(std::make_unique<Room>(Assets::ASSETROOT + roomName));
+			rooms.push_back(roomStorage.back().get());
+		}
+		Level level(Assets::ASSETROOT + name);
+		if (level.GetTileMap().empty()) {
+			log << "Can't load " << name << "\n";
+			return false;
+		}
+		CookMesh cube;
+		if (!MshLoader::LoadMesh("cube.msh", cube)) {
+			log << "Can't load cube.msh for " << name << "\n";
+			return false;
+		}
+		std::vector<float> verts;
+		std::vector<unsigned int> tris;
+		NavigationGeometry::Build(level, rooms, cube, verts, tris);
+
+		RecastBuilder builder;
+		delete[] builder.BuildNavMesh(verts, tris);
+		if (force && builder.WasLoadedFromCache()) {
+			std::error_code error;
+			std::filesystem::remove(builder.GetCachePath(), error);
+			delete[] builder.BuildNavMesh(std::move(verts), std::move(tris));
+		}
+		if (!builder.GetNavMesh()) {
+			log << "Failed to build the navmesh for " << name << "\n";
+			return false;
+		}
+
+		std::chrono::duration<double, std::milli> time = std::chrono::high_resolution_clock::now() - start;
+		std::error_code error;
+		log << name << ": navmesh of " << builder.GetTileCount() << " tiles " << (builder.WasLoadedFromCache() ? "up to date" : "built")
+			<< ", " << std::filesystem::file_size(builder.GetCachePath(), error) / 1024 << "KB in " << time.count() << "ms\n";
+		return true;
+	}
+#endif
+
+	SourceKind GetSourceKind(const std::string& name) {
+		if (IsTexture(name)) {
+			return SourceKind::Texture;
+		}
+		return std::filesystem::path(name).extension() == ".anm" ? SourceKind::Animation : SourceKind::Mesh;
+	}
+
+	Source MakeSource(const std::string& name) {
+		Source source;
+		source.name = name;
+		source.kind = GetSourceKind(name);
+		switch (source.kind) {
+		case SourceKind::Texture:
+			source.path = TextureLoader::GetTexturePath(name);
+			source.cookedPath = TextureLoader::GetCookedTexturePath(name);
+			break;
+		case SourceKind::Animation:
+			source.path = Assets::MESHDIR + name;
+			source.cookedPath = MeshAnimation::GetBinaryAnimationPath(name);
+			break;
+		default:
+			source.path = Assets::MESHDIR + name;
+			source.cookedPath = MshLoader::GetBinaryMeshPath(name);
+			break;
+		}
+		source.manifestKey = std::filesystem::path(source.path).lexically_relative(Assets::ASSETROOT).generic_string();
+		return source;
+	}
+
+#ifdef COOK_LEVELS
+	//Levels and rooms are named relative to the asset root
+	Source MakeLevelSource(const std::string& name) {
+		Source source;
+		source.name = name;
+		source.kind = SourceKind::Level;
+		source.path = Assets::ASSETROOT + name;
+		source.cookedPath = LevelCooker::GetCookedPath(source.path);
+		source.manifestKey = name;
+		return source;
+	}
+#endif
+
+	//FNV-1a over the file's bytes, seeded with the cook version
+	bool HashSource(const std::string& path, uint64_t& hash) {
+		hash = 14695981039346656037ull;
+		for (int i = 0; i < 8; ++i) {
+			hash ^= (COOK_VERSION >> (i * 8)) & 0xff;
+			hash *= 1099511628211ull;
+		}
+		std::error_code error;
+		if (std::filesystem::file_size(path, error) == 0) {
+			return !error;
+		}
+		MappedFile file;
+		if (!file.Open(path)) {
+			return false;
+		}
+		const uint8_t* data = (const uint8_t*)file.GetData();
+		for (size_t i = 0; i < file.GetSize(); ++i) {
+			hash ^= data[i];
+			hash *= 1099511628211ull;
+		}
+		return true;
+	}
+
+	/*
+	Every cooked format starts with its magic and version, then the size and
+	write time of the source it was cooked from, which the runtime loaders
+	check. A checkout can give a source a new write time without changing
+	it, so rather than cooking it again the stamp is rewritten in place.
+	*/
+	bool RestampCookedFile(const std::string& cookedPath, const std::string& sourcePath) {
+		std::error_code error;
+		uint64_t sourceSize = std::filesystem::file_size(sourcePath, error);
+		int64_t sourceWriteTime = (int64_t)std::filesystem::last_write_time(sourcePath, error).time_since_epoch().count();
+		if (error) {
+			return false;
+		}
+		std::fstream file(cookedPath, std::ios::binary | std::ios::in | std::ios::out);
+		uint64_t stamp[2] = {};
+		if (!file.seekg(8) || !file.read((char*)stamp, sizeof(stamp))) {
+			return false;
+		}
+		if (stamp[0] == sourceSize && (int64_t)stamp[1] == sourceWriteTime) {
+			return true;
+		}
+		stamp[0] = sourceSize;
+		stamp[1] = (uint64_t)sourceWriteTime;
+		return file.seekp(8) && file.write((const char*)stamp, sizeof(stamp));
+	}
+
+	//A cooked level is checked against its source's content when it's loaded
+	//rather than its write time, so it only has to be there
+	bool IsCookedFileCurrent(const Source& source) {
+		if (source.kind == SourceKind::Level) {
+			return std::filesystem::exists(source.cookedPath);
+		}
+		return RestampCookedFile(source.cookedPath, source.path);
+	}
+
+	std::map<std::string, uint64_t> LoadManifest() {
+		std::map<std::string, uint64_t> manifest;
+		std::ifstream file(MANIFEST_PATH);
+		std::string line;
+		while (std::getline(file, line)) {
+			size_t split = line.find(' ');
+			if (split == std::string::npos) {
+				continue;
+			}
+			manifest[line.substr(split + 1)] = std::strtoull(line.substr(0, split).c_str(), nullptr, 16);
+		}
+		return manifest;
+	}
+
+	bool SaveManifest(const std::map<std::string, uint64_t>& manifest) {
+		std::string tempPath = MANIFEST_PATH + ".tmp";
+		{
+			std::ofstream file(tempPath, std::ios::trunc);
+			for (const auto& [key, hash] : manifest) {
+				file << std::hex << std::setw(16) << std::setfill('0') << hash << " " << key << "\n";
+			}
+			if (!file) {
+				return false;
+			}
+		}
+		std::error_code error;
+		std::filesystem::rename(tempPath, MANIFEST_PATH, error);
+		return !error;
+	}
+
+	bool Cook(const Source& source, std::ostream& log) {
+		switch (source.kind) {
+		case SourceKind::Texture:	return CookTexture(source.name, log);
+		case SourceKind::Animation:	return ConvertAnimation(source.name, log);
+#ifdef COOK_LEVELS
+		case SourceKind::Level:		return CookLevel(source.name, log);
+#endif
+		default:					return ConvertMesh(source.name, log);
+		}
+	}
+
+	/*
+	Every file under the asset root except the cooker's own, sounds, which
+	irrKlang opens by path itself, and sources the game will never read
+	because their cooked copy is packed instead
+	*/
+	std::vector<AssetPack::SourceFile> FindPackFiles() {
+		std::vector<AssetPack::SourceFile> files;
+		for (const auto& entry : std::filesystem::recursive_directory_iterator(Assets::ASSETROOT)) {
+			if (!entry.is_regular_file() || entry.file_size() == 0) {
+				continue;
+			}
+			std::string path = entry.path().string();
+			std::string name = std::filesystem::relative(entry.path(), Assets::ASSETROOT).generic_string();
+			if (path == PACK_PATH || path == MANIFEST_PATH || entry.path().extension() == ".tmp" || name.starts_with("Sounds/")) {
+				continue;
+			}
+			std::string cookedPath;
+			if (IsTexture(name)) {
+				cookedPath = std::filesystem::path(path).replace_extension(".ctex").string();
+			}
+			else if (entry.path().extension() == ".msh") {
+				cookedPath = std::filesystem::path(path).replace_extension(".mshb").string();
+			}
+			else if (entry.path().extension() == ".anm") {
+				cookedPath = std::filesystem::path(path).replace_extension(".anmb").string();
+			}
+			if (!cookedPath.empty() && std::filesystem::exists(cookedPath)) {
+				continue;
+			}
+			// cooked formats are built to be read in place, so they stay
+			// uncompressed and are handed out straight from the mapping
+			std::string extension = entry.path().extension().string();
+			bool isCooked = extension == ".mshb" || extension == ".anmb" || extension == ".ctex" ||
+				extension == ".lvlb" || extension == ".navcache";
+			files.push_back({ name, path, !isCooked });
+		}
+		return files;
+	}
+
+	bool WritePack() {
+		auto start = std::chrono::high_resolution_clock::now();
+		std::vector<AssetPack::SourceFile> files = FindPackFiles();
+		if (!AssetPack::Write(PACK_PATH, files)) {
+			std::cout << "Can't write " << PACK_PATH << "\n";
+			return false;
+		}
+		std::chrono::duration<double, std::milli> time = std::chrono::high_resolution_clock::now() - start;
+		std::error_code error;
+		std::cout << "Packed " << files.size() << " files into " << PACK_PATH << ", "
+			<< std::filesystem::file_size(PACK_PATH, error) / 1024 << "KB in " << time.count() << "ms\n";
+		return true;
+	}
+}
+
+int main(int argc, char** argv) {
+	std::vector<std::string> names;
+	std::vector<std::string> levelNames;
+	std::vector<std::string> navMeshNames;
+	unsigned int jobCount = std::max(1u, std::thread::hardware_concurrency());
+	bool force = false;
+	bool pack = false;
+	for (int i = 1; i < argc; ++i) {
+		std::string argument = argv[i];
+		if (argument == "-j" && i + 1 < argc) {
+			jobCount = std::max(1, std::atoi(argv[++i]));
+		}
+		else if (argument == "--force") {
+			force = true;
+		}
+		else if (argument == "--pack") {
+			pack = true;
+		}
+		else if (argument == "--level" && i + 1 < argc) {
+			levelNames.push_back(argv[++i]);
+		}
+		else if (argument == "--navmesh" && i + 1 < argc) {
+			navMeshNames.push_back(argv[++i]);
+		}
+		else {
+			names.push_back(argument);
+		}
+	}
+#ifdef COOK_LEVELS
+	if (names.empty() && levelNames.empty() && navMeshNames.empty()) {
+		names = FindSources();
+		levelNames = FindJsonFiles(ROOMDIR);
+		for (const std::string& name : FindJsonFiles(LEVELDIR)) {
+			levelNames.push_back(name);
+			navMeshNames.push_back(name);
+		}
+	}
+#else
+	if (!levelNames.empty() || !navMeshNames.empty()) {
+		std::cout << "Levels and navmeshes need CSC8503CoreClasses, which a COOKER_ONLY build leaves out\n";
+		return 1;
+	}
+	if (names.empty()) {
+		names = FindSources();
+	}
+#endif
+	//the calling thread is one of the JobSystem's threads
+	JobSystem::Initialise(jobCount - 1);
+	JobSystem* jobs = JobSystem::GetJobSystem();
+
+	auto start = std::chrono::high_resolution_clock::now();
+
+	std::vector<Source> sources;
+	for (const std::string& name : names) {
+		sources.push_back(MakeSource(name));
+	}
+#ifdef COOK_LEVELS
+	for (const std::string& name : levelNames) {
+		sources.push_back(MakeLevelSource(name));
+	}
+#endif
+	std::map<std::string, uint64_t> manifest = LoadManifest();
+
+	jobs->ParallelFor(sources.size(), 1, [&](size_t begin, size_t end) {
+		for (size_t i = begin; i < end; ++i) {
+			Source& source = sources[i];
+			source.hashed = HashSource(source.path, source.hash);
+			auto entry = manifest.find(source.manifestKey);
+			source.stale = force || !source.hashed || entry == manifest.end() || entry->second != source.hash ||
+				!IsCookedFileCurrent(source);
+		}
+	});
+
+	std::mutex logLock;
+	jobs->ParallelFor(sources.size(), 1, [&](size_t begin, size_t end) {
+		for (size_t i = begin; i < end; ++i) {
+			Source& source = sources[i];
+			if (!source.stale) {
+				continue;
+			}
+			std::ostringstream log;
+			source.cooked = Cook(source, log);
+			std::lock_guard<std::mutex> lock(logLock);
+			std::cout << log.str();
+		}
+	});
+
+	int upToDate = 0;
+	int failures = 0;
+	for (const Source& source : sources) {
+		if (!source.stale) {
+			upToDate++;
+		}
+		else if (source.cooked && source.hashed) {
+			manifest[source.manifestKey] = source.hash;
+		}
+		else {
+			manifest.erase(source.manifestKey);
+			failures++;
+		}
+	}
+	if (!SaveManifest(manifest)) {
+		std::cout << "Can't write " << MANIFEST_PATH << "\n";
+	}
+
+	// navmeshes are built from the levels and meshes cooked above
+	int navMeshFailures = 0;
+#ifdef COOK_LEVELS
+	for (const std::string& name : navMeshNames) {
+		if (!CookNavMesh(name, force, std::cout)) {
+			navMeshFailures++;
+		}
+	}
+#endif
+
+	std::chrono::duration<double, std::milli> time = std::chrono::high_resolution_clock::now() - start;
+	std::cout << "Cooked " << sources.size() - upToDate - failures << " of " << sources.size() << " files, " << upToDate
+		<< " up to date, " << failures << " failed, and " << navMeshNames.size() - navMeshFailures << " of " << navMeshNames.size()
+		<< " navmeshes, in " << time.count() << "ms on " << jobs->GetThreadCount() << " threads\n";
+	JobSystem::Destroy();
+
+	if (failures > 0 || navMeshFailures > 0) {
+		return 1;
+	}
+	return !pack || WritePack() ? 0 : 1;
+}
@@ -30,8 +30,10 @@ void main(void)
 {
 	float shadow = 1.0; // New !
 	mat3 TBN = mat3(normalize(IN.tangent), normalize(IN.binormal), normalize(IN.normal));
-	vec3 bumpNormal = texture(normTex, IN.texCoord).rgb;
-	bumpNormal = normalize(TBN * normalize(bumpNormal * 2.0 - 1.0));
+	// cooked normal maps only keep x and y, so z is always rebuilt
+	vec2 bumpXY = texture(normTex, IN.texCoord).rg * 2.0 - 1.0;
+	vec3 bumpNormal = vec3(bumpXY, sqrt(max(0.0, 1.0 - dot(bumpXY, bumpXY))));
+	bumpNormal = normalize(TBN * bumpNormal);
 	
 	if( IN . shadowProj . w > 0.0) { // New !
 		shadow = textureProj ( shadowTex , IN . shadowProj ) * 0.5f;
@@ -0,0 +1,310 @@
+#include "FrameBenchmark.h"
+#include "GameWorld.h"
+#include "PhysicsSystem.h"
+#include "PhysicsObject.h"
+#include "CollisionDetection.h"
+#include "AnimationSystem.h"
+#include "AnimationObject.h"
+#include "RenderObject.h"
+#include "RenderSnapshot.h"
+#include "MshLoader.h"
+#include "JobSystem.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <thread>
+
+using namespace NCL;
+using namespace CSC8503;
+using namespace Rendering;
+
+namespace {
+	constexpr int GUARD_COUNT = 300;
+	// sized so the guards are close enough to keep running into each other
+	constexpr float ARENA_HALF_SIZE = 60.0f;
+	constexpr float WALL_HEIGHT = 5.0f;
+	constexpr float GUARD_MESH_SIZE = 3.0f;
+	constexpr float GUARD_INVERSE_MASS = 0.5f;
+	constexpr float GUARD_SPEED = 6.0f;
+	constexpr float CAMERA_HEIGHT = 160.0f;
+	constexpr float FRAME_DT = 1.0f / 60.0f;
+	constexpr float ASPECT_RATIO = 16.0f / 9.0f;
+	// frames run before timing starts, so physics has settled on its iteration count
+	constexpr int WARMUP_FRAMES = 60;
+
+	typedef std::chrono::high_resolution_clock Clock;
+
+	double MillisecondsSince(Clock::time_point start) {
+		return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+	}
+
+	//Has the mesh data skinning needs, and never uploads any of it
+	class HeadlessMesh : public Mesh {
+	public:
+		HeadlessMesh() {}
+		~HeadlessMesh() {}
+
+		void UploadToGPU(RendererBase*) override {}
+	};
+
+	/*
+	A walled floor covered in guards built the way LevelManager::AddGuardToWorld
+	builds them. Each guard walks a fixed heading, standing in for its
+	UpdateObject, and bounces off the walls and the other guards.
+	*/
+	class BenchmarkLevel {
+	public:
+		BenchmarkLevel() : mPhysics(mWorld), mAnimation(mWorld) {
+			mPhysics.UseGravity(true);
+			mPhysics.SetNewBroadphaseSize(Vector3(ARENA_HALF_SIZE * 2, WALL_HEIGHT, ARENA_HALF_SIZE * 2));
+
+			HeadlessMesh* rigMesh = new HeadlessMesh();
+			MshLoader::LoadMesh("Max/Rig_Maximilian.msh", *rigMesh);
+			mRigMesh = SharedMesh(rigMesh);
+			mRigAnimation = std::make_unique<MeshAnimation>("Max/Walk2.anm");
+
+			AddBox(Vector3(0, -1, 0), Vector3(ARENA_HALF_SIZE, 1, ARENA_HALF_SIZE));
+			AddBox(Vector3(ARENA_HALF_SIZE, WALL_HEIGHT, 0), Vector3(1, WALL_HEIGHT, ARENA_HALF_SIZE));
+			AddBox(Vector3(-ARENA_HALF_SIZE, WALL_HEIGHT, 0), Vector3(1, WALL_HEIGHT, ARENA_HALF_SIZE));
+			AddBox(Vector3(0, WALL_HEIGHT, ARENA_HALF_SIZE), Vector3(ARENA_HALF_SIZE, WALL_HEIGHT, 1));
+			AddBox(Vector3(0, WALL_HEIGHT, -ARENA_HALF_SIZE), Vector3(ARENA_HALF_SIZE, WALL_HEIGHT, 1));
+
+			std::mt19937 random(1);
+			std::uniform_real_distribution<float> position(-ARENA_HALF_SIZE + GUARD_MESH_SIZE, ARENA_HALF_SIZE - GUARD_MESH_SIZE);
+			std::uniform_real_distribution<float> angle(0.0f, 6.2831853f);
+			for (int i = 0; i < GUARD_COUNT; ++i) {
+				float heading = angle(random);
+				AddGuard(Vector3(position(random), GUARD_MESH_SIZE, position(random)), Vector3(std::cos(heading), 0, std::sin(heading)));
+			}
+
+			mWorld.GetMainCamera()
+				.SetPosition(Vector3(0, CAMERA_HEIGHT, 0))
+				.SetPitch(-90.0f)
+				.SetYaw(0.0f);
+
+			TaskGraph::TaskID world = mFrameTasks.AddTask("UpdateWorld", [this]() {
+				mWorld.UpdateWorld(FRAME_DT);
+			});
+			TaskGraph::TaskID physics = mFrameTasks.AddTask("Physics", [this]() {
+				mPhysics.Update(FRAME_DT);
+			});
+			mFrameTasks.AddTask("Animation", [this]() {
+				mAnimation.Update(FRAME_DT, mAnimations);
+			});
+			mFrameTasks.AddDependency(world, physics);
+		}
+
+		~BenchmarkLevel() {
+			mPhysics.Clear();
+			mWorld.ClearAndErase();
+		}
+
+		//Average milliseconds a frame spends on the frame tasks
+		double TimeFrameTasks(int frames, bool asGraph) {
+			Clock::time_point start = Clock::now();
+			for (int i = 0; i < frames; ++i) {
+				Simulate(asGraph);
+			}
+			return MillisecondsSince(start) / std::max(frames, 1);
+		}
+
+		/*
+		Whole frames, as LevelManager::Update runs them. Pipelined, a frame's
+		snapshot is culled and sorted as a job while the next frame simulates, and
+		is drawn at the end of that next frame; otherwise it is prepared and drawn
+		straight after its own simulation. Latency is from the start of a
+		simulation step to the end of the draw that shows it.
+		*/
+		void TimeFrames(int frames, bool pipelined, double& latency, double& framesPerSecond) {
+			JobSystem* jobSystem = JobSystem::GetJobSystem();
+			JobCounter prepareCounter;
+			int nextSnapshot = 0;
+			bool snapshotQueued = false;
+			Clock::time_point queuedFrameStart;
+			double totalLatency = 0.0;
+			int framesShown = 0;
+
+			Clock::time_point start = Clock::now();
+			for (int i = 0; i < frames; ++i) {
+				Clock::time_point frameStart = Clock::now();
+				Simulate(true);
+				if (pipelined) {
+					jobSystem->Wait(prepareCounter);
+					if (snapshotQueued) {
+						Draw(mSnapshots[1 - nextSnapshot]);
+						totalLatency += MillisecondsSince(queuedFrameStart);
+						framesShown++;
+					}
+					RenderSnapshot& snapshot = mSnapshots[nextSnapshot];
+					snapshot.Capture(mWorld, ASPECT_RATIO);
+					jobSystem->Submit([&snapshot]() {
+						snapshot.BuildObjectList();
+						snapshot.SortObjectList();
+					}, &prepareCounter);
+					nextSnapshot = 1 - nextSnapshot;
+					snapshotQueued = true;
+					queuedFrameStart = frameStart;
+				}
+				else {
+					RenderSnapshot& snapshot = mSnapshots[0];
+					snapshot.Capture(mWorld, ASPECT_RATIO);
+					snapshot.BuildObjectList();
+					snapshot.SortObjectList();
+					Draw(snapshot);
+					totalLatency += MillisecondsSince(frameStart);
+					framesShown++;
+				}
+			}
+			jobSystem->Wait(prepareCounter);
+			double elapsed = MillisecondsSince(start) / 1000.0;
+
+			latency = totalLatency / std::max(framesShown, 1);
+			framesPerSecond = frames / elapsed;
+		}
+
+		//Items and joint matrices the sink has been handed since the last call
+		void TakeDrawCounts(size_t& items, size_t& joints) {
+			items = mDrawnItems;
+			joints = mDrawnJoints;
+			mDrawnItems = 0;
+			mDrawnJoints = 0;
+		}
+
+	protected:
+		void AddBox(const Vector3& position, const Vector3& halfSize) {
+			GameObject* box = new GameObject(StaticObj, "Wall");
+			box->SetBoundingVolume((CollisionVolume*)new AABBVolume(halfSize));
+			box->GetTransform()
+				.SetScale(halfSize * 2)
+				.SetPosition(position);
+			box->SetPhysicsObject(new PhysicsObject(box, box->GetBoundingVolume()));
+			box->GetPhysicsObject()->SetInverseMass(0);
+			box->GetPhysicsObject()->InitCubeInertia();
+			mWorld.AddGameObject(box);
+		}
+
+		void AddGuard(const Vector3& position, const Vector3& heading) {
+			GameObject* guard = new GameObject(Npc, "Guard");
+			guard->SetBoundingVolume((CollisionVolume*)new CapsuleVolume(1.3f, 1.0f));
+			guard->GetTransform()
+				.SetScale(Vector3(GUARD_MESH_SIZE, GUARD_MESH_SIZE, GUARD_MESH_SIZE))
+				.SetPosition(position);
+
+			RenderObject* renderObject = new RenderObject(guard, mRigMesh, nullptr, nullptr, nullptr, GUARD_MESH_SIZE);
+			//One texture per sub mesh, so the snapshot copies every palette as it would in game
+			renderObject->SetMatTextures(vector<GLuint>(mRigMesh->GetSubMeshCount(), 0));
+			guard->SetRenderObject(renderObject);
+			guard->SetPhysicsObject(new PhysicsObject(guard, guard->GetBoundingVolume(), 1, 0, 5));
+			guard->SetAnimationObject(new AnimationObject(mRigAnimation.get(), nullptr));
+
+			guard->GetPhysicsObject()->SetInverseMass(GUARD_INVERSE_MASS);
+			guard->GetPhysicsObject()->InitSphereInertia(false);
+
+			mWorld.AddGameObject(guard);
+			mGuards.push_back({ guard, heading });
+		}
+
+		void Simulate(bool asGraph) {
+			for (Guard& guard : mGuards) {
+				PhysicsObject* physicsObject = guard.object->GetPhysicsObject();
+				Vector3 velocity = physicsObject->GetLinearVelocity();
+				//Turn around on hitting something, otherwise keep walking
+				if (Vector3::Dot(velocity, guard.heading) < 0.0f) {
+					guard.heading = -guard.heading;
+				}
+				physicsObject->SetLinearVelocity(Vector3(guard.heading.x * GUARD_SPEED, velocity.y, guard.heading.z * GUARD_SPEED));
+			}
+			if (asGraph) {
+				mFrameTasks.Run(*JobSystem::GetJobSystem());
+			}
+			else {
+				mWorld.UpdateWorld(FRAME_DT);
+				mPhysics.Update(FRAME_DT);
+				mAnimation.Update(FRAME_DT, mAnimations);
+			}
+			mPhysics.DeliverCollisionEvents();
+			JobSystem::GetJobSystem()->ResetAllocators();
+		}
+
+		//Stands in for the renderer, walking everything it would draw without drawing it
+		void Draw(const RenderSnapshot& snapshot) {
+			for (int index : snapshot.GetActiveItems()) {
+				const RenderSnapshot::RenderItem& item = snapshot.GetItem(index);
+				for (int i = 0; i < item.paletteCount; ++i) {
+					int jointCount = 0;
+					snapshot.GetPaletteMatrices(item, i, jointCount);
+					mDrawnJoints += jointCount;
+				}
+				mDrawnItems++;
+			}
+		}
+
+		struct Guard {
+			GameObject*	object;
+			Vector3		heading;
+		};
+
+		GameWorld		mWorld;
+		PhysicsSystem	mPhysics;
+		AnimationSystem	mAnimation;
+		TaskGraph		mFrameTasks;
+
+		SharedMesh						mRigMesh;
+		std::unique_ptr<MeshAnimation>	mRigAnimation;
+		//Guards aren't GuardObjects, so nothing here swaps their animation
+		std::map<std::string, MeshAnimation*> mAnimations;
+
+		std::vector<Guard>	mGuards;
+		RenderSnapshot		mSnapshots[2];
+		size_t				mDrawnItems = 0;
+		size_t				mDrawnJoints = 0;
+	};
+}
+
+/*
+The frame tasks are timed on 1, 2, 4... threads up to every core, restarting
+the job system each time, to show how well they scale. Whole frames are then
+timed on every core, which is what the game runs with.
+*/
+void FrameBenchmark::Run(std::ostream& out, int frames) {
+	BenchmarkLevel level;
+	unsigned int cores = std::max(1u, std::thread::hardware_concurrency());
+
+	out << "Frame tasks for " << GUARD_COUNT << " guards over " << frames << " frames" << std::endl;
+	std::vector<unsigned int> threadCounts;
+	for (unsigned int threads = 1; threads < cores; threads *= 2) {
+		threadCounts.push_back(threads);
+	}
+	threadCounts.push_back(cores);
+
+	double singleThreadTime = 0.0;
+	for (unsigned int threads : threadCounts) {
+		JobSystem::Initialise(threads - 1);
+		level.TimeFrameTasks(WARMUP_FRAMES, true);
+		double graphTime = level.TimeFrameTasks(frames, true);
+		double inOrderTime = level.TimeFrameTasks(frames, false);
+		if (threads == 1) {
+			singleThreadTime = graphTime;
+		}
+		out << "  " << threads << (threads == 1 ? " thread: " : " threads: ")
+			<< graphTime << "ms a frame as a task graph (" << singleThreadTime / graphTime << "x one thread), "
+			<< inOrderTime << "ms one after another" << std::endl;
+	}
+	JobSystem::Initialise(cores - 1);
+
+	for (bool pipelined : { false, true }) {
+		double latency = 0.0;
+		double framesPerSecond = 0.0;
+		level.TimeFrames(WARMUP_FRAMES, pipelined, latency, framesPerSecond);
+		size_t items = 0;
+		size_t joints = 0;
+		level.TakeDrawCounts(items, joints);
+		level.TimeFrames(frames, pipelined, latency, framesPerSecond);
+		level.TakeDrawCounts(items, joints);
+		out << (pipelined ? "Pipelined" : "Sequential") << " frames: " << latency << "ms latency, "
+			<< framesPerSecond << " frames/s, " << items / frames << " items and "
+			<< joints / frames << " joint matrices drawn a frame" << std::endl;
+	}
+}
@@ -0,0 +1,19 @@
+#pragma once
+#include <iosfwd>
+
+namespace NCL {
+	namespace CSC8503 {
+		/*
+		Times the per-frame work of a level full of guards without a window or
+		renderer: the frame tasks as the task graph and one after another on
+		1, 2, 4... threads up to every core, then whole frames with and without
+		pipelining. Each frame ends in a render snapshot that is culled and sorted
+		as it would be for drawing, then handed to a sink that draws nothing, so
+		the GPU is left out of the numbers.
+		*/
+		class FrameBenchmark {
+		public:
+			static void Run(std::ostream& out, int frames);
+		};
+	}
+}
@@ -3,7 +3,9 @@
 #include "RenderObject.h"
 #include "Camera.h"
 #include "TextureLoader.h"
+#include "CookedTexture.h"
 #include "MshLoader.h"
+#include "LoadProfiler.h"
 #include "UI.h"
 #include "Mesh.h"
 
@@ -15,8 +17,40 @@ using namespace CSC8503;
 
 Matrix4 biasMatrix = Matrix4::Translation(Vector3(0.5f, 0.5f, 0.5f)) * Matrix4::Scale(Vector3(0.5f, 0.5f, 0.5f));
 
+namespace {
+	size_t GetMeshBytes(const Mesh& mesh) {
+		return mesh.GetPositionData().size() * sizeof(Vector3)
+			+ mesh.GetTextureCoordData().size() * sizeof(Vector2)
+			+ mesh.GetColourData().size() * sizeof(Vector4)
+			+ mesh.GetNormalData().size() * sizeof(Vector3)
+			+ mesh.GetTangentData().size() * sizeof(Vector4)
+			+ mesh.GetSkinWeightData().size() * sizeof(Vector4)
+			+ mesh.GetSkinIndexData().size() * sizeof(Vector4i)
+			+ mesh.GetIndexData().size() * sizeof(unsigned int);
+	}
+
+	size_t GetTextureBytes(const Texture& tex) {
+		return ((const OGLTexture&)tex).GetMemorySize();
+	}
+
+	size_t GetAnimationBytes(const MeshAnimation& anim) {
+		return anim.GetJointCount() * anim.GetFrameCount() * sizeof(Matrix4);
+	}
+
+	template<class T>
+	void PrintCacheStats(const char* type, const AssetCache<T>& cache) {
+		std::cout << "Assets: " << type << ": " << cache.GetAssetCount() << " resident, "
+			<< cache.GetResidentBytes() / 1024 << "KB, "
+			<< cache.GetHitCount() << " hits, " << cache.GetMissCount() << " misses\n";
+	}
+}
+
 GameTechRenderer::GameTechRenderer(GameWorld& world) : OGLRenderer(*Window::GetWindow()), gameWorld(world) {
 	glEnable(GL_DEPTH_TEST);
+
+	mFrameSnapshot = nullptr;
+	mNextSnapshot = 0;
+	mSnapshotQueued = false;
   
 	debugShader = new OGLShader("debug.vert", "debug.frag");
 	shadowShader = new OGLShader("shadow.vert", "shadow.frag");
@@ -84,7 +118,7 @@ GameTechRenderer::GameTechRenderer(GameWorld& world) : OGLRenderer(*Window::GetW
 	LoadSkybox();
 	SetUpFBOs();
 	LoadDefRendShaders();
-	mSphereMesh = (OGLMesh*)LoadMesh("sphere.msh");
+	mSphereMesh = (OGLMesh*)LoadMesh("sphere.msh").get();
 
 	glGenVertexArrays(1, &lineVAO);
 	glGenVertexArrays(1, &textVAO);
@@ -105,6 +139,8 @@ GameTechRenderer::GameTechRenderer(GameWorld& world) : OGLRenderer(*Window::GetW
 }
 
 GameTechRenderer::~GameTechRenderer() {
+	JobSystem::GetJobSystem()->Wait(mPrepareCounter);
+	FinishAsyncLoads();
 	glDeleteTextures(1, &shadowTex);
 	glDeleteFramebuffers(1, &shadowFBO);
 
@@ -116,10 +152,6 @@ GameTechRenderer::~GameTechRenderer() {
 	glDeleteTextures(1, &mLightAlbedoTex);
 	glDeleteTextures(1, &mLightSpecularTex);
 
-	delete mPointLightShader;
-	delete mSpotLightShader;
-	delete mDirLightShader;
-	delete mCombineShader;
 	ClearLights();
 }
 
@@ -133,6 +165,10 @@ void GameTechRenderer::LoadSkybox() {
 		"/Cubemap/skyrender0005.png"
 	};
 
+	if (LoadCookedSkybox(filenames)) {
+		return;
+	}
+
 	int width[6] = { 0 };
 	int height[6] = { 0 };
 	int channels[6] = { 0 };
@@ -163,23 +199,53 @@ void GameTechRenderer::LoadSkybox() {
 	glBindTexture(GL_TEXTURE_CUBE_MAP, 0);
 }
 
+//Only the top level of each face is uploaded, as the skybox is never minified
+bool GameTechRenderer::LoadCookedSkybox(const std::string filenames[6]) {
+	CookedTexture faces[6];
+	for (int i = 0; i < 6; ++i) {
+		if (!TextureLoader::LoadCookedTexture(filenames[i], faces[i])) {
+			return false;
+		}
+		if (faces[i].GetFormat() != faces[0].GetFormat() || faces[i].GetWidth() != faces[0].GetWidth() || faces[i].GetHeight() != faces[0].GetHeight()) {
+			std::cout << __FUNCTION__ << " cooked cubemap faces don't match in size or format?\n";
+			return false;
+		}
+	}
+	glGenTextures(1, &skyboxTex);
+	glBindTexture(GL_TEXTURE_CUBE_MAP, skyboxTex);
+
+	for (int i = 0; i < 6; ++i) {
+		OGLTexture::UploadCookedLevels(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, faces[i], 1);
+	}
+
+	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAX_LEVEL, 0);
+	glTexParameterf(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameterf(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+
+	glBindTexture(GL_TEXTURE_CUBE_MAP, 0);
+	return true;
+}
+
 void GameTechRenderer::LoadDefRendShaders() {
-	mPointLightShader = LoadShader("light.vert", "pointlight.frag");
-	mSpotLightShader = LoadShader("light.vert", "spotlight.frag");
-	mDirLightShader = LoadShader("light.vert", "dirlight.frag");
-	mCombineShader = LoadShader("combine.vert", "combine.frag");
+	mPointLightShader = LoadShader("light.vert", "pointlight.frag").get();
+	mSpotLightShader = LoadShader("light.vert", "spotlight.frag").get();
+	mDirLightShader = LoadShader("light.vert", "dirlight.frag").get();
+	mCombineShader = LoadShader("combine.vert", "combine.frag").get();
 }
 
 void GameTechRenderer::RenderFrame() {
-	Matrix4 viewMatrix = gameWorld.GetMainCamera().BuildViewMatrix();
-	Matrix4 projMatrix = gameWorld.GetMainCamera().BuildProjectionMatrix(hostWindow.GetScreenAspect());
-	mFrameFrustum = mFrameFrustum.FromViewProjMatrix(projMatrix * viewMatrix);
+	//Nobody handed us a snapshot this frame, so take one of the world as it is now
+	if (!mSnapshotQueued) {
+		SubmitSnapshot(false);
+	}
+	JobSystem::GetJobSystem()->Wait(mPrepareCounter);
+	mSnapshotQueued = false;
+
 	glEnable(GL_CULL_FACE);
 	glEnable(GL_BLEND);
 	glEnable(GL_DEPTH_TEST);
 	glClearColor(1, 1, 1, 1);
-	BuildObjectList();
-	SortObjectList();
 
 	RenderCamera();
 	RenderSkybox();
@@ -201,31 +267,40 @@ void GameTechRenderer::RenderFrame() {
 	
 }
 
-void GameTechRenderer::BuildObjectList() {
-	mActiveObjects.clear();
-	mOutlinedObjects.clear();
-
-	gameWorld.OperateOnContents(
-		[&](GameObject* o) {
-			if (o->IsRendered()) {
-				RenderObject* rendObj = o->GetRenderObject();
-				bool isInFrustum = mFrameFrustum.SphereInsideFrustum(o->GetTransform().GetPosition(), o->GetRenderObject()->GetCullSphereRadius());
-				if (rendObj && isInFrustum && !rendObj->IsInstanced()) {
-					rendObj->SetSqDistToCam(gameWorld.GetMainCamera().GetPosition());
-					mActiveObjects.emplace_back(rendObj);
-					if (rendObj->GetOutlined()) {
-						mOutlinedObjects.emplace_back(rendObj);
-					}
-				}
-			}
-		}
-	);
+
+/*
+Copies the world's render state into the next snapshot, then culls and sorts
+it. With prepareAsync the culling and sorting run as a job, so they overlap
+with whatever the caller does before the next RenderFrame.
+*/
+void GameTechRenderer::SubmitSnapshot(bool prepareAsync) {
+	JobSystem* jobSystem = JobSystem::GetJobSystem();
+	jobSystem->Wait(mPrepareCounter);
+
+	RenderSnapshot& snapshot = mSnapshots[mNextSnapshot];
+	snapshot.Capture(gameWorld, hostWindow.GetScreenAspect());
+	if (prepareAsync) {
+		jobSystem->Submit([&snapshot]() {
+			snapshot.BuildObjectList();
+			snapshot.SortObjectList();
+		}, &mPrepareCounter);
+	}
+	else {
+		snapshot.BuildObjectList();
+		snapshot.SortObjectList();
+	}
+	mFrameSnapshot = &snapshot;
+	mNextSnapshot = 1 - mNextSnapshot;
+	mSnapshotQueued = true;
 }
 
-void GameTechRenderer::SortObjectList() {
-	std::sort(mActiveObjects.begin(), mActiveObjects.end(), RenderObject::CompareBySqCamDist);
+//Drops a queued snapshot without drawing it. Must be called before freeing any asset it draws with
+void GameTechRenderer::DiscardSnapshot() {
+	JobSystem::GetJobSystem()->Wait(mPrepareCounter);
+	mSnapshotQueued = false;
 }
 
+
 void GameTechRenderer::RenderShadowMap() {
 	glBindFramebuffer(GL_FRAMEBUFFER, shadowFBO);
 	glClear(GL_DEPTH_BUFFER_BIT);
@@ -244,12 +319,12 @@ void GameTechRenderer::RenderShadowMap() {
 
 	shadowMatrix = biasMatrix * mvMatrix; //we'll use this one later on
 
-	for (const auto& i : mActiveObjects) {
-		Matrix4 modelMatrix = (*i).GetTransform()->GetMatrix();
-		Matrix4 mvpMatrix = mvMatrix * modelMatrix;
+	for (int index : mFrameSnapshot->GetActiveItems()) {
+		const RenderSnapshot::RenderItem& item = mFrameSnapshot->GetItem(index);
+		Matrix4 mvpMatrix = mvMatrix * item.modelMatrix;
 		glUniformMatrix4fv(mvpLocation, 1, false, (float*)&mvpMatrix);
-		BindMesh((OGLMesh&)*(*i).GetMesh());
-		size_t layerCount = (*i).GetMesh()->GetSubMeshCount();
+		BindMesh((OGLMesh&)*item.mesh);
+		size_t layerCount = item.mesh->GetSubMeshCount();
 		for (size_t i = 0; i < layerCount; ++i) {
 			DrawBoundMesh((uint32_t)i);
 		}
@@ -273,8 +348,8 @@ void GameTechRenderer::RenderSkybox() {
 	glBlitFramebuffer(0, 0, width, height, 0, 0, width, height, GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT, GL_NEAREST);
 	glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
 
-	Matrix4 viewMatrix = gameWorld.GetMainCamera().BuildViewMatrix();
-	Matrix4 projMatrix = gameWorld.GetMainCamera().BuildProjectionMatrix(hostWindow.GetScreenAspect());
+	const Matrix4& viewMatrix = mFrameSnapshot->GetViewMatrix();
+	const Matrix4& projMatrix = mFrameSnapshot->GetProjMatrix();
 
 	BindShader(*skyboxShader);
 
@@ -296,14 +371,14 @@ void GameTechRenderer::RenderSkybox() {
 }
 
 void GameTechRenderer::RenderCamera() {
-	Matrix4 viewMatrix = gameWorld.GetMainCamera().BuildViewMatrix();
-	Matrix4 projMatrix = gameWorld.GetMainCamera().BuildProjectionMatrix(hostWindow.GetScreenAspect());
+	const Matrix4& viewMatrix = mFrameSnapshot->GetViewMatrix();
+	const Matrix4& projMatrix = mFrameSnapshot->GetProjMatrix();
 	FillGBuffer(viewMatrix, projMatrix);
 	DrawLightVolumes(viewMatrix, projMatrix);
 	CombineBuffers();
 }
 
-void GameTechRenderer::DrawWallsFloorsInstanced(Matrix4& viewMatrix, Matrix4& projMatrix) {
+void GameTechRenderer::DrawWallsFloorsInstanced(const Matrix4& viewMatrix, const Matrix4& projMatrix) {
 
 	RenderObject* rendObj = mWallFloorTile->GetRenderObject();
 	OGLShader* shader = (OGLShader*)rendObj->GetShader();
@@ -327,7 +402,7 @@ void GameTechRenderer::DrawWallsFloorsInstanced(Matrix4& viewMatrix, Matrix4& pr
 	int hasInstanceMatLocation = glGetUniformLocation(shader->GetProgramID(), "hasInstanceMatrix");
 	int shadowTexLocation = glGetUniformLocation(shader->GetProgramID(), "shadowTex");
 
-	Vector3 camPos = gameWorld.GetMainCamera().GetPosition();
+	Vector3 camPos = mFrameSnapshot->GetCameraPosition();
 	glUniform3fv(cameraLocation, 1, &camPos.x);
 
 	glUniformMatrix4fv(projLocation, 1, false, (float*)&projMatrix);
@@ -349,7 +424,7 @@ void GameTechRenderer::DrawWallsFloorsInstanced(Matrix4& viewMatrix, Matrix4& pr
 
 }
 
-void GameTechRenderer::FillGBuffer(Matrix4& viewMatrix, Matrix4& projMatrix) {
+void GameTechRenderer::FillGBuffer(const Matrix4& viewMatrix, const Matrix4& projMatrix) {
 	glBindFramebuffer(GL_FRAMEBUFFER, mGBufferFBO);
 	glEnable(GL_STENCIL_TEST);
 	glClear(GL_DEPTH_BUFFER_BIT | GL_COLOR_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
@@ -375,18 +450,19 @@ void GameTechRenderer::FillGBuffer(Matrix4& viewMatrix, Matrix4& projMatrix) {
 	glActiveTexture(GL_TEXTURE0 + 1);
 	glBindTexture(GL_TEXTURE_2D, shadowTex);
 
-	for (const auto& i : mActiveObjects) {
-		OGLShader* shader = (OGLShader*)(*i).GetShader();
+	for (int index : mFrameSnapshot->GetActiveItems()) {
+		const RenderSnapshot::RenderItem& item = mFrameSnapshot->GetItem(index);
+		OGLShader* shader = (OGLShader*)item.shader;
 		BindShader(*shader);
-		if ((*i).GetAlbedoTexture()) {
-			BindTextureToShader(*(OGLTexture*)(*i).GetAlbedoTexture(), "mainTex", 0);
+		if (item.albedoTex) {
+			BindTextureToShader(*(OGLTexture*)item.albedoTex, "mainTex", 0);
 			
 		}
 		
-		if ((*i).GetNormalTexture()) {
-			BindTextureToShader(*(OGLTexture*)(*i).GetNormalTexture(), "normTex", 2);
+		if (item.normalTex) {
+			BindTextureToShader(*(OGLTexture*)item.normalTex, "normTex", 2);
 		}
-		if ((*i).GetAnimation()) {
+		if (item.animated) {
 			glUniform1i(glGetUniformLocation(shader->GetProgramID(), "mainTex"), 3);
 		}
 		if (activeShader != shader) {
@@ -400,7 +476,7 @@ void GameTechRenderer::FillGBuffer(Matrix4& viewMatrix, Matrix4& projMatrix) {
 			cameraLocation = glGetUniformLocation(shader->GetProgramID(), "cameraPos");
 			hasInstanceMatLocation = glGetUniformLocation(shader->GetProgramID(), "hasInstanceMatrix");
 
-			Vector3 camPos = gameWorld.GetMainCamera().GetPosition();
+			Vector3 camPos = mFrameSnapshot->GetCameraPosition();
 			glUniform3fv(cameraLocation, 1, &camPos.x);
 
 			glUniformMatrix4fv(projLocation, 1, false, (float*)&projMatrix);
@@ -411,33 +487,34 @@ void GameTechRenderer::FillGBuffer(Matrix4& viewMatrix, Matrix4& projMatrix) {
 			activeShader = shader;
 		}
 		
-		Matrix4 modelMatrix = (*i).GetTransform()->GetMatrix();
+		const Matrix4& modelMatrix = item.modelMatrix;
 		glUniformMatrix4fv(modelLocation, 1, false, (float*)&modelMatrix);
 
 		Matrix4 fullShadowMat = shadowMatrix * modelMatrix;
 		glUniformMatrix4fv(shadowLocation, 1, false, (float*)&fullShadowMat);
 
-		Vector4 colour = i->GetColour();
+		Vector4 colour = item.colour;
 		glUniform4fv(colourLocation, 1, &colour.x);
 
-		glUniform1i(hasVColLocation, !(*i).GetMesh()->GetColourData().empty());
+		glUniform1i(hasVColLocation, !item.mesh->GetColourData().empty());
 
-		glUniform1i(hasTexLocation, (OGLTexture*)(*i).GetAlbedoTexture() ? 1:0);
+		glUniform1i(hasTexLocation, item.albedoTex ? 1:0);
 		glUniform1i(hasInstanceMatLocation, 0);
 		
 
 		//Animation basic draw
 
 		
-		if ((*i).GetAnimation()) {
-			BindMesh((OGLMesh&)*(*i).GetMesh());
-			mMesh = (*i).GetMesh();
-			size_t layerCount = mMesh->GetSubMeshCount();
+		if (item.animated) {
+			BindMesh((OGLMesh&)*item.mesh);
+			size_t layerCount = std::min<size_t>(item.mesh->GetSubMeshCount(), item.paletteCount);
 			for (size_t b = 0; b < layerCount; ++b) {
 				glActiveTexture(GL_TEXTURE3);
-				GLuint textureID = (*i).GetMatTextures()[b];
+				GLuint textureID = mFrameSnapshot->GetPaletteTexture(item, (int)b);
 				glBindTexture(GL_TEXTURE_2D, textureID);
-				glUniformMatrix4fv(glGetUniformLocation(shader->GetProgramID(), "joints"), (*i).GetFrameMatricesVec()[b].size(), false, (float*)(*i).GetFrameMatricesVec()[b].data());
+				int jointCount = 0;
+				const Matrix4* joints = mFrameSnapshot->GetPaletteMatrices(item, (int)b, jointCount);
+				glUniformMatrix4fv(glGetUniformLocation(shader->GetProgramID(), "joints"), jointCount, false, (float*)joints);
 				DrawBoundMesh((uint32_t)b);
 			}
 			
@@ -445,8 +522,8 @@ void GameTechRenderer::FillGBuffer(Matrix4& viewMatrix, Matrix4& projMatrix) {
 		}
 		else
 		{
-			BindMesh((OGLMesh&)*(*i).GetMesh());
-			size_t layerCount = (*i).GetMesh()->GetSubMeshCount();
+			BindMesh((OGLMesh&)*item.mesh);
+			size_t layerCount = item.mesh->GetSubMeshCount();
 			for (size_t b = 0; b < layerCount; ++b) {
 
 				DrawBoundMesh((uint32_t)b);
@@ -458,7 +535,7 @@ void GameTechRenderer::FillGBuffer(Matrix4& viewMatrix, Matrix4& projMatrix) {
 	glBindFramebuffer(GL_FRAMEBUFFER, 0);
 }
 
-void GameTechRenderer::DrawLightVolumes(Matrix4& viewMatrix, Matrix4& projMatrix) {
+void GameTechRenderer::DrawLightVolumes(const Matrix4& viewMatrix, const Matrix4& projMatrix) {
 	glBindFramebuffer(GL_FRAMEBUFFER, mLightFBO);
 	BindCommonLightDataToShader((OGLShader*)mPointLightShader, viewMatrix, projMatrix);
 	BindCommonLightDataToShader((OGLShader*)mSpotLightShader, viewMatrix, projMatrix);
@@ -482,7 +559,7 @@ void GameTechRenderer::DrawLightVolumes(Matrix4& viewMatrix, Matrix4& projMatrix
 	glBindFramebuffer(GL_FRAMEBUFFER, 0);
 }
 
-void GameTechRenderer::BindCommonLightDataToShader(OGLShader* shader, Matrix4& viewMatrix, Matrix4& projMatrix) {
+void GameTechRenderer::BindCommonLightDataToShader(OGLShader* shader, const Matrix4& viewMatrix, const Matrix4& projMatrix) {
 	BindShader(*shader);
 	glClearColor(0, 0, 0, 1);
 	glClear(GL_COLOR_BUFFER_BIT);
@@ -494,7 +571,7 @@ void GameTechRenderer::BindCommonLightDataToShader(OGLShader* shader, Matrix4& v
 	glActiveTexture(GL_TEXTURE2);
 	glBindTexture(GL_TEXTURE_2D, mGBufferDepthTex);
 
-	Vector3 camPos = gameWorld.GetMainCamera().GetPosition();
+	Vector3 camPos = mFrameSnapshot->GetCameraPosition();
 	glUniform3fv(glGetUniformLocation(shader->GetProgramID(), "cameraPos"), 1, &camPos.x);
 	glUniform2f(glGetUniformLocation(shader->GetProgramID(), "pixelSize"), 1.0f / hostWindow.GetScreenSize().x, 1.0f / hostWindow.GetScreenSize().y);
 
@@ -526,17 +603,17 @@ void GameTechRenderer::DrawOutlinedObjects() {
 	glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
 	glDepthFunc(GL_GEQUAL);
 	BindShader(*mOutlineShader);
-	Matrix4 viewMatrix = gameWorld.GetMainCamera().BuildViewMatrix();
-	Matrix4 projMatrix = gameWorld.GetMainCamera().BuildProjectionMatrix(hostWindow.GetScreenAspect());
+	const Matrix4& viewMatrix = mFrameSnapshot->GetViewMatrix();
+	const Matrix4& projMatrix = mFrameSnapshot->GetProjMatrix();
 	glUniformMatrix4fv(glGetUniformLocation(mOutlineShader->GetProgramID(), "projMatrix"), 1, false, (float*)&projMatrix);
 	glUniformMatrix4fv(glGetUniformLocation(mOutlineShader->GetProgramID(), "viewMatrix"), 1, false, (float*)&viewMatrix);
 
-	for (int i = 0; i < mOutlinedObjects.size(); i++) {
-		Matrix4 modelMatrix = mOutlinedObjects[i]->GetTransform()->GetMatrix();
-		glUniformMatrix4fv(glGetUniformLocation(mOutlineShader->GetProgramID(), "modelMatrix"), 1, false, (float*)&modelMatrix);
+	for (int index : mFrameSnapshot->GetOutlinedItems()) {
+		const RenderSnapshot::RenderItem& item = mFrameSnapshot->GetItem(index);
+		glUniformMatrix4fv(glGetUniformLocation(mOutlineShader->GetProgramID(), "modelMatrix"), 1, false, (float*)&item.modelMatrix);
 
-		BindMesh((OGLMesh&)*(*mOutlinedObjects[i]).GetMesh());
-		size_t layerCount = (*mOutlinedObjects[i]).GetMesh()->GetSubMeshCount();
+		BindMesh((OGLMesh&)*item.mesh);
+		size_t layerCount = item.mesh->GetSubMeshCount();
 		for (size_t i = 0; i < layerCount; ++i) {
 			DrawBoundMesh((uint32_t)i);
 		}
@@ -596,12 +673,15 @@ void GameTechRenderer::BindTexAttachmentsToBuffers(GLuint& fbo, GLuint& colour0,
 }
 
 
-Mesh* GameTechRenderer::LoadMesh(const std::string& name) {
+AssetCache<Mesh>::Handle GameTechRenderer::LoadMesh(const std::string& name) {
+	if (SharedMesh cached = mMeshCache.Acquire(name)) {
+		return cached;
+	}
 	OGLMesh* mesh = new OGLMesh();
 	MshLoader::LoadMesh(name, *mesh);
 	mesh->SetPrimitiveType(GeometryPrimitive::Triangles);
 	mesh->UploadToGPU();
-	return mesh;
+	return mMeshCache.Add(name, SharedMesh(mesh), GetMeshBytes(*mesh));
 }
 
 void GameTechRenderer::NewRenderLines() {
@@ -610,8 +690,8 @@ void GameTechRenderer::NewRenderLines() {
 		return;
 	}
 
-	Matrix4 viewMatrix = gameWorld.GetMainCamera().BuildViewMatrix();
-	Matrix4 projMatrix = gameWorld.GetMainCamera().BuildProjectionMatrix(hostWindow.GetScreenAspect());
+	const Matrix4& viewMatrix = mFrameSnapshot->GetViewMatrix();
+	const Matrix4& projMatrix = mFrameSnapshot->GetProjMatrix();
 
 	Matrix4 viewProj = projMatrix * viewMatrix;
 
@@ -732,22 +812,140 @@ void GameTechRenderer::NewRenderText() {
 	glBindVertexArray(0);
 }
 
-Texture* GameTechRenderer::LoadTexture(const std::string& name) {
-	return OGLTexture::TextureFromFile(name).release();
+AssetCache<Texture>::Handle GameTechRenderer::LoadTexture(const std::string& name) {
+	if (SharedTexture cached = mTextureCache.Acquire(name)) {
+		return cached;
+	}
+	SharedTexture tex = OGLTexture::TextureFromFile(name);
+	return mTextureCache.Add(name, tex, GetTextureBytes(*tex));
 }
 
-Shader* GameTechRenderer::LoadShader(const std::string& vertex, const std::string& fragment) {
-	return new OGLShader(vertex, fragment);
+AssetCache<Shader>::Handle GameTechRenderer::LoadShader(const std::string& vertex, const std::string& fragment) {
+	std::string key = vertex + "|" + fragment;
+	if (AssetCache<Shader>::Handle cached = mShaderCache.Acquire(key)) {
+		return cached;
+	}
+	return mShaderCache.Add(key, std::make_shared<OGLShader>(vertex, fragment));
 }
 
-MeshAnimation* NCL::CSC8503::GameTechRenderer::LoadAnimation(const std::string& name)
+AssetCache<MeshAnimation>::Handle NCL::CSC8503::GameTechRenderer::LoadAnimation(const std::string& name)
 {
-	return new MeshAnimation(name);
+	if (SharedMeshAnim cached = mAnimationCache.Acquire(name)) {
+		return cached;
+	}
+	MeshAnimation* anim = new MeshAnimation(name);
+	return mAnimationCache.Add(name, SharedMeshAnim(anim), GetAnimationBytes(*anim));
 }
 
-MeshMaterial* NCL::CSC8503::GameTechRenderer::LoadMaterial(const std::string& name)
+AssetCache<MeshMaterial>::Handle NCL::CSC8503::GameTechRenderer::LoadMaterial(const std::string& name)
 {
-	return new MeshMaterial(name);
+	if (AssetCache<MeshMaterial>::Handle cached = mMaterialCache.Acquire(name)) {
+		return cached;
+	}
+	return mMaterialCache.Add(name, std::make_shared<MeshMaterial>(name));
+}
+
+void GameTechRenderer::LoadMeshAsync(const std::string& name, AssetCache<Mesh>::Handle& out) {
+	if (SharedMesh cached = mMeshCache.Acquire(name)) {
+		out = cached;
+		return;
+	}
+	// cached before it has loaded, so later requests in the same batch share it
+	OGLMesh* mesh = new OGLMesh();
+	out = mMeshCache.Add(name, SharedMesh(mesh));
+	JobSystem::GetJobSystem()->Submit([this, name, mesh]() {
+		LoadMarker marker("Load mesh", name);
+		MshLoader::LoadMesh(name, *mesh);
+		mesh->SetPrimitiveType(GeometryPrimitive::Triangles);
+
+		std::lock_guard<std::mutex> lock(mUploadLock);
+		mPendingUploads.emplace_back([this, name, mesh]() {
+			mesh->UploadToGPU();
+			mMeshCache.SetResidentBytes(name, GetMeshBytes(*mesh));
+		});
+	}, &mAsyncLoadCounter);
+}
+
+void GameTechRenderer::LoadTextureAsync(const std::string& name, AssetCache<Texture>::Handle& out) {
+	if (SharedTexture cached = mTextureCache.Acquire(name)) {
+		out = cached;
+		return;
+	}
+	// the texture object is made here as generating its name is a GL call
+	OGLTexture* tex = new OGLTexture();
+	out = mTextureCache.Add(name, SharedTexture(tex));
+	JobSystem::GetJobSystem()->Submit([this, name, tex]() {
+		LoadMarker marker("Load texture", name);
+		std::shared_ptr<CookedTexture> cooked = std::make_shared<CookedTexture>();
+		if (TextureLoader::LoadCookedTexture(name, *cooked)) {
+			std::lock_guard<std::mutex> lock(mUploadLock);
+			mPendingUploads.emplace_back([this, name, tex, cooked]() {
+				tex->UploadCooked(*cooked);
+				mTextureCache.SetResidentBytes(name, GetTextureBytes(*tex));
+			});
+			return;
+		}
+
+		char* texData = nullptr;
+		int width = 0;
+		int height = 0;
+		int channels = 0;
+		int flags = 0;
+		TextureLoader::LoadTexture(name, texData, width, height, channels, flags);
+
+		std::lock_guard<std::mutex> lock(mUploadLock);
+		mPendingUploads.emplace_back([this, name, tex, texData, width, height, channels]() {
+			tex->UploadData(texData, width, height, channels);
+			free(texData);
+			mTextureCache.SetResidentBytes(name, GetTextureBytes(*tex));
+		});
+	}, &mAsyncLoadCounter);
+}
+
+//Animations and materials load entirely in their constructors, so they can't
+//be cached ahead of time. Two misses on one name in a batch both load it, and
+//whichever adds second is handed the first copy
+void GameTechRenderer::LoadAnimationAsync(const std::string& name, AssetCache<MeshAnimation>::Handle& out) {
+	if (SharedMeshAnim cached = mAnimationCache.Acquire(name)) {
+		out = cached;
+		return;
+	}
+	JobSystem::GetJobSystem()->Submit([this, name, &out]() {
+		LoadMarker marker("Load animation", name);
+		MeshAnimation* anim = new MeshAnimation(name);
+		out = mAnimationCache.Add(name, SharedMeshAnim(anim), GetAnimationBytes(*anim));
+	}, &mAsyncLoadCounter);
+}
+
+void GameTechRenderer::LoadMaterialAsync(const std::string& name, AssetCache<MeshMaterial>::Handle& out) {
+	if (AssetCache<MeshMaterial>::Handle cached = mMaterialCache.Acquire(name)) {
+		out = cached;
+		return;
+	}
+	JobSystem::GetJobSystem()->Submit([this, name, &out]() {
+		LoadMarker marker("Load material", name);
+		out = mMaterialCache.Add(name, std::make_shared<MeshMaterial>(name));
+	}, &mAsyncLoadCounter);
+}
+
+void GameTechRenderer::FinishAsyncLoads() {
+	{
+		LoadMarker marker("Wait for async loads");
+		JobSystem::GetJobSystem()->Wait(mAsyncLoadCounter);
+	}
+	LoadMarker marker("Upload to GPU");
+	for (const std::function<void()>& upload : mPendingUploads) {
+		upload();
+	}
+	mPendingUploads.clear();
+}
+
+void GameTechRenderer::PrintAssetStats() const {
+	PrintCacheStats("meshes", mMeshCache);
+	PrintCacheStats("textures", mTextureCache);
+	PrintCacheStats("shaders", mShaderCache);
+	PrintCacheStats("animations", mAnimationCache);
+	PrintCacheStats("materials", mMaterialCache);
 }
 
 void GameTechRenderer::SetDebugStringBufferSizes(size_t newVertCount) {
@@ -851,6 +1049,11 @@ void GameTechRenderer::AddLight(Light* lightPtr) {
 	mLights.push_back(lightPtr);
 }
 
+//The caller keeps ownership of a removed light
+void GameTechRenderer::RemoveLight(Light* lightPtr) {
+	mLights.erase(std::remove(mLights.begin(), mLights.end(), lightPtr), mLights.end());
+}
+
 void GameTechRenderer::ClearLights() {
 	for (int i = 0; i < mLights.size(); i++) {
 		delete(mLights[i]);
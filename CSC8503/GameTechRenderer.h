@@ -15,6 +15,9 @@
 #include "MeshMaterial.h"
 
 #include "UI.h"
+#include "RenderSnapshot.h"
+#include "JobSystem.h"
+#include "AssetCache.h"
 
 
 
@@ -30,14 +33,44 @@ namespace NCL {
 			GameTechRenderer(GameWorld& world);
 			~GameTechRenderer();
 
-			Mesh*		LoadMesh(const std::string& name);
-			Texture*	LoadTexture(const std::string& name);
-			Shader*		LoadShader(const std::string& vertex, const std::string& fragment);
-			MeshAnimation* LoadAnimation(const std::string& name);
-			MeshMaterial* LoadMaterial(const std::string& name);
-			
+			//Assets are shared through the caches below, so asking for one that is
+			//already loaded hands back the same copy. Each load takes a reference
+			//in the cache, which the caller gives back with the cache's Release
+			//once it is done with the handle; the handle itself keeps the asset
+			//alive until it is destroyed
+			AssetCache<Mesh>::Handle			LoadMesh(const std::string& name);
+			AssetCache<Texture>::Handle			LoadTexture(const std::string& name);
+			AssetCache<Shader>::Handle			LoadShader(const std::string& vertex, const std::string& fragment);
+			AssetCache<MeshAnimation>::Handle	LoadAnimation(const std::string& name);
+			AssetCache<MeshMaterial>::Handle	LoadMaterial(const std::string& name);
+
+			//Files are read and decoded on the job threads, and the assets aren't
+			//usable until FinishAsyncLoads has done the GPU side on this thread
+			void LoadMeshAsync(const std::string& name, AssetCache<Mesh>::Handle& out);
+			void LoadTextureAsync(const std::string& name, AssetCache<Texture>::Handle& out);
+			void LoadAnimationAsync(const std::string& name, AssetCache<MeshAnimation>::Handle& out);
+			void LoadMaterialAsync(const std::string& name, AssetCache<MeshMaterial>::Handle& out);
+			void FinishAsyncLoads();
+
+			AssetCache<Mesh>& GetMeshCache() {
+				return mMeshCache;
+			}
+			AssetCache<Texture>& GetTextureCache() {
+				return mTextureCache;
+			}
+			AssetCache<Shader>& GetShaderCache() {
+				return mShaderCache;
+			}
+			AssetCache<MeshAnimation>& GetAnimationCache() {
+				return mAnimationCache;
+			}
+			AssetCache<MeshMaterial>& GetMaterialCache() {
+				return mMaterialCache;
+			}
+			void PrintAssetStats() const;
 
 			void AddLight(Light* light);
+			void RemoveLight(Light* light);
 			void ClearLights();
 			void SetWallFloorObject(GameObject* wallFloorTile) {
 				mWallFloorTile = wallFloorTile;
@@ -47,6 +80,9 @@ namespace NCL {
 				mUi = ui;
 			}
 
+			void SubmitSnapshot(bool prepareAsync);
+			void DiscardSnapshot();
+
 		protected:
 			void NewRenderLines();
 			void NewRenderText();
@@ -60,8 +96,6 @@ namespace NCL {
 
 			GameWorld&	gameWorld;
 
-			void BuildObjectList();
-			void SortObjectList();
 			void RenderShadowMap();
 			void RenderCamera(); 
 			void RenderSkybox();
@@ -69,26 +103,42 @@ namespace NCL {
 			void GenerateScreenTexture(GLuint &fbo, bool depth = false);
 			void BindTexAttachmentsToBuffers(GLuint& fbo, GLuint& colourAttach0, GLuint& colourAttach1, GLuint* depthTex = nullptr);
 			void LoadDefRendShaders();
-			void FillGBuffer(Matrix4& viewMatrix, Matrix4& projMatrix);
-			void DrawLightVolumes(Matrix4& viewMatrix, Matrix4& projMatrix);
+			void FillGBuffer(const Matrix4& viewMatrix, const Matrix4& projMatrix);
+			void DrawLightVolumes(const Matrix4& viewMatrix, const Matrix4& projMatrix);
 			void CombineBuffers();
 			void DrawOutlinedObjects();
 			void LoadSkybox();
+			bool LoadCookedSkybox(const std::string filenames[6]);
 
-			void DrawWallsFloorsInstanced(Matrix4& viewMatrix, Matrix4& projMatrix);
+			void DrawWallsFloorsInstanced(const Matrix4& viewMatrix, const Matrix4& projMatrix);
 
 			void SetDebugStringBufferSizes(size_t newVertCount);
 			void SetDebugLineBufferSizes(size_t newVertCount);
 
 			void SetUIiconBufferSizes(size_t newVertCount);
-			void BindCommonLightDataToShader(OGLShader* shader, Matrix4& viewMatrix, Matrix4& projMatrix);
+			void BindCommonLightDataToShader(OGLShader* shader, const Matrix4& viewMatrix, const Matrix4& projMatrix);
 			void BindSpecificLightDataToShader(Light* l);			
 			void SendPointLightDataToShader(OGLShader* shader, PointLight* l);
 			void SendSpotLightDataToShader(OGLShader* shader, SpotLight* l);
 			void SendDirLightDataToShader(OGLShader* shader, DirectionLight* l);
 
-			vector<const RenderObject*> mActiveObjects;
-			vector<const RenderObject*> mOutlinedObjects;
+			//Snapshots are double buffered so one can be captured while the other is drawn
+			RenderSnapshot	mSnapshots[2];
+			const RenderSnapshot* mFrameSnapshot;
+			int			mNextSnapshot;
+			bool		mSnapshotQueued;
+			JobCounter	mPrepareCounter;
+
+			//GL calls left over from async loads, run by FinishAsyncLoads
+			JobCounter	mAsyncLoadCounter;
+			std::mutex	mUploadLock;
+			std::vector<std::function<void()>> mPendingUploads;
+
+			AssetCache<Mesh>			mMeshCache;
+			AssetCache<Texture>			mTextureCache;
+			AssetCache<Shader>			mShaderCache;
+			AssetCache<MeshAnimation>	mAnimationCache;
+			AssetCache<MeshMaterial>	mMaterialCache;
 
 			OGLShader*  debugShader;
 			OGLShader*  skyboxShader;
@@ -155,8 +205,6 @@ namespace NCL {
 
 			vector<Light*> mLights;
 
-			Frustum mFrameFrustum;
-
 			UI* mUi;
 		};
 	}
@@ -58,7 +58,8 @@ void	GameTechVulkanRenderer::InitStructures() {
 		.WithQueue(GetQueue(CommandBuffer::Graphics))
 		.BuildFromFile("Default.png");
 
-	loadedTextures.push_back(&(*defaultTexture)); //Default will always be index 0!
+	//Default will always be index 0! defaultTexture owns it, so this handle doesn't
+	loadedTextures.push_back(SharedTexture(&(*defaultTexture), [](Texture*) {}));
 
 	defaultSampler = GetDevice().createSamplerUnique(
 		vk::SamplerCreateInfo()
@@ -170,7 +171,8 @@ void	GameTechVulkanRenderer::InitStructures() {
 	currentFrameIndex = 0;
 	currentFrame = &allFrames[currentFrameIndex];
 
-	Debug::CreateDebugFont("PressStart2P.fnt", *LoadTexture("PressStart2P.png"));
+	fontTexture = LoadTexture("PressStart2P.png");
+	Debug::CreateDebugFont("PressStart2P.fnt", *fontTexture);
 }
 
 
@@ -507,7 +509,7 @@ void GameTechVulkanRenderer::RenderDebugText(vk::CommandBuffer cmds) {
 	cmds.draw((uint32_t)currentFrame->textVertCount, 1, 0, 0);
 }
 
-Mesh* GameTechVulkanRenderer::LoadMesh(const string& name) {
+SharedMesh GameTechVulkanRenderer::LoadMesh(const string& name) {
 	VulkanMesh* newMesh = new VulkanMesh();
 
 	MshLoader::LoadMesh(name, *newMesh);
@@ -515,10 +517,10 @@ Mesh* GameTechVulkanRenderer::LoadMesh(const string& name) {
 	newMesh->SetPrimitiveType(NCL::GeometryPrimitive::Triangles);
 	newMesh->SetDebugName(name);
 	newMesh->UploadToGPU(this);
-	return newMesh;
+	return SharedMesh(newMesh);
 }
 
-Texture* GameTechVulkanRenderer::LoadTexture(const string& name) {
+SharedTexture GameTechVulkanRenderer::LoadTexture(const string& name) {
 	VulkanTexture* t = TextureBuilder(GetDevice(), GetMemoryAllocator())
 		.WithPool(GetCommandPool(CommandBuffer::Graphics))
 		.WithQueue(GetQueue(CommandBuffer::Graphics))
@@ -527,16 +529,16 @@ Texture* GameTechVulkanRenderer::LoadTexture(const string& name) {
 	//Write the texture to our big descriptor set
 	WriteImageDescriptor(*objectTextxureDescriptor, 0, (int)loadedTextures.size(), t->GetDefaultView(), *defaultSampler);
 	t->SetAssetID(loadedTextures.size());
-	loadedTextures.push_back(t);
-	return t;
+	//The texture stays in the descriptor set for the renderer's lifetime, so the list shares ownership
+	loadedTextures.push_back(SharedTexture(t));
+	return loadedTextures.back();
 }
 
-Shader* GameTechVulkanRenderer::LoadShader(const string& vertex, const string& fragment) {
-	return ShaderBuilder(GetDevice())
+SharedShader GameTechVulkanRenderer::LoadShader(const string& vertex, const string& fragment) {
+	return SharedShader(ShaderBuilder(GetDevice())
 		.WithVertexBinary(vertex + ".spv")
 		.WithFragmentBinary(fragment + ".spv")
-		.Build("Shader!").release();
-	return nullptr;
+		.Build("Shader!").release());
 }
 
 UniqueVulkanMesh GameTechVulkanRenderer::GenerateQuad() {
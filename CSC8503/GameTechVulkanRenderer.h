@@ -15,9 +15,9 @@ namespace NCL::Rendering {
 
 		void		InitStructures();
 
-		Mesh*		LoadMesh(const string& name);
-		Texture*	LoadTexture(const string& name);
-		Shader*		LoadShader(const string& vertex, const string& fragment);
+		SharedMesh		LoadMesh(const string& name);
+		SharedTexture	LoadTexture(const string& name);
+		SharedShader	LoadShader(const string& vertex, const string& fragment);
 
 	protected:
 		void SetupDevice(vk::PhysicalDeviceFeatures2& deviceFeatures) override;
@@ -141,7 +141,8 @@ namespace NCL::Rendering {
 		vk::UniqueSampler	defaultSampler;
 		vk::UniqueSampler	textSampler;
 
-		vector<Vulkan::VulkanTexture*> loadedTextures;
+		vector<SharedTexture> loadedTextures;
+		SharedTexture	fontTexture;
 	};
 }
 #endif
@@ -22,11 +22,26 @@ namespace InventoryBuffSystem
             mPlayerInventoryPtr->Init();
         };
 
+        void SaveState()
+        {
+            mSavedPlayerBuffs = *mPlayerBuffsPtr;
+            mSavedPlayerInventory = *mPlayerInventoryPtr;
+        };
+
+        void RestoreState()
+        {
+            *mPlayerBuffsPtr = mSavedPlayerBuffs;
+            *mPlayerInventoryPtr = mSavedPlayerInventory;
+        };
+
         PlayerBuffs* GetPlayerBuffsPtr() { return mPlayerBuffsPtr; };
         PlayerInventory* GetPlayerInventoryPtr() { return mPlayerInventoryPtr; };
     private:
         PlayerBuffs* mPlayerBuffsPtr;
         PlayerInventory* mPlayerInventoryPtr;
+
+        PlayerBuffs mSavedPlayerBuffs;
+        PlayerInventory mSavedPlayerInventory;
     };
 }
 
@@ -2,6 +2,7 @@
 #include "InventoryBuffSystem.h"
 
 InventoryBuffSystem::Item::Item(PlayerInventory::item itemType, InventoryBuffSystemClass& inventoryBuffSystemClass) {
+	mObjectType = Type;
 	mItemType = itemType;
 	mInventoryBuffSystemClassPtr = &inventoryBuffSystemClass;
 }
@@ -7,6 +7,8 @@ namespace InventoryBuffSystem{
 
     class Item : public NCL::CSC8503::GameObject, public PlayerInventoryObserver {
     public:
+        static constexpr NCL::CSC8503::GameObjectType Type = NCL::CSC8503::GameObjectType::Item;
+
         Item(PlayerInventory::item, InventoryBuffSystemClass& inventoryBuffSystemClass);
         
         PlayerInventory::item GetItemType() const { return mItemType;  };
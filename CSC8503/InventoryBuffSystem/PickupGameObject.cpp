@@ -16,6 +16,7 @@ PickupGameObject::PickupGameObject(
 	unsigned int randomSeed,
 	std::map<GameObject*, int>* playerObjectToPlayerNoMap,
 	float initCooldown) {
+	mObjectType = Type;
 	mPlayerObjectToPlayerNoMap = playerObjectToPlayerNoMap;
 	mRandomSeed = randomSeed;
 	mCooldown = 0.0f;
@@ -87,6 +88,24 @@ void PickupGameObject::UpdateObject(float dt) {
 	mStateMachine->Update(dt);
 }
 
+void PickupGameObject::SaveState() {
+	GameObject::SaveState();
+	mSavedPickupState.activeState	= mStateMachine->GetActiveState();
+	mSavedPickupState.cooldown		= mCooldown;
+	mSavedPickupState.isBuff		= mIsBuff;
+	mSavedPickupState.currentItem	= mCurrentItem;
+	mSavedPickupState.currentBuff	= mCurrentBuff;
+}
+
+void PickupGameObject::RestoreState() {
+	GameObject::RestoreState();
+	mStateMachine->SetActiveState(mSavedPickupState.activeState);
+	mCooldown		= mSavedPickupState.cooldown;
+	mIsBuff			= mSavedPickupState.isBuff;
+	mCurrentItem	= mSavedPickupState.currentItem;
+	mCurrentBuff	= mSavedPickupState.currentBuff;
+}
+
 void PickupGameObject::ChangeToRandomPickup(){
 	std::random_device rd;
 	std::mt19937 gen(rd());
@@ -13,7 +13,11 @@ namespace NCL {
     namespace CSC8503 {
         class PickupGameObject : public GameObject {
         public:
-            PickupGameObject() {};
+            static constexpr GameObjectType Type = GameObjectType::Pickup;
+
+            PickupGameObject() {
+                mObjectType = Type;
+            };
             PickupGameObject(
                 InventoryBuffSystemClass* inventoryBuffSystemClassPtr,
                 unsigned int randomSeed = 10,
@@ -28,6 +32,9 @@ namespace NCL {
 
             virtual void OnCollisionBegin(GameObject* otherObject) override;
 
+            virtual void SaveState() override;
+            virtual void RestoreState() override;
+
         protected:
             void GoOver(float dt); //go over the surface
             void GoUnder(float dt); // go under the surface
@@ -44,6 +51,15 @@ namespace NCL {
             InventoryBuffSystemClass* mInventoryBuffSystemClassPtr;
             PlayerInventory::item mCurrentItem;
             PlayerBuffs::buff mCurrentBuff;
+
+            struct SavedPickupState {
+                State*              activeState;
+                float               cooldown;
+                bool                isBuff;
+                PlayerInventory::item currentItem;
+                PlayerBuffs::buff   currentBuff;
+            };
+            SavedPickupState mSavedPickupState;
         };
     }
 }
@@ -9,25 +9,36 @@
 using namespace NCL;
 using namespace CSC8503;
 
-SoundEmitter::SoundEmitter(int initCooldown, LocationBasedSuspicion* locationBasedSuspicionPTR) {
+SoundEmitter::SoundEmitter(float initCooldown, LocationBasedSuspicion* locationBasedSuspicionPTR) {
 
+	mObjectType = Type;
 	mInitCooldown = initCooldown;
+	mCooldown = 0;
+	mIsEmitting = false;
 	mLocationBasedSuspicionPTR = locationBasedSuspicionPTR;
-
-	NCL::Maths::Vector3 pos = GetTransform().GetPosition();
-
-	mLocationBasedSuspicionPTR->AddActiveLocationSusCause(LocationBasedSuspicion::continouousSound, pos.x,pos.z);
 }
 
 SoundEmitter::~SoundEmitter() {
 }
 
-void SoundEmitter::Update(float dt) {
-	mInitCooldown -= dt;
+//Emitters are reused, so this is called each time one is placed rather than on construction
+void SoundEmitter::StartEmitting(const Vector3& position) {
+	GetTransform().SetPosition(position);
+	mCooldown = mInitCooldown;
+	mIsEmitting = true;
+
+	mLocationBasedSuspicionPTR->AddActiveLocationSusCause(LocationBasedSuspicion::continouousSound, position.x, position.z);
+}
+
+void SoundEmitter::UpdateObject(float dt) {
+	if (!mIsEmitting)
+		return;
+
+	mCooldown -= dt;
 
-	if (mInitCooldown < 0)
+	if (mCooldown < 0)
 	{
-		this->SetIsRendered(false);
+		mIsEmitting = false;
 		NCL::Maths::Vector3 pos = GetTransform().GetPosition();
 		mLocationBasedSuspicionPTR->RemoveActiveLocationSusCause(LocationBasedSuspicion::continouousSound, pos.x, pos.z);
 	}
@@ -11,14 +11,24 @@ namespace NCL {
     namespace CSC8503 {
         class SoundEmitter : public GameObject {
         public:
-            SoundEmitter() {};
-            SoundEmitter(int initCooldown, LocationBasedSuspicion* locationBasedSuspicionPTR);
+            static constexpr GameObjectType Type = GameObjectType::SoundEmitter;
+
+            SoundEmitter() {
+                mObjectType = Type;
+            };
+            SoundEmitter(float initCooldown, LocationBasedSuspicion* locationBasedSuspicionPTR);
             ~SoundEmitter();
 
-            virtual void Update(float dt);
+            void StartEmitting(const Vector3& position);
+
+            virtual void UpdateObject(float dt) override;
+
+            bool IsEmitting() const { return mIsEmitting; }
 
         protected:
-            int mInitCooldown;
+            float mInitCooldown;
+            float mCooldown;
+            bool mIsEmitting;
             LocationBasedSuspicion* mLocationBasedSuspicionPTR;
         };
     }
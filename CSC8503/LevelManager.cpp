@@ -2,6 +2,9 @@
 
 #include "GameWorld.h"
 #include "RecastBuilder.h"
+#include "NavigationGeometry.h"
+#include "PathfindingService.h"
+#include "CrowdManager.h"
 #include "PhysicsObject.h"
 #include "RenderObject.h"
 #include "AnimationObject.h"
@@ -19,6 +22,7 @@
 #include "InventoryBuffSystem/SoundEmitter.h"
 #include "UI.h"
 #include "SoundManager.h"
+#include "LoadProfiler.h"
 #include <filesystem>
 
 using namespace NCL::CSC8503;
@@ -26,32 +30,81 @@ using namespace NCL::CSC8503;
 LevelManager* LevelManager::instance = nullptr;
 
 LevelManager::LevelManager() {
-	mBuilder = new RecastBuilder();
-	mWorld = new GameWorld();
-	mRenderer = new GameTechRenderer(*mWorld);
-	mPhysics = new PhysicsSystem(*mWorld);
-	mPhysics->UseGravity(true);
-	mAnimation = new AnimationSystem(*mWorld);
-	mUi = new UI();
-	mInventoryBuffSystemClassPtr = new InventoryBuffSystemClass();
-	mSuspicionSystemClassPtr = new SuspicionSystemClass();
-
-	mRoomList = std::vector<Room*>();
-	for (const auto& entry : std::filesystem::directory_iterator("../Assets/Levels/Rooms")) {
-		Room* newRoom = new Room(entry.path().string());
-		mRoomList.push_back(newRoom);
-	}
-	mLevelList = std::vector<Level*>();
-	for (const auto& entry : std::filesystem::directory_iterator("../Assets/Levels/Levels")) {
-		Level* newLevel = new Level(entry.path().string());
-		mLevelList.push_back(newLevel);
+	LoadMarker constructMarker("LevelManager");
+	{
+		LoadMarker marker("Create systems");
+		mBuilder = new RecastBuilder();
+		mPathfinding = nullptr;
+		mCrowd = nullptr;
+		mWorld = new GameWorld();
+		mRenderer = new GameTechRenderer(*mWorld);
+		mPhysics = new PhysicsSystem(*mWorld);
+		mPhysics->UseGravity(true);
+		mAnimation = new AnimationSystem(*mWorld);
+		mUi = new UI();
+		mInventoryBuffSystemClassPtr = new InventoryBuffSystemClass();
+		mSuspicionSystemClassPtr = new SuspicionSystemClass();
+		mSuspicionSystemClassPtr->Init();
 	}
-	mActiveLevel = -1;
 
-	SoundManager* a = new SoundManager();
-	
+	// level files are parsed on the job threads while the assets load, and
+	// whichever finishes first helps out with the other
+	JobCounter levelFileCounter;
+	LoadLevelFiles(levelFileCounter);
 	InitialiseAssets();
+	{
+		LoadMarker marker("Wait for level files");
+		JobSystem::GetJobSystem()->Wait(levelFileCounter);
+	}
+
+	mActiveLevel = -1;
+	mLevelTileMatrixCount = 0;
+	mHasLevelSnapshot = false;
+	mPrintStats = false;
+	mSnapshotPlayerID = -1;
+	mSnapshotLayoutHash = 0;
+
+	{
+		LoadMarker marker("Create sound");
+		SoundManager* a = new SoundManager();
+	}
+
+	LoadMarker marker("Icons and frame tasks");
 	InitialiseIcons();
+	InitialiseFrameTasks();
+}
+
+void LevelManager::LoadLevelFiles(JobCounter& counter) {
+	auto findJsonFiles = [](const std::string& directory) {
+		std::vector<std::string> paths;
+		for (const auto& entry : std::filesystem::directory_iterator(directory)) {
+			// cooked copies sit beside the sources and are picked up by the constructors
+			if (entry.path().extension() == ".json") {
+				paths.push_back(entry.path().string());
+			}
+		}
+		return paths;
+	};
+	std::vector<std::string> roomPaths = findJsonFiles("../Assets/Levels/Rooms");
+	std::vector<std::string> levelPaths = findJsonFiles("../Assets/Levels/Levels");
+
+	// every file gets its own slot up front, so the jobs never resize the lists
+	mRoomList = std::vector<Room*>(roomPaths.size(), nullptr);
+	mLevelList = std::vector<Level*>(levelPaths.size(), nullptr);
+
+	JobSystem* jobSystem = JobSystem::GetJobSystem();
+	for (size_t i = 0; i < roomPaths.size(); i++) {
+		jobSystem->Submit([this, i, path = roomPaths[i]]() {
+			LoadMarker marker("Parse room", path);
+			mRoomList[i] = new Room(path);
+		}, &counter);
+	}
+	for (size_t i = 0; i < levelPaths.size(); i++) {
+		jobSystem->Submit([this, i, path = levelPaths[i]]() {
+			LoadMarker marker("Parse level", path);
+			mLevelList[i] = new Level(path);
+		}, &counter);
+	}
 }
 
 LevelManager::~LevelManager() {
@@ -75,72 +128,38 @@ LevelManager::~LevelManager() {
 	delete mTempPlayer;
 	delete mUi;
 
-	delete mCubeMesh;
-	delete mSphereMesh;
-	delete mCapsuleMesh;
-	delete mCharMesh;
-	delete mEnemyMesh;
-	delete mBonusMesh;
-
-
-	delete mBasicTex;
-	delete mBasicShader;
-	delete mKeeperAlbedo;
-	delete mKeeperNormal;
-	delete mFloorAlbedo;
-	delete mFloorNormal;
-
+	// meshes, textures, shaders and animations belong to the renderer's asset caches
+	ReleaseAssets();
 	delete mPhysics;
 	delete mRenderer;
 	delete mWorld;
 	delete mAnimation;
-
-	delete mInventorySlotTex;
-	delete mHighlightAwardTex;
-	delete mLightOffTex;
-	delete mMakingNoiseTex;
-	delete mSilentRunTex;
-	delete mSlowDownTex;
-	delete mStunTex;
-	delete mSwapPositionTex;
-
-	delete mSuspensionBarTex;
-	delete mSuspensionIndicatorTex;
-
-	delete mAnimationShader;
-
-	delete mGuardMaterial;
-	delete mGuardMesh;
-
-	delete mPlayerMaterial;
-	delete mPlayerMesh;
-
-	delete mRigMaterial;
-	delete mRigMesh;
-
-	delete mGuardAnimationStand;
-	delete mGuardAnimationSprint;
-	delete mGuardAnimationWalk;
-
-	
-	delete mPlayerAnimationStand;
-	delete mPlayerAnimationSprint;
-	delete mPlayerAnimationWalk;
-	
-	delete mRigAnimationStand;
-	delete mRigAnimationSprint;
-	delete mRigAnimationWalk;
+	// after the world, as guards cancel their requests and leave the crowd as they go
+	delete mPathfinding;
+	delete mCrowd;
 }
 
 void LevelManager::ClearLevel() {
+	if (mPrintStats) {
+		ReportPoolUsage();
+		ReportGuardPathing();
+	}
+	mPickupPool.Clear();
+	mSoundEmitterPool.Clear();
+	mHasLevelSnapshot = false;
+	mSnapshotObjects.clear();
+	ClearStreamedRooms();
 	mRenderer->ClearLights();
 	mWorld->ClearAndErase();
 	mPhysics->Clear();
 	mLevelMatrices.clear();
+	mLevelTileMatrixCount = 0;
 	mUpdatableObjects.clear();
 	mLevelLayout.clear();
 	mRenderer->SetWallFloorObject(nullptr);
+	mRenderer->DiscardSnapshot();
 	mAnimation->Clear();
+	mAnimation->ReleaseMatTextures(*mRenderer);
 	if(mTempPlayer)mTempPlayer->ResetPlayerPoints();	
 }
 
@@ -161,29 +180,275 @@ void LevelManager::ResetLevel() {
 
 void LevelManager::LoadLevel(int levelID, int playerID, bool isMultiplayer) {
 	if (levelID > mLevelList.size() - 1) return;
+	LoadMarker levelMarker("LoadLevel", "Level " + std::to_string(levelID));
+	// restarting the same layout skips the rebuild and navmesh generation entirely
+	if (mHasLevelSnapshot && !isMultiplayer && levelID == mActiveLevel && playerID == mSnapshotPlayerID &&
+		GetLayoutHash(levelID) == mSnapshotLayoutHash) {
+		LoadMarker marker("Restore snapshot");
+		RestoreLevelSnapshot();
+		return;
+	}
 	mActiveLevel = levelID;
-	mWorld->ClearAndErase();
-	mPhysics->Clear();
-	ClearLevel();
+	{
+		LoadMarker marker("Clear level");
+		ClearLevel();
+	}
 	std::vector<Vector3> itemPositions;
-	LoadMap((*mLevelList[levelID]).GetTileMap(), Vector3(0, 0, 0));
-	LoadVents((*mLevelList[levelID]).GetVents(), (*mLevelList[levelID]).GetVentConnections());
-	LoadDoors((*mLevelList[levelID]).GetDoors(), Vector3(0, 0, 0));
-	LoadLights((*mLevelList[levelID]).GetLights(), Vector3(0, 0, 0));
-	mHelipad = AddHelipadToWorld((*mLevelList[levelID]).GetHelipadPosition());
-	AddPrisonDoorToWorld((*mLevelList[levelID]).GetPrisonDoor());
-	for (Vector3 itemPos : (*mLevelList[levelID]).GetItemPositions()) {
-		itemPositions.push_back(itemPos);
+	{
+		LoadMarker marker("Load layout");
+		LoadMap((*mLevelList[levelID]).GetTileMap(), Vector3(0, 0, 0));
+		LoadVents((*mLevelList[levelID]).GetVents(), (*mLevelList[levelID]).GetVentConnections());
+		LoadDoors((*mLevelList[levelID]).GetDoors(), Vector3(0, 0, 0));
+		LoadLights((*mLevelList[levelID]).GetLights(), Vector3(0, 0, 0));
+		mHelipad = AddHelipadToWorld((*mLevelList[levelID]).GetHelipadPosition());
+		if ((*mLevelList[levelID]).GetPrisonDoor())
+			AddPrisonDoorToWorld((*mLevelList[levelID]).GetPrisonDoor());
+		for (Vector3 itemPos : (*mLevelList[levelID]).GetItemPositions()) {
+			itemPositions.push_back(itemPos);
+		}
+		mLevelTileMatrixCount = mLevelMatrices.size();
+	}
+
+	// guards path through every room, so the navmesh is built from the whole
+	// layout and rooms nobody is near are released again afterwards
+	{
+		LoadMarker marker("Prepare rooms");
+		InitialiseStreamedRooms(levelID, itemPositions);
+		for (auto& room : mStreamedRooms) {
+			PrepareRoom(*room);
+		}
+		for (auto& room : mStreamedRooms) {
+			JobSystem::GetJobSystem()->Wait(room->prepareCounter);
+			room->state = StreamedRoom::Prepared;
+		}
+	}
+
+	// the old guards are gone, and no search may run while the navmesh is replaced
+	delete mPathfinding;
+	mPathfinding = nullptr;
+	delete mCrowd;
+	mCrowd = nullptr;
+	std::vector<float> navigationVerts;
+	std::vector<unsigned int> navigationTris;
+	NavigationGeometry::Build(*mLevelList[levelID], mRoomList, *mWallFloorCubeMesh, navigationVerts, navigationTris);
+	float* levelSize = mBuilder->BuildNavMesh(std::move(navigationVerts), std::move(navigationTris));
+	if (mPrintStats) {
+		std::cout << "Navmesh of " << mBuilder->GetTileCount() << " tiles " << (mBuilder->WasLoadedFromCache() ? "loaded from cache" : "built") << std::endl;
+	}
+	if (mBuilder->GetNavMesh()) {
+		mPathfinding = new PathfindingService(mBuilder->GetNavMesh());
+		mCrowd = new CrowdManager(mBuilder->GetNavMesh(), MAX_CROWD_AGENTS, MAX_CROWD_AGENT_RADIUS);
+	}
+	if(levelSize) mPhysics->SetNewBroadphaseSize(Vector3(levelSize[x], levelSize[y], levelSize[z]));
+
+	if (!isMultiplayer){
+		LoadMarker marker("Add player and guards");
+		AddPlayerToWorld((*mLevelList[levelID]).GetPlayerStartTransform(playerID), "Player");
+
+		//TODO(erendgrmnc): after implementing ai to multiplayer move out from this if block
+		LoadGuards((*mLevelList[levelID]).GetGuardCount());
 	}
 
+	// with nobody in the world yet every room stays until the first players arrive
+	{
+		LoadMarker marker("Stream rooms");
+		std::vector<Vector3> anchors = GetStreamingAnchors();
+		if (anchors.empty()) {
+			for (auto& room : mStreamedRooms) {
+				AddRoomToWorld(*room);
+			}
+		}
+		else {
+			StreamRooms(anchors);
+			ParkGuards();
+		}
+	}
+	{
+		LoadMarker marker("SendWallFloorInstancesToGPU");
+		SendWallFloorInstancesToGPU();
+	}
+	{
+		LoadMarker marker("Pools and items");
+		InitialisePools(itemPositions.size());
+		LoadItems(itemPositions);
+	}
+
+	{
+		LoadMarker marker("Preload material textures");
+		mAnimation->PreloadMatTextures(*mRenderer);
+	}
+
+	delete[] levelSize;
+
+	mTimer = 20.f;
+
+	if (!isMultiplayer) {
+		LoadMarker marker("Save snapshot");
+		SaveLevelSnapshot(playerID);
+	}
+	if (mPrintStats) {
+		mRenderer->PrintAssetStats();
+	}
+}
+
+/*
+Level geometry never changes during play, and doors come and go with room
+streaming, so neither is part of the snapshot. Doors are all opened again on
+a restore instead, as every door starts open.
+*/
+void LevelManager::SaveLevelSnapshot(int playerID) {
+	mSnapshotObjects.clear();
+	std::vector<GameObject*>::const_iterator first;
+	std::vector<GameObject*>::const_iterator last;
+	mWorld->GetObjectIterators(first, last);
+	for (auto i = first; i != last; ++i) {
+		GameObject* o = *i;
+		if ((o->GetObjectType() == GameObjectType::Default && o->GetCollisionLayer() == StaticObj) ||
+			o->GetObjectType() == GameObjectType::Door) {
+			continue;
+		}
+		o->SaveState();
+		mSnapshotObjects.push_back(o);
+	}
+	mInventoryBuffSystemClassPtr->SaveState();
+	mSuspicionSystemClassPtr->SaveState();
+
+	mSnapshotPlayerID = playerID;
+	mSnapshotLayoutHash = GetLayoutHash(mActiveLevel);
+	mHasLevelSnapshot = true;
+}
+
+void LevelManager::RestoreLevelSnapshot() {
+	mRenderer->DiscardSnapshot();
+
+	// sound emitters are only ever placed during play
+	mSoundEmitterPool.ReleaseAll();
+
+	mPhysics->Clear();
+	for (GameObject* o : mSnapshotObjects) {
+		o->RestoreState();
+	}
+	mInventoryBuffSystemClassPtr->RestoreState();
+	mSuspicionSystemClassPtr->RestoreState();
+	for (Door* door : mWorld->Query<Door>()) {
+		door->Open();
+	}
+	for (auto& room : mStreamedRooms) {
+		for (Door* door : room->doors) {
+			door->Open();
+		}
+	}
+
+	mWorld->GetMainCamera().SetYaw((*mLevelList[mActiveLevel]).GetPlayerStartTransform(mSnapshotPlayerID).GetOrientation().ToEuler().y);
+	mTimer = 20.f;
+
+	UpdateRoomStreaming();
+}
+
+/*
+Hashes everything LoadLevel builds static geometry and the navmesh from, so a
+snapshot is only reused while the layout it was taken with is still current.
+*/
+size_t LevelManager::GetLayoutHash(int levelID) const {
+	size_t hash = 14695981039346656037ull;
+	auto hashValue = [&hash](float value) {
+		hash = (hash ^ std::hash<float>()(value)) * 1099511628211ull;
+	};
+	auto hashTileMap = [&](const std::map<Vector3, TileType>& tileMap, const Vector3& offset) {
+		for (auto const& [key, val] : tileMap) {
+			hashValue(key.x + offset.x);
+			hashValue(key.y + offset.y);
+			hashValue(key.z + offset.z);
+			hashValue((float)val);
+		}
+	};
+	hashTileMap((*mLevelList[levelID]).GetTileMap(), Vector3(0, 0, 0));
+	for (auto const& [key, val] : (*mLevelList[levelID]).GetRooms()) {
+		for (Room* room : mRoomList) {
+			if (room->GetType() == (*val).GetType()) {
+				hashTileMap(room->GetTileMap(), key);
+				break;
+			}
+		}
+	}
+	return hash;
+}
+
+void LevelManager::SendWallFloorInstancesToGPU() {
+	mLevelMatrices.resize(mLevelTileMatrixCount);
+	for (auto& room : mStreamedRooms) {
+		if (room->state == StreamedRoom::Resident) {
+			mLevelMatrices.insert(mLevelMatrices.end(), room->tileMatrices.begin(), room->tileMatrices.end());
+		}
+	}
+	OGLMesh* instance = (OGLMesh*)mWallFloorCubeMesh.get();
+	instance->SetInstanceMatrices(mLevelMatrices);
+	if (!mLevelLayout.empty()) {
+		mRenderer->SetWallFloorObject(mLevelLayout[0]);
+	}
+}
+
+void LevelManager::InitialisePools(size_t pickupCount) {
+	mPickupPool.Initialise(*mWorld, *mPhysics, pickupCount + PICKUP_POOL_SPARE, [this]() {
+		return CreatePickup(mInventoryBuffSystemClassPtr);
+	});
+	mSoundEmitterPool.Initialise(*mWorld, *mPhysics, SOUND_EMITTER_POOL_SIZE, [this]() {
+		return CreateSoundEmitter(mSuspicionSystemClassPtr->GetLocationBasedSuspicion());
+	});
+}
+
+//Most that were ever out at once, for sizing the pools
+void LevelManager::ReportPoolUsage() const {
+	if (mPickupPool.GetCapacity() == 0 && mSoundEmitterPool.GetCapacity() == 0) {
+		return;
+	}
+	std::cout << "Pickup pool high water mark: " << mPickupPool.GetHighWaterMark() << "/" << mPickupPool.GetCapacity()
+		<< ", sound emitter pool high water mark: " << mSoundEmitterPool.GetHighWaterMark() << "/" << mSoundEmitterPool.GetCapacity() << std::endl;
+}
+
+void LevelManager::ReportGuardPathing() const {
+	int guardNo = 0;
+	for (GuardObject* guard : mWorld->Query<GuardObject>()) {
+		const PathCorridor::Stats& stats = guard->GetPathStats();
+		std::cout << "Guard " << guardNo++ << " pathing: " << stats.plans << " plans (" << stats.failedPlans << " failed), "
+			<< (stats.plans > 0 ? stats.planTime / stats.plans : 0.0) << "ms average, " << stats.maxPlanTime << "ms max; following "
+			<< (stats.updates > 0 ? stats.followTime * 1000.0 / stats.updates : 0.0) << "us a frame over " << stats.updates << " frames" << std::endl;
+	}
+}
+
+void LevelManager::RunPathfindingBenchmark(int agentCount, int frames) {
+	if (!mBuilder->GetNavMesh()) {
+		std::cout << __FUNCTION__ << " needs a level loaded first" << std::endl;
+		return;
+	}
+	PathfindingService::RunBenchmark(mBuilder->GetNavMesh(), agentCount, frames, std::cout);
+}
+
+void LevelManager::RunNavMeshBenchmark() const {
+	mBuilder->BenchmarkBuild(std::cout);
+}
+
+void LevelManager::InitialiseStreamedRooms(int levelID, std::vector<Vector3>& itemPositions) {
 	for (auto const& [key, val] : (*mLevelList[levelID]).GetRooms()) {
 		switch ((*val).GetType()) {
 		case Medium:
 			for (Room* room : mRoomList) {
 				if (room->GetType() == Medium) {
-					LoadMap(room->GetTileMap(), key);
-					LoadLights(room->GetLights(), key);
-					LoadDoors(room->GetDoors(), key);
+					StreamedRoom* streamedRoom = new StreamedRoom();
+					streamedRoom->room = room;
+					streamedRoom->offset = key;
+					streamedRoom->boundsMin = key;
+					streamedRoom->boundsMax = key;
+					for (auto const& [tilePos, tile] : room->GetTileMap()) {
+						Vector3 position = tilePos + key;
+						streamedRoom->boundsMin.x = std::min(streamedRoom->boundsMin.x, position.x - TILE_HALF_SIZE);
+						streamedRoom->boundsMin.z = std::min(streamedRoom->boundsMin.z, position.z - TILE_HALF_SIZE);
+						streamedRoom->boundsMax.x = std::max(streamedRoom->boundsMax.x, position.x + TILE_HALF_SIZE);
+						streamedRoom->boundsMax.z = std::max(streamedRoom->boundsMax.z, position.z + TILE_HALF_SIZE);
+					}
+					mStreamedRooms.emplace_back(streamedRoom);
+
+					// items stay resident, as the flag is picked from the full list
 					for (int i = 0; i < room->GetItemPositions().size(); i++) {
 						itemPositions.push_back(room->GetItemPositions()[i] + key);
 					}
@@ -193,43 +458,232 @@ void LevelManager::LoadLevel(int levelID, int playerID, bool isMultiplayer) {
 			break;
 		}
 	}
-	float* levelSize = new float[3];
-	levelSize = mBuilder->BuildNavMesh(mLevelLayout);
-	if(levelSize) mPhysics->SetNewBroadphaseSize(Vector3(levelSize[x], levelSize[y], levelSize[z]));
+}
 
-	if (!isMultiplayer){
-		AddPlayerToWorld((*mLevelList[levelID]).GetPlayerStartTransform(playerID), "Player");
+/*
+Resident rooms are owned by the world and lights list, which ClearLevel
+empties anyway, so only rooms that were built but never added are deleted here.
+*/
+void LevelManager::ClearStreamedRooms() {
+	for (auto& room : mStreamedRooms) {
+		JobSystem::GetJobSystem()->Wait(room->prepareCounter);
+		if (room->state != StreamedRoom::Resident) {
+			ReleaseRoom(*room);
+		}
+	}
+	mStreamedRooms.clear();
+}
 
-		//TODO(erendgrmnc): after implementing ai to multiplayer move out from this if block
-		LoadGuards((*mLevelList[levelID]).GetGuardCount());
+/*
+Rooms stream in around the players, and around any guard within
+GUARD_ANCHOR_DISTANCE of one. Guards further out don't hold rooms in memory,
+they are parked by ParkGuards when their room goes.
+*/
+std::vector<Vector3> LevelManager::GetStreamingAnchors() {
+	std::vector<Vector3> anchors;
+	for (PlayerObject* player : mWorld->Query<PlayerObject>()) {
+		anchors.push_back(player->GetTransform().GetPosition());
 	}
-	SendWallFloorInstancesToGPU();
-	LoadItems(itemPositions);	
+	size_t playerCount = anchors.size();
+	for (GuardObject* guard : mWorld->Query<GuardObject>()) {
+		Vector3 position = guard->GetTransform().GetPosition();
+		for (size_t i = 0; i < playerCount; ++i) {
+			if ((position - anchors[i]).LengthSquared() <= GUARD_ANCHOR_DISTANCE * GUARD_ANCHOR_DISTANCE) {
+				anchors.push_back(position);
+				break;
+			}
+		}
+	}
+	return anchors;
+}
 
-	mAnimation->PreloadMatTextures(*mRenderer);
+//A guard standing in a room that isn't in the world has no floor under it, so it
+//waits where it is until the room streams back in
+void LevelManager::ParkGuards() {
+	for (GuardObject* guard : mWorld->Query<GuardObject>()) {
+		Vector3 position = guard->GetTransform().GetPosition();
+		bool parked = false;
+		for (auto& room : mStreamedRooms) {
+			if (room->state != StreamedRoom::Resident && room->DistanceTo(position) <= 0.0f) {
+				parked = true;
+				break;
+			}
+		}
+		if (parked != guard->IsParked()) {
+			guard->SetParked(parked);
+		}
+	}
+}
 
-	mAnimation->SetGameObjectLists(mUpdatableObjects);
+void LevelManager::UpdateRoomStreaming() {
+	if (mStreamedRooms.empty()) {
+		return;
+	}
+	std::vector<Vector3> anchors = GetStreamingAnchors();
+	if (anchors.empty()) {
+		return;
+	}
+	bool changed = StreamRooms(anchors);
+	ParkGuards();
+	if (changed) {
+		SendWallFloorInstancesToGPU();
+	}
+}
 
-	delete[] levelSize;
+/*
+Rooms within ROOM_PREPARE_DISTANCE of an anchor are built in the background,
+and added to the world once inside ROOM_STREAM_IN_DISTANCE. If a room is
+needed before its job has finished, this waits for it rather than let anyone
+fall through a missing floor. Rooms are only dropped past
+ROOM_STREAM_OUT_DISTANCE, so walking along a boundary doesn't thrash.
+Returns true if the set of resident rooms changed.
+*/
+bool LevelManager::StreamRooms(const std::vector<Vector3>& anchors) {
+	bool changed = false;
+	for (auto& room : mStreamedRooms) {
+		float distance = FLT_MAX;
+		for (const Vector3& anchor : anchors) {
+			distance = std::min(distance, room->DistanceTo(anchor));
+		}
+		if (room->state == StreamedRoom::Preparing && room->prepareCounter.IsDone()) {
+			room->state = StreamedRoom::Prepared;
+		}
 
-	mTimer = 20.f;
+		if (distance <= ROOM_STREAM_IN_DISTANCE) {
+			if (room->state == StreamedRoom::Unloaded) {
+				PrepareRoom(*room);
+			}
+			if (room->state == StreamedRoom::Preparing) {
+				JobSystem::GetJobSystem()->Wait(room->prepareCounter);
+				room->state = StreamedRoom::Prepared;
+			}
+			if (room->state == StreamedRoom::Prepared) {
+				AddRoomToWorld(*room);
+				changed = true;
+			}
+		}
+		else if (distance <= ROOM_PREPARE_DISTANCE) {
+			if (room->state == StreamedRoom::Unloaded) {
+				PrepareRoom(*room);
+			}
+		}
+		else if (distance > ROOM_STREAM_OUT_DISTANCE) {
+			if (room->state == StreamedRoom::Resident) {
+				RemoveRoomFromWorld(*room);
+				changed = true;
+			}
+			if (room->state == StreamedRoom::Prepared) {
+				ReleaseRoom(*room);
+			}
+		}
+	}
+	if (changed) {
+		mPhysics->ClearStaticGeometry();
+	}
+	return changed;
 }
 
-void LevelManager::SendWallFloorInstancesToGPU() {
-	OGLMesh* instance = (OGLMesh*)mWallFloorCubeMesh;
-	instance->SetInstanceMatrices(mLevelMatrices);
-	if (!mLevelLayout.empty()) {
-		mRenderer->SetWallFloorObject(mLevelLayout[0]);
+/*
+Builds every object, collider, light and instance matrix the room needs on a
+job thread. None of it touches the world until AddRoomToWorld.
+*/
+void LevelManager::PrepareRoom(StreamedRoom& room) {
+	room.state = StreamedRoom::Preparing;
+	JobSystem::GetJobSystem()->Submit([this, &room]() {
+		for (auto const& [key, val] : room.room->GetTileMap()) {
+			GameObject* tile = (val == Wall) ? CreateWall(key + room.offset) : CreateFloor(key + room.offset);
+			room.tiles.push_back(tile);
+			room.tileMatrices.push_back(tile->GetTransform().GetMatrix());
+		}
+		for (Door* door : room.room->GetDoors()) {
+			room.doors.push_back(CreateDoor(door, room.offset));
+		}
+		for (Light* light : room.room->GetLights()) {
+			room.lights.push_back(CopyLight(light, room.offset));
+		}
+	}, &room.prepareCounter);
+}
+
+void LevelManager::AddRoomToWorld(StreamedRoom& room) {
+	for (GameObject* tile : room.tiles) {
+		mWorld->AddGameObject(tile);
+	}
+	for (Door* door : room.doors) {
+		mWorld->AddGameObject(door);
+	}
+	for (Light* light : room.lights) {
+		mRenderer->AddLight(light);
+	}
+	room.state = StreamedRoom::Resident;
+}
+
+void LevelManager::RemoveRoomFromWorld(StreamedRoom& room) {
+	for (GameObject* tile : room.tiles) {
+		mPhysics->RemoveCollisionsWith(tile);
+		mWorld->RemoveGameObject(tile, false);
+	}
+	for (Door* door : room.doors) {
+		mPhysics->RemoveCollisionsWith(door);
+		mWorld->RemoveGameObject(door, false);
 	}
+	for (Light* light : room.lights) {
+		mRenderer->RemoveLight(light);
+	}
+	room.state = StreamedRoom::Prepared;
+}
+
+void LevelManager::ReleaseRoom(StreamedRoom& room) {
+	for (GameObject* tile : room.tiles) {
+		delete tile;
+	}
+	for (Door* door : room.doors) {
+		delete door;
+	}
+	for (Light* light : room.lights) {
+		delete light;
+	}
+	room.tiles.clear();
+	room.doors.clear();
+	room.lights.clear();
+	room.tileMatrices.clear();
+	room.state = StreamedRoom::Unloaded;
 }
 
 void LevelManager::Update(float dt, bool isPlayingLevel, bool isPaused) {
+	auto frameStart = std::chrono::high_resolution_clock::now();
+	if (isPlayingLevel && !isPaused) {
+		UpdateRoomStreaming();
+	}
 	if (isPlayingLevel) {
+		// paths searched for since last frame reach the guards before they move
+		if (mPathfinding) {
+			mPathfinding->Update();
+		}
+		// with no search running, tiles under doors that moved can be rebuilt
+		if (mBuilder->UpdateObstacles(NAVMESH_REBUILD_BUDGET) && mPathfinding) {
+			mPathfinding->RestartSearches();
+		}
 		if ((mUpdatableObjects.size() > 0)) {
 			for (GameObject* obj : mUpdatableObjects) {
 				obj->UpdateObject(dt);
 			}
 		}
+		if (mPathfinding) {
+			mPathfinding->Dispatch();
+		}
+		// works out how each guard should steer next frame, from where they all are now
+		if (mCrowd) {
+			mCrowd->Update(dt);
+		}
+		mPickupPool.ForEachActive([dt](PickupGameObject* pickup) {
+			pickup->UpdateObject(dt);
+		});
+		mSoundEmitterPool.ForEachActive([this, dt](SoundEmitter* emitter) {
+			emitter->UpdateObject(dt);
+			if (!emitter->IsEmitting()) {
+				mSoundEmitterPool.Release(emitter);
+			}
+		});
 		Debug::Print("TIME LEFT: " + to_string(int(mTimer)), Vector2(0, 3));
 		if (mTempPlayer)
 			Debug::Print("POINTS: " + to_string(int(mTempPlayer->GetPoints())), Vector2(0, 6));
@@ -239,86 +693,152 @@ void LevelManager::Update(float dt, bool isPlayingLevel, bool isPaused) {
 	if (isPaused)
 		mRenderer->Render();
 	else {
-		mWorld->UpdateWorld(dt);
+		mFrameDt = dt;
+		mFrameTasks.Run(*JobSystem::GetJobSystem());
+		mPhysics->DeliverCollisionEvents();
+		//No jobs are running between frames, so the frame's scratch memory can go
+		JobSystem::GetJobSystem()->ResetAllocators();
 		mRenderer->Update(dt);
-		mPhysics->Update(dt);
-		mAnimation->Update(dt, mUpdatableObjects, mPreAnimationList);
-		mRenderer->Render();
+		if (mPipelinedFrames) {
+			//Draws the previous step, whose culling and sorting overlapped with this one
+			mRenderer->Render();
+			mFrameLatency += std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - mQueuedFrameStart).count();
+			mRenderer->SubmitSnapshot(true);
+			mQueuedFrameStart = frameStart;
+		}
+		else {
+			mRenderer->Render();
+			mFrameLatency += std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - frameStart).count();
+		}
 		Debug::UpdateRenderables(dt);
 	}
 }
 
-void LevelManager::InitialiseAssets() {
-	mCubeMesh = mRenderer->LoadMesh("cube.msh");
-	mWallFloorCubeMesh = mRenderer->LoadMesh("cube.msh");
-	mSphereMesh = mRenderer->LoadMesh("sphere.msh");
-	mCapsuleMesh = mRenderer->LoadMesh("Capsule.msh");
-	mCharMesh = mRenderer->LoadMesh("goat.msh");
-	mEnemyMesh = mRenderer->LoadMesh("Keeper.msh");
-	mBonusMesh = mRenderer->LoadMesh("apple.msh");
-	mCapsuleMesh = mRenderer->LoadMesh("capsule.msh");
-
-	mBasicTex = mRenderer->LoadTexture("checkerboard.png");
-	mKeeperAlbedo = mRenderer->LoadTexture("fleshy_albedo.png");
-	mKeeperNormal = mRenderer->LoadTexture("fleshy_normal.png");
-	mFloorAlbedo = mRenderer->LoadTexture("panel_albedo.png");
-	mFloorNormal = mRenderer->LoadTexture("panel_normal.png");
-
-	mBasicShader = mRenderer->LoadShader("scene.vert", "scene.frag");
-	mAnimationShader = mRenderer->LoadShader("animationScene.vert", "scene.frag");
+void LevelManager::SetPipelinedFrames(bool pipelined) {
+	mPipelinedFrames = pipelined;
+	mRenderer->DiscardSnapshot();
+	mQueuedFrameStart = std::chrono::high_resolution_clock::now();
+}
 
+/*
+Physics and animation don't touch each other's data, so they run side by side
+once the world has been updated. Object updates stay on the calling thread as
+gameplay code reaches into audio, UI and input, none of which is thread safe;
+that includes collision callbacks, which physics queues for the caller to
+deliver once the tasks have finished.
+*/
+void LevelManager::InitialiseFrameTasks() {
+	mFrameDt = 0.0f;
+	mFrameLatency = 0.0;
+	mPipelinedFrames = PIPELINED_FRAMES_DEFAULT;
+	mQueuedFrameStart = std::chrono::high_resolution_clock::now();
+
+	TaskGraph::TaskID world = mFrameTasks.AddTask("UpdateWorld", [this]() {
+		mWorld->UpdateWorld(mFrameDt);
+	});
+	TaskGraph::TaskID physics = mFrameTasks.AddTask("Physics", [this]() {
+		mPhysics->Update(mFrameDt);
+	});
+	mFrameTasks.AddTask("Animation", [this]() {
+		mAnimation->Update(mFrameDt, mPreAnimationList);
+	});
+	mFrameTasks.AddDependency(world, physics);
+}
 
+namespace {
+	template<class T>
+	void ReleaseHandles(AssetCache<T>& cache, std::initializer_list<std::shared_ptr<T>*> handles) {
+		for (std::shared_ptr<T>* handle : handles) {
+			if (*handle) {
+				cache.Release(*handle);
+				handle->reset();
+			}
+		}
+	}
+}
 
-	mGuardMesh = mRenderer->LoadMesh("MaleGuard/Male_Guard.msh");	
-	mGuardMaterial = mRenderer->LoadMaterial("MaleGuard/Male_Guard.mat");
+void LevelManager::ReleaseAssets() {
+	mPreAnimationList.clear();
+	ReleaseHandles(mRenderer->GetMeshCache(), { &mCubeMesh, &mWallFloorCubeMesh, &mSphereMesh, &mCapsuleMesh, &mCharMesh,
+		&mEnemyMesh, &mBonusMesh, &mGuardMesh, &mPlayerMesh, &mRigMesh });
+	ReleaseHandles(mRenderer->GetTextureCache(), { &mBasicTex, &mKeeperAlbedo, &mKeeperNormal, &mFloorAlbedo, &mFloorNormal,
+		&mInventorySlotTex, &mHighlightAwardTex, &mLightOffTex, &mMakingNoiseTex, &mSilentRunTex, &mSlowDownTex,
+		&mStunTex, &mSwapPositionTex, &mSuspensionBarTex, &mSuspensionIndicatorTex });
+	ReleaseHandles(mRenderer->GetShaderCache(), { &mBasicShader, &mSoldierShader, &mAnimationShader, &mAnimationShader2 });
+	ReleaseHandles(mRenderer->GetMaterialCache(), { &mRigMaterial, &mGuardMaterial, &mPlayerMaterial });
+	ReleaseHandles(mRenderer->GetAnimationCache(), { &mGuardAnimationStand, &mGuardAnimationSprint, &mGuardAnimationWalk,
+		&mGuardAnimationHappy, &mGuardAnimationAngry, &mPlayerAnimationStand, &mPlayerAnimationSprint, &mPlayerAnimationWalk,
+		&mRigAnimationStand, &mRigAnimationSprint, &mRigAnimationWalk });
+}
 
-	mPlayerMesh = mRenderer->LoadMesh("FemaleGuard/Female_Guard.msh");
-	mPlayerMaterial = mRenderer->LoadMaterial("FemaleGuard/Female_Guard.mat");
+void LevelManager::InitialiseAssets() {
+	LoadMarker assetMarker("InitialiseAssets");
+	mRenderer->LoadMeshAsync("cube.msh", mCubeMesh);
+	mRenderer->LoadMeshAsync("cube.msh", mWallFloorCubeMesh);
+	mRenderer->LoadMeshAsync("sphere.msh", mSphereMesh);
+	mRenderer->LoadMeshAsync("Capsule.msh", mCapsuleMesh);
+	mRenderer->LoadMeshAsync("goat.msh", mCharMesh);
+	mRenderer->LoadMeshAsync("Keeper.msh", mEnemyMesh);
+	mRenderer->LoadMeshAsync("apple.msh", mBonusMesh);
+
+	mRenderer->LoadTextureAsync("checkerboard.png", mBasicTex);
+	mRenderer->LoadTextureAsync("fleshy_albedo.png", mKeeperAlbedo);
+	mRenderer->LoadTextureAsync("fleshy_normal.png", mKeeperNormal);
+	mRenderer->LoadTextureAsync("panel_albedo.png", mFloorAlbedo);
+	mRenderer->LoadTextureAsync("panel_normal.png", mFloorNormal);
+
+	mRenderer->LoadMeshAsync("MaleGuard/Male_Guard.msh", mGuardMesh);
+	mRenderer->LoadMaterialAsync("MaleGuard/Male_Guard.mat", mGuardMaterial);
+
+	mRenderer->LoadMeshAsync("FemaleGuard/Female_Guard.msh", mPlayerMesh);
+	mRenderer->LoadMaterialAsync("FemaleGuard/Female_Guard.mat", mPlayerMaterial);
 	
-	mRigMesh = mRenderer->LoadMesh("Max/Rig_Maximilian.msh");
-	mRigMaterial = mRenderer->LoadMaterial("Max/Rig_Maximilian.mat");
+	mRenderer->LoadMeshAsync("Max/Rig_Maximilian.msh", mRigMesh);
+	mRenderer->LoadMaterialAsync("Max/Rig_Maximilian.mat", mRigMaterial);
 	//Animations
-	mGuardAnimationStand = mRenderer->LoadAnimation("MaleGuard/Idle1.anm");
-	mGuardAnimationWalk = mRenderer->LoadAnimation("MaleGuard/StepForwardOneHand.anm");
-	mGuardAnimationSprint = mRenderer->LoadAnimation("MaleGuard/StepForward.anm");
+	mRenderer->LoadAnimationAsync("MaleGuard/Idle1.anm", mGuardAnimationStand);
+	mRenderer->LoadAnimationAsync("MaleGuard/StepForwardOneHand.anm", mGuardAnimationWalk);
+	mRenderer->LoadAnimationAsync("MaleGuard/StepForward.anm", mGuardAnimationSprint);
 
-	mPlayerAnimationStand = mRenderer->LoadAnimation("FemaleGuard/Idle1.anm");
-	mPlayerAnimationWalk = mRenderer->LoadAnimation("FemaleGuard/StepForwardOneHand.anm");
-	mPlayerAnimationSprint = mRenderer->LoadAnimation("FemaleGuard/StepForward.anm");
+	mRenderer->LoadAnimationAsync("FemaleGuard/Idle1.anm", mPlayerAnimationStand);
+	mRenderer->LoadAnimationAsync("FemaleGuard/StepForwardOneHand.anm", mPlayerAnimationWalk);
+	mRenderer->LoadAnimationAsync("FemaleGuard/StepForward.anm", mPlayerAnimationSprint);
 
-	mRigAnimationStand = mRenderer->LoadAnimation("Max/Idle.anm");
-	mRigAnimationWalk = mRenderer->LoadAnimation("Max/Walk2.anm");
-	mRigAnimationSprint = mRenderer->LoadAnimation("Max/Incentivise.anm");
+	mRenderer->LoadAnimationAsync("Max/Idle.anm", mRigAnimationStand);
+	mRenderer->LoadAnimationAsync("Max/Walk2.anm", mRigAnimationWalk);
+	mRenderer->LoadAnimationAsync("Max/Incentivise.anm", mRigAnimationSprint);
 
+	//icons
+	mRenderer->LoadTextureAsync("InventorySlot.png", mInventorySlotTex);
+	mRenderer->LoadTextureAsync("HighlightAward.png", mHighlightAwardTex);
+	mRenderer->LoadTextureAsync("LightOff.png", mLightOffTex);
+	mRenderer->LoadTextureAsync("MakingNoise.png", mMakingNoiseTex);
+	mRenderer->LoadTextureAsync("SilentRun.png", mSilentRunTex);
+	mRenderer->LoadTextureAsync("SlowDown.png", mSlowDownTex);
+	mRenderer->LoadTextureAsync("Stun.png", mStunTex);
+	mRenderer->LoadTextureAsync("SwapPosition.png", mSwapPositionTex);
+
+	mRenderer->LoadTextureAsync("SuspensionBar.png", mSuspensionBarTex);
+	mRenderer->LoadTextureAsync("SuspensionPointer.png", mSuspensionIndicatorTex);
+
+	// shaders have to be compiled on this thread, which overlaps them with the file loading
+	{
+		LoadMarker marker("Compile shaders");
+		mBasicShader = mRenderer->LoadShader("scene.vert", "scene.frag");
+		mAnimationShader = mRenderer->LoadShader("animationScene.vert", "scene.frag");
+	}
 
-	//preLoadList
-	mPreAnimationList.insert(std::make_pair("GuardStand", mRigAnimationStand));
-	mPreAnimationList.insert(std::make_pair("GuardWalk", mRigAnimationWalk));
-	mPreAnimationList.insert(std::make_pair("GuardSprint", mRigAnimationSprint));
-	
-
-	mPreAnimationList.insert(std::make_pair("PlayerStand", mGuardAnimationStand));
-	mPreAnimationList.insert(std::make_pair("PlayerWalk", mGuardAnimationWalk));
-	mPreAnimationList.insert(std::make_pair("PlayerSprint", mGuardAnimationSprint));
-
-	
-
+	mRenderer->FinishAsyncLoads();
 
+	//preLoadList
+	mPreAnimationList.insert(std::make_pair("GuardStand", mRigAnimationStand.get()));
+	mPreAnimationList.insert(std::make_pair("GuardWalk", mRigAnimationWalk.get()));
+	mPreAnimationList.insert(std::make_pair("GuardSprint", mRigAnimationSprint.get()));
 	
-	
-
-	//icons
-	mInventorySlotTex = mRenderer->LoadTexture("InventorySlot.png");
-	mHighlightAwardTex = mRenderer->LoadTexture("HighlightAward.png");
-	mLightOffTex = mRenderer->LoadTexture("LightOff.png");
-	mMakingNoiseTex = mRenderer->LoadTexture("MakingNoise.png");
-	mSilentRunTex = mRenderer->LoadTexture("SilentRun.png");
-	mSlowDownTex = mRenderer->LoadTexture("SlowDown.png");
-	mStunTex = mRenderer->LoadTexture("Stun.png");
-	mSwapPositionTex = mRenderer->LoadTexture("SwapPosition.png");
 
-	mSuspensionBarTex = mRenderer->LoadTexture("SuspensionBar.png");
-	mSuspensionIndicatorTex = mRenderer->LoadTexture("SuspensionPointer.png");
+	mPreAnimationList.insert(std::make_pair("PlayerStand", mGuardAnimationStand.get()));
+	mPreAnimationList.insert(std::make_pair("PlayerWalk", mGuardAnimationWalk.get()));
+	mPreAnimationList.insert(std::make_pair("PlayerSprint", mGuardAnimationSprint.get()));
 }
 
 void LevelManager::LoadMap(const std::map<Vector3, TileType>& tileMap, const Vector3& startPosition) {
@@ -337,24 +857,23 @@ void LevelManager::LoadMap(const std::map<Vector3, TileType>& tileMap, const Vec
 
 void LevelManager::LoadLights(const std::vector<Light*>& lights, const Vector3& centre) {
 	for (int i = 0; i < lights.size(); i++) {
-		if (lights[i]->GetType() == Light::Point) {
-			auto* pl = dynamic_cast<PointLight*>(lights[i]);
-			PointLight* newPL = new PointLight(pl->GetPosition() + centre, pl->GetColour(), pl->GetRadius());
-			mRenderer->AddLight(newPL);
-		}
-		else if (lights[i]->GetType() == Light::Spot) {
-			auto* sl = dynamic_cast<SpotLight*>(lights[i]);
-			SpotLight* newSL = new SpotLight(sl->GetDirection(), sl->GetPosition() + centre, sl->GetColour(), sl->GetRadius(), sl->GetAngle(), 2);
-			mRenderer->AddLight(newSL);
-		}
-		else {
-			auto* dl = dynamic_cast<DirectionLight*>(lights[i]);
-			DirectionLight* newDL = new DirectionLight(dl->GetDirection(), dl->GetColour(), dl->GetRadius(), dl->GetCentre());
-			mRenderer->AddLight(newDL);
-		}
+		mRenderer->AddLight(CopyLight(lights[i], centre));
 	}
 }
 
+Light* LevelManager::CopyLight(Light* light, const Vector3& centre) const {
+	if (light->GetType() == Light::Point) {
+		auto* pl = dynamic_cast<PointLight*>(light);
+		return new PointLight(pl->GetPosition() + centre, pl->GetColour(), pl->GetRadius());
+	}
+	else if (light->GetType() == Light::Spot) {
+		auto* sl = dynamic_cast<SpotLight*>(light);
+		return new SpotLight(sl->GetDirection(), sl->GetPosition() + centre, sl->GetColour(), sl->GetRadius(), sl->GetAngle(), 2);
+	}
+	auto* dl = dynamic_cast<DirectionLight*>(light);
+	return new DirectionLight(dl->GetDirection(), dl->GetColour(), dl->GetRadius(), dl->GetCentre());
+}
+
 void LevelManager::LoadGuards(int guardCount) {
 	for (int i = 0; i < guardCount; i++) {
 		AddGuardToWorld((*mLevelList[mActiveLevel]).GetGuardPaths()[i], (*mLevelList[mActiveLevel]).GetPrisonPosition(), "Guard")->SetIsSensed(true);
@@ -391,37 +910,49 @@ void LevelManager::LoadDoors(const std::vector<Door*>& doors, const Vector3& cen
 }
 
 void LevelManager::InitialiseIcons() {
-	UI::Icon mInventoryIcon1 = mUi->AddIcon(Vector2(45, 90), 4.5, 8, mInventorySlotTex);
+	UI::Icon mInventoryIcon1 = mUi->AddIcon(Vector2(45, 90), 4.5, 8, mInventorySlotTex.get());
 
-	UI::Icon mInventoryIcon2 = mUi->AddIcon(Vector2(50, 90), 4.5, 8, mInventorySlotTex);
+	UI::Icon mInventoryIcon2 = mUi->AddIcon(Vector2(50, 90), 4.5, 8, mInventorySlotTex.get());
 
-	UI::Icon mHighlightAwardIcon = mUi->AddIcon(Vector2(3, 84), 4.5, 7, mHighlightAwardTex, false);
-	UI::Icon mLightOffIcon = mUi->AddIcon(Vector2(8, 84), 4.5, 7, mLightOffTex, false);
-	UI::Icon mMakingNoiseIcon = mUi->AddIcon(Vector2(13, 84), 4.5, 7, mMakingNoiseTex, false);
-	UI::Icon mSilentRunIcon = mUi->AddIcon(Vector2(18, 84), 4.5, 7, mSilentRunTex, false);
-	UI::Icon mSlowDownIcon = mUi->AddIcon(Vector2(3, 92), 4.5, 7, mSlowDownTex, false);
-	UI::Icon mStunIcon = mUi->AddIcon(Vector2(8, 92), 4.5, 7, mStunTex, false);
-	UI::Icon mSwapPositionIcon = mUi->AddIcon(Vector2(13, 92), 4.5, 7, mSwapPositionTex, false);
+	UI::Icon mHighlightAwardIcon = mUi->AddIcon(Vector2(3, 84), 4.5, 7, mHighlightAwardTex.get(), false);
+	UI::Icon mLightOffIcon = mUi->AddIcon(Vector2(8, 84), 4.5, 7, mLightOffTex.get(), false);
+	UI::Icon mMakingNoiseIcon = mUi->AddIcon(Vector2(13, 84), 4.5, 7, mMakingNoiseTex.get(), false);
+	UI::Icon mSilentRunIcon = mUi->AddIcon(Vector2(18, 84), 4.5, 7, mSilentRunTex.get(), false);
+	UI::Icon mSlowDownIcon = mUi->AddIcon(Vector2(3, 92), 4.5, 7, mSlowDownTex.get(), false);
+	UI::Icon mStunIcon = mUi->AddIcon(Vector2(8, 92), 4.5, 7, mStunTex.get(), false);
+	UI::Icon mSwapPositionIcon = mUi->AddIcon(Vector2(13, 92), 4.5, 7, mSwapPositionTex.get(), false);
 
-	UI::Icon mSuspensionBarIcon = mUi->AddIcon(Vector2(90, 16), 12, 75, mSuspensionBarTex);
-	UI::Icon mSuspensionIndicatorIcon = mUi->AddIcon(Vector2(93, 86), 5, 5, mSuspensionIndicatorTex);
+	UI::Icon mSuspensionBarIcon = mUi->AddIcon(Vector2(90, 16), 12, 75, mSuspensionBarTex.get());
+	UI::Icon mSuspensionIndicatorIcon = mUi->AddIcon(Vector2(93, 86), 5, 5, mSuspensionIndicatorTex.get());
 
 	mRenderer->SetUIObject(mUi);
 }
 
 GameObject* LevelManager::AddWallToWorld(const Vector3& position) {
+	GameObject* wall = CreateWall(position);
+
+	mWorld->AddGameObject(wall);
+
+	mLevelLayout.push_back(wall);
+
+	mLevelMatrices.push_back(wall->GetTransform().GetMatrix());
+
+	return wall;
+}
+
+GameObject* LevelManager::CreateWall(const Vector3& position) const {
 	GameObject* wall = new GameObject(StaticObj, "Wall");
 
-	Vector3 wallSize = Vector3(5, 5, 5);
+	Vector3 wallSize = NavigationGeometry::WALL_HALF_SIZE;
 	AABBVolume* volume = new AABBVolume(wallSize);
 	wall->SetBoundingVolume((CollisionVolume*)volume);
 	wall->GetTransform()
 		.SetScale(wallSize * 2)
 		.SetPosition(position);
 
-	wall->SetRenderObject(new RenderObject(&wall->GetTransform(), mWallFloorCubeMesh, mFloorAlbedo, mFloorNormal, mBasicShader, 
+	wall->SetRenderObject(new RenderObject(wall, mWallFloorCubeMesh, mFloorAlbedo, mFloorNormal, mBasicShader, 
 		std::sqrt(std::pow(wallSize.x, 2) + std::powf(wallSize.z, 2))));
-	wall->SetPhysicsObject(new PhysicsObject(&wall->GetTransform(), wall->GetBoundingVolume()));
+	wall->SetPhysicsObject(new PhysicsObject(wall, wall->GetBoundingVolume()));
 
 	wall->GetPhysicsObject()->SetInverseMass(0);
 	wall->GetPhysicsObject()->InitCubeInertia();
@@ -430,28 +961,34 @@ GameObject* LevelManager::AddWallToWorld(const Vector3& position) {
 
 	wall->GetRenderObject()->SetIsInstanced(true);
 
-	mWorld->AddGameObject(wall);
+	return wall;
+}
 
-	mLevelLayout.push_back(wall);
+GameObject* LevelManager::AddFloorToWorld(const Vector3& position) {
+	GameObject* floor = CreateFloor(position);
 
-	mLevelMatrices.push_back(wall->GetTransform().GetMatrix());
+	mWorld->AddGameObject(floor);
 
-	return wall;
+	if(position.y < 0) mLevelLayout.push_back(floor);
+
+	mLevelMatrices.push_back(floor->GetTransform().GetMatrix());
+
+	return floor;
 }
 
-GameObject* LevelManager::AddFloorToWorld(const Vector3& position) {
+GameObject* LevelManager::CreateFloor(const Vector3& position) const {
 	GameObject* floor = new GameObject(StaticObj, "Floor");
 
-	Vector3 wallSize = Vector3(5, 0.5f, 5);
+	Vector3 wallSize = NavigationGeometry::FLOOR_HALF_SIZE;
 	AABBVolume* volume = new AABBVolume(wallSize);
 	floor->SetBoundingVolume((CollisionVolume*)volume);
 	floor->GetTransform()
 		.SetScale(wallSize * 2)
 		.SetPosition(position);
 
-	floor->SetRenderObject(new RenderObject(&floor->GetTransform(), mWallFloorCubeMesh, mFloorAlbedo, mFloorNormal, mBasicShader, 
+	floor->SetRenderObject(new RenderObject(floor, mWallFloorCubeMesh, mFloorAlbedo, mFloorNormal, mBasicShader, 
 		std::sqrt(std::pow(wallSize.x, 2) + std::powf(wallSize.z, 2))));
-	floor->SetPhysicsObject(new PhysicsObject(&floor->GetTransform(), floor->GetBoundingVolume(), 0, 2, 2));
+	floor->SetPhysicsObject(new PhysicsObject(floor, floor->GetBoundingVolume(), 0, 2, 2));
 
 	floor->GetPhysicsObject()->SetInverseMass(0);
 	floor->GetPhysicsObject()->InitCubeInertia();
@@ -460,28 +997,22 @@ GameObject* LevelManager::AddFloorToWorld(const Vector3& position) {
 
 	floor->GetRenderObject()->SetIsInstanced(true);
 
-	mWorld->AddGameObject(floor);
-
-	if(position.y < 0) mLevelLayout.push_back(floor);
-
-	mLevelMatrices.push_back(floor->GetTransform().GetMatrix());
-
 	return floor;
 }
 
 Helipad* LevelManager::AddHelipadToWorld(const Vector3& position) {
 	Helipad* helipad = new Helipad();
 
-	Vector3 wallSize = Vector3(15, 0.5f, 15);
+	Vector3 wallSize = NavigationGeometry::HELIPAD_HALF_SIZE;
 	AABBVolume* volume = new AABBVolume(wallSize);
 	helipad->SetBoundingVolume((CollisionVolume*)volume);
 	helipad->GetTransform()
 		.SetScale(wallSize * 2)
 		.SetPosition(position);
 
-	helipad->SetRenderObject(new RenderObject(&helipad->GetTransform(), mCubeMesh, mBasicTex, mFloorNormal, mBasicShader, 
+	helipad->SetRenderObject(new RenderObject(helipad, mCubeMesh, mBasicTex, mFloorNormal, mBasicShader, 
 		std::sqrt(std::pow(wallSize.x, 2) + std::powf(wallSize.z, 2))));
-	helipad->SetPhysicsObject(new PhysicsObject(&helipad->GetTransform(), helipad->GetBoundingVolume()));
+	helipad->SetPhysicsObject(new PhysicsObject(helipad, helipad->GetBoundingVolume()));
 
 	helipad->GetPhysicsObject()->SetInverseMass(0);
 	helipad->GetPhysicsObject()->InitCubeInertia();
@@ -508,9 +1039,9 @@ Vent* LevelManager::AddVentToWorld(Vent* vent) {
 		.SetOrientation(vent->GetTransform().GetOrientation())
 		.SetScale(size*2);
 
-	newVent->SetRenderObject(new RenderObject(&newVent->GetTransform(), mCubeMesh, mBasicTex, mFloorNormal, mBasicShader,
+	newVent->SetRenderObject(new RenderObject(newVent, mCubeMesh, mBasicTex, mFloorNormal, mBasicShader,
 		std::sqrt(std::pow(size.x, 2) + std::powf(size.y, 2))));
-	newVent->SetPhysicsObject(new PhysicsObject(&newVent->GetTransform(), newVent->GetBoundingVolume(), 1, 1, 5));
+	newVent->SetPhysicsObject(new PhysicsObject(newVent, newVent->GetBoundingVolume(), 1, 1, 5));
 
 
 	newVent->GetPhysicsObject()->SetInverseMass(0);
@@ -524,6 +1055,14 @@ Vent* LevelManager::AddVentToWorld(Vent* vent) {
 }
 
 Door* LevelManager::AddDoorToWorld(Door* door, const Vector3& offset) {
+	Door* newDoor = CreateDoor(door, offset);
+
+	mWorld->AddGameObject(newDoor);
+
+	return newDoor;
+}
+
+Door* LevelManager::CreateDoor(Door* door, const Vector3& offset) const {
 	Door* newDoor = new Door();
 	Vector3 size = Vector3(0.5f, 4.5f, 5);
 	OBBVolume* volume = new OBBVolume(size);
@@ -535,17 +1074,16 @@ Door* LevelManager::AddDoorToWorld(Door* door, const Vector3& offset) {
 		.SetOrientation(door->GetTransform().GetOrientation())
 		.SetScale(size * 2);
 
-	newDoor->SetRenderObject(new RenderObject(&newDoor->GetTransform(), mCubeMesh, mBasicTex, mFloorNormal, mBasicShader,
+	newDoor->SetRenderObject(new RenderObject(newDoor, mCubeMesh, mBasicTex, mFloorNormal, mBasicShader,
 		std::sqrt(std::pow(size.y, 2) + std::powf(size.z, 2))));
-	newDoor->SetPhysicsObject(new PhysicsObject(&newDoor->GetTransform(), newDoor->GetBoundingVolume(), 1, 1, 5));
+	newDoor->SetPhysicsObject(new PhysicsObject(newDoor, newDoor->GetBoundingVolume(), 1, 1, 5));
 
 
 	newDoor->GetPhysicsObject()->SetInverseMass(0);
 	newDoor->GetPhysicsObject()->InitCubeInertia();
 
 	newDoor->SetCollisionLayer(NoCollide);
-
-	mWorld->AddGameObject(newDoor);
+	newDoor->SetNavMesh(mBuilder);
 
 	return newDoor;
 }
@@ -563,9 +1101,9 @@ PrisonDoor* LevelManager::AddPrisonDoorToWorld(PrisonDoor* door) {
 		.SetOrientation(door->GetTransform().GetOrientation())
 		.SetScale(size * 2);
 
-	newDoor->SetRenderObject(new RenderObject(&newDoor->GetTransform(), mCubeMesh, mBasicTex, mFloorNormal, mBasicShader,
+	newDoor->SetRenderObject(new RenderObject(newDoor, mCubeMesh, mBasicTex, mFloorNormal, mBasicShader,
 		std::sqrt(std::pow(size.y, 2) + std::powf(size.z, 2))));
-	newDoor->SetPhysicsObject(new PhysicsObject(&newDoor->GetTransform(), newDoor->GetBoundingVolume(), 1, 1, 5));
+	newDoor->SetPhysicsObject(new PhysicsObject(newDoor, newDoor->GetBoundingVolume(), 1, 1, 5));
 
 
 	newDoor->GetPhysicsObject()->SetInverseMass(0);
@@ -574,6 +1112,7 @@ PrisonDoor* LevelManager::AddPrisonDoorToWorld(PrisonDoor* door) {
 	newDoor->GetRenderObject()->SetColour(Vector4(1.0f, 0, 0, 1));
 
 	newDoor->SetCollisionLayer(NoCollide);
+	newDoor->SetNavMesh(mBuilder);
 
 	mWorld->AddGameObject(newDoor);
 
@@ -591,8 +1130,8 @@ FlagGameObject* LevelManager::AddFlagToWorld(const Vector3& position, InventoryB
 		.SetScale(size * 2)
 		.SetPosition(position);
 
-	flag->SetRenderObject(new RenderObject(&flag->GetTransform(), mSphereMesh, mBasicTex, mFloorNormal, mBasicShader, 0.75f));
-	flag->SetPhysicsObject(new PhysicsObject(&flag->GetTransform(), flag->GetBoundingVolume()));
+	flag->SetRenderObject(new RenderObject(flag, mSphereMesh, mBasicTex, mFloorNormal, mBasicShader, 0.75f));
+	flag->SetPhysicsObject(new PhysicsObject(flag, flag->GetBoundingVolume()));
 
 	flag->SetCollisionLayer(Collectable);
 
@@ -609,17 +1148,27 @@ FlagGameObject* LevelManager::AddFlagToWorld(const Vector3& position, InventoryB
 
 PickupGameObject* LevelManager::AddPickupToWorld(const Vector3& position, InventoryBuffSystemClass* inventoryBuffSystemClassPtr)
 {
+	PickupGameObject* pickup = mPickupPool.Acquire();
+	if (!pickup) {
+		std::cout << "Pickup pool is empty, raise PICKUP_POOL_SPARE" << std::endl;
+		return nullptr;
+	}
+	pickup->GetTransform().SetPosition(position);
+
+	return pickup;
+}
+
+PickupGameObject* LevelManager::CreatePickup(InventoryBuffSystemClass* inventoryBuffSystemClassPtr) const {
 	PickupGameObject* pickup = new PickupGameObject(inventoryBuffSystemClassPtr);
 
 	Vector3 size = Vector3(0.75f, 0.75f, 0.75f);
 	SphereVolume* volume = new SphereVolume(0.75f);
 	pickup->SetBoundingVolume((CollisionVolume*)volume);
 	pickup->GetTransform()
-		.SetScale(size * 2)
-		.SetPosition(position);
+		.SetScale(size * 2);
 
-	pickup->SetRenderObject(new RenderObject(&pickup->GetTransform(), mSphereMesh, mFloorAlbedo, mFloorNormal, mBasicShader, 0.75f));
-	pickup->SetPhysicsObject(new PhysicsObject(&pickup->GetTransform(), pickup->GetBoundingVolume()));
+	pickup->SetRenderObject(new RenderObject(pickup, mSphereMesh, mFloorAlbedo, mFloorNormal, mBasicShader, 0.75f));
+	pickup->SetPhysicsObject(new PhysicsObject(pickup, pickup->GetBoundingVolume()));
 
 	pickup->SetCollisionLayer(Collectable);
 
@@ -628,10 +1177,6 @@ PickupGameObject* LevelManager::AddPickupToWorld(const Vector3& position, Invent
 
 	pickup->GetRenderObject()->SetColour(Vector4(0.0f, 0.4f, 0.2f, 1));
 
-	mWorld->AddGameObject(pickup);
-
-	mUpdatableObjects.push_back(pickup);
-
 	return pickup;
 }
 
@@ -655,8 +1200,8 @@ void LevelManager::CreatePlayerObjectComponents(PlayerObject& playerObject, cons
 		.SetScale(Vector3(PLAYER_MESH_SIZE, PLAYER_MESH_SIZE, PLAYER_MESH_SIZE))
 		.SetPosition(position);
 
-	playerObject.SetRenderObject(new RenderObject(&playerObject.GetTransform(), mEnemyMesh, mKeeperAlbedo, mKeeperNormal, mBasicShader, PLAYER_MESH_SIZE));
-	playerObject.SetPhysicsObject(new PhysicsObject(&playerObject.GetTransform(), playerObject.GetBoundingVolume(), 1, 1, 5));
+	playerObject.SetRenderObject(new RenderObject(&playerObject, mEnemyMesh, mKeeperAlbedo, mKeeperNormal, mBasicShader, PLAYER_MESH_SIZE));
+	playerObject.SetPhysicsObject(new PhysicsObject(&playerObject, playerObject.GetBoundingVolume(), 1, 1, 5));
 
 
 	playerObject.GetPhysicsObject()->SetInverseMass(PLAYER_INVERSE_MASS);
@@ -675,9 +1220,9 @@ void LevelManager::CreatePlayerObjectComponents(PlayerObject& playerObject, cons
 		.SetPosition(playerTransform.GetPosition())
 		.SetOrientation(playerTransform.GetOrientation());
 
-	playerObject.SetRenderObject(new RenderObject(&playerObject.GetTransform(), mGuardMesh, mKeeperAlbedo, mKeeperNormal, mAnimationShader, PLAYER_MESH_SIZE));
-	playerObject.SetPhysicsObject(new PhysicsObject(&playerObject.GetTransform(), playerObject.GetBoundingVolume(), 1, 1, 5));
-	playerObject.SetAnimationObject(new AnimationObject(mGuardAnimationStand, mGuardMaterial));
+	playerObject.SetRenderObject(new RenderObject(&playerObject, mGuardMesh, mKeeperAlbedo, mKeeperNormal, mAnimationShader, PLAYER_MESH_SIZE));
+	playerObject.SetPhysicsObject(new PhysicsObject(&playerObject, playerObject.GetBoundingVolume(), 1, 1, 5));
+	playerObject.SetAnimationObject(new AnimationObject(mGuardAnimationStand.get(), mGuardMaterial.get()));
 
 	playerObject.GetPhysicsObject()->SetInverseMass(PLAYER_INVERSE_MASS);
 	playerObject.GetPhysicsObject()->InitSphereInertia(false);
@@ -721,9 +1266,9 @@ GuardObject* LevelManager::AddGuardToWorld(const vector<Vector3> nodes, const Ve
 		.SetScale(Vector3(meshSize, meshSize, meshSize))
 		.SetPosition(nodes[currentNode]);
 
-	guard->SetRenderObject(new RenderObject(&guard->GetTransform(), mRigMesh, mKeeperAlbedo, mKeeperNormal, mAnimationShader, meshSize));
-	guard->SetPhysicsObject(new PhysicsObject(&guard->GetTransform(), guard->GetBoundingVolume(), 1, 0, 5));
-	guard->SetAnimationObject(new AnimationObject(mRigAnimationStand, mRigMaterial));
+	guard->SetRenderObject(new RenderObject(guard, mRigMesh, mKeeperAlbedo, mKeeperNormal, mAnimationShader, meshSize));
+	guard->SetPhysicsObject(new PhysicsObject(guard, guard->GetBoundingVolume(), 1, 0, 5));
+	guard->SetAnimationObject(new AnimationObject(mRigAnimationStand.get(), mRigMaterial.get()));
 
 	guard->GetPhysicsObject()->SetInverseMass(PLAYER_INVERSE_MASS);
 	guard->GetPhysicsObject()->InitSphereInertia(false);
@@ -737,6 +1282,9 @@ GuardObject* LevelManager::AddGuardToWorld(const vector<Vector3> nodes, const Ve
 	guard->SetPrisonPosition(prisonPosition);
 	guard->SetPatrolNodes(nodes);
 	guard->SetCurrentNode(currentNode);
+	guard->SetNavMeshQuery(mBuilder->GetNavMeshQuery());
+	guard->SetPathfinding(mPathfinding);
+	guard->SetCrowd(mCrowd);
 
 	mWorld->AddGameObject(guard);
 	mUpdatableObjects.push_back(guard);
@@ -758,17 +1306,27 @@ void LevelManager::UpdateInventoryObserver(InventoryEvent invEvent, int playerNo
 
 SoundEmitter* LevelManager::AddSoundEmitterToWorld(const Vector3& position, LocationBasedSuspicion* locationBasedSuspicionPTR)
 {
-	SoundEmitter* soundEmitterObjectPtr = new SoundEmitter(5, locationBasedSuspicionPTR);
+	SoundEmitter* soundEmitterObjectPtr = mSoundEmitterPool.Acquire();
+	if (!soundEmitterObjectPtr) {
+		std::cout << "Sound emitter pool is empty, raise SOUND_EMITTER_POOL_SIZE" << std::endl;
+		return nullptr;
+	}
+	soundEmitterObjectPtr->StartEmitting(position);
+
+	return soundEmitterObjectPtr;
+}
+
+SoundEmitter* LevelManager::CreateSoundEmitter(LocationBasedSuspicion* locationBasedSuspicionPTR) const {
+	SoundEmitter* soundEmitterObjectPtr = new SoundEmitter(SOUND_EMITTER_DURATION, locationBasedSuspicionPTR);
 
 	Vector3 size = Vector3(0.75f, 0.75f, 0.75f);
 	SphereVolume* volume = new SphereVolume(0.75f);
 	soundEmitterObjectPtr->SetBoundingVolume((CollisionVolume*)volume);
 	soundEmitterObjectPtr->GetTransform()
-		.SetScale(size * 2)
-		.SetPosition(position);
+		.SetScale(size * 2);
 
-	soundEmitterObjectPtr->SetRenderObject(new RenderObject(&soundEmitterObjectPtr->GetTransform(), mSphereMesh, mBasicTex, mFloorNormal, mBasicShader, 0.75f));
-	soundEmitterObjectPtr->SetPhysicsObject(new PhysicsObject(&soundEmitterObjectPtr->GetTransform(), soundEmitterObjectPtr->GetBoundingVolume()));
+	soundEmitterObjectPtr->SetRenderObject(new RenderObject(soundEmitterObjectPtr, mSphereMesh, mBasicTex, mFloorNormal, mBasicShader, 0.75f));
+	soundEmitterObjectPtr->SetPhysicsObject(new PhysicsObject(soundEmitterObjectPtr, soundEmitterObjectPtr->GetBoundingVolume()));
 
 	soundEmitterObjectPtr->SetCollisionLayer(Collectable);
 
@@ -777,7 +1335,5 @@ SoundEmitter* LevelManager::AddSoundEmitterToWorld(const Vector3& position, Loca
 
 	soundEmitterObjectPtr->GetRenderObject()->SetColour(Vector4(1.0f, 1.0f, 1.0f, 1));
 
-	mWorld->AddGameObject(soundEmitterObjectPtr);
-
 	return soundEmitterObjectPtr;
 }
@@ -3,6 +3,8 @@
 #include "GameTechRenderer.h"
 #include "PhysicsSystem.h"
 #include "AnimationSystem.h"
+#include "JobSystem.h"
+#include "GameObjectPool.h"
 #include "InventoryBuffSystem/InventoryBuffSystem.h"
 #include "InventoryBuffSystem/PlayerInventory.h"
 #include "SuspicionSystem/SuspicionSystem.h"
@@ -14,10 +16,33 @@ using namespace SuspicionSystem;
 namespace NCL {
 	constexpr float PLAYER_MESH_SIZE = 3.0f;
 	constexpr float PLAYER_INVERSE_MASS = 0.5f;
+	constexpr bool PIPELINED_FRAMES_DEFAULT = true;
+	// rooms are built in the background once a player is within the prepare
+	// distance, and added to the world within the stream in distance
+	constexpr float ROOM_STREAM_IN_DISTANCE = 40.0f;
+	constexpr float ROOM_PREPARE_DISTANCE = 80.0f;
+	constexpr float ROOM_STREAM_OUT_DISTANCE = 100.0f;
+	constexpr float TILE_HALF_SIZE = 5.0f;
+	// guards this close to a player keep the rooms around them loaded too, so
+	// a chase doesn't run off the edge of the streamed rooms
+	constexpr float GUARD_ANCHOR_DISTANCE = 40.0f;
+	// pooled objects are all built when a level loads, so these bound how many
+	// can be out at once
+	constexpr int SOUND_EMITTER_POOL_SIZE = 8;
+	constexpr int PICKUP_POOL_SPARE = 4;
+	constexpr float SOUND_EMITTER_DURATION = 5.0f;
+	// milliseconds a frame spent rebuilding navmesh tiles under doors that
+	// opened or closed; at least one tile is always rebuilt
+	constexpr double NAVMESH_REBUILD_BUDGET = 1.0;
+	// guards that steer around each other; any more walk as they did before
+	constexpr int MAX_CROWD_AGENTS = 64;
+	constexpr float MAX_CROWD_AGENT_RADIUS = 1.0f;
 	namespace CSC8503 {
 		class PlayerObject;
 		class GuardObject;
 		class RecastBuilder;
+		class PathfindingService;
+		class CrowdManager;
 		class Helipad;
 		class FlagGameObject;
 		class PickupGameObject;
@@ -33,6 +58,38 @@ namespace NCL {
 			}
 		};
 
+		/*
+		One room placed in the active level. Its objects are built on a job
+		thread as players approach, added to the world once someone is close
+		enough to need them, and deleted again when everyone has moved away.
+		*/
+		struct StreamedRoom {
+			enum State {
+				Unloaded,
+				Preparing,
+				Prepared,
+				Resident
+			};
+
+			Room* room;
+			Vector3 offset;
+			Vector3 boundsMin;
+			Vector3 boundsMax;
+			State state = Unloaded;
+			JobCounter prepareCounter;
+
+			std::vector<GameObject*> tiles;
+			std::vector<Door*> doors;
+			std::vector<Light*> lights;
+			std::vector<Matrix4> tileMatrices;
+
+			float DistanceTo(const Vector3& point) const {
+				float dx = std::max(std::max(boundsMin.x - point.x, point.x - boundsMax.x), 0.0f);
+				float dz = std::max(std::max(boundsMin.z - point.z, point.z - boundsMax.z), 0.0f);
+				return std::sqrt(dx * dx + dz * dz);
+			}
+		};
+
 		class LevelManager : PlayerInventoryObserver {
 		public:
 			static LevelManager* GetLevelManager();
@@ -54,6 +111,18 @@ namespace NCL {
 
 			GameTechRenderer* GetRenderer() { return mRenderer; }
 
+			void SetPipelinedFrames(bool pipelined);
+			bool GetPipelinedFrames() const { return mPipelinedFrames; }
+
+			//Prints the asset caches and navmesh after each load, and pool and guard
+			//pathing use when a level is cleared
+			void SetPrintStats(bool printStats) { mPrintStats = printStats; }
+
+			//Stress tests the active level's navmesh with agentCount agents, see PathfindingService::RunBenchmark
+			void RunPathfindingBenchmark(int agentCount, int frames);
+			//Times the active level's navmesh built as one tile against the tiled build
+			void RunNavMeshBenchmark() const;
+
 			virtual void UpdateInventoryObserver(InventoryEvent invEvent, int playerNo) override;
 
 			const std::vector<Matrix4>& GetLevelMatrices() { return mLevelMatrices; }
@@ -75,10 +144,13 @@ namespace NCL {
 
 			static LevelManager* instance;
 
+			void LoadLevelFiles(JobCounter& counter);
 			virtual void InitialiseAssets();
 
 			void InitialiseIcons();
 
+			void InitialiseFrameTasks();
+
 			void LoadMap(const std::map<Vector3, TileType>& tileMap, const Vector3& startPosition);
 
 			void LoadLights(const std::vector<Light*>& lights, const Vector3& centre);
@@ -92,6 +164,37 @@ namespace NCL {
 			void LoadDoors(const std::vector<Door*>& doors, const Vector3& centre);
 			void SendWallFloorInstancesToGPU();
 
+			void SaveLevelSnapshot(int playerID);
+			void RestoreLevelSnapshot();
+			size_t GetLayoutHash(int levelID) const;
+
+			//Gives back the assets loaded by InitialiseAssets, before the renderer holding their caches goes
+			void ReleaseAssets();
+
+			void InitialisePools(size_t pickupCount);
+			void ReportPoolUsage() const;
+			//Planning and following costs for every guard, as they stand before the level is cleared
+			void ReportGuardPathing() const;
+
+			void InitialiseStreamedRooms(int levelID, std::vector<Vector3>& itemPositions);
+			void ClearStreamedRooms();
+			void UpdateRoomStreaming();
+			bool StreamRooms(const std::vector<Vector3>& anchors);
+			std::vector<Vector3> GetStreamingAnchors();
+			void ParkGuards();
+
+			void PrepareRoom(StreamedRoom& room);
+			void AddRoomToWorld(StreamedRoom& room);
+			void RemoveRoomFromWorld(StreamedRoom& room);
+			void ReleaseRoom(StreamedRoom& room);
+
+			GameObject* CreateWall(const Vector3& position) const;
+			GameObject* CreateFloor(const Vector3& position) const;
+			Door* CreateDoor(Door* door, const Vector3& offset) const;
+			Light* CopyLight(Light* light, const Vector3& centre) const;
+			PickupGameObject* CreatePickup(InventoryBuffSystemClass* inventoryBuffSystemClassPtr) const;
+			SoundEmitter* CreateSoundEmitter(LocationBasedSuspicion* locationBasedSuspicionPTR) const;
+
 			GameObject* AddWallToWorld(const Vector3& position);
 			GameObject* AddFloorToWorld(const Vector3& position);
 			Helipad* AddHelipadToWorld(const Vector3& position);
@@ -113,76 +216,106 @@ namespace NCL {
 			std::vector<Room*> mRoomList;
 			std::vector<GameObject*> mLevelLayout;
 			std::vector<Matrix4> mLevelMatrices;
+			size_t mLevelTileMatrixCount;
+
+			std::vector<std::unique_ptr<StreamedRoom>> mStreamedRooms;
+
+			// state of the active level straight after it loaded, so a restart
+			// can be done in place rather than through ClearLevel and LoadLevel
+			bool mHasLevelSnapshot;
+			int mSnapshotPlayerID;
+			size_t mSnapshotLayoutHash;
+			std::vector<GameObject*> mSnapshotObjects;
 
 			RecastBuilder* mBuilder;
+			// searches guard paths on the job threads; rebuilt with the navmesh
+			PathfindingService* mPathfinding;
+			// keeps guards from walking into each other; rebuilt with the navmesh
+			CrowdManager* mCrowd;
 			GameTechRenderer* mRenderer;
 			GameWorld* mWorld;
 			PhysicsSystem* mPhysics;
 			AnimationSystem* mAnimation;
 
+			// per-frame subsystem work, run across the job threads
+			TaskGraph mFrameTasks;
+			float mFrameDt;
+
+			// when pipelined, frame N is culled and sorted while frame N+1 simulates
+			bool mPipelinedFrames;
+			std::chrono::high_resolution_clock::time_point mQueuedFrameStart;
+			// milliseconds from the start of each step to the end of the render
+			// that showed it, summed since the frame benchmark last reset it
+			double mFrameLatency;
+
+			bool mPrintStats;
+
 			vector<GameObject*> mUpdatableObjects;
 
+			GameObjectPool<PickupGameObject> mPickupPool;
+			GameObjectPool<SoundEmitter> mSoundEmitterPool;
+
 			// meshes
-			Mesh* mCubeMesh;
-			Mesh* mWallFloorCubeMesh;
-			Mesh* mSphereMesh;
-			Mesh* mCapsuleMesh;
-			Mesh* mCharMesh;
-			Mesh* mEnemyMesh;
-			Mesh* mBonusMesh;
+			SharedMesh mCubeMesh;
+			SharedMesh mWallFloorCubeMesh;
+			SharedMesh mSphereMesh;
+			SharedMesh mCapsuleMesh;
+			SharedMesh mCharMesh;
+			SharedMesh mEnemyMesh;
+			SharedMesh mBonusMesh;
 
 			// textures
-			Texture* mBasicTex;
-			Texture* mKeeperAlbedo;
-			Texture* mKeeperNormal;
-			Texture* mFloorAlbedo;
-			Texture* mFloorNormal;
+			SharedTexture mBasicTex;
+			SharedTexture mKeeperAlbedo;
+			SharedTexture mKeeperNormal;
+			SharedTexture mFloorAlbedo;
+			SharedTexture mFloorNormal;
 
 			//icons
 			UI* mUi;
-			Texture* mInventorySlotTex;
+			SharedTexture mInventorySlotTex;
 
-			Texture* mHighlightAwardTex;
-			Texture* mLightOffTex;
-			Texture* mMakingNoiseTex;
-			Texture* mSilentRunTex;
-			Texture* mSlowDownTex;
-			Texture* mStunTex;
-			Texture* mSwapPositionTex;
+			SharedTexture mHighlightAwardTex;
+			SharedTexture mLightOffTex;
+			SharedTexture mMakingNoiseTex;
+			SharedTexture mSilentRunTex;
+			SharedTexture mSlowDownTex;
+			SharedTexture mStunTex;
+			SharedTexture mSwapPositionTex;
 
-			Texture* mSuspensionBarTex;
-			Texture* mSuspensionIndicatorTex;
+			SharedTexture mSuspensionBarTex;
+			SharedTexture mSuspensionIndicatorTex;
 
 			// shaders
-			Shader* mBasicShader;
-			Shader* mSoldierShader;
+			SharedShader mBasicShader;
+			SharedShader mSoldierShader;
 
 			// animation 
-			Mesh* mGuardMesh;
-			Mesh* mPlayerMesh;
-			Mesh* mRigMesh;
-			MeshMaterial* mRigMaterial;
-			MeshMaterial* mGuardMaterial;
-			MeshMaterial* mPlayerMaterial;
+			SharedMesh mGuardMesh;
+			SharedMesh mPlayerMesh;
+			SharedMesh mRigMesh;
+			SharedMeshMaterial mRigMaterial;
+			SharedMeshMaterial mGuardMaterial;
+			SharedMeshMaterial mPlayerMaterial;
 
-			Shader* mAnimationShader;
-			Shader* mAnimationShader2;
+			SharedShader mAnimationShader;
+			SharedShader mAnimationShader2;
 
 			//animation guard
 			std::map<std::string, MeshAnimation*> mPreAnimationList;
-			MeshAnimation* mGuardAnimationStand;
-			MeshAnimation* mGuardAnimationSprint;
-			MeshAnimation* mGuardAnimationWalk;
-			MeshAnimation* mGuardAnimationHappy;
-			MeshAnimation* mGuardAnimationAngry;
-
-			MeshAnimation* mPlayerAnimationStand;
-			MeshAnimation* mPlayerAnimationSprint;
-			MeshAnimation* mPlayerAnimationWalk;
-
-			MeshAnimation* mRigAnimationStand;
-			MeshAnimation* mRigAnimationSprint;
-			MeshAnimation* mRigAnimationWalk;
+			SharedMeshAnim mGuardAnimationStand;
+			SharedMeshAnim mGuardAnimationSprint;
+			SharedMeshAnim mGuardAnimationWalk;
+			SharedMeshAnim mGuardAnimationHappy;
+			SharedMeshAnim mGuardAnimationAngry;
+
+			SharedMeshAnim mPlayerAnimationStand;
+			SharedMeshAnim mPlayerAnimationSprint;
+			SharedMeshAnim mPlayerAnimationWalk;
+
+			SharedMeshAnim mRigAnimationStand;
+			SharedMeshAnim mRigAnimationSprint;
+			SharedMeshAnim mRigAnimationWalk;
 			
 			
 
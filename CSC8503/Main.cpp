@@ -11,6 +11,9 @@
 
 #include "NavigationGrid.h"
 #include "NavigationMesh.h"
+#include "CrowdManager.h"
+#include "FrameBenchmark.h"
+#include "JsonParserBenchmark.h"
 
 #include "GameSceneManager.h"
 
@@ -23,26 +26,121 @@
 #include "DebugNetworkedGame.h"
 #include "PushdownMachine.h"
 #include "SceneManager.h"
+#include "AssetPack.h"
+#include "LoadProfiler.h"
+#include "Assets.h"
 using namespace NCL;
 using namespace CSC8503;
 
+#include <algorithm>
 #include <chrono>
+#include <cstdlib>
 #include <thread>
 #include <sstream>
 
 namespace{
     constexpr int SERVER_CHOICE = 1;
+    constexpr int PATHFINDING_BENCHMARK_FRAMES = 600;
+    constexpr int CROWD_BENCHMARK_TICKS = 600;
 }
 
-int main(){
-    Window* w = Window::CreateGameWindow("CSC8503 Game technology!", 1280, 720);
+int main(int argc, char** argv){
+    // --profile-load <trace.json> goes straight into the first level, draws one
+    // frame and exits, writing a Chrome trace of the load and a summary table
+    // to stdout, so CI can time startup without anyone pressing a key
+    std::string loadTracePath;
+    // --benchmark-pathfinding <agents> loads the first level the same way and
+    // stress tests its navmesh with that many agents instead of playing
+    int pathfindingAgents = 0;
+    // --benchmark-navmesh does the same, then times its navmesh built in one
+    // piece against the tiled build
+    bool benchmarkNavMesh = false;
+    // --benchmark-grid times the grid path searches on TestGrid1.txt and larger
+    // generated grids, needing no window or level
+    bool benchmarkGrid = false;
+    // --benchmark-crowd <agents> sends that many agents steering around each
+    // other across a generated maze's navmesh, also windowless
+    int crowdAgents = 0;
+    // --benchmark-frames <frames> times that many frames of a generated level
+    // full of guards, the frame tasks on 1, 2, 4... threads up to every core,
+    // then whole frames with and without pipelining, also windowless
+    int benchmarkFrames = 0;
+    // --benchmark-json <passes> parses every level and room file that many
+    // times with JsonParser and with the parser it replaced, also windowless
+    int jsonPasses = 0;
+    // --print-stats prints the asset caches and navmesh after each level load,
+    // and pool and guard pathing use as each level is cleared
+    bool printStats = false;
+    for (int i = 1; i < argc; ++i) {
+        if (std::string(argv[i]) == "--benchmark-navmesh") {
+            benchmarkNavMesh = true;
+        }
+        if (std::string(argv[i]) == "--benchmark-grid") {
+            benchmarkGrid = true;
+        }
+        if (std::string(argv[i]) == "--print-stats") {
+            printStats = true;
+        }
+    }
+    for (int i = 1; i + 1 < argc; ++i) {
+        if (std::string(argv[i]) == "--profile-load") {
+            loadTracePath = argv[i + 1];
+        }
+        if (std::string(argv[i]) == "--benchmark-pathfinding") {
+            pathfindingAgents = std::max(1, std::atoi(argv[i + 1]));
+        }
+        if (std::string(argv[i]) == "--benchmark-crowd") {
+            crowdAgents = std::max(1, std::atoi(argv[i + 1]));
+        }
+        if (std::string(argv[i]) == "--benchmark-frames") {
+            benchmarkFrames = std::max(1, std::atoi(argv[i + 1]));
+        }
+        if (std::string(argv[i]) == "--benchmark-json") {
+            jsonPasses = std::max(1, std::atoi(argv[i + 1]));
+        }
+    }
+    LoadProfiler::Begin("Startup");
+
+    // shipped builds carry their assets in a pack, made by AssetCooker --pack;
+    // without one everything loads from the loose files
+    if (AssetPack::Mount(Assets::ASSETROOT + "Assets.pak")) {
+        std::cout << "Mounted " << Assets::ASSETROOT << "Assets.pak" << std::endl;
+    }
+    if (benchmarkGrid || crowdAgents > 0 || benchmarkFrames > 0 || jsonPasses > 0) {
+        if (benchmarkGrid) {
+            NavigationGrid::RunBenchmark(std::cout);
+        }
+        if (crowdAgents > 0) {
+            CrowdManager::RunBenchmark(crowdAgents, CROWD_BENCHMARK_TICKS, std::cout);
+        }
+        if (benchmarkFrames > 0) {
+            FrameBenchmark::Run(std::cout, benchmarkFrames);
+        }
+        if (jsonPasses > 0) {
+            JsonParserBenchmark::Run(std::cout, jsonPasses);
+        }
+        AssetPack::UnmountAll();
+        return 0;
+    }
+
+    Window* w = nullptr;
+    {
+        LoadMarker marker("CreateGameWindow");
+        w = Window::CreateGameWindow("CSC8503 Game technology!", 1280, 720);
+    }
 
     if (!w->HasInitialised()) {
         return -1;
     }
 
 
-    auto* sceneManager = SceneManager::GetSceneManager();
+    // every scene shares the one LevelManager, which is made along with them
+    SceneManager* sceneManager = nullptr;
+    {
+        LoadMarker marker("SceneManager");
+        sceneManager = SceneManager::GetSceneManager();
+    }
+    LevelManager::GetLevelManager()->SetPrintStats(printStats);
     
     GameSceneManager* gm = nullptr;
     //erendgrmnc: make the bool below true for network test.
@@ -70,6 +168,22 @@ int main(){
     else{
         gm = new GameSceneManager();
     }
+    bool runBenchmarks = pathfindingAgents > 0 || benchmarkNavMesh;
+    if (!loadTracePath.empty() || runBenchmarks) {
+        sceneManager->SetCurrentScene(Scenes::Singleplayer);
+        ((GameSceneManager*)sceneManager->GetCurrentScene())->CreateLevel();
+    }
+    if (runBenchmarks) {
+        if (benchmarkNavMesh) {
+            LevelManager::GetLevelManager()->RunNavMeshBenchmark();
+        }
+        if (pathfindingAgents > 0) {
+            LevelManager::GetLevelManager()->RunPathfindingBenchmark(pathfindingAgents, PATHFINDING_BENCHMARK_FRAMES);
+        }
+        Window::DestroyGameWindow();
+        AssetPack::UnmountAll();
+        return 0;
+    }
     
     w->GetTimer().GetTimeDeltaSeconds(); //Clear the timer so we don't get a larget first dt!
     while (w->UpdateWindow() && !sceneManager->GetIsForceQuit()) {
@@ -78,6 +192,9 @@ int main(){
             std::cout << "Skipping large time delta" << std::endl;
             continue; //must have hit a breakpoint or something to have a 1 second frame time!
         }
+        if (!loadTracePath.empty()) {
+            LoadProfiler::Begin("First frame");
+        }
         if (Window::GetKeyboard()->KeyPressed(KeyCodes::PRIOR)) {
             w->ShowConsole(true);
         }
@@ -92,12 +209,22 @@ int main(){
         w->SetTitle("Gametech frame time:" + std::to_string(1000.0f * dt));
         //gm->UpdateGame(dt);
 
-        if (sceneManager->GetScenePushdownMachine() != nullptr) {
+        // the menus would switch the profiled level straight back out
+        if (sceneManager->GetScenePushdownMachine() != nullptr && loadTracePath.empty()) {
             sceneManager->GetScenePushdownMachine()->Update(dt);
         }
         if (sceneManager->GetCurrentScene() != nullptr) {
             sceneManager->GetCurrentScene()->UpdateGame(dt);
         }
+
+        if (!loadTracePath.empty()) {
+            LoadProfiler::End();
+            LoadProfiler::End();
+            LoadProfiler::WriteChromeTrace(loadTracePath);
+            LoadProfiler::PrintSummary(std::cout);
+            break;
+        }
     }
     Window::DestroyGameWindow();
+    AssetPack::UnmountAll();
 }
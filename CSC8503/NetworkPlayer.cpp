@@ -72,7 +72,7 @@ void NetworkPlayer::MovePlayer(float dt){
     bool isServer = game->GetIsServer();
     
     if (mIsLocalPlayer){
-        const Vector3 playerPos = mTransform.GetPosition();
+        const Vector3 playerPos = GetTransform().GetPosition();
 
         Debug::Print("Player Position: " + std::to_string(playerPos.x) + ", " + std::to_string(playerPos.y) + ", " + std::to_string(playerPos.z), Vector2(5, 30), Debug::MAGENTA);  
         
@@ -126,16 +126,16 @@ void NetworkPlayer::HandleMovement(float dt, const PlayerInputs& playerInputs){
     }
     
     if (playerInputs.movementButtons[MOVE_FORWARD_INDEX])
-        mPhysicsObject->AddForce(fwdAxis * mMovementSpeed);
+        GetPhysicsObject()->AddForce(fwdAxis * mMovementSpeed);
 
     if (playerInputs.movementButtons[MOVE_LEFT_INDEX])
-        mPhysicsObject->AddForce(rightAxis * mMovementSpeed);
+        GetPhysicsObject()->AddForce(rightAxis * mMovementSpeed);
     
     if (playerInputs.movementButtons[MOVE_BACKWARDS_INDEX])
-        mPhysicsObject->AddForce(fwdAxis * mMovementSpeed);
+        GetPhysicsObject()->AddForce(fwdAxis * mMovementSpeed);
 
     if (playerInputs.movementButtons[MOVE_RIGHT_INDEX])
-        mPhysicsObject->AddForce(rightAxis * mMovementSpeed);
+        GetPhysicsObject()->AddForce(rightAxis * mMovementSpeed);
 
     ActivateSprint(playerInputs.isSprinting);
     ToggleCrouch(playerInputs.isCrouching);
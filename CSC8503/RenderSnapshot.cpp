@@ -0,0 +1,84 @@
+#include "RenderSnapshot.h"
+#include "GameWorld.h"
+#include "GameObject.h"
+#include "RenderObject.h"
+#include "Camera.h"
+
+using namespace NCL;
+using namespace CSC8503;
+
+/*
+Copies out the current state of every visible render object. This is the only
+part of render preparation that has to run while the simulation is stopped.
+*/
+void RenderSnapshot::Capture(GameWorld& world, float aspectRatio) {
+	mItems.clear();
+	mPalettes.clear();
+	mJointMatrices.clear();
+	mActiveItems.clear();
+	mOutlinedItems.clear();
+
+	world.UpdateTransforms();
+
+	PerspectiveCamera& camera = world.GetMainCamera();
+	mViewMatrix = camera.BuildViewMatrix();
+	mProjMatrix = camera.BuildProjectionMatrix(aspectRatio);
+	mCameraPos	= camera.GetPosition();
+	mFrustum	= Frustum::FromViewProjMatrix(mProjMatrix * mViewMatrix);
+
+	world.OperateOnComponents<RenderObject, Transform>(
+		[&](GameObject* o, RenderObject& rendObj, Transform& transform) {
+			if (!o->IsActive() || !o->IsRendered() || rendObj.IsInstanced()) {
+				return;
+			}
+			RenderItem item;
+			item.mesh				= rendObj.GetMesh();
+			item.albedoTex			= rendObj.GetAlbedoTexture();
+			item.normalTex			= rendObj.GetNormalTexture();
+			item.shader				= rendObj.GetShader();
+			item.modelMatrix		= transform.GetMatrix();
+			item.colour				= rendObj.GetColour();
+			item.position			= transform.GetPosition();
+			item.cullSphereRadius	= rendObj.GetCullSphereRadius();
+			item.sqDistToCam		= 0.0f;
+			item.outlined			= rendObj.GetOutlined();
+			item.animated			= rendObj.GetAnimation() != nullptr;
+			item.firstPalette		= (int)mPalettes.size();
+			item.paletteCount		= 0;
+
+			if (item.animated) {
+				const std::vector<std::vector<Matrix4>>& frameMatrices = rendObj.GetFrameMatricesVec();
+				const std::vector<GLuint>& matTextures = rendObj.GetMatTextures();
+				size_t subMeshCount = std::min(frameMatrices.size(), matTextures.size());
+				for (size_t i = 0; i < subMeshCount; ++i) {
+					mPalettes.push_back({ (int)mJointMatrices.size(), (int)frameMatrices[i].size(), matTextures[i] });
+					mJointMatrices.insert(mJointMatrices.end(), frameMatrices[i].begin(), frameMatrices[i].end());
+					item.paletteCount++;
+				}
+			}
+			mItems.emplace_back(item);
+		}
+	);
+}
+
+void RenderSnapshot::BuildObjectList() {
+	mActiveItems.clear();
+	mOutlinedItems.clear();
+
+	for (int i = 0; i < (int)mItems.size(); ++i) {
+		RenderItem& item = mItems[i];
+		if (mFrustum.SphereInsideFrustum(item.position, item.cullSphereRadius)) {
+			item.sqDistToCam = (mCameraPos - item.position).LengthSquared();
+			mActiveItems.emplace_back(i);
+			if (item.outlined) {
+				mOutlinedItems.emplace_back(i);
+			}
+		}
+	}
+}
+
+void RenderSnapshot::SortObjectList() {
+	std::sort(mActiveItems.begin(), mActiveItems.end(), [&](int a, int b) {
+		return mItems[a].sqDistToCam < mItems[b].sqDistToCam;
+	});
+}
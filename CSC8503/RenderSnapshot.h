@@ -0,0 +1,100 @@
+#pragma once
+#include "Frustum.h"
+
+namespace NCL {
+	using namespace NCL::Maths;
+	namespace Rendering {
+		class Mesh;
+		class Texture;
+		class Shader;
+	}
+	namespace CSC8503 {
+		class GameWorld;
+
+		/*
+		Everything the renderer needs from one simulation step, copied out so the
+		simulation can carry on with the next step while this one is culled,
+		sorted and drawn. Nothing points back into the world, so the step after
+		can move or delete objects freely; only the assets have to outlive it.
+		*/
+		class RenderSnapshot {
+		public:
+			struct RenderItem {
+				Rendering::Mesh*	mesh;
+				Rendering::Texture*	albedoTex;
+				Rendering::Texture*	normalTex;
+				Rendering::Shader*	shader;
+				Matrix4	modelMatrix;
+				Vector4	colour;
+				Vector3	position;
+				float	cullSphereRadius;
+				float	sqDistToCam;
+				bool	outlined;
+				bool	animated;
+				int		firstPalette;
+				int		paletteCount;
+			};
+
+			//Joint matrices and material texture for one sub mesh, as a range of mJointMatrices
+			struct Palette {
+				int				start;
+				int				count;
+				unsigned int	texture;
+			};
+
+			RenderSnapshot() {}
+			~RenderSnapshot() {}
+
+			void Capture(GameWorld& world, float aspectRatio);
+			void BuildObjectList();
+			void SortObjectList();
+
+			const RenderItem& GetItem(int index) const {
+				return mItems[index];
+			}
+
+			const std::vector<int>& GetActiveItems() const {
+				return mActiveItems;
+			}
+
+			const std::vector<int>& GetOutlinedItems() const {
+				return mOutlinedItems;
+			}
+
+			const Matrix4* GetPaletteMatrices(const RenderItem& item, int subMesh, int& count) const {
+				const Palette& p = mPalettes[item.firstPalette + subMesh];
+				count = p.count;
+				return mJointMatrices.data() + p.start;
+			}
+
+			unsigned int GetPaletteTexture(const RenderItem& item, int subMesh) const {
+				return mPalettes[item.firstPalette + subMesh].texture;
+			}
+
+			const Matrix4& GetViewMatrix() const {
+				return mViewMatrix;
+			}
+
+			const Matrix4& GetProjMatrix() const {
+				return mProjMatrix;
+			}
+
+			const Vector3& GetCameraPosition() const {
+				return mCameraPos;
+			}
+
+		protected:
+			std::vector<RenderItem>	mItems;
+			std::vector<Palette>	mPalettes;
+			std::vector<Matrix4>	mJointMatrices;
+
+			std::vector<int>		mActiveItems;
+			std::vector<int>		mOutlinedItems;
+
+			Matrix4		mViewMatrix;
+			Matrix4		mProjMatrix;
+			Vector3		mCameraPos;
+			Frustum		mFrustum;
+		};
+	}
+}
@@ -23,6 +23,20 @@ namespace SuspicionSystem
 			mLocationBasedSuspicionPtr->Init();
 		}
 
+		void SaveState()
+		{
+			mSavedGlobalSuspicionMetre = *mGlobalSuspicionMetrePtr;
+			mSavedLocalSuspicionMetre = *mLocalSuspicionMetrePtr;
+			mSavedLocationBasedSuspicion = *mLocationBasedSuspicionPtr;
+		}
+
+		void RestoreState()
+		{
+			*mGlobalSuspicionMetrePtr = mSavedGlobalSuspicionMetre;
+			*mLocalSuspicionMetrePtr = mSavedLocalSuspicionMetre;
+			*mLocationBasedSuspicionPtr = mSavedLocationBasedSuspicion;
+		}
+
 		LocalSuspicionMetre* GetLocalSuspicionMetre() { return mLocalSuspicionMetrePtr; };
 		GlobalSuspicionMetre* GetGlobalSuspicionMetre() { return mGlobalSuspicionMetrePtr; };
 		LocationBasedSuspicion* GetLocationBasedSuspicion() { return mLocationBasedSuspicionPtr; };
@@ -30,5 +44,9 @@ namespace SuspicionSystem
 		LocalSuspicionMetre* mLocalSuspicionMetrePtr;
 		GlobalSuspicionMetre* mGlobalSuspicionMetrePtr;
 		LocationBasedSuspicion* mLocationBasedSuspicionPtr;
+
+		GlobalSuspicionMetre mSavedGlobalSuspicionMetre;
+		LocalSuspicionMetre mSavedLocalSuspicionMetre{ nullptr };
+		LocationBasedSuspicion mSavedLocationBasedSuspicion;
 	};
 };
\ No newline at end of file
@@ -96,22 +96,7 @@ void TutorialGame::LoadAssetFiles(){
 }
 
 TutorialGame::~TutorialGame()	{
-	delete cubeMesh;
-	delete sphereMesh;
-	delete capsuleMesh;
-	delete charMesh;
-	delete enemyMesh;
-	delete bonusMesh;
-
-
-
-	delete basicTex;
-	delete basicShader;
-	delete mKeeperAlbedo;
-	delete mKeeperNormal;
-	delete mFloorAlbedo;
-	delete mFloorNormal;
-
+	//Meshes, textures and shaders are freed with the renderer's asset caches
 	delete physics;
 	delete renderer;
 	delete world;
@@ -191,6 +176,7 @@ void TutorialGame::UpdateGame(float dt) {
 	
 	renderer->Update(dt);
 	physics->Update(dt);
+	physics->DeliverCollisionEvents();
 	renderer->Render();
 	Debug::UpdateRenderables(dt);
 }
@@ -280,8 +266,8 @@ void TutorialGame::CreatePlayerObjectComponents(PlayerObject& playerObject,  con
 		.SetScale(Vector3(PLAYER_MESH_SIZE, PLAYER_MESH_SIZE, PLAYER_MESH_SIZE))
 		.SetPosition(position);
 
-	playerObject.SetRenderObject(new RenderObject(&playerObject.GetTransform(), enemyMesh, mKeeperAlbedo, mKeeperNormal, basicShader, PLAYER_MESH_SIZE));
-	playerObject.SetPhysicsObject(new PhysicsObject(&playerObject.GetTransform(), playerObject.GetBoundingVolume(), 1, 1, 5));
+	playerObject.SetRenderObject(new RenderObject(&playerObject, enemyMesh, mKeeperAlbedo, mKeeperNormal, basicShader, PLAYER_MESH_SIZE));
+	playerObject.SetPhysicsObject(new PhysicsObject(&playerObject, playerObject.GetBoundingVolume(), 1, 1, 5));
 
 
 	playerObject.GetPhysicsObject()->SetInverseMass(PLAYER_INVERSE_MASS);
@@ -372,8 +358,8 @@ GameObject* TutorialGame::AddFloorToWorld(const Vector3& position, const std::st
 		.SetScale(floorSize * 2)
 		.SetPosition(position);
 
-	floor->SetRenderObject(new RenderObject(&floor->GetTransform(), cubeMesh, mFloorAlbedo, mFloorNormal, basicShader, 120));
-	floor->SetPhysicsObject(new PhysicsObject(&floor->GetTransform(), floor->GetBoundingVolume(), 1, 2, 2));
+	floor->SetRenderObject(new RenderObject(floor, cubeMesh, mFloorAlbedo, mFloorNormal, basicShader, 120));
+	floor->SetPhysicsObject(new PhysicsObject(floor, floor->GetBoundingVolume(), 1, 2, 2));
 
 	floor->GetPhysicsObject()->SetInverseMass(0);
 	floor->GetPhysicsObject()->InitCubeInertia();
@@ -403,8 +389,8 @@ GameObject* TutorialGame::AddSphereToWorld(const Vector3& position, float radius
 		.SetScale(sphereSize)
 		.SetPosition(position);
 
-	sphere->SetRenderObject(new RenderObject(&sphere->GetTransform(), sphereMesh, mFloorAlbedo, mFloorNormal, basicShader,radius));
-	sphere->SetPhysicsObject(new PhysicsObject(&sphere->GetTransform(), sphere->GetBoundingVolume()));
+	sphere->SetRenderObject(new RenderObject(sphere, sphereMesh, mFloorAlbedo, mFloorNormal, basicShader,radius));
+	sphere->SetPhysicsObject(new PhysicsObject(sphere, sphere->GetBoundingVolume()));
 
 	sphere->GetPhysicsObject()->SetInverseMass(inverseMass);
 	sphere->GetPhysicsObject()->InitSphereInertia(false);
@@ -425,8 +411,8 @@ GameObject* TutorialGame::AddCapsuleToWorld(const Vector3& position, float halfH
 		.SetScale(capsuleSize)
 		.SetPosition(position);
 
-	capsule->SetRenderObject(new RenderObject(&capsule->GetTransform(), capsuleMesh, basicTex, nullptr, basicShader, halfHeight));
-	capsule->SetPhysicsObject(new PhysicsObject(&capsule->GetTransform(), capsule->GetBoundingVolume()));
+	capsule->SetRenderObject(new RenderObject(capsule, capsuleMesh, basicTex, nullptr, basicShader, halfHeight));
+	capsule->SetPhysicsObject(new PhysicsObject(capsule, capsule->GetBoundingVolume()));
 
 	capsule->GetPhysicsObject()->SetInverseMass(inverseMass);
 	capsule->GetPhysicsObject()->InitSphereInertia(false);
@@ -446,8 +432,8 @@ GameObject* TutorialGame::AddOBBCubeToWorld(const Vector3& position, Vector3 dim
 		.SetPosition(position)
 		.SetScale(dimensions * 2);
 	float largestDim = std::max(dimensions.x, std::max(dimensions.y, dimensions.z));
-	cube->SetRenderObject(new RenderObject(&cube->GetTransform(), cubeMesh, basicTex, nullptr, basicShader, largestDim));
-	cube->SetPhysicsObject(new PhysicsObject(&cube->GetTransform(), cube->GetBoundingVolume()));
+	cube->SetRenderObject(new RenderObject(cube, cubeMesh, basicTex, nullptr, basicShader, largestDim));
+	cube->SetPhysicsObject(new PhysicsObject(cube, cube->GetBoundingVolume()));
 	
 	cube->GetPhysicsObject()->SetInverseMass(inverseMass);
 	cube->GetPhysicsObject()->InitCubeInertia();
@@ -467,8 +453,8 @@ GameObject* TutorialGame::AddAABBCubeToWorld(const Vector3& position, Vector3 di
 		.SetPosition(position)
 		.SetScale(dimensions * 2);
 	float largestDim = std::max(dimensions.x, std::max(dimensions.y, dimensions.z));
-	cube->SetRenderObject(new RenderObject(&cube->GetTransform(), cubeMesh, mFloorAlbedo, mFloorNormal, basicShader, largestDim));
-	cube->SetPhysicsObject(new PhysicsObject(&cube->GetTransform(), cube->GetBoundingVolume()));
+	cube->SetRenderObject(new RenderObject(cube, cubeMesh, mFloorAlbedo, mFloorNormal, basicShader, largestDim));
+	cube->SetPhysicsObject(new PhysicsObject(cube, cube->GetBoundingVolume()));
 
 	cube->GetPhysicsObject()->SetInverseMass(inverseMass);
 	cube->GetPhysicsObject()->InitCubeInertia();
@@ -501,8 +487,8 @@ GameObject* TutorialGame::AddEnemyToWorld(const Vector3& position, const std::st
 		.SetScale(Vector3(meshSize, meshSize, meshSize))
 		.SetPosition(position);
 
-	character->SetRenderObject(new RenderObject(&character->GetTransform(), enemyMesh, mKeeperAlbedo, mKeeperNormal, basicShader, meshSize));
-	character->SetPhysicsObject(new PhysicsObject(&character->GetTransform(), character->GetBoundingVolume()));
+	character->SetRenderObject(new RenderObject(character, enemyMesh, mKeeperAlbedo, mKeeperNormal, basicShader, meshSize));
+	character->SetPhysicsObject(new PhysicsObject(character, character->GetBoundingVolume()));
 
 	character->GetPhysicsObject()->SetInverseMass(inverseMass);
 	character->GetPhysicsObject()->InitSphereInertia(false);
@@ -521,8 +507,8 @@ GameObject* TutorialGame::AddBonusToWorld(const Vector3& position, const std::st
 		.SetScale(Vector3(2, 2, 2))
 		.SetPosition(position);
 
-	apple->SetRenderObject(new RenderObject(&apple->GetTransform(), bonusMesh, basicTex, nullptr, basicShader, 0.5f));
-	apple->SetPhysicsObject(new PhysicsObject(&apple->GetTransform(), apple->GetBoundingVolume()));
+	apple->SetRenderObject(new RenderObject(apple, bonusMesh, basicTex, nullptr, basicShader, 0.5f));
+	apple->SetPhysicsObject(new PhysicsObject(apple, apple->GetBoundingVolume()));
 
 	apple->GetPhysicsObject()->SetInverseMass(1.0f);
 	apple->GetPhysicsObject()->InitSphereInertia(false);
@@ -543,8 +529,8 @@ StateGameObject* TutorialGame::AddStateObjectToWorld(const Vector3& position, co
 		.SetScale(Vector3(2, 2, 2))
 		.SetPosition(position);
 
-	apple->SetRenderObject(new RenderObject(&apple->GetTransform(), cubeMesh, basicTex, nullptr, basicShader, 1));
-	apple->SetPhysicsObject(new PhysicsObject(&apple->GetTransform(), apple->GetBoundingVolume()));
+	apple->SetRenderObject(new RenderObject(apple, cubeMesh, basicTex, nullptr, basicShader, 1));
+	apple->SetPhysicsObject(new PhysicsObject(apple, apple->GetBoundingVolume()));
 
 	apple->GetPhysicsObject()->SetInverseMass(1.0f);
 	apple->GetPhysicsObject()->InitSphereInertia(false);
@@ -568,8 +554,8 @@ GuardObject* TutorialGame::AddGuardToWorld(const Vector3& position, const std::s
 		.SetScale(Vector3(meshSize, meshSize, meshSize))
 		.SetPosition(position);
 
-	guard->SetRenderObject(new RenderObject(&guard->GetTransform(), enemyMesh, mKeeperAlbedo, mKeeperNormal, basicShader, meshSize));
-	guard->SetPhysicsObject(new PhysicsObject(&guard->GetTransform(), guard->GetBoundingVolume(), 1, 0, 5));
+	guard->SetRenderObject(new RenderObject(guard, enemyMesh, mKeeperAlbedo, mKeeperNormal, basicShader, meshSize));
+	guard->SetPhysicsObject(new PhysicsObject(guard, guard->GetBoundingVolume(), 1, 0, 5));
 
 	guard->GetPhysicsObject()->SetInverseMass(inverseMass);
 	guard->GetPhysicsObject()->InitSphereInertia(false);
@@ -90,17 +90,17 @@ namespace NCL {
 
 			GameObject* selectionObject = nullptr;
 
-			Mesh*	capsuleMesh = nullptr;
-			Mesh*	cubeMesh	= nullptr;
-			Mesh*	sphereMesh	= nullptr;
+			SharedMesh	capsuleMesh = nullptr;
+			SharedMesh	cubeMesh	= nullptr;
+			SharedMesh	sphereMesh	= nullptr;
 			
-			Texture*	basicTex	= nullptr;
-			Texture* mKeeperAlbedo = nullptr;
-			Texture* mKeeperNormal = nullptr;
-			Texture* mFloorAlbedo = nullptr;
-			Texture* mFloorNormal = nullptr;
+			SharedTexture	basicTex	= nullptr;
+			SharedTexture mKeeperAlbedo = nullptr;
+			SharedTexture mKeeperNormal = nullptr;
+			SharedTexture mFloorAlbedo = nullptr;
+			SharedTexture mFloorNormal = nullptr;
 
-			Shader*		basicShader = nullptr;
+			SharedShader		basicShader = nullptr;
 
 			//Animation Thing
 			
@@ -109,9 +109,9 @@ namespace NCL {
 
 
 			//Coursework Meshes
-			Mesh*	charMesh	= nullptr;
-			Mesh*	enemyMesh	= nullptr;
-			Mesh*	bonusMesh	= nullptr;
+			SharedMesh	charMesh	= nullptr;
+			SharedMesh	enemyMesh	= nullptr;
+			SharedMesh	bonusMesh	= nullptr;
 
 			//Coursework Additional functionality	
 			GameObject* lockedObject	= nullptr;
@@ -1,6 +1,7 @@
 #include "AnimationSystem.h"
 #include "Camera.h"
 #include "AnimationObject.h"
+#include "JobSystem.h"
 
 
 #define SHADERDIR	"../Assets/Shaders/"
@@ -10,9 +11,6 @@
 
 AnimationSystem::AnimationSystem(GameWorld& g):gameWorld(g)
 {
-	mShader = nullptr;
-	mMesh = nullptr;
-	mAnim = nullptr;
 	mGuardState = Stand;
 	mPlayerState = Stand;
 	
@@ -24,77 +22,76 @@ AnimationSystem::~AnimationSystem()
 
 void AnimationSystem::Clear()
 {
-	mAnimationList.clear();
-	mGuardList.clear();
-	mPlayerList.clear();
+	mGuardState = Stand;
+	mPlayerState = Stand;
 }
 
-void AnimationSystem::Update(float dt, vector<GameObject*> UpdatableObjects,std::map<std::string,MeshAnimation*> preAnimationList)
+void AnimationSystem::Update(float dt, std::map<std::string,MeshAnimation*> preAnimationList)
 {
 	UpdateCurrentFrames(dt);
 	UpdateAnimations(preAnimationList);
-	UpdateAllAnimationObjects(dt, UpdatableObjects);
+	UpdateAllAnimationObjects(dt);
 	
 }
 
-void AnimationSystem::UpdateAllAnimationObjects(float dt, vector<GameObject*> UpdatableObjects)
+void AnimationSystem::UpdateAllAnimationObjects(float dt)
 {
-		for (auto& obj : UpdatableObjects) {
-			if (obj->GetAnimationObject()) {
-				AnimationObject* animObj = obj->GetAnimationObject();
-				int currentFrame = animObj->GetCurrentFrame();
-				mMesh = obj->GetRenderObject()->GetMesh();
-				mAnim = animObj->GetAnimation();
-				mShader = obj->GetRenderObject()->GetShader();
-				
-				const Matrix4* invBindPose = mMesh->GetInverseBindPose().data();
-				const Matrix4* frameData = mAnim->GetJointData(currentFrame);
-				
-				const int* bindPoseIndices = mMesh->GetBindPoseIndices();
-				std::vector<std::vector<Matrix4>> frameMatricesVec;
-				for (unsigned int i = 0; i < mMesh->GetSubMeshCount(); ++i) {
-
-					
-					Mesh::SubMeshPoses pose;
-					mMesh->GetBindPoseState(i, pose);
-					
-
-					vector<Matrix4> frameMatrices;
-					for (unsigned int i = 0; i < pose.count; ++i) {
-						int jointID = bindPoseIndices[pose.start + i];
-						Matrix4 mat = frameData[jointID] * invBindPose[pose.start + i];
-						frameMatrices.emplace_back(mat);
-					}
-					frameMatricesVec.emplace_back(frameMatrices);
+	ComponentPool<AnimationObject>& animationPool = gameWorld.GetComponentPool<AnimationObject>();
+	ComponentPool<RenderObject>& renderPool = gameWorld.GetComponentPool<RenderObject>();
+
+	//Each object only writes to its own RenderObject, so skinning can be split across threads.
+	//The joint matrices are built in the thread's frame allocator rather than on the heap.
+	JobSystem::GetJobSystem()->ParallelFor(animationPool.Size(), 4, [&](size_t begin, size_t end) {
+		FrameAllocator& scratch = JobSystem::GetJobSystem()->GetThreadAllocator();
+		for (size_t index = begin; index < end; ++index) {
+			RenderObject* renderObj = renderPool.Get(animationPool.GetEntity(index));
+			if (!renderObj || !animationPool.GetOwner(index)->IsActive()) {
+				continue;
+			}
+			AnimationObject& animObj = animationPool.GetComponent(index);
+			int currentFrame = animObj.GetCurrentFrame();
+			Mesh* mesh = renderObj->GetMesh();
+			MeshAnimation* anim = animObj.GetAnimation();
+
+			const Matrix4* invBindPose = mesh->GetInverseBindPose().data();
+			const Matrix4* frameData = anim->GetJointData(currentFrame);
+
+			const int* bindPoseIndices = mesh->GetBindPoseIndices();
+			for (unsigned int i = 0; i < mesh->GetSubMeshCount(); ++i) {
+				Mesh::SubMeshPoses pose;
+				mesh->GetBindPoseState(i, pose);
+
+				Matrix4* frameMatrices = scratch.AllocateArray<Matrix4>(pose.count);
+				for (unsigned int j = 0; j < pose.count; ++j) {
+					int jointID = bindPoseIndices[pose.start + j];
+					frameMatrices[j] = frameData[jointID] * invBindPose[pose.start + j];
 				}
-				obj->GetRenderObject()->SetAnimation(obj->GetAnimationObject()->GetAnimation());
-				obj->GetRenderObject()->SetMaterial(obj->GetAnimationObject()->GetMaterial());
-				obj->GetRenderObject()->SetCurrentFrame(currentFrame);
-				obj->GetRenderObject()->SetFrameMatricesVec(frameMatricesVec);
-				
-				frameMatricesVec.clear();
-
+				renderObj->SetFrameMatrices(i, frameMatrices, pose.count);
 			}
-
-			
-			
+			renderObj->SetAnimation(animObj.GetAnimation());
+			renderObj->SetMaterial(animObj.GetMaterial());
+			renderObj->SetCurrentFrame(currentFrame);
 		}
-	
-	
+	});
 }
 
 void AnimationSystem::UpdateCurrentFrames(float dt)
 {
-	for ( auto& animList : mAnimationList) {
-		animList->Update(dt);
-	}
+	ComponentPool<AnimationObject>& animationPool = gameWorld.GetComponentPool<AnimationObject>();
+	JobSystem::GetJobSystem()->ParallelFor(animationPool.Size(), 64, [&](size_t begin, size_t end) {
+		for (size_t i = begin; i < end; ++i) {
+			if (animationPool.GetOwner(i)->IsActive()) {
+				animationPool.GetComponent(i).Update(dt);
+			}
+		}
+	});
 }
 
 
 void AnimationSystem::UpdateAnimations(std::map<std::string, MeshAnimation*> preAnimationList)
 {
 	
-	for (auto& obj : mGuardList) {
+	for (GuardObject* obj : gameWorld.Query<GuardObject>()) {
 
 		GuardObject::GuardState GuardState = obj->GetGuardState();
 		
@@ -120,7 +117,7 @@ void AnimationSystem::UpdateAnimations(std::map<std::string, MeshAnimation*> pre
 			}
 	}
 
-	for (auto& obj : mPlayerList) {
+	for (PlayerObject* obj : gameWorld.Query<PlayerObject>()) {
 
 		PlayerObject::PlayerState PlayerState = obj->GetPlayerState();
 
@@ -150,53 +147,44 @@ void AnimationSystem::UpdateAnimations(std::map<std::string, MeshAnimation*> pre
 
 void AnimationSystem::PreloadMatTextures(GameTechRenderer& renderer)
 {
-	gameWorld.OperateOnContents(
-		[&](GameObject* o) {
-
-			if (o->GetAnimationObject()) {
-				for (int i = 0; i < o->GetRenderObject()->GetMesh()->GetSubMeshCount(); ++i) {
-					const MeshMaterialEntry* matEntry = o->GetAnimationObject()->GetMaterial()->GetMaterialForLayer(i);
-					const string* filename = nullptr;
-					matEntry->GetEntry("Diffuse", &filename);
-					GLuint texID = 0;
-
-					if (filename) {
-						string path = *filename;  
-						std::cout << path << std::endl;
-						mAnimTexture = renderer.LoadTexture(path.c_str());
-						texID = ((OGLTexture*)mAnimTexture)->GetObjectID();
-						std::cout << texID << endl;
-						NCL::Rendering::OGLRenderer::SetTextureRepeating(texID, true);
-					}
-					
-					mMatTextures.emplace_back(texID);
-					if (mMatTextures.size() == o->GetRenderObject()->GetMesh()->GetSubMeshCount()) {
-						o->GetRenderObject()->SetMatTextures(mMatTextures);	
-						mMatTextures.clear();
-					}
-				
-					
-				}
-				
-				
+	gameWorld.OperateOnComponents<AnimationObject, RenderObject>(
+		[&](GameObject* o, AnimationObject& animObj, RenderObject& renderObj) {
+			// every guard shares one material, so its textures are only looked up once
+			auto textures = mMatTextures.find(animObj.GetMaterial());
+			if (textures == mMatTextures.end()) {
+				vector<GLuint> loaded = LoadMatTextures(renderer, *animObj.GetMaterial(), renderObj.GetMesh()->GetSubMeshCount());
+				textures = mMatTextures.emplace(animObj.GetMaterial(), std::move(loaded)).first;
 			}
-
+			renderObj.SetMatTextures(textures->second);
 		}
 	);
 }
 
-void AnimationSystem::SetGameObjectLists(vector<GameObject*> UpdatableObjects) {
-	for (auto& obj : UpdatableObjects) {
-		
-		if (obj->GetName() == "Guard") {
-			mGuardList.emplace_back((GuardObject*)obj);
-			AnimationObject* animObj = obj->GetAnimationObject();
-			mAnimationList.emplace_back(animObj);
-		}
-		if (obj->GetName() == "Player") {
-			mPlayerList.emplace_back((PlayerObject*)obj);
-			AnimationObject* animObj = obj->GetAnimationObject();
-			mAnimationList.emplace_back(animObj);
+vector<GLuint> AnimationSystem::LoadMatTextures(GameTechRenderer& renderer, const MeshMaterial& material, int subMeshCount)
+{
+	vector<GLuint> texIDs;
+	for (int i = 0; i < subMeshCount; ++i) {
+		const MeshMaterialEntry* matEntry = material.GetMaterialForLayer(i);
+		const string* filename = nullptr;
+		matEntry->GetEntry("Diffuse", &filename);
+		GLuint texID = 0;
+
+		if (filename) {
+			SharedTexture texture = renderer.LoadTexture(*filename);
+			texID = ((OGLTexture*)texture.get())->GetObjectID();
+			NCL::Rendering::OGLRenderer::SetTextureRepeating(texID, true);
+			mMatTextureHandles.emplace_back(std::move(texture));
 		}
+		texIDs.emplace_back(texID);
+	}
+	return texIDs;
+}
+
+void AnimationSystem::ReleaseMatTextures(GameTechRenderer& renderer)
+{
+	for (const SharedTexture& texture : mMatTextureHandles) {
+		renderer.GetTextureCache().Release(texture);
 	}
+	mMatTextureHandles.clear();
+	mMatTextures.clear();
 }
@@ -26,22 +26,23 @@ namespace NCL {
 
 			void Clear();
 
-			void Update(float dt, vector<GameObject*> mUpdatableObjects , std::map<std::string, MeshAnimation*> preAnimationList);
+			void Update(float dt, std::map<std::string, MeshAnimation*> preAnimationList);
 
-			void UpdateAllAnimationObjects(float dt, vector<GameObject*> UpdatableObjects);
+			void UpdateAllAnimationObjects(float dt);
 
 			void UpdateCurrentFrames(float dt);
 
 			void UpdateAnimations(std::map<std::string, MeshAnimation*> preAnimationList);
 
+			//Loads the textures each animated object's material names, once per material
 			void PreloadMatTextures(GameTechRenderer& renderer);
+			//Gives back everything PreloadMatTextures loaded, for when the level is cleared
+			void ReleaseMatTextures(GameTechRenderer& renderer);
 
 			void SetGuardAnimationState(AnimationState animationState) {
 				mGuardState = animationState;
 			}
 
-			void SetGameObjectLists(vector<GameObject*> UpdatableObjects);
-
 			AnimationState GetGuardAnimationState() {
 				return mGuardState;
 			}
@@ -57,15 +58,11 @@ namespace NCL {
 		protected:
 
 
+			vector<GLuint> LoadMatTextures(GameTechRenderer& renderer, const MeshMaterial& material, int subMeshCount);
+
 			GameWorld& gameWorld;
-			vector<AnimationObject*> mAnimationList;
-			vector<GuardObject*> mGuardList;
-			vector<PlayerObject*> mPlayerList;
-			vector<GLuint>  mMatTextures;
-			Shader* mShader;
-			Mesh* mMesh;
-			MeshAnimation* mAnim;
-			Texture* mAnimTexture = nullptr;	
+			std::map<const MeshMaterial*, vector<GLuint>> mMatTextures;
+			vector<SharedTexture> mMatTextureHandles;
 
 			AnimationState mGuardState;
 			AnimationState mPlayerState;
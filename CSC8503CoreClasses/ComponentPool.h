@@ -0,0 +1,187 @@
+#pragma once
+#include <algorithm>
+#include <cassert>
+#include <vector>
+#include <utility>
+
+namespace NCL {
+	namespace CSC8503 {
+		class GameObject;
+
+		template<class T>
+		class ComponentPool;
+
+		/*
+		For keeping hold of a component across frames, where a pointer would
+		be left behind as the pool moves components about. The component is
+		looked up again on every use, and only while it is the same one the
+		handle was made for: once it has been removed or replaced, Get returns
+		nullptr and dereferencing the handle asserts.
+		*/
+		template<class T>
+		class ComponentHandle {
+		public:
+			ComponentHandle() {}
+
+			T* Get() const {
+				return mPool ? mPool->Get(mEntity, mGeneration) : nullptr;
+			}
+
+			T* operator->() const {
+				T* component = Get();
+				assert(component && "Stale component handle");
+				return component;
+			}
+
+			T& operator*() const {
+				return *operator->();
+			}
+
+			explicit operator bool() const {
+				return Get() != nullptr;
+			}
+
+		protected:
+			friend class ComponentPool<T>;
+
+			ComponentHandle(ComponentPool<T>* pool, int entity, unsigned int generation)
+				: mPool(pool), mEntity(entity), mGeneration(generation) {}
+
+			ComponentPool<T>*	mPool		= nullptr;
+			int					mEntity		= -1;
+			unsigned int		mGeneration	= 0;
+		};
+
+		/*
+		Dense storage for one component type, indexed by the owning object's world ID.
+		The pool owns the components themselves, packed contiguously alongside their
+		owners and entities, so systems walk them in memory order. Removal moves the
+		last element into the gap so the arrays never contain holes, which means a
+		component's address only holds until the next insert or remove; keep the
+		owner's world ID, or a ComponentHandle, rather than a pointer.
+
+		Each entity's slot counts how many components it has had, so a handle
+		made for one of them never finds a later one.
+		*/
+		template<class T>
+		class ComponentPool {
+		public:
+			ComponentPool() {}
+			~ComponentPool() {}
+
+			//Replaces the entity's component if it already has one
+			T& Insert(int entity, GameObject* owner, T component) {
+				if (entity >= (int)mSparse.size()) {
+					mSparse.resize(entity + 1, -1);
+					mGenerations.resize(entity + 1, 0);
+				}
+				int denseIndex = mSparse[entity];
+				if (denseIndex >= 0) {
+					mComponents[denseIndex] = std::move(component);
+					mOwners[denseIndex] = owner;
+					mGenerations[entity]++;
+					return mComponents[denseIndex];
+				}
+				mSparse[entity] = (int)mComponents.size();
+				mOwners.emplace_back(owner);
+				mEntities.emplace_back(entity);
+				return mComponents.emplace_back(std::move(component));
+			}
+
+			void Remove(int entity) {
+				if (!Contains(entity)) {
+					return;
+				}
+				int denseIndex = mSparse[entity];
+				int lastIndex = (int)mComponents.size() - 1;
+				if (denseIndex != lastIndex) {
+					mComponents[denseIndex] = std::move(mComponents[lastIndex]);
+					mOwners[denseIndex] = mOwners[lastIndex];
+					mEntities[denseIndex] = mEntities[lastIndex];
+					mSparse[mEntities[denseIndex]] = denseIndex;
+				}
+				mComponents.pop_back();
+				mOwners.pop_back();
+				mEntities.pop_back();
+				mSparse[entity] = -1;
+				mGenerations[entity]++;
+			}
+
+			bool Contains(int entity) const {
+				return entity >= 0 && entity < (int)mSparse.size() && mSparse[entity] >= 0;
+			}
+
+			T* Get(int entity) {
+				return Contains(entity) ? &mComponents[mSparse[entity]] : nullptr;
+			}
+
+			const T* Get(int entity) const {
+				return Contains(entity) ? &mComponents[mSparse[entity]] : nullptr;
+			}
+
+			//Only the component the entity had when its generation was taken
+			T* Get(int entity, unsigned int generation) {
+				return Contains(entity) && mGenerations[entity] == generation ? &mComponents[mSparse[entity]] : nullptr;
+			}
+
+			ComponentHandle<T> GetHandle(int entity) {
+				return Contains(entity) ? ComponentHandle<T>(this, entity, mGenerations[entity]) : ComponentHandle<T>();
+			}
+
+			//Generations are kept, so handles from before stay stale
+			void Clear() {
+				for (int entity : mEntities) {
+					mGenerations[entity]++;
+				}
+				mComponents.clear();
+				mOwners.clear();
+				mEntities.clear();
+				std::fill(mSparse.begin(), mSparse.end(), -1);
+			}
+
+			//Highest entity ever inserted plus one
+			size_t GetSparseSize() const {
+				return mSparse.size();
+			}
+
+			size_t Size() const {
+				return mComponents.size();
+			}
+
+			T& GetComponent(size_t denseIndex) {
+				return mComponents[denseIndex];
+			}
+
+			const T& GetComponent(size_t denseIndex) const {
+				return mComponents[denseIndex];
+			}
+
+			GameObject* GetOwner(size_t denseIndex) const {
+				return mOwners[denseIndex];
+			}
+
+			int GetEntity(size_t denseIndex) const {
+				return mEntities[denseIndex];
+			}
+
+			std::vector<T>& GetComponents() {
+				return mComponents;
+			}
+
+			const std::vector<T>& GetComponents() const {
+				return mComponents;
+			}
+
+			const std::vector<GameObject*>& GetOwners() const {
+				return mOwners;
+			}
+
+		protected:
+			std::vector<T>				mComponents;
+			std::vector<GameObject*>	mOwners;
+			std::vector<int>			mEntities;
+			std::vector<int>			mSparse;
+			std::vector<unsigned int>	mGenerations;
+		};
+	}
+}
@@ -0,0 +1,794 @@
+#include "CrowdManager.h"
+#include "RecastBuilder.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <chrono>
+#include <iostream>
+#include <random>
+
+using namespace NCL;
+using namespace CSC8503;
+
+namespace {
+	constexpr float SEARCH_EXTENTS[3] = { 2.0f, 4.0f, 2.0f };
+	constexpr int QUERY_NODES = 512;
+	constexpr int MAX_QUERY_RESULTS = 32;
+	constexpr size_t AGENT_GRAIN = 32;
+
+	// all in agent radii. A cell as wide as the query range means a query
+	// only ever looks at the few cells around the agent
+	constexpr float COLLISION_QUERY_RADII = 8.0f;
+	constexpr float GRID_CELL_RADII = COLLISION_QUERY_RADII;
+	constexpr float SLOW_DOWN_RADII = 2.0f;
+	constexpr float ARRIVAL_RADII = 0.25f;
+	// neighbours further apart in height are on another floor
+	constexpr float NEIGHBOUR_HEIGHT = 3.0f;
+
+	// velocity sampling, as Detour's adaptive presets: a ring of samples
+	// around the current best, narrowing each pass. Passes stop once the best
+	// is clear, which is usually after the first
+	constexpr int ADAPTIVE_DIVS = 5;
+	constexpr int ADAPTIVE_RINGS = 2;
+	constexpr int ADAPTIVE_DEPTH = 3;
+	constexpr int PATTERN_SIZE = 1 + ADAPTIVE_DIVS * ADAPTIVE_RINGS;
+	constexpr float VELOCITY_BIAS = 0.4f;
+	constexpr float WEIGHT_DESIRED = 2.0f;
+	constexpr float WEIGHT_CURRENT = 0.75f;
+	constexpr float WEIGHT_SIDE = 0.75f;
+	constexpr float WEIGHT_TIME_TO_HIT = 2.5f;
+	constexpr float HORIZON_TIME = 2.5f;
+
+	constexpr int SEPARATION_ITERATIONS = 4;
+	constexpr float SEPARATION_FACTOR = 0.7f;
+
+	constexpr float BENCHMARK_DT = 1.0f / 60.0f;
+	constexpr int BENCHMARK_OVERLAP_INTERVAL = 10;
+	constexpr int BENCHMARK_MAZE_ROOMS = 12;
+	constexpr float BENCHMARK_ROOM_SIZE = 8.0f;
+	constexpr float BENCHMARK_WALL_THICKNESS = 0.5f;
+	constexpr float BENCHMARK_WALL_HEIGHT = 3.0f;
+	// walls knocked through on top of the maze's own passages, so there's
+	// more than one way between most rooms
+	constexpr float BENCHMARK_EXTRA_DOOR_CHANCE = 0.2f;
+	// what the crowd is meant to manage: hundreds of agents in a few hundred
+	// microseconds a tick, with avoidance
+	constexpr int BENCHMARK_TARGET_AGENTS = 200;
+	constexpr double BENCHMARK_TARGET_TICK = 300.0;	//microseconds
+
+	double MillisecondsSince(std::chrono::high_resolution_clock::time_point start) {
+		return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+	}
+
+	Vector3 Flat(const Vector3& v) {
+		return Vector3(v.x, 0.0f, v.z);
+	}
+
+	float FlatDot(const Vector3& a, const Vector3& b) {
+		return a.x * b.x + a.z * b.z;
+	}
+
+	float FlatDistance(const Vector3& a, const Vector3& b) {
+		float dx = a.x - b.x;
+		float dz = a.z - b.z;
+		return sqrtf(dx * dx + dz * dz);
+	}
+
+	// sample offsets around +x, each ring turned half a step from the last
+	struct SamplePattern {
+		float x[PATTERN_SIZE];
+		float z[PATTERN_SIZE];
+
+		SamplePattern() {
+			x[0] = 0.0f;
+			z[0] = 0.0f;
+			int count = 1;
+			for (int ring = 0; ring < ADAPTIVE_RINGS; ++ring) {
+				float radius = (float)(ADAPTIVE_RINGS - ring) / ADAPTIVE_RINGS;
+				float offset = (ring & 1) ? 0.5f : 0.0f;
+				for (int i = 0; i < ADAPTIVE_DIVS; ++i) {
+					float angle = (i + offset) * 6.2831853f / ADAPTIVE_DIVS;
+					x[count] = cosf(angle) * radius;
+					z[count] = sinf(angle) * radius;
+					count++;
+				}
+			}
+		}
+	};
+	const SamplePattern samplePattern;
+
+	std::mt19937 benchmarkRandom;
+
+	float BenchmarkRandom() {
+		return std::uniform_real_distribution<float>(0.0f, 1.0f)(benchmarkRandom);
+	}
+
+	//Facing up, wound the way Recast counts as walkable
+	void AddQuad(std::vector<float>& verts, std::vector<unsigned int>& tris, const Vector3& a, const Vector3& b, const Vector3& c, const Vector3& d) {
+		unsigned int first = (unsigned int)(verts.size() / 3);
+		for (const Vector3& v : { a, b, c, d }) {
+			verts.insert(verts.end(), { v.x, v.y, v.z });
+		}
+		tris.insert(tris.end(), { first, first + 1, first + 2, first, first + 2, first + 3 });
+	}
+
+	void AddBox(std::vector<float>& verts, std::vector<unsigned int>& tris, const Vector3& min, const Vector3& max) {
+		AddQuad(verts, tris, Vector3(min.x, max.y, min.z), Vector3(min.x, max.y, max.z), Vector3(max.x, max.y, max.z), Vector3(max.x, max.y, min.z));
+		AddQuad(verts, tris, Vector3(min.x, min.y, min.z), Vector3(min.x, max.y, min.z), Vector3(max.x, max.y, min.z), Vector3(max.x, min.y, min.z));
+		AddQuad(verts, tris, Vector3(min.x, min.y, max.z), Vector3(max.x, min.y, max.z), Vector3(max.x, max.y, max.z), Vector3(min.x, max.y, max.z));
+		AddQuad(verts, tris, Vector3(min.x, min.y, min.z), Vector3(min.x, min.y, max.z), Vector3(min.x, max.y, max.z), Vector3(min.x, max.y, min.z));
+		AddQuad(verts, tris, Vector3(max.x, min.y, min.z), Vector3(max.x, max.y, min.z), Vector3(max.x, max.y, max.z), Vector3(max.x, min.y, max.z));
+	}
+
+	/*
+	A square of rooms joined by a random depth first walk, with some more
+	walls knocked through at random, as the floor and walls for RecastBuilder.
+	*/
+	void BuildBenchmarkMaze(std::vector<float>& verts, std::vector<unsigned int>& tris, unsigned int seed) {
+		const int rooms = BENCHMARK_MAZE_ROOMS;
+		const float size = rooms * BENCHMARK_ROOM_SIZE;
+		std::mt19937 random(seed);
+		std::uniform_real_distribution<float> chance(0.0f, 1.0f);
+
+		// whether each room's east and south walls are still standing
+		std::vector<bool> eastWalls(rooms * rooms, true);
+		std::vector<bool> southWalls(rooms * rooms, true);
+		std::vector<bool> visited(rooms * rooms, false);
+		std::vector<int> stack = { 0 };
+		visited[0] = true;
+		while (!stack.empty()) {
+			int room = stack.back();
+			int x = room % rooms;
+			int z = room / rooms;
+			int next[4];
+			int nextCount = 0;
+			if (x > 0 && !visited[room - 1])				next[nextCount++] = room - 1;
+			if (x < rooms - 1 && !visited[room + 1])		next[nextCount++] = room + 1;
+			if (z > 0 && !visited[room - rooms])			next[nextCount++] = room - rooms;
+			if (z < rooms - 1 && !visited[room + rooms])	next[nextCount++] = room + rooms;
+			if (nextCount == 0) {
+				stack.pop_back();
+				continue;
+			}
+			int chosen = next[std::uniform_int_distribution<int>(0, nextCount - 1)(random)];
+			int first = std::min(room, chosen);
+			if (std::abs(chosen - room) == 1) {
+				eastWalls[first] = false;
+			}
+			else {
+				southWalls[first] = false;
+			}
+			visited[chosen] = true;
+			stack.push_back(chosen);
+		}
+		for (int room = 0; room < rooms * rooms; ++room) {
+			if (chance(random) < BENCHMARK_EXTRA_DOOR_CHANCE) {
+				eastWalls[room] = false;
+			}
+			if (chance(random) < BENCHMARK_EXTRA_DOOR_CHANCE) {
+				southWalls[room] = false;
+			}
+		}
+
+		AddQuad(verts, tris, Vector3(0, 0, 0), Vector3(0, 0, size), Vector3(size, 0, size), Vector3(size, 0, 0));
+		const float half = BENCHMARK_WALL_THICKNESS * 0.5f;
+		const float height = BENCHMARK_WALL_HEIGHT;
+		AddBox(verts, tris, Vector3(-half, 0, -half), Vector3(size + half, height, half));
+		AddBox(verts, tris, Vector3(-half, 0, -half), Vector3(half, height, size + half));
+		for (int z = 0; z < rooms; ++z) {
+			for (int x = 0; x < rooms; ++x) {
+				int room = z * rooms + x;
+				float east = (x + 1) * BENCHMARK_ROOM_SIZE;
+				float south = (z + 1) * BENCHMARK_ROOM_SIZE;
+				// the outside walls stay up whatever the maze says
+				if (eastWalls[room] || x == rooms - 1) {
+					AddBox(verts, tris, Vector3(east - half, 0, south - BENCHMARK_ROOM_SIZE - half), Vector3(east + half, height, south + half));
+				}
+				if (southWalls[room] || z == rooms - 1) {
+					AddBox(verts, tris, Vector3(east - BENCHMARK_ROOM_SIZE - half, 0, south - half), Vector3(east + half, height, south + half));
+				}
+			}
+		}
+	}
+}
+
+CrowdManager::CrowdManager(dtNavMesh* navMesh, int maxAgents, float maxAgentRadius)
+	: mGrid(maxAgents, maxAgentRadius * GRID_CELL_RADII) {
+	mAgents.resize(std::max(maxAgents, 0));
+	mActiveCount = 0;
+	mPlanBudget = 0;
+
+	unsigned int queryCount = std::max(1u, JobSystem::GetJobSystem()->GetThreadCount());
+	for (unsigned int i = 0; i < queryCount; ++i) {
+		dtNavMeshQuery* query = dtAllocNavMeshQuery();
+		if (!query || dtStatusFailed(query->init(navMesh, QUERY_NODES))) {
+			std::cout << __FUNCTION__ << " can't create a navmesh query\n";
+			dtFreeNavMeshQuery(query);
+			continue;
+		}
+		mQueries.push_back(query);
+	}
+}
+
+CrowdManager::~CrowdManager() {
+	for (dtNavMeshQuery* query : mQueries) {
+		dtFreeNavMeshQuery(query);
+	}
+}
+
+int CrowdManager::AddAgent(const Vector3& position, const AgentParams& params) {
+	if (mQueries.empty()) {
+		return -1;
+	}
+	for (int i = 0; i < (int)mAgents.size(); ++i) {
+		if (mAgents[i].active) {
+			continue;
+		}
+		Agent& agent = mAgents[i];
+		agent = Agent();
+		// the query an agent is given decides which job thread works on its corridor
+		dtNavMeshQuery* query = mQueries[i % mQueries.size()];
+		agent.corridor.SetQuery(query);
+
+		dtPolyRef ref = 0;
+		Vector3 nearest;
+		query->findNearestPoly(&position.x, SEARCH_EXTENTS, &agent.corridor.GetFilter(), &ref, &nearest.x);
+		if (ref == 0) {
+			return -1;
+		}
+		agent.active = true;
+		agent.params = params;
+		agent.position = nearest;
+		agent.target = nearest;
+		mActiveCount++;
+		return i;
+	}
+	return -1;
+}
+
+void CrowdManager::RemoveAgent(int agent) {
+	if (agent < 0 || agent >= (int)mAgents.size() || !mAgents[agent].active) {
+		return;
+	}
+	mAgents[agent].active = false;
+	mAgents[agent].corridor.Clear();
+	mActiveCount--;
+}
+
+bool CrowdManager::RequestMoveTarget(int agent, const Vector3& target) {
+	if (agent < 0 || agent >= (int)mAgents.size() || !mAgents[agent].active) {
+		return false;
+	}
+	mAgents[agent].mode = Target;
+	mAgents[agent].target = target;
+	mAgents[agent].needsPlan = true;
+	return true;
+}
+
+void CrowdManager::RequestMoveVelocity(int agent, const Vector3& velocity) {
+	mAgents[agent].mode = Velocity;
+	mAgents[agent].desiredVelocity = Flat(velocity);
+	mAgents[agent].needsPlan = false;
+}
+
+void CrowdManager::ResetMove(int agent) {
+	mAgents[agent].mode = Idle;
+	mAgents[agent].desiredVelocity = Vector3();
+	mAgents[agent].needsPlan = false;
+}
+
+void CrowdManager::SetAgentPosition(int agent, const Vector3& position, const Vector3& velocity) {
+	mAgents[agent].position = position;
+	mAgents[agent].velocity = Flat(velocity);
+}
+
+void CrowdManager::ForEachAgentOnQueries(const std::function<void(Agent&, int)>& job) {
+	int queryCount = (int)mQueries.size();
+	auto run = [this, &job, queryCount](int query) {
+		for (size_t i = query; i < mAgents.size(); i += queryCount) {
+			if (mAgents[i].active) {
+				job(mAgents[i], (int)i);
+			}
+		}
+	};
+	JobSystem* jobSystem = JobSystem::GetJobSystem();
+	JobCounter counter;
+	for (int query = 1; query < queryCount; ++query) {
+		jobSystem->Submit([&run, query]() { run(query); }, &counter);
+	}
+	run(0);
+	jobSystem->Wait(counter);
+}
+
+void CrowdManager::ForEachAgent(const std::function<void(Agent&, int)>& job) {
+	JobSystem::GetJobSystem()->ParallelFor(mAgents.size(), AGENT_GRAIN, [this, &job](size_t begin, size_t end) {
+		for (size_t i = begin; i < end; ++i) {
+			if (mAgents[i].active) {
+				job(mAgents[i], (int)i);
+			}
+		}
+	});
+}
+
+/*
+Each phase reads what the one before wrote for every agent, so they run one
+after another, each spread across the job threads.
+*/
+void CrowdManager::Update(float dt) {
+	if (mActiveCount == 0 || dt <= 0.0f) {
+		return;
+	}
+	auto updateStart = std::chrono::high_resolution_clock::now();
+
+	mPlanBudget = MAX_PLANS_PER_UPDATE;
+	ForEachAgentOnQueries([this](Agent& agent, int) {
+		UpdatePath(agent);
+	});
+	mStats.plans += MAX_PLANS_PER_UPDATE - std::max(mPlanBudget.load(), 0);
+	double pathTime = MillisecondsSince(updateStart);
+
+	auto avoidanceStart = std::chrono::high_resolution_clock::now();
+	mGrid.Clear();
+	for (int i = 0; i < (int)mAgents.size(); ++i) {
+		if (mAgents[i].active) {
+			mGrid.AddItem(i, mAgents[i].position.x, mAgents[i].position.z);
+		}
+	}
+	ForEachAgent([this](Agent& agent, int index) {
+		FindNeighbours(agent, index);
+		ChooseVelocity(agent);
+	});
+	double avoidanceTime = MillisecondsSince(avoidanceStart);
+
+	auto moveStart = std::chrono::high_resolution_clock::now();
+	ForEachAgent([this, dt](Agent& agent, int) {
+		Integrate(agent, dt);
+	});
+	for (int i = 0; i < SEPARATION_ITERATIONS; ++i) {
+		ForEachAgent([this](Agent& agent, int index) {
+			FindSeparation(agent, index);
+		});
+		ForEachAgent([](Agent& agent, int) {
+			agent.position += agent.displacement;
+		});
+	}
+	ForEachAgentOnQueries([this](Agent& agent, int) {
+		MoveAlongNavMesh(agent);
+	});
+	double moveTime = MillisecondsSince(moveStart);
+
+	for (const Agent& agent : mAgents) {
+		mStats.neighbours += agent.active ? agent.neighbourCount : 0;
+	}
+	double updateTime = MillisecondsSince(updateStart);
+	mStats.ticks++;
+	mStats.pathTime += pathTime;
+	mStats.avoidanceTime += avoidanceTime;
+	mStats.moveTime += moveTime;
+	mStats.updateTime += updateTime;
+	mStats.maxUpdateTime = std::max(mStats.maxUpdateTime, updateTime);
+}
+
+/*
+Plans are shared out a few a tick, so a crowd all given targets at once
+starts moving over a handful of frames rather than stalling one. The desired
+velocity heads for the next corner, easing off on the last one.
+*/
+void CrowdManager::UpdatePath(Agent& agent) {
+	if (agent.mode != Target) {
+		if (agent.mode == Idle) {
+			agent.desiredVelocity = Vector3();
+		}
+		return;
+	}
+	// the corridor runs over polygons that have since been rebuilt
+	if (!agent.needsPlan && agent.corridor.HasPath() && !agent.corridor.IsValid()) {
+		agent.needsPlan = true;
+	}
+	if (agent.needsPlan) {
+		if (mPlanBudget.fetch_sub(1) <= 0) {
+			agent.desiredVelocity = Vector3();
+			return;
+		}
+		agent.needsPlan = false;
+		if (!agent.corridor.Plan(agent.position, agent.target)) {
+			agent.mode = Idle;
+			agent.desiredVelocity = Vector3();
+			return;
+		}
+	}
+
+	Vector3 corner;
+	if (!agent.corridor.GetNextCorner(corner)) {
+		agent.desiredVelocity = Vector3();
+		return;
+	}
+	Vector3 toCorner = Flat(corner - agent.position);
+	float distance = toCorner.Length();
+	if (distance < agent.params.radius * ARRIVAL_RADII) {
+		agent.desiredVelocity = Vector3();
+		return;
+	}
+	float speed = agent.params.maxSpeed;
+	if (FlatDistance(corner, agent.corridor.GetTarget()) < 0.01f) {
+		speed *= std::min(1.0f, distance / (agent.params.radius * SLOW_DOWN_RADII));
+	}
+	agent.desiredVelocity = toCorner * (speed / distance);
+}
+
+//The nearest few agents within the query range, closest first
+void CrowdManager::FindNeighbours(Agent& agent, int index) {
+	agent.neighbourCount = 0;
+	float range = agent.params.radius * COLLISION_QUERY_RADII;
+	int ids[MAX_QUERY_RESULTS];
+	int found = std::min(mGrid.QueryItems(agent.position.x, agent.position.z, range, ids, MAX_QUERY_RESULTS), MAX_QUERY_RESULTS);
+	for (int i = 0; i < found; ++i) {
+		if (ids[i] == index) {
+			continue;
+		}
+		const Agent& other = mAgents[ids[i]];
+		if (fabsf(other.position.y - agent.position.y) > NEIGHBOUR_HEIGHT) {
+			continue;
+		}
+		float dx = other.position.x - agent.position.x;
+		float dz = other.position.z - agent.position.z;
+		float distanceSquared = dx * dx + dz * dz;
+		if (distanceSquared > range * range) {
+			continue;
+		}
+		int slot = agent.neighbourCount;
+		while (slot > 0 && agent.neighbourDistances[slot - 1] > distanceSquared) {
+			if (slot < MAX_NEIGHBOURS) {
+				agent.neighbours[slot] = agent.neighbours[slot - 1];
+				agent.neighbourDistances[slot] = agent.neighbourDistances[slot - 1];
+			}
+			slot--;
+		}
+		if (slot < MAX_NEIGHBOURS) {
+			agent.neighbours[slot] = ids[i];
+			agent.neighbourDistances[slot] = distanceSquared;
+			agent.neighbourCount = std::min(agent.neighbourCount + 1, MAX_NEIGHBOURS);
+		}
+	}
+}
+
+/*
+Works out once what scoring a velocity needs of each neighbour, which is
+all of it but the candidate itself.
+*/
+int CrowdManager::PrepareObstacles(const Agent& agent, ObstacleCircle* circles) const {
+	for (int i = 0; i < agent.neighbourCount; ++i) {
+		const Agent& other = mAgents[agent.neighbours[i]];
+		ObstacleCircle& circle = circles[i];
+		circle.offsetX = other.position.x - agent.position.x;
+		circle.offsetZ = other.position.z - agent.position.z;
+		float reach = agent.params.radius + other.params.radius;
+		float distanceSquared = circle.offsetX * circle.offsetX + circle.offsetZ * circle.offsetZ;
+		circle.reachTerm = distanceSquared - reach * reach;
+		circle.velocityX = agent.velocity.x + other.velocity.x;
+		circle.velocityZ = agent.velocity.z + other.velocity.z;
+
+		float distance = sqrtf(distanceSquared);
+		circle.hasSide = distance > 0.0001f;
+		if (circle.hasSide) {
+			Vector3 toOther(circle.offsetX / distance, 0.0f, circle.offsetZ / distance);
+			// both sides agree which way round to pass from how they want to move
+			Vector3 desiredDifference = other.desiredVelocity - agent.desiredVelocity;
+			float area = desiredDifference.x * toOther.z - toOther.x * desiredDifference.z;
+			Vector3 normal = area < 0.01f ? Vector3(-toOther.z, 0.0f, toOther.x) : Vector3(toOther.z, 0.0f, -toOther.x);
+			circle.toOtherX = toOther.x;
+			circle.toOtherZ = toOther.z;
+			circle.normalX = normal.x;
+			circle.normalZ = normal.z;
+		}
+	}
+	return agent.neighbourCount;
+}
+
+//When the agent, moving at the relative velocity, is within reach of the circle
+bool CrowdManager::SweepCircle(const ObstacleCircle& circle, float relativeX, float relativeZ, float& tmin, float& tmax) {
+	float a = relativeX * relativeX + relativeZ * relativeZ;
+	if (a < FLT_EPSILON) {
+		return false;
+	}
+	float b = relativeX * circle.offsetX + relativeZ * circle.offsetZ;
+	float d = b * b - a * circle.reachTerm;
+	if (d < 0.0f) {
+		return false;
+	}
+	a = 1.0f / a;
+	float rd = sqrtf(d);
+	tmin = (b - rd) * a;
+	tmax = (b + rd) * a;
+	return true;
+}
+
+//Whether the velocity runs into, or stays inside, any of the circles before the horizon
+bool CrowdManager::HitsWithinHorizon(const ObstacleCircle* circles, int circleCount, const Vector3& candidate) {
+	for (int i = 0; i < circleCount; ++i) {
+		const ObstacleCircle& circle = circles[i];
+		float hitMin;
+		float hitMax;
+		if (SweepCircle(circle, candidate.x * 2.0f - circle.velocityX, candidate.z * 2.0f - circle.velocityZ, hitMin, hitMax) &&
+			hitMax > 0.0f && hitMin < HORIZON_TIME) {
+			return true;
+		}
+	}
+	return false;
+}
+
+/*
+Samples a ring of velocities around a point between standing still and the
+desired velocity, keeps the best, then samples a smaller ring around that,
+a few times over. The desired velocity is tried first and kept without
+sampling when it's clear of everyone for the whole horizon, and refining
+stops once the best is clear or no better than the centre it started from.
+*/
+void CrowdManager::ChooseVelocity(Agent& agent) {
+	agent.newVelocity = agent.desiredVelocity;
+	if (!(agent.params.flags & AvoidOthers) || agent.neighbourCount == 0) {
+		return;
+	}
+	ObstacleCircle circles[MAX_NEIGHBOURS];
+	int circleCount = PrepareObstacles(agent, circles);
+	if (!HitsWithinHorizon(circles, circleCount, agent.desiredVelocity)) {
+		return;
+	}
+
+	Vector3 direction = agent.desiredVelocity;
+	if (FlatDot(direction, direction) < 0.0001f) {
+		direction = agent.velocity;
+	}
+	float length = sqrtf(FlatDot(direction, direction));
+	float dirX = length > 0.0001f ? direction.x / length : 1.0f;
+	float dirZ = length > 0.0001f ? direction.z / length : 0.0f;
+
+	float maxSpeed = agent.params.maxSpeed;
+	float ringRadius = maxSpeed * (1.0f - VELOCITY_BIAS);
+	Vector3 centre = agent.desiredVelocity * VELOCITY_BIAS;
+	for (int depth = 0; depth < ADAPTIVE_DEPTH; ++depth) {
+		float minPenalty = FLT_MAX;
+		Vector3 best;
+		int bestSample = 0;
+		for (int i = 0; i < PATTERN_SIZE; ++i) {
+			// the pattern turned to face the way the agent wants to go
+			float x = samplePattern.x[i] * dirX - samplePattern.z[i] * dirZ;
+			float z = samplePattern.x[i] * dirZ + samplePattern.z[i] * dirX;
+			Vector3 candidate(centre.x + x * ringRadius, 0.0f, centre.z + z * ringRadius);
+			if (FlatDot(candidate, candidate) > (maxSpeed + 0.001f) * (maxSpeed + 0.001f)) {
+				continue;
+			}
+			float penalty = ScoreVelocity(agent, circles, circleCount, candidate, minPenalty);
+			if (penalty < minPenalty) {
+				minPenalty = penalty;
+				best = candidate;
+				bestSample = i;
+			}
+		}
+		centre = best;
+		ringRadius *= 0.5f;
+		if ((depth > 0 && bestSample == 0) || !HitsWithinHorizon(circles, circleCount, best)) {
+			break;
+		}
+	}
+	agent.newVelocity = centre;
+}
+
+/*
+Penalises straying from the desired and current velocities, passing others on
+the wrong side, and most of all how soon the candidate runs into someone.
+Each neighbour is assumed to take half the effort of avoiding, so the
+velocity is tested against the other's as though it were reflected through
+the candidate.
+*/
+float CrowdManager::ScoreVelocity(const Agent& agent, const ObstacleCircle* circles, int circleCount, const Vector3& candidate, float minPenalty) const {
+	float invMaxSpeed = 1.0f / agent.params.maxSpeed;
+	float desiredPenalty = WEIGHT_DESIRED * FlatDistance(candidate, agent.desiredVelocity) * invMaxSpeed;
+	float currentPenalty = WEIGHT_CURRENT * FlatDistance(candidate, agent.velocity) * invMaxSpeed;
+
+	// a hit any sooner than this puts the candidate past the best so far
+	float remaining = minPenalty - desiredPenalty - currentPenalty;
+	if (remaining <= 0.0f) {
+		return minPenalty;
+	}
+	float threshold = (WEIGHT_TIME_TO_HIT / remaining - 0.1f) * HORIZON_TIME;
+	if (threshold - HORIZON_TIME > -FLT_EPSILON) {
+		return minPenalty;
+	}
+
+	float timeToHit = HORIZON_TIME;
+	float side = 0.0f;
+	int sideCount = 0;
+	for (int i = 0; i < circleCount; ++i) {
+		const ObstacleCircle& circle = circles[i];
+		float relativeX = candidate.x * 2.0f - circle.velocityX;
+		float relativeZ = candidate.z * 2.0f - circle.velocityZ;
+		if (circle.hasSide) {
+			float ahead = (circle.toOtherX * relativeX + circle.toOtherZ * relativeZ) * 0.5f + 0.5f;
+			float across = (circle.normalX * relativeX + circle.normalZ * relativeZ) * 2.0f;
+			side += std::clamp(std::min(ahead, across), 0.0f, 1.0f);
+			sideCount++;
+		}
+
+		float hitMin;
+		float hitMax;
+		if (!SweepCircle(circle, relativeX, relativeZ, hitMin, hitMax)) {
+			continue;
+		}
+		// already overlapping, so moving apart is worth more the deeper it is
+		if (hitMin < 0.0f && hitMax > 0.0f) {
+			hitMin = -hitMin * 0.5f;
+		}
+		if (hitMin >= 0.0f && hitMin < timeToHit) {
+			timeToHit = hitMin;
+			if (timeToHit < threshold) {
+				return minPenalty;
+			}
+		}
+	}
+	if (sideCount > 0) {
+		side /= sideCount;
+	}
+	float sidePenalty = WEIGHT_SIDE * side;
+	float hitPenalty = WEIGHT_TIME_TO_HIT * (1.0f / (0.1f + timeToHit / HORIZON_TIME));
+	return desiredPenalty + currentPenalty + sidePenalty + hitPenalty;
+}
+
+void CrowdManager::Integrate(Agent& agent, float dt) {
+	Vector3 change = Flat(agent.newVelocity - agent.velocity);
+	float length = change.Length();
+	float maxChange = agent.params.maxAcceleration * dt;
+	if (length > maxChange) {
+		change = change * (maxChange / length);
+	}
+	agent.velocity = Flat(agent.velocity + change);
+	if (agent.mode != Velocity && agent.corridor.HasPath()) {
+		agent.position += agent.velocity * dt;
+	}
+}
+
+//Pushes the agent out of anyone it overlaps, half the way when they're pushed too
+void CrowdManager::FindSeparation(Agent& agent, int index) {
+	agent.displacement = Vector3();
+	if (!(agent.params.flags & Separate) || agent.mode == Velocity || !agent.corridor.HasPath()) {
+		return;
+	}
+	float weight = 0.0f;
+	for (int i = 0; i < agent.neighbourCount; ++i) {
+		int otherIndex = agent.neighbours[i];
+		const Agent& other = mAgents[otherIndex];
+		Vector3 difference = Flat(agent.position - other.position);
+		float combined = agent.params.radius + other.params.radius;
+		float distanceSquared = FlatDot(difference, difference);
+		if (distanceSquared > combined * combined) {
+			continue;
+		}
+		float distance = sqrtf(distanceSquared);
+		float push;
+		if (distance < 0.0001f) {
+			// right on top of each other, so they part sideways by index
+			difference = index > otherIndex ? Vector3(-agent.desiredVelocity.z, 0.0f, agent.desiredVelocity.x)
+				: Vector3(agent.desiredVelocity.z, 0.0f, -agent.desiredVelocity.x);
+			push = 0.01f;
+		}
+		else {
+			bool otherMoves = (other.params.flags & Separate) && other.mode != Velocity && other.corridor.HasPath();
+			push = (combined - distance) * (otherMoves ? 0.5f : 1.0f) * SEPARATION_FACTOR / distance;
+		}
+		agent.displacement += difference * push;
+		weight += 1.0f;
+	}
+	if (weight > 0.0f) {
+		agent.displacement = agent.displacement / weight;
+	}
+}
+
+//Slides the corridor to where the agent was pushed, which keeps it on the navmesh
+void CrowdManager::MoveAlongNavMesh(Agent& agent) {
+	if (agent.mode == Velocity || !agent.corridor.HasPath()) {
+		return;
+	}
+	if (!agent.corridor.MovePosition(agent.position)) {
+		agent.needsPlan = agent.mode == Target;
+	}
+	agent.position = agent.corridor.GetPosition();
+}
+
+void CrowdManager::RunBenchmark(int agentCount, int ticks, std::ostream& out) {
+	std::vector<float> verts;
+	std::vector<unsigned int> tris;
+	BuildBenchmarkMaze(verts, tris, 8503);
+	RecastBuilder builder;
+	delete[] builder.BuildNavMesh(std::move(verts), std::move(tris));
+	if (!builder.GetNavMesh()) {
+		out << "Crowd benchmark: the maze's navmesh didn't build\n";
+		return;
+	}
+	out << "Crowd benchmark: " << BENCHMARK_MAZE_ROOMS << "x" << BENCHMARK_MAZE_ROOMS << " room maze, "
+		<< builder.GetTileCount() << " navmesh tiles, " << ticks << " ticks, " << JobSystem::GetJobSystem()->GetThreadCount() << " threads\n";
+
+	double targetTick = BenchmarkCrowd(builder.GetNavMesh(), BENCHMARK_TARGET_AGENTS, ticks, out);
+	if (agentCount != BENCHMARK_TARGET_AGENTS) {
+		BenchmarkCrowd(builder.GetNavMesh(), agentCount, ticks, out);
+	}
+	out << "  target of " << BENCHMARK_TARGET_AGENTS << " agents in " << BENCHMARK_TARGET_TICK << "us a tick: ";
+	if (targetTick <= BENCHMARK_TARGET_TICK) {
+		out << "met\n";
+	}
+	else {
+		out << "missed, " << targetTick / BENCHMARK_TARGET_TICK << " times over\n";
+	}
+}
+
+double CrowdManager::BenchmarkCrowd(dtNavMesh* navMesh, int agentCount, int ticks, std::ostream& out) {
+	AgentParams params;
+	double avoidanceTick = 0.0;
+	out << "  " << agentCount << " agents\n";
+	for (int flags : { (int)AllFlags, (int)Separate }) {
+		benchmarkRandom.seed(8503);
+		params.flags = flags;
+		CrowdManager crowd(navMesh, agentCount, params.radius);
+		if (crowd.mQueries.empty()) {
+			return 0.0;
+		}
+		dtNavMeshQuery* query = crowd.mQueries[0];
+		// random points are drawn from the same polygons the agents walk
+		dtQueryFilter filter = crowd.mAgents[0].corridor.GetFilter();
+		auto randomPoint = [&]() {
+			dtPolyRef ref = 0;
+			Vector3 point;
+			query->findRandomPoint(&filter, BenchmarkRandom, &ref, &point.x);
+			return point;
+		};
+		for (int i = 0; i < agentCount; ++i) {
+			int agent = crowd.AddAgent(randomPoint(), params);
+			crowd.RequestMoveTarget(agent, randomPoint());
+		}
+
+		// overlaps are counted between every pair, away from the timed ticks
+		uint64_t overlaps = 0;
+		int samples = 0;
+		int arrivals = 0;
+		for (int tick = 0; tick < ticks; ++tick) {
+			crowd.Update(BENCHMARK_DT);
+			for (int i = 0; i < (int)crowd.mAgents.size(); ++i) {
+				Agent& agent = crowd.mAgents[i];
+				if (!agent.active) {
+					continue;
+				}
+				if (agent.mode == Idle || (!agent.needsPlan && FlatDistance(agent.position, agent.corridor.GetTarget()) < params.radius * 2.0f)) {
+					crowd.RequestMoveTarget(i, randomPoint());
+					arrivals++;
+				}
+			}
+			if (tick % BENCHMARK_OVERLAP_INTERVAL != 0) {
+				continue;
+			}
+			samples++;
+			for (size_t a = 0; a < crowd.mAgents.size(); ++a) {
+				for (size_t b = a + 1; b < crowd.mAgents.size(); ++b) {
+					const Agent& first = crowd.mAgents[a];
+					const Agent& second = crowd.mAgents[b];
+					float reach = (first.params.radius + second.params.radius) * 0.5f;
+					if (first.active && second.active && FlatDistance(first.position, second.position) < reach) {
+						overlaps++;
+					}
+				}
+			}
+		}
+
+		const Stats& stats = crowd.GetStats();
+		double perTick = 1000.0 / std::max<uint64_t>(stats.ticks, 1);
+		if (flags & AvoidOthers) {
+			avoidanceTick = stats.updateTime * perTick;
+		}
+		out << (flags & AvoidOthers ? "    with avoidance: " : "    separation only: ")
+			<< stats.updateTime * perTick << "us a tick, " << stats.maxUpdateTime * 1000.0 << "us worst "
+			<< "(paths " << stats.pathTime * perTick << "us, avoidance " << stats.avoidanceTime * perTick
+			<< "us, movement " << stats.moveTime * perTick << "us)\n"
+			<< "      " << stats.plans << " plans, " << arrivals << " arrivals, "
+			<< (double)stats.neighbours / std::max<uint64_t>(stats.ticks * crowd.GetAgentCount(), 1) << " neighbours each, "
+			<< (double)overlaps / std::max(samples, 1) << " pairs overlapping by half or more\n";
+	}
+	return avoidanceTick;
+}
@@ -0,0 +1,178 @@
+#pragma once
+#include "Vector3.h"
+#include "PathCorridor.h"
+#include "ProximityGrid.h"
+#include "JobSystem.h"
+
+#include <atomic>
+#include <functional>
+#include <iosfwd>
+#include <vector>
+
+namespace NCL {
+	using namespace NCL::Maths;
+	namespace CSC8503 {
+		/*
+		Moves a crowd of agents across the navmesh without them walking into
+		each other. Each tick every agent steers toward the next corner of
+		its path corridor, picks the velocity nearest that which won't run
+		into its neighbours soon, found by sampling velocities around it and
+		scoring each by time to collision (reciprocal velocity obstacles), and
+		is then nudged apart from anyone it still overlaps. Neighbours come from
+		a proximity grid rebuilt every tick.
+
+		Agents given a target are moved by the crowd and kept on the navmesh.
+		Agents given a velocity are moved by their owner, who reports where
+		they got to with SetAgentPosition; the crowd only works out a velocity
+		that avoids the others for them to take next.
+
+		The per-agent work runs on the job threads. Corridor work goes through
+		one dtNavMeshQuery per thread, as a query isn't safe to share.
+
+		Works in the same manner as Detour's dtCrowd, which isn't part of the
+		Detour library this project builds.
+		*/
+		class CrowdManager {
+		public:
+			static constexpr int MAX_NEIGHBOURS = 4;
+			static constexpr int MAX_PLANS_PER_UPDATE = 16;
+
+			enum AgentFlags {
+				AvoidOthers	= 1,
+				Separate	= 2,
+				AllFlags	= AvoidOthers | Separate
+			};
+
+			enum MoveMode {
+				Idle,
+				Target,
+				Velocity
+			};
+
+			struct AgentParams {
+				float	radius			= 1.0f;
+				float	maxSpeed		= 6.0f;
+				float	maxAcceleration	= 24.0f;
+				int		flags			= AllFlags;
+			};
+
+			struct Stats {
+				uint64_t	ticks			= 0;
+				uint64_t	plans			= 0;
+				uint64_t	neighbours		= 0;	//summed over every agent and tick
+				double		pathTime		= 0.0;	//milliseconds, wall clock
+				double		avoidanceTime	= 0.0;
+				double		moveTime		= 0.0;
+				double		updateTime		= 0.0;
+				double		maxUpdateTime	= 0.0;
+			};
+
+			CrowdManager(dtNavMesh* navMesh, int maxAgents, float maxAgentRadius);
+			~CrowdManager();
+
+			CrowdManager(const CrowdManager&) = delete;
+			CrowdManager& operator=(const CrowdManager&) = delete;
+
+			//Returns the agent's index, or -1 when the crowd is full or position is off the navmesh
+			int AddAgent(const Vector3& position, const AgentParams& params);
+			void RemoveAgent(int agent);
+
+			bool RequestMoveTarget(int agent, const Vector3& target);
+			void RequestMoveVelocity(int agent, const Vector3& velocity);
+			void ResetMove(int agent);
+			//For agents moved by their owner, where they are now and how fast they're going
+			void SetAgentPosition(int agent, const Vector3& position, const Vector3& velocity);
+
+			void Update(float dt);
+
+			const Vector3& GetAgentPosition(int agent) const {
+				return mAgents[agent].position;
+			}
+
+			const Vector3& GetAgentVelocity(int agent) const {
+				return mAgents[agent].velocity;
+			}
+
+			//The velocity the last Update chose, before acceleration was applied
+			const Vector3& GetAgentAvoidanceVelocity(int agent) const {
+				return mAgents[agent].newVelocity;
+			}
+
+			MoveMode GetAgentMoveMode(int agent) const {
+				return mAgents[agent].mode;
+			}
+
+			int GetAgentCount() const {
+				return mActiveCount;
+			}
+
+			const Stats& GetStats() const {
+				return mStats;
+			}
+
+			//Builds a maze's navmesh, needing no window or level, and sends
+			//agentCount agents to random points on it for the given number of
+			//ticks, with and without avoidance. Prints the cost of a tick and how
+			//often agents ended up overlapping, for agentCount and for the crowd's
+			//target size, and whether that target was met
+			static void RunBenchmark(int agentCount, int ticks, std::ostream& out);
+
+		protected:
+			struct Agent {
+				bool			active		= false;
+				MoveMode		mode		= Idle;
+				bool			needsPlan	= false;
+				AgentParams		params;
+				Vector3			position;
+				Vector3			velocity;
+				Vector3			desiredVelocity;
+				Vector3			newVelocity;
+				Vector3			displacement;
+				Vector3			target;
+				int				neighbours[MAX_NEIGHBOURS];
+				float			neighbourDistances[MAX_NEIGHBOURS];
+				int				neighbourCount = 0;
+				PathCorridor	corridor;
+			};
+
+			// a neighbour as velocity sampling sees it, relative to the agent
+			struct ObstacleCircle {
+				float	offsetX;
+				float	offsetZ;
+				float	reachTerm;	//squared distance less squared combined radius
+				float	velocityX;	//both agents' velocities summed
+				float	velocityZ;
+				float	toOtherX;
+				float	toOtherZ;
+				float	normalX;	//the side to pass on
+				float	normalZ;
+				bool	hasSide;
+			};
+
+			//Runs job for every active agent, split so each job thread has a query to itself
+			void ForEachAgentOnQueries(const std::function<void(Agent&, int)>& job);
+			void ForEachAgent(const std::function<void(Agent&, int)>& job);
+
+			void UpdatePath(Agent& agent);
+			void FindNeighbours(Agent& agent, int index);
+			int PrepareObstacles(const Agent& agent, ObstacleCircle* circles) const;
+			void ChooseVelocity(Agent& agent);
+			float ScoreVelocity(const Agent& agent, const ObstacleCircle* circles, int circleCount, const Vector3& candidate, float minPenalty) const;
+			static bool SweepCircle(const ObstacleCircle& circle, float relativeX, float relativeZ, float& tmin, float& tmax);
+			static bool HitsWithinHorizon(const ObstacleCircle* circles, int circleCount, const Vector3& candidate);
+			void Integrate(Agent& agent, float dt);
+			void FindSeparation(Agent& agent, int index);
+			void MoveAlongNavMesh(Agent& agent);
+
+			//Returns the microseconds a tick took with avoidance
+			static double BenchmarkCrowd(dtNavMesh* navMesh, int agentCount, int ticks, std::ostream& out);
+
+			std::vector<Agent>				mAgents;
+			std::vector<dtNavMeshQuery*>	mQueries;
+			ProximityGrid					mGrid;
+			int								mActiveCount;
+			std::atomic<int>				mPlanBudget;
+			Stats							mStats;
+		};
+	}
+}
@@ -1 +1,29 @@
 #include "Door.h"
+#include "RecastBuilder.h"
+
+using namespace NCL;
+using namespace CSC8503;
+
+Door::~Door() {
+	Open();
+}
+
+void Door::Open() {
+	if (mNavMesh) {
+		mNavMesh->RemoveObstacle(mObstacle);
+	}
+	mObstacle = 0;
+	mIsOpen = true;
+}
+
+void Door::Close() {
+	if (!mIsOpen) {
+		return;
+	}
+	mIsOpen = false;
+	if (mNavMesh) {
+		// doors only ever turn about y, so their x axis gives the angle
+		Vector3 axis = GetTransform().GetOrientation() * Vector3(1, 0, 0);
+		mObstacle = mNavMesh->AddObstacle(GetTransform().GetPosition(), GetTransform().GetScale() * 0.5f, atan2f(-axis.z, axis.x));
+	}
+}
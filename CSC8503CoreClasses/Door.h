@@ -1,14 +1,40 @@
 #pragma once
 #include "GameObject.h"
+#include "../DetourTileCache/Include/DetourTileCache.h"
 
 namespace NCL {
 	namespace CSC8503 {
+		class RecastBuilder;
+
+		/*
+		A closed door is an obstacle on the navmesh, so guards path around it
+		rather than through. Doors start open, and the tiles under one are
+		rebuilt a few frames after it opens or closes.
+		*/
 		class Door : public GameObject {
 		public:
+			static constexpr GameObjectType Type = GameObjectType::Door;
+
 			Door(){
 				mName = "Door";
+				mObjectType = Type;
+				mIsOpen = true;
+				mNavMesh = nullptr;
+				mObstacle = 0;
 			}
+			~Door();
+
+			void SetNavMesh(RecastBuilder* navMesh) {
+				mNavMesh = navMesh;
+			}
+
+			void Open();
+			void Close();
+			bool IsOpen() const { return mIsOpen; }
 		protected:
+			bool mIsOpen;
+			RecastBuilder* mNavMesh;
+			dtObstacleRef mObstacle;
 		};
 	}
 }
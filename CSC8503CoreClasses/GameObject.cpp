@@ -4,6 +4,7 @@
 #include "RenderObject.h"
 #include "NetworkObject.h"
 #include "AnimationObject.h"
+#include "GameWorld.h"
 
 using namespace NCL::CSC8503;
 
@@ -13,25 +14,152 @@ GameObject::GameObject(CollisionLayer collisionLayer, const std::string& objectN
 	mWorldID			= -1;
 	mIsRendered		= true;
 	mHasPhysics		= true;
+	mIsActive		= true;
 	mBoundingVolume	= nullptr;
-	mPhysicsObject	= nullptr;
-	mRenderObject	= nullptr;
 	mNetworkObject	= nullptr;
-
-	mAnimationObject = nullptr;
+	mGameWorld		= nullptr;
 	mCollisionLayer = collisionLayer;
-
+	mObjectType		= GameObjectType::Default;
 
 	mIsPlayer = false;
 }
 
 GameObject::~GameObject()	{
 	delete mBoundingVolume;
-	delete mPhysicsObject;
-	delete mRenderObject;
+	delete mDetached.physicsObject;
+	delete mDetached.renderObject;
 	delete mNetworkObject;
-	delete mAnimationObject;
+	delete mDetached.animationObject;
+
+}
+
+Transform& GameObject::GetTransform() {
+	if (mGameWorld) {
+		return *mGameWorld->GetComponentPool<Transform>().Get(mWorldID);
+	}
+	return mDetached.transform;
+}
+
+RenderObject* GameObject::GetRenderObject() const {
+	if (mGameWorld) {
+		return mGameWorld->GetComponentPool<RenderObject>().Get(mWorldID);
+	}
+	return mDetached.renderObject;
+}
+
+PhysicsObject* GameObject::GetPhysicsObject() const {
+	if (mGameWorld) {
+		return mGameWorld->GetComponentPool<PhysicsObject>().Get(mWorldID);
+	}
+	return mDetached.physicsObject;
+}
+
+AnimationObject* GameObject::GetAnimationObject() const {
+	if (mGameWorld) {
+		return mGameWorld->GetComponentPool<AnimationObject>().Get(mWorldID);
+	}
+	return mDetached.animationObject;
+}
+
+ComponentHandle<Transform> GameObject::GetTransformHandle() const {
+	return mGameWorld ? mGameWorld->GetComponentPool<Transform>().GetHandle(mWorldID) : ComponentHandle<Transform>();
+}
+
+ComponentHandle<RenderObject> GameObject::GetRenderHandle() const {
+	return mGameWorld ? mGameWorld->GetComponentPool<RenderObject>().GetHandle(mWorldID) : ComponentHandle<RenderObject>();
+}
+
+ComponentHandle<PhysicsObject> GameObject::GetPhysicsHandle() const {
+	return mGameWorld ? mGameWorld->GetComponentPool<PhysicsObject>().GetHandle(mWorldID) : ComponentHandle<PhysicsObject>();
+}
+
+ComponentHandle<AnimationObject> GameObject::GetAnimationHandle() const {
+	return mGameWorld ? mGameWorld->GetComponentPool<AnimationObject>().GetHandle(mWorldID) : ComponentHandle<AnimationObject>();
+}
+
+void GameObject::SetRenderObject(RenderObject* newObject) {
+	if (mGameWorld) {
+		mGameWorld->SetComponent(this, newObject);
+		return;
+	}
+	if (mDetached.renderObject != newObject) {
+		delete mDetached.renderObject;
+	}
+	mDetached.renderObject = newObject;
+}
+
+void GameObject::SetPhysicsObject(PhysicsObject* newObject) {
+	if (mGameWorld) {
+		mGameWorld->SetComponent(this, newObject);
+		return;
+	}
+	if (mDetached.physicsObject != newObject) {
+		delete mDetached.physicsObject;
+	}
+	mDetached.physicsObject = newObject;
+}
+
+void GameObject::SetAnimationObject(AnimationObject* newObject) {
+	if (mGameWorld) {
+		mGameWorld->SetComponent(this, newObject);
+		return;
+	}
+	if (mDetached.animationObject != newObject) {
+		delete mDetached.animationObject;
+	}
+	mDetached.animationObject = newObject;
+}
+
+void GameObject::SetIsSensed(bool sensed) {
+	GetRenderObject()->SetOutlined(sensed);
+}
+
+bool GameObject::GetIsSensed() {
+	return GetRenderObject()->GetOutlined();
+}
+
+void GameObject::SetCollisionLayer(CollisionLayer collisionLayer) {
+	mCollisionLayer = collisionLayer;
+	if (mGameWorld) {
+		mGameWorld->UpdateIndices(this);
+	}
+}
+
+void GameObject::SetActive(bool isActive) {
+	if (mIsActive == isActive) {
+		return;
+	}
+	mIsActive = isActive;
+	if (mGameWorld) {
+		mGameWorld->UpdateIndices(this);
+	}
+}
 
+void GameObject::SaveState() {
+	Transform& transform = GetTransform();
+	mSavedState.position	= transform.GetPosition();
+	mSavedState.orientation	= transform.GetOrientation();
+	mSavedState.scale		= transform.GetScale();
+	mSavedState.isRendered	= mIsRendered;
+	mSavedState.hasPhysics	= mHasPhysics;
+	if (PhysicsObject* physicsObject = GetPhysicsObject()) {
+		mSavedState.linearVelocity	= physicsObject->GetLinearVelocity();
+		mSavedState.angularVelocity	= physicsObject->GetAngularVelocity();
+	}
+}
+
+void GameObject::RestoreState() {
+	GetTransform()
+		.SetPosition(mSavedState.position)
+		.SetOrientation(mSavedState.orientation)
+		.SetScale(mSavedState.scale);
+	mIsRendered = mSavedState.isRendered;
+	mHasPhysics = mSavedState.hasPhysics;
+	if (PhysicsObject* physicsObject = GetPhysicsObject()) {
+		physicsObject->SetLinearVelocity(mSavedState.linearVelocity);
+		physicsObject->SetAngularVelocity(mSavedState.angularVelocity);
+		physicsObject->ClearForces();
+	}
 }
 
 bool GameObject::GetBroadphaseAABB(Vector3&outSize) const {
@@ -54,7 +182,7 @@ void GameObject::UpdateBroadphaseAABB() {
 		mBroadphaseAABB = Vector3(r, r, r);
 	}
 	else if (mBoundingVolume->type == VolumeType::OBB) {
-		Matrix3 mat = Matrix3(mTransform.GetOrientation());
+		Matrix3 mat = Matrix3(GetTransform().GetOrientation());
 		mat = mat.Absolute();
 		Vector3 halfSizes = ((OBBVolume&)*mBoundingVolume).GetHalfDimensions();
 		mBroadphaseAABB = mat * halfSizes;
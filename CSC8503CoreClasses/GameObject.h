@@ -2,6 +2,7 @@
 #include "Transform.h"
 #include "CollisionVolume.h"
 #include "RenderObject.h"
+#include "ComponentPool.h"
 
 using std::vector;
 
@@ -10,6 +11,7 @@ namespace NCL::CSC8503 {
 	class RenderObject;
 	class PhysicsObject;
 	class AnimationObject;
+	class GameWorld;
 
 	enum CollisionLayer {
 		StaticObj = 1,
@@ -21,8 +23,25 @@ namespace NCL::CSC8503 {
 		NoSpecialFeatures = 64
 	};
 
+	//Used by GameWorld to bucket objects by their concrete type. Subclasses set
+	//mObjectType in their constructor and expose it as a static Type member.
+	enum class GameObjectType {
+		Default,
+		Player,
+		Guard,
+		Door,
+		Vent,
+		Helipad,
+		Item,
+		Pickup,
+		SoundEmitter,
+		MaxTypes
+	};
+
 	class GameObject	{
 	public:
+		static constexpr GameObjectType Type = GameObjectType::Default;
+
 		GameObject(CollisionLayer = NoSpecialFeatures, const std::string& name = "");
 		~GameObject();
 
@@ -58,47 +77,59 @@ namespace NCL::CSC8503 {
 			mHasPhysics = !mHasPhysics;
 		}
 
-		Transform& GetTransform() {
-			return mTransform;
+		//False while the object sits idle in a GameObjectPool. It stays in the world
+		//with its components in place, but world queries, physics, raycasts,
+		//rendering and animation all pass over it.
+		bool IsActive() const {
+			return mIsActive;
 		}
 
-		RenderObject* GetRenderObject() const {
-			return mRenderObject;
-		}
+		void SetActive(bool isActive);
 
-		PhysicsObject* GetPhysicsObject() const {
-			return mPhysicsObject;
-		}
+		//While the object is in a world its components live in the world's pools,
+		//so these look them up by world ID rather than keeping pointers. What they
+		//return is only good until the pool next changes; anything kept across
+		//frames should use the Get*Handle versions, which assert once stale.
+		Transform& GetTransform();
+
+		RenderObject* GetRenderObject() const;
+
+		PhysicsObject* GetPhysicsObject() const;
 
 		NetworkObject* GetNetworkObject() const {
 			return mNetworkObject;
 		}
 
-		void SetIsSensed(bool sensed) {
-			mRenderObject->SetOutlined(sensed);
-		}
+		void SetIsSensed(bool sensed);
 
-		bool GetIsSensed() {
-			return mRenderObject->GetOutlined();
-		}
+		bool GetIsSensed();
 
     
     void SetNetworkObject(NetworkObject* netObj) { mNetworkObject = netObj; }
     
-		AnimationObject* GetAnimationObject() const {
-			return mAnimationObject;
-		}
+		AnimationObject* GetAnimationObject() const;
 
-		void SetRenderObject(RenderObject* newObject) {
-			mRenderObject = newObject;
-		}
+		//Empty while the object isn't in a world
+		ComponentHandle<Transform>			GetTransformHandle() const;
+		ComponentHandle<RenderObject>		GetRenderHandle() const;
+		ComponentHandle<PhysicsObject>		GetPhysicsHandle() const;
+		ComponentHandle<AnimationObject>	GetAnimationHandle() const;
+
+		//The object takes ownership of newObject. Once the object is in a world,
+		//newObject is moved into the world's pool and deleted here, so the pointer
+		//passed in is dangling as soon as this returns; use Get*Object or a handle.
+		void SetRenderObject(RenderObject* newObject);
+
+		void SetPhysicsObject(PhysicsObject* newObject);
 
-		void SetPhysicsObject(PhysicsObject* newObject) {
-			mPhysicsObject = newObject;
+		void SetAnimationObject(AnimationObject* newObject);
+
+		void SetGameWorld(GameWorld* world) {
+			mGameWorld = world;
 		}
 
-		void SetAnimationObject(AnimationObject* newObject) {
-			mAnimationObject = newObject;
+		GameWorld* GetGameWorld() const {
+			return mGameWorld;
 		}
 
 		const std::string& GetName() const {
@@ -129,33 +160,64 @@ namespace NCL::CSC8503 {
 
 		bool GetIsPlayer() { return mIsPlayer; }
 
-		CollisionLayer GetCollisionLayer() {
+		CollisionLayer GetCollisionLayer() const {
 			return mCollisionLayer;
 		}
 
-		void SetCollisionLayer(CollisionLayer collisionLayer) {
-			mCollisionLayer = collisionLayer;
+		void SetCollisionLayer(CollisionLayer collisionLayer);
+
+		GameObjectType GetObjectType() const {
+			return mObjectType;
 		}
 
+		//Records the object as it is now so a level restart can put it back
+		//without rebuilding it. Subclasses add any gameplay state they keep.
+		virtual void SaveState();
+		virtual void RestoreState();
+
 	protected:
-		Transform			mTransform;
+		struct SavedState {
+			Vector3		position;
+			Quaternion	orientation;
+			Vector3		scale;
+			Vector3		linearVelocity;
+			Vector3		angularVelocity;
+			bool		isRendered;
+			bool		hasPhysics;
+		};
 
 		CollisionVolume*	mBoundingVolume;
-		PhysicsObject*		mPhysicsObject;
-		RenderObject*		mRenderObject;
 		NetworkObject*		mNetworkObject;
-		AnimationObject*    mAnimationObject;
+		GameWorld*			mGameWorld;
 
 		bool		mIsSensed;
 		bool		mHasPhysics;
 		bool		mIsRendered;
+		bool		mIsActive;
 		int			mWorldID;
 		std::string	mName;
 
 		Vector3 mBroadphaseAABB;
 
 		CollisionLayer mCollisionLayer;
+		GameObjectType mObjectType;
 		bool mIsPlayer;
+
+		SavedState mSavedState;
+
+	private:
+		friend class GameWorld;
+
+		//Where the components are kept while the object isn't in a world. GameWorld
+		//moves them into its pools when the object is added and back when it's removed.
+		struct DetachedComponents {
+			Transform			transform;
+			PhysicsObject*		physicsObject	= nullptr;
+			RenderObject*		renderObject	= nullptr;
+			AnimationObject*	animationObject	= nullptr;
+		};
+
+		DetachedComponents mDetached;
 	};
 }
 
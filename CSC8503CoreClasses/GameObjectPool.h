@@ -0,0 +1,144 @@
+#pragma once
+#include "GameWorld.h"
+#include "PhysicsSystem.h"
+
+#include <cassert>
+#include <unordered_map>
+
+namespace NCL {
+	namespace CSC8503 {
+		/*
+		Fixed set of fully built objects of one type, created when a level loads.
+		Every object is added to the world once, up front, and stays there with
+		its components in place. Acquire and Release only flip the object's
+		active flag, which takes it in and out of the world's queries, physics,
+		raycasts, rendering and animation, so neither touches the heap, the
+		world's object list or its component pools. The world owns the objects
+		and deletes them with everything else when the level is cleared.
+		*/
+		template<class T>
+		class GameObjectPool {
+		public:
+			GameObjectPool() {
+				mWorld = nullptr;
+				mPhysics = nullptr;
+				mHighWaterMark = 0;
+			}
+			~GameObjectPool() {
+				Clear();
+			}
+
+			void Initialise(GameWorld& world, PhysicsSystem& physics, size_t capacity, const std::function<T*()>& create) {
+				Clear();
+				mWorld = &world;
+				mPhysics = &physics;
+				mObjects.reserve(capacity);
+				mActive.reserve(capacity);
+				mFree.reserve(capacity);
+				mIndices.reserve(capacity);
+				for (size_t i = 0; i < capacity; ++i) {
+					T* object = create();
+					//Added active, so the world's indices already have room for it when it is acquired
+					mWorld->AddGameObject(object);
+					object->SetActive(false);
+					mIndices.emplace(object, (int)i);
+					mObjects.emplace_back(object);
+					mActive.emplace_back(false);
+				}
+				for (size_t i = capacity; i > 0; --i) {
+					mFree.emplace_back((int)i - 1);
+				}
+			}
+
+			//Returns nullptr once every object is in use
+			T* Acquire() {
+				if (mFree.empty()) {
+					return nullptr;
+				}
+				int index = mFree.back();
+				mFree.pop_back();
+				mActive[index] = true;
+				mHighWaterMark = std::max(mHighWaterMark, GetActiveCount());
+
+				T* object = mObjects[index];
+				[[maybe_unused]] WorldSize before = GetWorldSize();
+				object->SetActive(true);
+				assert(GetWorldSize() == before && "Acquiring a pooled object resized the world");
+				return object;
+			}
+
+			void Release(T* object) {
+				auto i = mIndices.find(object);
+				if (i == mIndices.end() || !mActive[i->second]) {
+					return;
+				}
+				[[maybe_unused]] WorldSize before = GetWorldSize();
+				mPhysics->RemoveCollisionsWith(object);
+				object->SetActive(false);
+				assert(GetWorldSize() == before && "Releasing a pooled object resized the world");
+				mActive[i->second] = false;
+				mFree.emplace_back(i->second);
+			}
+
+			void ReleaseAll() {
+				for (size_t i = 0; i < mObjects.size(); ++i) {
+					if (mActive[i]) {
+						Release(mObjects[i]);
+					}
+				}
+			}
+
+			template<typename F>
+			void ForEachActive(F func) {
+				for (size_t i = 0; i < mObjects.size(); ++i) {
+					if (mActive[i]) {
+						func(mObjects[i]);
+					}
+				}
+			}
+
+			//Forgets the objects, which are left for the world to delete
+			void Clear() {
+				mObjects.clear();
+				mActive.clear();
+				mFree.clear();
+				mIndices.clear();
+				mHighWaterMark = 0;
+			}
+
+			size_t GetCapacity() const {
+				return mObjects.size();
+			}
+
+			size_t GetActiveCount() const {
+				return mObjects.size() - mFree.size();
+			}
+
+			size_t GetHighWaterMark() const {
+				return mHighWaterMark;
+			}
+
+		protected:
+			//What Acquire and Release must leave alone: the world's object list, and
+			//how many world IDs its component pools are sized for
+			struct WorldSize {
+				size_t objects;
+				size_t entities;
+
+				bool operator==(const WorldSize& other) const = default;
+			};
+
+			WorldSize GetWorldSize() const {
+				return { mWorld->GetObjectCount(), mWorld->GetEntityCapacity() };
+			}
+
+			GameWorld*						mWorld;
+			PhysicsSystem*					mPhysics;
+			std::vector<T*>					mObjects;
+			std::vector<bool>				mActive;
+			std::vector<int>				mFree;
+			std::unordered_map<const T*, int>	mIndices;
+			size_t							mHighWaterMark;
+		};
+	}
+}
@@ -3,6 +3,10 @@
 #include "Constraint.h"
 #include "CollisionDetection.h"
 #include "Camera.h"
+#include "PhysicsObject.h"
+#include "RenderObject.h"
+#include "AnimationObject.h"
+#include "JobSystem.h"
 
 
 using namespace NCL;
@@ -19,8 +23,21 @@ GameWorld::~GameWorld()	{
 }
 
 void GameWorld::Clear() {
+	for (auto& i : gameObjects) {
+		DetachComponents(i);
+	}
 	gameObjects.clear();
 	constraints.clear();
+	transformPool.Clear();
+	physicsPool.Clear();
+	renderPool.Clear();
+	animationPool.Clear();
+	for (auto& i : typeIndex) {
+		i.Clear();
+	}
+	for (auto& i : layerIndex) {
+		i.Clear();
+	}
 	worldIDCounter		= 0;
 	worldStateCounter	= 0;
 }
@@ -29,6 +46,7 @@ void GameWorld::ClearAndErase() {
 	for (auto& i : gameObjects) {
 		delete i;
 	}
+	gameObjects.clear();
 	for (auto& i : constraints) {
 		delete i;
 	}
@@ -38,17 +56,126 @@ void GameWorld::ClearAndErase() {
 void GameWorld::AddGameObject(GameObject* o) {
 	gameObjects.emplace_back(o);
 	o->SetWorldID(worldIDCounter++);
+	AttachComponents(o);
+	UpdateIndices(o);
 	worldStateCounter++;
 }
 
 void GameWorld::RemoveGameObject(GameObject* o, bool andDelete) {
 	gameObjects.erase(std::remove(gameObjects.begin(), gameObjects.end(), o), gameObjects.end());
+	RemoveIndices(o);
+	DetachComponents(o);
 	if (andDelete) {
 		delete o;
 	}
 	worldStateCounter++;
 }
 
+namespace {
+	template<class T>
+	void MoveIntoPool(ComponentPool<T>& pool, GameObject* o, T*& component) {
+		if (component) {
+			pool.Insert(o->GetWorldID(), o, std::move(*component));
+			delete component;
+			component = nullptr;
+		}
+	}
+
+	template<class T>
+	void MoveOutOfPool(ComponentPool<T>& pool, GameObject* o, T*& component) {
+		if (T* pooled = pool.Get(o->GetWorldID())) {
+			component = new T(std::move(*pooled));
+			pool.Remove(o->GetWorldID());
+		}
+	}
+
+	template<class T>
+	void ReplaceInPool(ComponentPool<T>& pool, GameObject* o, T* component) {
+		if (component) {
+			MoveIntoPool(pool, o, component);
+		}
+		else {
+			pool.Remove(o->GetWorldID());
+		}
+	}
+}
+
+/*
+Moves the components the object was built with into the world's pools. From
+here until it is removed, the object finds them again through its world ID.
+*/
+void GameWorld::AttachComponents(GameObject* o) {
+	GameObject::DetachedComponents& detached = o->mDetached;
+	transformPool.Insert(o->GetWorldID(), o, detached.transform);
+	MoveIntoPool(physicsPool, o, detached.physicsObject);
+	MoveIntoPool(renderPool, o, detached.renderObject);
+	MoveIntoPool(animationPool, o, detached.animationObject);
+	o->SetGameWorld(this);
+}
+
+//Hands the components back to the object, so it can be added to a world again later
+void GameWorld::DetachComponents(GameObject* o) {
+	GameObject::DetachedComponents& detached = o->mDetached;
+	if (Transform* transform = transformPool.Get(o->GetWorldID())) {
+		detached.transform = *transform;
+		transformPool.Remove(o->GetWorldID());
+	}
+	MoveOutOfPool(physicsPool, o, detached.physicsObject);
+	MoveOutOfPool(renderPool, o, detached.renderObject);
+	MoveOutOfPool(animationPool, o, detached.animationObject);
+	o->SetGameWorld(nullptr);
+}
+
+void GameWorld::SetComponent(GameObject* o, PhysicsObject* component) {
+	ReplaceInPool(physicsPool, o, component);
+}
+
+void GameWorld::SetComponent(GameObject* o, RenderObject* component) {
+	ReplaceInPool(renderPool, o, component);
+}
+
+void GameWorld::SetComponent(GameObject* o, AnimationObject* component) {
+	ReplaceInPool(animationPool, o, component);
+}
+
+/*
+Rebuilds every stale transform matrix in one pass over the packed transform
+pool, so the renderer never pays for a lazy rebuild mid-draw.
+*/
+void GameWorld::UpdateTransforms() {
+	std::vector<Transform>& transforms = transformPool.GetComponents();
+	JobSystem::GetJobSystem()->ParallelFor(transforms.size(), 256, [&](size_t begin, size_t end) {
+		Transform::UpdateMatrices(transforms.data() + begin, end - begin);
+	});
+}
+
+/*
+Files the object under its type tag and collision layer, so Query<T>() and
+ByLayer() can hand back packed lists without any string or RTTI checks.
+GameObject calls this again whenever its collision layer changes, and when it
+is activated or deactivated, as inactive objects are left out of both.
+*/
+void GameWorld::UpdateIndices(GameObject* o) {
+	RemoveIndices(o);
+	if (!o->IsActive()) {
+		return;
+	}
+	int id = o->GetWorldID();
+	typeIndex[(int)o->GetObjectType()].Insert(id, o, o);
+	int layer = LayerToIndex(o->GetCollisionLayer());
+	if (layer < MAX_COLLISION_LAYERS) {
+		layerIndex[layer].Insert(id, o, o);
+	}
+}
+
+void GameWorld::RemoveIndices(GameObject* o) {
+	int id = o->GetWorldID();
+	typeIndex[(int)o->GetObjectType()].Remove(id);
+	for (int i = 0; i < MAX_COLLISION_LAYERS; i++) {
+		layerIndex[i].Remove(id);
+	}
+}
+
 void GameWorld::GetObjectIterators(
 	GameObjectIterator& first,
 	GameObjectIterator& last) const {
@@ -83,7 +210,7 @@ bool GameWorld::Raycast(Ray& r, RayCollision& closestCollision, bool closestObje
 	RayCollision collision;
 
 	for (auto& i : gameObjects) {
-		if (!i->GetBoundingVolume()) { //objects might not be collideable etc...
+		if (!i->GetBoundingVolume() || !i->IsActive()) { //objects might not be collideable etc...
 			continue;
 		}
 		if (i == ignoreThis) {
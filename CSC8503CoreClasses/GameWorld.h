@@ -1,15 +1,22 @@
 #pragma once
 #include <random>
+#include <bit>
 
 #include "Ray.h"
 #include "CollisionDetection.h"
 #include "QuadTree.h"
+#include "ComponentPool.h"
+#include "ObjectQuery.h"
 namespace NCL {
 		class Camera;
 		using Maths::Ray;
 	namespace CSC8503 {
 		class GameObject;
 		class Constraint;
+		class Transform;
+		class PhysicsObject;
+		class RenderObject;
+		class AnimationObject;
 
 		typedef std::function<void(GameObject*)> GameObjectFunc;
 		typedef std::vector<GameObject*>::const_iterator GameObjectIterator;
@@ -58,7 +65,75 @@ namespace NCL {
 				return worldStateCounter;
 			}
 
+			size_t GetObjectCount() const {
+				return gameObjects.size();
+			}
+
+			//How many world IDs the component pools are sized for. Every object has a
+			//transform, so this only grows as objects are added.
+			size_t GetEntityCapacity() const {
+				return transformPool.GetSparseSize();
+			}
+
+			//Called by GameObject when it is given a new component while in the world.
+			//The component is moved into the pool and then deleted.
+			void SetComponent(GameObject* o, PhysicsObject* component);
+			void SetComponent(GameObject* o, RenderObject* component);
+			void SetComponent(GameObject* o, AnimationObject* component);
+
+			void UpdateTransforms();
+
+			void UpdateIndices(GameObject* o);
+
+			//All objects in the world tagged with T::Type, e.g. Query<GuardObject>()
+			template<class T>
+			ObjectQuery<T> Query() const {
+				return ObjectQuery<T>(typeIndex[(int)T::Type].GetComponents());
+			}
+
+			//All objects on a single collision layer, e.g. ByLayer(Player)
+			std::span<GameObject* const> ByLayer(CollisionLayer layer) const {
+				return layerIndex[LayerToIndex(layer)].GetComponents();
+			}
+
+			template<class T>
+			ComponentPool<T>& GetComponentPool();
+
+			/*
+			Calls f(GameObject*, First&, Rest&...) for every object that has all of
+			the requested components. Iteration walks the dense pool of the first
+			type, so list the rarest component first.
+			*/
+			template<class First, class... Rest, class Func>
+			void OperateOnComponents(Func f) {
+				ComponentPool<First>& pool = GetComponentPool<First>();
+				for (size_t i = 0; i < pool.Size(); ++i) {
+					int entity = pool.GetEntity(i);
+					if ((GetComponentPool<Rest>().Contains(entity) && ...)) {
+						f(pool.GetOwner(i), pool.GetComponent(i), *GetComponentPool<Rest>().Get(entity)...);
+					}
+				}
+			}
+
 		protected:
+			void AttachComponents(GameObject* o);
+			void DetachComponents(GameObject* o);
+			void RemoveIndices(GameObject* o);
+
+			static int LayerToIndex(CollisionLayer layer) {
+				return std::countr_zero((unsigned int)layer);
+			}
+
+			static const int MAX_COLLISION_LAYERS = 7;
+
+			ComponentPool<Transform>		transformPool;
+			ComponentPool<PhysicsObject>	physicsPool;
+			ComponentPool<RenderObject>		renderPool;
+			ComponentPool<AnimationObject>	animationPool;
+
+			ComponentPool<GameObject*>	typeIndex[(int)GameObjectType::MaxTypes];
+			ComponentPool<GameObject*>	layerIndex[MAX_COLLISION_LAYERS];
+
 			std::vector<GameObject*> gameObjects;
 			std::vector<Constraint*> constraints;
 
@@ -69,6 +144,26 @@ namespace NCL {
 			int		worldIDCounter;
 			int		worldStateCounter;
 		};
+
+		template<>
+		inline ComponentPool<Transform>& GameWorld::GetComponentPool<Transform>() {
+			return transformPool;
+		}
+
+		template<>
+		inline ComponentPool<PhysicsObject>& GameWorld::GetComponentPool<PhysicsObject>() {
+			return physicsPool;
+		}
+
+		template<>
+		inline ComponentPool<RenderObject>& GameWorld::GetComponentPool<RenderObject>() {
+			return renderPool;
+		}
+
+		template<>
+		inline ComponentPool<AnimationObject>& GameWorld::GetComponentPool<AnimationObject>() {
+			return animationPool;
+		}
 	}
 }
 
@@ -4,31 +4,120 @@
 #include "Debug.h"
 #include "PhysicsObject.h"
 #include "BehaviourSelector.h"
+#include "CrowdManager.h"
 
 using namespace NCL;
 using namespace CSC8503;
 
+namespace {
+	// a target that moves less than this a frame drags the corridor along,
+	// further and it's somewhere new that needs a fresh path
+	constexpr float REPLAN_DISTANCE_SQUARED = 16.0f;
+	// a target the corridor can't be dragged to, like a player standing off
+	// the navmesh, is planned for again at most this often
+	constexpr float REPLAN_INTERVAL = 0.25f;
+	// a guard that has seen the player is searched for before ones on patrol
+	constexpr int PATROL_PATH_PRIORITY = 0;
+	constexpr int CHASE_PATH_PRIORITY = 1;
+	// guards are pushed about by forces, so the crowd only needs roughly how
+	// fast they go to judge who gets in whose way
+	constexpr float CROWD_RADIUS = 1.0f;
+	constexpr float CROWD_SPEED = 8.0f;
+}
+
 GuardObject::GuardObject(const std::string& objectName) {
 	mName = objectName;
+	mObjectType = Type;
 	mRootSequence = new BehaviourSequence("Root Sequence");
 	mCanSeePlayer = false;
 	mHasCaughtPlayer = false;
 	mPlayerHasItems = true;
 	BehaviourTree();
 	mGuardState = Stand;
+	mTimeSincePlan = REPLAN_INTERVAL;
+	mPathfinding = nullptr;
+	mPathRequest = 0;
+	mCrowd = nullptr;
+	mCrowdAgent = -1;
+	mIsParked = false;
 }
 
 GuardObject::~GuardObject() {
+	CancelPathRequest();
+	if (mCrowd) {
+		mCrowd->RemoveAgent(mCrowdAgent);
+	}
 	delete mRootSequence;
 }
 
+void GuardObject::SetPathfinding(PathfindingService* pathfinding) {
+	CancelPathRequest();
+	mPathfinding = pathfinding;
+}
+
+void GuardObject::SetCrowd(CrowdManager* crowd) {
+	if (mCrowd) {
+		mCrowd->RemoveAgent(mCrowdAgent);
+	}
+	mCrowd = nullptr;
+	mCrowdAgent = -1;
+	if (!crowd) {
+		return;
+	}
+	CrowdManager::AgentParams params;
+	params.radius = CROWD_RADIUS;
+	params.maxSpeed = CROWD_SPEED;
+	params.flags = CrowdManager::AvoidOthers;
+	mCrowdAgent = crowd->AddAgent(this->GetTransform().GetPosition(), params);
+	if (mCrowdAgent >= 0) {
+		mCrowd = crowd;
+	}
+}
+
+void GuardObject::SetParked(bool parked) {
+	mIsParked = parked;
+	SetHasPhysics(!parked);
+}
+
 void GuardObject::UpdateObject(float dt) {
+	if (mIsParked) {
+		return;
+	}
+	mTimeSincePlan += dt;
+	// the crowd hears where the guard got to, and whether it still wants to move
+	if (mCrowd) {
+		mCrowd->SetAgentPosition(mCrowdAgent, this->GetTransform().GetPosition(), this->GetPhysicsObject()->GetLinearVelocity());
+		mCrowd->ResetMove(mCrowdAgent);
+	}
 	RaycastToPlayer();
 	ExecuteBT();
 }
 
+void GuardObject::SaveState() {
+	GameObject::SaveState();
+	mSavedNode = mCurrentNode;
+	mSavedGuardState = mGuardState;
+}
+
+/*
+Levels are saved straight after loading, before the behaviour tree has run,
+so resetting every node takes it back to the saved state without copying it.
+*/
+void GuardObject::RestoreState() {
+	GameObject::RestoreState();
+	mCurrentNode = mSavedNode;
+	mGuardState = mSavedGuardState;
+	mRootSequence->Reset();
+	mSightedObject = nullptr;
+	mCanSeePlayer = false;
+	mHasCaughtPlayer = false;
+	mPlayerHasItems = true;
+	CancelPathRequest();
+	mPathCorridor.Clear();
+	mTimeSincePlan = REPLAN_INTERVAL;
+}
+
 void GuardObject::RaycastToPlayer() {
-	mPlayer = dynamic_cast<PlayerObject*>(mPlayer);
 	Vector3 dir = (mPlayer->GetTransform().GetPosition() - this->GetTransform().GetPosition()).Normalised();
 	float ang = Vector3::Dot(dir, GuardForwardVector());
 	if (ang > 2) {
@@ -55,7 +144,8 @@ void GuardObject::RaycastToPlayer() {
 }
 
 Vector3 GuardObject::GuardForwardVector() {
-	Vector3 rightAxis = this->mTransform.GetMatrix().GetColumn(0);
+	Transform& transform = GetTransform();
+	Vector3 rightAxis = transform.GetOrientation() * Vector3(transform.GetScale().x, 0, 0);
 	Vector3 fwdAxis = Vector3::Cross(Vector3(0, 1, 0), rightAxis);
 	return fwdAxis;
 }
@@ -67,9 +157,71 @@ float GuardObject::AngleFromFocalPoint(Vector3 direction) {
 	return angle;
 }
 
+/*
+Returns the way to head for target, which is toward the next corner of the
+path there. The corridor is only planned again when the target jumps
+somewhere new, like the next patrol node, or the guard can't follow it any
+more; otherwise both ends just slide along the navmesh each frame. With a
+pathfinding service the new path is asked for instead, and the guard keeps
+on along the old corridor, or straight at the target, until it arrives.
+*/
+Vector3 GuardObject::PathTowards(const Vector3& target, int priority) {
+	const Vector3& position = this->GetTransform().GetPosition();
+	float targetMoved = (target - mPathTarget).LengthSquared();
+	bool following = mPathCorridor.IsValid() && mPathCorridor.MovePosition(position);
+	if (following && targetMoved > 0.01f) {
+		following = targetMoved < REPLAN_DISTANCE_SQUARED &&
+			(mPathCorridor.MoveTarget(target) || mTimeSincePlan < REPLAN_INTERVAL);
+	}
+	mPathTarget = target;
+	if (!following) {
+		if (!mPathfinding) {
+			mPathCorridor.Plan(position, target);
+			mTimeSincePlan = 0.0f;
+		}
+		// a target that only creeps along waits for the path already asked for
+		else if (targetMoved >= REPLAN_DISTANCE_SQUARED || mTimeSincePlan >= REPLAN_INTERVAL) {
+			RequestPath(position, target, priority);
+			mTimeSincePlan = 0.0f;
+		}
+	}
+	Vector3 corner;
+	if (!mPathCorridor.GetNextCorner(corner)) {
+		return target - position;
+	}
+	return corner - position;
+}
+
+void GuardObject::RequestPath(const Vector3& start, const Vector3& target, int priority) {
+	CancelPathRequest();
+	mPathRequest = mPathfinding->Request(start, target, priority, [this](const PathfindingService::Result& result) {
+		mPathRequest = 0;
+		mPathCorridor.SetPath(result.polys, result.start, result.end, result.searchTime);
+	});
+}
+
+void GuardObject::CancelPathRequest() {
+	if (mPathfinding && mPathRequest != 0) {
+		mPathfinding->Cancel(mPathRequest);
+	}
+	mPathRequest = 0;
+}
+
+/*
+In a crowd the guard asks to move the way it wants, and is pushed the way the
+crowd chose for it last update, which bends around any guards in the way.
+*/
 void GuardObject::MoveTowardFocalPoint(Vector3 direction) {
 	Vector3 dirNorm = direction.Normalised();
-	this->GetPhysicsObject()->AddForce(Vector3(dirNorm.x, 0, dirNorm.z) * mGuardSpeedMultiplier);
+	Vector3 heading(dirNorm.x, 0, dirNorm.z);
+	if (mCrowd) {
+		Vector3 avoidance = mCrowd->GetAgentAvoidanceVelocity(mCrowdAgent);
+		mCrowd->RequestMoveVelocity(mCrowdAgent, heading * CROWD_SPEED);
+		if (avoidance.LengthSquared() > 0.01f) {
+			heading = avoidance / CROWD_SPEED;
+		}
+	}
+	this->GetPhysicsObject()->AddForce(heading * mGuardSpeedMultiplier);
 
 }
 
@@ -128,10 +280,10 @@ BehaviourAction* GuardObject::Patrol() {
 			if (mCanSeePlayer == false) {
 				
 				mGuardSpeedMultiplier = 25;
-				Vector3 direction = mNodes[mNextNode] - this->GetTransform().GetPosition();
+				Vector3 direction = PathTowards(mNodes[mNextNode], PATROL_PATH_PRIORITY);
 				LookTowardFocalPoint(direction);
 				MoveTowardFocalPoint(direction);
-				float dist = direction.LengthSquared();
+				float dist = (mNodes[mNextNode] - this->GetTransform().GetPosition()).LengthSquared();
 				if (dist < 36) {
 					mCurrentNode = mNextNode;
 					if (mCurrentNode == mNodes.size() - 1) {
@@ -175,7 +327,7 @@ BehaviourAction* GuardObject::ChasePlayerSetup() {
 					return Failure;
 				}
 				else {
-					MoveTowardFocalPoint(direction);
+					MoveTowardFocalPoint(PathTowards(mPlayer->GetTransform().GetPosition(), CHASE_PATH_PRIORITY));
 				}
 			}
 			else if (mCanSeePlayer == false && mHasCaughtPlayer == false) {
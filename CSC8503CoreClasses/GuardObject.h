@@ -3,14 +3,20 @@
 #include "GameWorld.h"
 #include "BehaviourSequence.h"
 #include "BehaviourAction.h"
+#include "PathCorridor.h"
+#include "PathfindingService.h"
 #include <string>
 using namespace std;
 
 
 namespace NCL {
     namespace CSC8503 {
+        class CrowdManager;
+
         class GuardObject : public GameObject {
         public:
+            static constexpr GameObjectType Type = GameObjectType::Guard;
+
             GuardObject(const std::string& name = "");
             ~GuardObject();
 
@@ -24,6 +30,9 @@ namespace NCL {
 
             virtual void UpdateObject(float dt) override;
 
+            virtual void SaveState() override;
+            virtual void RestoreState() override;
+
             void SetPlayer(GameObject* newPlayer) {
                 mPlayer = newPlayer;
             }
@@ -44,6 +53,29 @@ namespace NCL {
                 mCurrentNode = node;
             }
 
+            //Without one the guard heads straight for its target
+            void SetNavMeshQuery(dtNavMeshQuery* query) {
+                mPathCorridor.SetQuery(query);
+            }
+
+            //Paths are then searched for on the job threads, turning up a frame or so later
+            void SetPathfinding(PathfindingService* pathfinding);
+
+            //Joins the crowd where the guard stands, to steer around the other guards in it
+            void SetCrowd(CrowdManager* crowd);
+
+            //A parked guard stands where it is, with no physics, and doesn't think
+            //until it is unparked; used while the floor under it is streamed out
+            void SetParked(bool parked);
+
+            bool IsParked() const {
+                return mIsParked;
+            }
+
+            const PathCorridor::Stats& GetPathStats() const {
+                return mPathCorridor.GetStats();
+            }
+
             GuardState GetGuardState() {
                 return  mGuardState;
             }
@@ -59,17 +91,30 @@ namespace NCL {
             vector<Vector3> mNodes;
             int mCurrentNode;
             int mNextNode;
+            int mSavedNode;
         private:
             bool mCanSeePlayer;
             bool mHasCaughtPlayer;
             bool mPlayerHasItems;
+            bool mIsParked;
 
             void BehaviourTree();
             void ExecuteBT();
+            Vector3 PathTowards(const Vector3& target, int priority);
+            void RequestPath(const Vector3& start, const Vector3& target, int priority);
+            void CancelPathRequest();
             void MoveTowardFocalPoint(Vector3 direction);
             void LookTowardFocalPoint(Vector3 direction);
             void GrabPlayer();
 
+            PathCorridor mPathCorridor;
+            Vector3 mPathTarget;
+            float mTimeSincePlan;
+            PathfindingService* mPathfinding;
+            PathfindingService::RequestID mPathRequest;
+            CrowdManager* mCrowd;
+            int mCrowdAgent;
+
             float mConfiscateItemsTime;
             int mGuardSpeedMultiplier;
 
@@ -82,6 +127,7 @@ namespace NCL {
             BehaviourState mState = Ongoing;
 
             GuardState mGuardState;
+            GuardState mSavedGuardState;
         };
     }
 }
\ No newline at end of file
@@ -5,17 +5,23 @@
 using namespace NCL::CSC8503;
 
 Helipad::Helipad() : GameObject(StaticObj, "Helipad") {
+	mObjectType = Type;
+	mCollidingWithPlayer = false;
+}
 
+void Helipad::RestoreState() {
+	GameObject::RestoreState();
+	mCollidingWithPlayer = false;
 }
 
 void Helipad::OnCollisionBegin(GameObject* otherObject) {
-	if (PlayerObject* temp = dynamic_cast<PlayerObject*>(otherObject)) {
+	if (otherObject->GetObjectType() == GameObjectType::Player) {
 		mCollidingWithPlayer = true;
 	}
 }
 
 void Helipad::OnCollisionEnd(GameObject* otherObject) {
-	if (PlayerObject* temp = dynamic_cast<PlayerObject*>(otherObject)) {
+	if (otherObject->GetObjectType() == GameObjectType::Player) {
 		mCollidingWithPlayer = false;
 	}
 }
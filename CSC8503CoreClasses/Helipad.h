@@ -5,6 +5,8 @@ namespace NCL {
     namespace CSC8503 {
         class Helipad : public GameObject {
         public:
+            static constexpr GameObjectType Type = GameObjectType::Helipad;
+
             Helipad();
 
             virtual void OnCollisionBegin(GameObject* otherObject) override;
@@ -12,6 +14,9 @@ namespace NCL {
             virtual void OnCollisionEnd(GameObject* otherObject) override;
 
             bool GetCollidingWithPlayer() { return mCollidingWithPlayer; }
+
+            //Collision pairs are dropped on a restart without OnCollisionEnd being called
+            virtual void RestoreState() override;
         protected:
             bool mCollidingWithPlayer;
         };
@@ -1,7 +1,9 @@
 #pragma once
+#include "../CSC8503/InventoryBuffSystem/PlayerInventory.h"
 
 namespace NCL {
 	namespace CSC8503 {
+		class GameObject;
 
 		enum InteractType {
 			Use,
@@ -10,7 +12,8 @@ namespace NCL {
 
 		class Interactable{
 		public:
-			virtual void Interact(InteractType interactType) { 
+			//user is the player interacting, usedItem the item they have equipped
+			virtual void Interact(InteractType interactType, GameObject* user, InventoryBuffSystem::PlayerInventory::item usedItem) { 
 				if (!CanBeInteractedWith())
 					return; 
 			};
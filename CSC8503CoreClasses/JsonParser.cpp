@@ -8,237 +8,299 @@
 
 using namespace NCL::CSC8503;
 
-constexpr ParserVariables LEVEL_VARIABLES[16] = {
-	TileMap,
-	RoomList,
-	GuardCount,
-	CCTVCount,
-	GuardPaths,
-	CCTVTransforms,
-	PrisonPosition,
-	PlayerStartTransforms,
-	DirectionalLight,
-	Pointlight,
-	Spotlight,
-	ItemPositions,
-	Vents,
-	Helipad,
-	PrisonDoorPos,
-	Doors
-};
-
-constexpr ParserVariables ROOM_VARIABLES[7] = {
-	SetRoomType,
-	TileMap,
-	CCTVTransforms,
-	Pointlight,
-	Spotlight,
-	ItemPositions,
-	Doors
-};
-
-void JsonParser::ParseJson(std::string JSON, Level* level, Room* room) {
-	if ((!level && !room) || (level && room)) return;
+namespace {
+	struct SchemaKey {
+		std::string_view key;
+		ParserVariables variable;
+	};
+
+	constexpr SchemaKey LEVEL_SCHEMA[] = {
+		{ "tiles", TileMap },
+		{ "rooms", RoomList },
+		{ "guardCount", GuardCount },
+		{ "cctvCount", CCTVCount },
+		{ "guardPaths", GuardPaths },
+		{ "cctvPositions", CCTVTransforms },
+		{ "prisonPosition", PrisonPosition },
+		{ "playerStartPositions", PlayerStartTransforms },
+		{ "directionalLight", DirectionalLight },
+		{ "pointLights", Pointlight },
+		{ "spotlights", Spotlight },
+		{ "itemPositions", ItemPositions },
+		{ "vents", Vents },
+		{ "helipadPosition", Helipad },
+		{ "prisonDoor", PrisonDoorPos },
+		{ "doors", Doors }
+	};
+
+	constexpr SchemaKey ROOM_SCHEMA[] = {
+		{ "type", SetRoomType },
+		{ "tiles", TileMap },
+		{ "cctvPositions", CCTVTransforms },
+		{ "pointLights", Pointlight },
+		{ "spotlights", Spotlight },
+		{ "itemPositions", ItemPositions },
+		{ "doors", Doors }
+	};
+
+	template<size_t N>
+	const SchemaKey* FindSchemaKey(const SchemaKey(&schema)[N], std::string_view key) {
+		for (const SchemaKey& entry : schema) {
+			if (entry.key == key) return &entry;
+		}
+		return nullptr;
+	}
+
+	//The editor exports with z pointing the other way to the game
+	Vector3 ToWorld(const Vector3& v) {
+		return Vector3(v.x, v.y, -v.z);
+	}
+}
+
+bool JsonParser::ParseJson(std::string_view json, Level* level, Room* room, const std::string& sourceName) {
+	if ((!level && !room) || (level && room)) return false;
 	mPlayerCount = 0;
-	std::string output = "";
-	std::string currentKey = "";
-
-	int indents = 0;
-	int maxIndents = 0;
-	bool writingKey = false;
-	bool writingValue = false;
-
-	std::vector<std::map<std::string, float>> keyValuePairs = std::vector<std::map<std::string, float>>();
-	for (char c : JSON) {
-		switch (c) {
-		case '"':
-			writingKey = !writingKey;
-			currentKey = output;
-			WriteValue(!writingKey, &keyValuePairs, output, &output, indents, maxIndents);
-			if (writingKey && indents == 1) maxIndents = 1;
-			break;
-		case '{':
-			indents++;
-			if (indents > maxIndents) maxIndents++;
-			writingValue = false;
-			keyValuePairs.push_back(std::map<std::string, float>());
-			break;
-		case '}':
-			WriteValue(writingValue, &keyValuePairs, currentKey, &output, indents, maxIndents);
-			writingValue = false;
-			indents--;
-			break;
-		case ',':
-			WriteValue(writingValue, &keyValuePairs, currentKey, &output, indents, maxIndents);
-			writingValue = false;
-			if (indents == 1) {
-				WriteVariable(keyValuePairs, level, room);
-				while (keyValuePairs.size() > 1) keyValuePairs.pop_back();
+
+	JsonReader reader(json);
+	std::string_view key;
+	if (reader.BeginObject()) {
+		while (reader.NextKey(key)) {
+			const SchemaKey* schemaKey = level ? FindSchemaKey(LEVEL_SCHEMA, key) : FindSchemaKey(ROOM_SCHEMA, key);
+			if (!schemaKey) {
+				std::cout << "JsonParser: " << sourceName << ": skipping unknown key \"" << key << "\"\n";
+				reader.SkipValue();
+				continue;
 			}
-			break;
-		case ':':
-			writingValue = true;
-			break;
-		case '[':
-		case ']':
-			break;
-		default:
-			output += c;
-			break;
+			if (!ReadVariable(schemaKey->variable, reader, level, room)) break;
 		}
+		reader.ExpectEnd();
 	}
-	WriteVariable(keyValuePairs, level, room);
+
+	if (reader.HasError()) {
+		std::cout << "JsonParser: " << sourceName << ":" << reader.GetErrorLine() << ":" << reader.GetErrorColumn()
+			<< ": " << reader.GetErrorMessage() << "\n";
+		return false;
+	}
+	return true;
 }
 
-void JsonParser::WriteValue(bool writingValue, std::vector<std::map<std::string, float>>* keyValuePairs, 
-	std::string key, std::string* value, int indents, int maxIndents) {
-	if (writingValue) {
-		if (keyValuePairs->size() <= maxIndents || indents < maxIndents) {
-			(*keyValuePairs)[indents - 1][key] = std::atof(value->c_str());
+bool JsonParser::ReadVariable(ParserVariables variable, JsonReader& reader, Level* level, Room* room) {
+	float value = 0;
+	Vector3 position;
+	switch (variable) {
+	case SetRoomType:
+		if (!reader.ReadNumber(value)) return false;
+		room->mType = (RoomType)(int)value;
+		return true;
+
+	case GuardCount:
+		if (!reader.ReadNumber(value)) return false;
+		level->mGuardCount = (int)value;
+		return true;
+
+	case CCTVCount:
+		if (!reader.ReadNumber(value)) return false;
+		level->mCCTVCount = (int)value;
+		return true;
+
+	case PrisonPosition:
+		if (!ReadVector(reader, position)) return false;
+		level->mPrisonPosition = ToWorld(position);
+		return true;
+
+	case Helipad:
+		if (!ReadVector(reader, position)) return false;
+		level->mHelipadPosition = ToWorld(position);
+		return true;
+
+	case ItemPositions:
+		if (!reader.BeginArray()) return false;
+		while (reader.NextElement()) {
+			if (!ReadVector(reader, position)) return false;
+			if (level) level->mItemPositions.push_back(ToWorld(position));
+			else room->mItemPositions.push_back(ToWorld(position));
 		}
-		else {
-			(*keyValuePairs)[keyValuePairs->size() - 1][key] = std::atof(value->c_str());
+		return !reader.HasError();
+
+	case PrisonDoorPos:
+	{
+		Entry entry;
+		if (!ReadEntry(reader, entry)) return false;
+		WriteEntry(variable, entry, level, room);
+	}
+		return true;
+
+	case DirectionalLight:
+		// the level's sun isn't used yet
+		return reader.SkipValue();
+
+	default:
+		return ReadEntries(variable, reader, level, room);
+	}
+}
+
+bool JsonParser::ReadEntries(ParserVariables variable, JsonReader& reader, Level* level, Room* room) {
+	if (!reader.BeginArray()) return false;
+	while (reader.NextElement()) {
+		Entry entry;
+		if (!ReadEntry(reader, entry)) return false;
+		WriteEntry(variable, entry, level, room);
+	}
+	return !reader.HasError();
+}
+
+bool JsonParser::ReadEntry(JsonReader& reader, Entry& entry) {
+	std::string_view key;
+	if (!reader.BeginObject()) return false;
+	while (reader.NextKey(key)) {
+		bool read = true;
+		if (key == "type") read = reader.ReadNumber(entry.type);
+		else if (key == "position" || key == "roomPosition") read = ReadVector(reader, entry.position);
+		else if (key == "rotation") read = ReadVector(reader, entry.rotation);
+		else if (key == "direction") read = ReadVector(reader, entry.direction);
+		else if (key == "colour") read = ReadVector(reader, entry.colour);
+		else if (key == "radius") read = reader.ReadNumber(entry.radius);
+		else if (key == "angle") read = reader.ReadNumber(entry.angle);
+		else if (key == "connectedVentID") read = reader.ReadNumber(entry.connectedVentID);
+		else if (key == "nodes") {
+			Vector3 node;
+			read = reader.BeginArray();
+			while (read && reader.NextElement()) {
+				read = ReadVector(reader, node);
+				entry.nodes.push_back(ToWorld(node));
+			}
 		}
-		*value = "";
+		else read = reader.SkipValue();
+
+		if (!read) return false;
 	}
+	return !reader.HasError();
 }
 
-void JsonParser::WriteVariable(std::vector<std::map<std::string, float>>& keyValuePairs, Level* level, Room* room) {
-	ParserVariables variable = level ? LEVEL_VARIABLES[keyValuePairs[0].size() - 1] : ROOM_VARIABLES[keyValuePairs[0].size() - 1];
-	switch (variable) {
-	case SetRoomType:
-		room->mType = (RoomType)keyValuePairs[0]["type"];
-		break;
+bool JsonParser::ReadVector(JsonReader& reader, Vector3& out) {
+	std::string_view key;
+	out = Vector3();
+	if (!reader.BeginObject()) return false;
+	while (reader.NextKey(key)) {
+		bool read = true;
+		if (key == "x") read = reader.ReadNumber(out.x);
+		else if (key == "y") read = reader.ReadNumber(out.y);
+		else if (key == "z") read = reader.ReadNumber(out.z);
+		else read = reader.SkipValue();
 
+		if (!read) return false;
+	}
+	return !reader.HasError();
+}
+
+bool JsonParser::ReadVector(JsonReader& reader, Vector4& out) {
+	std::string_view key;
+	out = Vector4();
+	if (!reader.BeginObject()) return false;
+	while (reader.NextKey(key)) {
+		bool read = true;
+		if (key == "x") read = reader.ReadNumber(out.x);
+		else if (key == "y") read = reader.ReadNumber(out.y);
+		else if (key == "z") read = reader.ReadNumber(out.z);
+		else if (key == "w") read = reader.ReadNumber(out.w);
+		else read = reader.SkipValue();
+
+		if (!read) return false;
+	}
+	return !reader.HasError();
+}
+
+void JsonParser::WriteEntry(ParserVariables variable, const Entry& entry, Level* level, Room* room) {
+	switch (variable) {
 	case TileMap:
 	{
-		Vector3 key = Vector3(keyValuePairs[2]["x"], keyValuePairs[2]["y"], -keyValuePairs[2]["z"]);
-		TileType value = (TileType)keyValuePairs[1]["type"];
+		Vector3 key = ToWorld(entry.position);
+		TileType value = (TileType)(int)entry.type;
 		if (level) level->mTileMap[key] = value;
 		else room->mTileMap[key] = value;
 	}
 		break;
 
 	case RoomList:
-		if (keyValuePairs.size() == 1) return;
-		level->mRoomList[Vector3(keyValuePairs[2]["x"], keyValuePairs[2]["y"], -keyValuePairs[2]["z"])] = new Room((int)keyValuePairs[1]["type"]);
-		break;
-
-	case GuardCount:
-		level->mGuardCount = (int)keyValuePairs[0]["guardCount"];
-		break;
-
-	case CCTVCount:
-		level->mCCTVCount = (int)keyValuePairs[0]["cctvCount"];
+		level->mRoomList[ToWorld(entry.position)] = new Room((int)entry.type);
 		break;
 
 	case GuardPaths:
-		if (keyValuePairs.size() == 1) return;
-		level->mGuardPaths.push_back(std::vector<Vector3>());
-		for (int i = 2; i < keyValuePairs.size(); i++) {
-			level->mGuardPaths[level->mGuardPaths.size() - 1].push_back(Vector3(keyValuePairs[i]["x"], keyValuePairs[i]["y"], -keyValuePairs[i]["z"]));
-		}
+		level->mGuardPaths.push_back(entry.nodes);
 		break;
 
 	case CCTVTransforms:
-		if (keyValuePairs.size() == 1) return;
 	{
 		Transform newTransform = Transform();
-		newTransform.SetPosition(Vector3(keyValuePairs[2]["x"], keyValuePairs[2]["y"], -keyValuePairs[2]["z"]))
-			.SetOrientation(Quaternion::EulerAnglesToQuaternion(0, keyValuePairs[3]["y"]-180, 0));
+		newTransform.SetPosition(ToWorld(entry.position))
+			.SetOrientation(Quaternion::EulerAnglesToQuaternion(0, entry.rotation.y - 180, 0));
 		if (level) level->mCCTVTransforms.push_back(newTransform);
 		else room->mCCTVTransforms.push_back(newTransform);
 	}
 		break;
 
-	case PrisonPosition:
-		level->mPrisonPosition = Vector3(keyValuePairs[1]["x"], keyValuePairs[1]["y"], -keyValuePairs[1]["z"]);
-		break;
-
 	case PlayerStartTransforms:
 		if (mPlayerCount < MAX_PLAYERS) {
 			Transform newTransform = Transform();
-			newTransform.SetPosition(Vector3(keyValuePairs[2]["x"], keyValuePairs[2]["y"], -keyValuePairs[2]["z"]))
-				.SetOrientation(Quaternion::EulerAnglesToQuaternion(keyValuePairs[3]["x"], keyValuePairs[3]["y"]-180, keyValuePairs[3]["z"]));
+			newTransform.SetPosition(ToWorld(entry.position))
+				.SetOrientation(Quaternion::EulerAnglesToQuaternion(entry.rotation.x, entry.rotation.y - 180, entry.rotation.z));
 			level->mPlayerStartTransforms[mPlayerCount] = newTransform;
 			mPlayerCount++;
 		}
 		break;
 
-	/*case DirectionalLight:
-	{
-		Light* newLight = (Light*)new DirectionLight(Vector3(keyValuePairs[2]["x"], keyValuePairs[2]["y"], -keyValuePairs[2]["z"]),
-			Vector4(keyValuePairs[3]["x"], keyValuePairs[3]["y"], keyValuePairs[3]["z"], keyValuePairs[3]["w"]));
-		level->mLights.push_back(newLight);
-	}
-		break;*/
-
 	case Pointlight:
-		if (keyValuePairs.size() == 1) return;
 	{
-		Light* newLight = (Light*)new PointLight(Vector3(keyValuePairs[2]["x"], keyValuePairs[2]["y"], -keyValuePairs[2]["z"]),
-			Vector4(keyValuePairs[3]["x"], keyValuePairs[3]["y"], keyValuePairs[3]["z"], keyValuePairs[3]["w"]), keyValuePairs[1]["radius"]);
-			if (level) level->mLights.push_back(newLight);
-			else room->mLights.push_back(newLight);
+		Light* newLight = (Light*)new PointLight(ToWorld(entry.position), entry.colour, entry.radius);
+		if (level) level->mLights.push_back(newLight);
+		else room->mLights.push_back(newLight);
 	}
 		break;
 
 	case Spotlight:
-		if (keyValuePairs.size() == 1) return;
 	{
-			Matrix4 xRot = Matrix4::Rotation(keyValuePairs[4]["x"], Vector3(-1, 0, 0));
-			Matrix4 yRot = Matrix4::Rotation(keyValuePairs[4]["y"]-180, Vector3(0, 1, 0));
-			Matrix4 zRot = Matrix4::Rotation(-keyValuePairs[4]["z"], Vector3(0, 0, 1));
-			Vector3 direction = xRot * yRot * zRot * Vector3(0, 0, 1);
-			Light* newLight = (Light*)new SpotLight(direction,
-			Vector3(keyValuePairs[2]["x"], keyValuePairs[2]["y"], -keyValuePairs[2]["z"]),
-			Vector4(keyValuePairs[3]["x"], keyValuePairs[3]["y"], keyValuePairs[3]["z"], keyValuePairs[3]["w"]),
-			keyValuePairs[1]["radius"], keyValuePairs[1]["angle"], 1.0f);
+		Matrix4 xRot = Matrix4::Rotation(entry.direction.x, Vector3(-1, 0, 0));
+		Matrix4 yRot = Matrix4::Rotation(entry.direction.y - 180, Vector3(0, 1, 0));
+		Matrix4 zRot = Matrix4::Rotation(-entry.direction.z, Vector3(0, 0, 1));
+		Vector3 direction = xRot * yRot * zRot * Vector3(0, 0, 1);
+		Light* newLight = (Light*)new SpotLight(direction, ToWorld(entry.position), entry.colour,
+			entry.radius, entry.angle, 1.0f);
 		if (level) level->mLights.push_back(newLight);
 		else room->mLights.push_back(newLight);
 	}
 		break;
 
-	case ItemPositions:
-	{
-		Vector3 newPos = Vector3(keyValuePairs[1]["x"], keyValuePairs[1]["y"], -keyValuePairs[1]["z"]);
-		if (level) level->mItemPositions.push_back(newPos);
-		else room->mItemPositions.push_back(newPos);
-	}
-		break;
-
 	case Vents:
-		if (keyValuePairs.size() == 1) return;
 	{
 		Vent* vent = new Vent();
-		vent->GetTransform().SetPosition(Vector3(keyValuePairs[2]["x"], keyValuePairs[2]["y"], -keyValuePairs[2]["z"]))
-			.SetOrientation(Quaternion::EulerAnglesToQuaternion(keyValuePairs[3]["x"], keyValuePairs[3]["y"]-180, -keyValuePairs[3]["z"]));
+		vent->GetTransform().SetPosition(ToWorld(entry.position))
+			.SetOrientation(Quaternion::EulerAnglesToQuaternion(entry.rotation.x, entry.rotation.y - 180, -entry.rotation.z));
 		level->mVents.push_back(vent);
-		level->mVentConnections.push_back(keyValuePairs[1]["connectedVentID"]);
+		level->mVentConnections.push_back((int)entry.connectedVentID);
 	}
 		break;
-	case Helipad:
-		level->mHelipadPosition = Vector3(keyValuePairs[1]["x"], keyValuePairs[1]["y"], -keyValuePairs[1]["z"]);
-		break;
+
 	case Doors:
-		if (keyValuePairs.size() == 1) return;
-		{
-			Door* door = new Door();
-			door->GetTransform().SetPosition(Vector3(keyValuePairs[2]["x"], keyValuePairs[2]["y"], -keyValuePairs[2]["z"]))
-				.SetOrientation(Quaternion::EulerAnglesToQuaternion(keyValuePairs[3]["x"], keyValuePairs[3]["y"] - 180, -keyValuePairs[3]["z"]));
-			if (level) level->mDoors.push_back(door);
-			else room->mDoors.push_back(door);
-		}
+	{
+		Door* door = new Door();
+		door->GetTransform().SetPosition(ToWorld(entry.position))
+			.SetOrientation(Quaternion::EulerAnglesToQuaternion(entry.rotation.x, entry.rotation.y - 180, -entry.rotation.z));
+		if (level) level->mDoors.push_back(door);
+		else room->mDoors.push_back(door);
+	}
 		break;
+
 	case PrisonDoorPos:
 	{
 		PrisonDoor* pDoor = new PrisonDoor();
-		pDoor->GetTransform().SetPosition(Vector3(keyValuePairs[2]["x"], keyValuePairs[2]["y"], -keyValuePairs[2]["z"]))
-			.SetOrientation(Quaternion::EulerAnglesToQuaternion(keyValuePairs[3]["x"], keyValuePairs[3]["y"] - 180, -keyValuePairs[3]["z"]));
+		pDoor->GetTransform().SetPosition(ToWorld(entry.position))
+			.SetOrientation(Quaternion::EulerAnglesToQuaternion(entry.rotation.x, entry.rotation.y - 180, -entry.rotation.z));
+		delete level->mPrisonDoor;
 		level->mPrisonDoor = pDoor;
 	}
-	break;
+		break;
+
+	default:
+		break;
 	}
 }
-
-
@@ -1,5 +1,8 @@
 #pragma once
 #include "Level.h"
+#include "JsonReader.h"
+
+#include <map>
 
 namespace NCL {
 	namespace CSC8503 {
@@ -22,13 +25,43 @@ namespace NCL {
 			Doors,
 			PrisonDoorPos
 		};
+		/*
+		Reads a level or room file in one pass with a JsonReader. Each top level
+		key is looked up in that file type's schema and read straight into the
+		Level or Room; keys can come in any order, missing ones leave their
+		defaults, and unknown ones are skipped with a warning.
+		*/
 		class JsonParser {
 		public:
 			JsonParser(){}
-			void ParseJson(std::string JSON, Level* level, Room* room);
+			bool ParseJson(std::string_view json, Level* level, Room* room, const std::string& sourceName = "");
 		protected:
-			void WriteVariable(std::vector<std::map<std::string, float>>& keyValuePairs, Level* level, Room* room);
-			void WriteValue(bool writingValue, std::vector<std::map<std::string, float>>* keyValuePairs, 
+			friend class JsonParserBenchmark;
+
+			//Every field an array entry in our files can have
+			struct Entry {
+				float type = 0;
+				float radius = 0;
+				float angle = 0;
+				float connectedVentID = 0;
+				Vector3 position;
+				Vector3 rotation;
+				Vector3 direction;
+				Vector4 colour;
+				std::vector<Vector3> nodes;
+			};
+
+			bool ReadVariable(ParserVariables variable, JsonReader& reader, Level* level, Room* room);
+			bool ReadEntries(ParserVariables variable, JsonReader& reader, Level* level, Room* room);
+			bool ReadEntry(JsonReader& reader, Entry& entry);
+			bool ReadVector(JsonReader& reader, Vector3& out);
+			bool ReadVector(JsonReader& reader, Vector4& out);
+			void WriteEntry(ParserVariables variable, const Entry& entry, Level* level, Room* room);
+
+			//The parser this one replaced, kept as JsonParserBenchmark's baseline
+			void ParseJsonLegacy(const std::string& json, Level* level, Room* room);
+			void WriteLegacyVariable(std::vector<std::map<std::string, float>>& keyValuePairs, Level* level, Room* room);
+			void WriteLegacyValue(bool writingValue, std::vector<std::map<std::string, float>>* keyValuePairs,
 				std::string key, std::string* value, int indents, int maxIndents);
 			int mPlayerCount = 0;
 		};
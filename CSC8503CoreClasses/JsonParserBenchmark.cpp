@@ -0,0 +1,337 @@
+#include "JsonParserBenchmark.h"
+#include "JsonParser.h"
+#include "DirectionalLight.h"
+#include "PointLight.h"
+#include "SpotLight.h"
+#include "Door.h"
+#include "PrisonDoor.h"
+#include "Vent.h"
+#include "Assets.h"
+
+#include <chrono>
+#include <filesystem>
+#include <iostream>
+
+using namespace NCL::CSC8503;
+
+/*
+The parser JsonReader replaced, kept as it was so JsonParserBenchmark has something
+to measure the new one against. It builds a map per nesting level one char at
+a time, and works out which variable it is reading from how many top level
+keys it has seen so far.
+*/
+namespace {
+	constexpr ParserVariables LEVEL_VARIABLES[16] = {
+		TileMap,
+		RoomList,
+		GuardCount,
+		CCTVCount,
+		GuardPaths,
+		CCTVTransforms,
+		PrisonPosition,
+		PlayerStartTransforms,
+		DirectionalLight,
+		Pointlight,
+		Spotlight,
+		ItemPositions,
+		Vents,
+		Helipad,
+		PrisonDoorPos,
+		Doors
+	};
+
+	constexpr ParserVariables ROOM_VARIABLES[7] = {
+		SetRoomType,
+		TileMap,
+		CCTVTransforms,
+		Pointlight,
+		Spotlight,
+		ItemPositions,
+		Doors
+	};
+}
+
+void JsonParser::ParseJsonLegacy(const std::string& JSON, Level* level, Room* room) {
+	if ((!level && !room) || (level && room)) return;
+	mPlayerCount = 0;
+	std::string output = "";
+	std::string currentKey = "";
+
+	int indents = 0;
+	int maxIndents = 0;
+	bool writingKey = false;
+	bool writingValue = false;
+
+	std::vector<std::map<std::string, float>> keyValuePairs = std::vector<std::map<std::string, float>>();
+	for (char c : JSON) {
+		switch (c) {
+		case '"':
+			writingKey = !writingKey;
+			currentKey = output;
+			WriteLegacyValue(!writingKey, &keyValuePairs, output, &output, indents, maxIndents);
+			if (writingKey && indents == 1) maxIndents = 1;
+			break;
+		case '{':
+			indents++;
+			if (indents > maxIndents) maxIndents++;
+			writingValue = false;
+			keyValuePairs.push_back(std::map<std::string, float>());
+			break;
+		case '}':
+			WriteLegacyValue(writingValue, &keyValuePairs, currentKey, &output, indents, maxIndents);
+			writingValue = false;
+			indents--;
+			break;
+		case ',':
+			WriteLegacyValue(writingValue, &keyValuePairs, currentKey, &output, indents, maxIndents);
+			writingValue = false;
+			if (indents == 1) {
+				WriteLegacyVariable(keyValuePairs, level, room);
+				while (keyValuePairs.size() > 1) keyValuePairs.pop_back();
+			}
+			break;
+		case ':':
+			writingValue = true;
+			break;
+		case '[':
+		case ']':
+			break;
+		default:
+			output += c;
+			break;
+		}
+	}
+	WriteLegacyVariable(keyValuePairs, level, room);
+}
+
+void JsonParser::WriteLegacyValue(bool writingValue, std::vector<std::map<std::string, float>>* keyValuePairs, 
+	std::string key, std::string* value, int indents, int maxIndents) {
+	if (writingValue) {
+		if (keyValuePairs->size() <= maxIndents || indents < maxIndents) {
+			(*keyValuePairs)[indents - 1][key] = std::atof(value->c_str());
+		}
+		else {
+			(*keyValuePairs)[keyValuePairs->size() - 1][key] = std::atof(value->c_str());
+		}
+		*value = "";
+	}
+}
+
+void JsonParser::WriteLegacyVariable(std::vector<std::map<std::string, float>>& keyValuePairs, Level* level, Room* room) {
+	ParserVariables variable = level ? LEVEL_VARIABLES[keyValuePairs[0].size() - 1] : ROOM_VARIABLES[keyValuePairs[0].size() - 1];
+	switch (variable) {
+	case SetRoomType:
+		room->mType = (RoomType)keyValuePairs[0]["type"];
+		break;
+
+	case TileMap:
+	{
+		Vector3 key = Vector3(keyValuePairs[2]["x"], keyValuePairs[2]["y"], -keyValuePairs[2]["z"]);
+		TileType value = (TileType)keyValuePairs[1]["type"];
+		if (level) level->mTileMap[key] = value;
+		else room->mTileMap[key] = value;
+	}
+		break;
+
+	case RoomList:
+		if (keyValuePairs.size() == 1) return;
+		level->mRoomList[Vector3(keyValuePairs[2]["x"], keyValuePairs[2]["y"], -keyValuePairs[2]["z"])] = new Room((int)keyValuePairs[1]["type"]);
+		break;
+
+	case GuardCount:
+		level->mGuardCount = (int)keyValuePairs[0]["guardCount"];
+		break;
+
+	case CCTVCount:
+		level->mCCTVCount = (int)keyValuePairs[0]["cctvCount"];
+		break;
+
+	case GuardPaths:
+		if (keyValuePairs.size() == 1) return;
+		level->mGuardPaths.push_back(std::vector<Vector3>());
+		for (int i = 2; i < keyValuePairs.size(); i++) {
+			level->mGuardPaths[level->mGuardPaths.size() - 1].push_back(Vector3(keyValuePairs[i]["x"], keyValuePairs[i]["y"], -keyValuePairs[i]["z"]));
+		}
+		break;
+
+	case CCTVTransforms:
+		if (keyValuePairs.size() == 1) return;
+	{
+		Transform newTransform = Transform();
+		newTransform.SetPosition(Vector3(keyValuePairs[2]["x"], keyValuePairs[2]["y"], -keyValuePairs[2]["z"]))
+			.SetOrientation(Quaternion::EulerAnglesToQuaternion(0, keyValuePairs[3]["y"]-180, 0));
+		if (level) level->mCCTVTransforms.push_back(newTransform);
+		else room->mCCTVTransforms.push_back(newTransform);
+	}
+		break;
+
+	case PrisonPosition:
+		level->mPrisonPosition = Vector3(keyValuePairs[1]["x"], keyValuePairs[1]["y"], -keyValuePairs[1]["z"]);
+		break;
+
+	case PlayerStartTransforms:
+		if (mPlayerCount < MAX_PLAYERS) {
+			Transform newTransform = Transform();
+			newTransform.SetPosition(Vector3(keyValuePairs[2]["x"], keyValuePairs[2]["y"], -keyValuePairs[2]["z"]))
+				.SetOrientation(Quaternion::EulerAnglesToQuaternion(keyValuePairs[3]["x"], keyValuePairs[3]["y"]-180, keyValuePairs[3]["z"]));
+			level->mPlayerStartTransforms[mPlayerCount] = newTransform;
+			mPlayerCount++;
+		}
+		break;
+
+	/*case DirectionalLight:
+	{
+		Light* newLight = (Light*)new DirectionLight(Vector3(keyValuePairs[2]["x"], keyValuePairs[2]["y"], -keyValuePairs[2]["z"]),
+			Vector4(keyValuePairs[3]["x"], keyValuePairs[3]["y"], keyValuePairs[3]["z"], keyValuePairs[3]["w"]));
+		level->mLights.push_back(newLight);
+	}
+		break;*/
+
+	case Pointlight:
+		if (keyValuePairs.size() == 1) return;
+	{
+		Light* newLight = (Light*)new PointLight(Vector3(keyValuePairs[2]["x"], keyValuePairs[2]["y"], -keyValuePairs[2]["z"]),
+			Vector4(keyValuePairs[3]["x"], keyValuePairs[3]["y"], keyValuePairs[3]["z"], keyValuePairs[3]["w"]), keyValuePairs[1]["radius"]);
+			if (level) level->mLights.push_back(newLight);
+			else room->mLights.push_back(newLight);
+	}
+		break;
+
+	case Spotlight:
+		if (keyValuePairs.size() == 1) return;
+	{
+			Matrix4 xRot = Matrix4::Rotation(keyValuePairs[4]["x"], Vector3(-1, 0, 0));
+			Matrix4 yRot = Matrix4::Rotation(keyValuePairs[4]["y"]-180, Vector3(0, 1, 0));
+			Matrix4 zRot = Matrix4::Rotation(-keyValuePairs[4]["z"], Vector3(0, 0, 1));
+			Vector3 direction = xRot * yRot * zRot * Vector3(0, 0, 1);
+			Light* newLight = (Light*)new SpotLight(direction,
+			Vector3(keyValuePairs[2]["x"], keyValuePairs[2]["y"], -keyValuePairs[2]["z"]),
+			Vector4(keyValuePairs[3]["x"], keyValuePairs[3]["y"], keyValuePairs[3]["z"], keyValuePairs[3]["w"]),
+			keyValuePairs[1]["radius"], keyValuePairs[1]["angle"], 1.0f);
+		if (level) level->mLights.push_back(newLight);
+		else room->mLights.push_back(newLight);
+	}
+		break;
+
+	case ItemPositions:
+	{
+		Vector3 newPos = Vector3(keyValuePairs[1]["x"], keyValuePairs[1]["y"], -keyValuePairs[1]["z"]);
+		if (level) level->mItemPositions.push_back(newPos);
+		else room->mItemPositions.push_back(newPos);
+	}
+		break;
+
+	case Vents:
+		if (keyValuePairs.size() == 1) return;
+	{
+		Vent* vent = new Vent();
+		vent->GetTransform().SetPosition(Vector3(keyValuePairs[2]["x"], keyValuePairs[2]["y"], -keyValuePairs[2]["z"]))
+			.SetOrientation(Quaternion::EulerAnglesToQuaternion(keyValuePairs[3]["x"], keyValuePairs[3]["y"]-180, -keyValuePairs[3]["z"]));
+		level->mVents.push_back(vent);
+		level->mVentConnections.push_back(keyValuePairs[1]["connectedVentID"]);
+	}
+		break;
+	case Helipad:
+		level->mHelipadPosition = Vector3(keyValuePairs[1]["x"], keyValuePairs[1]["y"], -keyValuePairs[1]["z"]);
+		break;
+	case Doors:
+		if (keyValuePairs.size() == 1) return;
+		{
+			Door* door = new Door();
+			door->GetTransform().SetPosition(Vector3(keyValuePairs[2]["x"], keyValuePairs[2]["y"], -keyValuePairs[2]["z"]))
+				.SetOrientation(Quaternion::EulerAnglesToQuaternion(keyValuePairs[3]["x"], keyValuePairs[3]["y"] - 180, -keyValuePairs[3]["z"]));
+			if (level) level->mDoors.push_back(door);
+			else room->mDoors.push_back(door);
+		}
+		break;
+	case PrisonDoorPos:
+	{
+		PrisonDoor* pDoor = new PrisonDoor();
+		pDoor->GetTransform().SetPosition(Vector3(keyValuePairs[2]["x"], keyValuePairs[2]["y"], -keyValuePairs[2]["z"]))
+			.SetOrientation(Quaternion::EulerAnglesToQuaternion(keyValuePairs[3]["x"], keyValuePairs[3]["y"] - 180, -keyValuePairs[3]["z"]));
+		level->mPrisonDoor = pDoor;
+	}
+	break;
+	}
+}
+
+namespace {
+	struct BenchmarkFile {
+		std::string path;
+		std::string json;
+		bool isLevel;
+	};
+
+	std::vector<BenchmarkFile> ReadBenchmarkFiles() {
+		std::vector<BenchmarkFile> files;
+		auto addDirectory = [&](const std::string& directory, bool isLevel) {
+			if (!std::filesystem::is_directory(directory)) return;
+			for (const auto& entry : std::filesystem::directory_iterator(directory)) {
+				if (entry.path().extension() != ".json") continue;
+				BenchmarkFile file{ entry.path().string(), std::string(), isLevel };
+				if (Assets::ReadTextFile(file.path, file.json)) {
+					files.push_back(std::move(file));
+				}
+			}
+		};
+		addDirectory("../Assets/Levels/Rooms", false);
+		addDirectory("../Assets/Levels/Levels", true);
+		return files;
+	}
+
+	//Neither Level nor Room owns its doors, as the level manager takes them over
+	template<class T>
+	void DeleteDoors(T& parsed) {
+		for (Door* door : parsed.GetDoors()) {
+			delete door;
+		}
+	}
+}
+
+void JsonParserBenchmark::Run(std::ostream& out, int iterations) {
+	std::vector<BenchmarkFile> files = ReadBenchmarkFiles();
+	size_t totalBytes = 0;
+	for (const BenchmarkFile& file : files) {
+		totalBytes += file.json.size();
+	}
+	out << "Json benchmark: " << files.size() << " level and room files, " << totalBytes << " bytes, "
+		<< iterations << " passes\n";
+	if (files.empty()) {
+		out << "  no level files found\n";
+		return;
+	}
+
+	auto timePasses = [&](bool legacy) {
+		auto start = std::chrono::high_resolution_clock::now();
+		for (int i = 0; i < iterations; ++i) {
+			for (const BenchmarkFile& file : files) {
+				JsonParser parser;
+				if (file.isLevel) {
+					Level level;
+					if (legacy) parser.ParseJsonLegacy(file.json, &level, nullptr);
+					else parser.ParseJson(file.json, &level, nullptr, file.path);
+					DeleteDoors(level);
+					delete level.GetPrisonDoor();
+				}
+				else {
+					Room room;
+					if (legacy) parser.ParseJsonLegacy(file.json, nullptr, &room);
+					else parser.ParseJson(file.json, nullptr, &room, file.path);
+					DeleteDoors(room);
+				}
+			}
+		}
+		return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+	};
+	double legacyTime = timePasses(true);
+	double readerTime = timePasses(false);
+
+	auto report = [&](const char* name, double time) {
+		double perPass = time / iterations;
+		out << "  " << name << ": " << perPass << "ms a pass, "
+			<< (perPass > 0.0 ? (totalBytes / (1024.0 * 1024.0)) / (perPass / 1000.0) : 0.0) << "MB/s\n";
+	};
+	report("char-by-char maps", legacyTime);
+	report("JsonReader", readerTime);
+	out << "  JsonReader is " << (readerTime > 0.0 ? legacyTime / readerTime : 0.0) << "x as fast\n";
+}
@@ -0,0 +1,16 @@
+#pragma once
+#include <iosfwd>
+
+namespace NCL {
+	namespace CSC8503 {
+		/*
+		Parses every level and room file a number of times with JsonParser and
+		with the char-by-char parser it replaced. Kept apart from JsonParser.h so
+		callers don't pull in its variable names.
+		*/
+		class JsonParserBenchmark {
+		public:
+			static void Run(std::ostream& out, int iterations);
+		};
+	}
+}
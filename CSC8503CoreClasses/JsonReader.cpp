@@ -0,0 +1,216 @@
+#include "JsonReader.h"
+#include <charconv>
+
+using namespace NCL::CSC8503;
+
+JsonReader::JsonReader(std::string_view json) {
+	mJson = json;
+	mPos = 0;
+	mHasError = false;
+	mErrorLine = 0;
+	mErrorColumn = 0;
+}
+
+bool JsonReader::BeginObject() {
+	if (!Expect('{')) return false;
+	mScopeHasItems.push_back(false);
+	return true;
+}
+
+bool JsonReader::NextKey(std::string_view& key) {
+	if (mHasError) return false;
+	SkipWhitespace();
+	if (mPos < mJson.size() && mJson[mPos] == '}') {
+		mPos++;
+		mScopeHasItems.pop_back();
+		return false;
+	}
+	if (mScopeHasItems.back() && !Expect(',')) return false;
+	mScopeHasItems.back() = true;
+
+	if (!ScanString(key)) return false;
+	return Expect(':');
+}
+
+bool JsonReader::BeginArray() {
+	if (!Expect('[')) return false;
+	mScopeHasItems.push_back(false);
+	return true;
+}
+
+bool JsonReader::NextElement() {
+	if (mHasError) return false;
+	SkipWhitespace();
+	if (mPos < mJson.size() && mJson[mPos] == ']') {
+		mPos++;
+		mScopeHasItems.pop_back();
+		return false;
+	}
+	if (mScopeHasItems.back() && !Expect(',')) return false;
+	mScopeHasItems.back() = true;
+	return !mHasError;
+}
+
+bool JsonReader::ReadNumber(float& out) {
+	if (mHasError) return false;
+	SkipWhitespace();
+	const char* start = mJson.data() + mPos;
+	const char* end = mJson.data() + mJson.size();
+	if (start == end || (*start != '-' && (*start < '0' || *start > '9'))) {
+		SetError("expected a number");
+		return false;
+	}
+	auto [next, ec] = std::from_chars(start, end, out);
+	if (ec != std::errc()) {
+		SetError("number out of range");
+		return false;
+	}
+	mPos += next - start;
+	return true;
+}
+
+bool JsonReader::ReadString(std::string_view& out) {
+	if (mHasError) return false;
+	SkipWhitespace();
+	return ScanString(out);
+}
+
+bool JsonReader::SkipValue() {
+	switch (PeekType()) {
+	case ObjectStart:
+	{
+		std::string_view key;
+		if (!BeginObject()) return false;
+		while (NextKey(key)) {
+			if (!SkipValue()) return false;
+		}
+	}
+		break;
+	case ArrayStart:
+		if (!BeginArray()) return false;
+		while (NextElement()) {
+			if (!SkipValue()) return false;
+		}
+		break;
+	case String:
+	{
+		std::string_view value;
+		return ReadString(value);
+	}
+	case Number:
+	{
+		float value;
+		return ReadNumber(value);
+	}
+	case Boolean:
+		return ScanLiteral(mJson[mPos] == 't' ? "true" : "false");
+	case Null:
+		return ScanLiteral("null");
+	case EndOfInput:
+		SetError("unexpected end of input");
+		return false;
+	default:
+		SetError("unexpected character");
+		return false;
+	}
+	return !mHasError;
+}
+
+bool JsonReader::ExpectEnd() {
+	if (mHasError) return false;
+	SkipWhitespace();
+	if (mPos < mJson.size()) {
+		SetError("unexpected data after the end of the document");
+		return false;
+	}
+	return true;
+}
+
+JsonReader::TokenType JsonReader::PeekType() {
+	if (mHasError) return Invalid;
+	SkipWhitespace();
+	if (mPos >= mJson.size()) return EndOfInput;
+	switch (mJson[mPos]) {
+	case '{': return ObjectStart;
+	case '}': return ObjectEnd;
+	case '[': return ArrayStart;
+	case ']': return ArrayEnd;
+	case '"': return String;
+	case 't':
+	case 'f': return Boolean;
+	case 'n': return Null;
+	case '-': return Number;
+	default:
+		if (mJson[mPos] >= '0' && mJson[mPos] <= '9') return Number;
+		return Invalid;
+	}
+}
+
+void JsonReader::SetError(std::string_view message) {
+	if (mHasError) return;
+	mHasError = true;
+	mErrorMessage = message;
+
+	// only worked out on failure, so reading never has to track lines
+	mErrorLine = 1;
+	mErrorColumn = 1;
+	size_t errorPos = std::min(mPos, mJson.size());
+	for (size_t i = 0; i < errorPos; i++) {
+		if (mJson[i] == '\n') {
+			mErrorLine++;
+			mErrorColumn = 1;
+		}
+		else {
+			mErrorColumn++;
+		}
+	}
+	mPos = mJson.size();
+}
+
+void JsonReader::SkipWhitespace() {
+	while (mPos < mJson.size()) {
+		char c = mJson[mPos];
+		if (c != ' ' && c != '\n' && c != '\r' && c != '\t') return;
+		mPos++;
+	}
+}
+
+bool JsonReader::Expect(char c) {
+	if (mHasError) return false;
+	SkipWhitespace();
+	if (mPos >= mJson.size() || mJson[mPos] != c) {
+		SetError(std::string("expected '") + c + "'");
+		return false;
+	}
+	mPos++;
+	return true;
+}
+
+bool JsonReader::ScanString(std::string_view& out) {
+	if (mPos >= mJson.size() || mJson[mPos] != '"') {
+		SetError("expected a string");
+		return false;
+	}
+	size_t start = ++mPos;
+	while (mPos < mJson.size()) {
+		char c = mJson[mPos];
+		if (c == '"') {
+			out = mJson.substr(start, mPos - start);
+			mPos++;
+			return true;
+		}
+		mPos += (c == '\\') ? 2 : 1;
+	}
+	mPos = start - 1;
+	SetError("unterminated string");
+	return false;
+}
+
+bool JsonReader::ScanLiteral(std::string_view literal) {
+	if (mJson.substr(mPos, literal.size()) != literal) {
+		SetError("unexpected character");
+		return false;
+	}
+	mPos += literal.size();
+	return true;
+}
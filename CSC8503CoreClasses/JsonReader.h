@@ -0,0 +1,74 @@
+#pragma once
+#include <string_view>
+
+namespace NCL {
+	namespace CSC8503 {
+		/*
+		Pull tokenizer over a JSON document that is already in memory. Strings
+		come back as views into the source, so nothing is copied while reading;
+		escape sequences are skipped over but left undecoded, which is fine for
+		the keys and values our level files use. The first error stops the read
+		and is kept with its line and column for the caller to report.
+		*/
+		class JsonReader {
+		public:
+			enum TokenType {
+				ObjectStart,
+				ObjectEnd,
+				ArrayStart,
+				ArrayEnd,
+				String,
+				Number,
+				Boolean,
+				Null,
+				EndOfInput,
+				Invalid
+			};
+
+			JsonReader(std::string_view json);
+			~JsonReader() {}
+
+			//Starts an object and returns false if the next value isn't one
+			bool BeginObject();
+			//Reads the next key of the current object, or returns false at its end
+			bool NextKey(std::string_view& key);
+
+			//Starts an array and returns false if the next value isn't one
+			bool BeginArray();
+			//Moves on to the next element of the current array, or returns false at its end
+			bool NextElement();
+
+			bool ReadNumber(float& out);
+			bool ReadString(std::string_view& out);
+			bool SkipValue();
+
+			//Checks nothing but whitespace follows the root value
+			bool ExpectEnd();
+
+			TokenType PeekType();
+
+			void SetError(std::string_view message);
+			bool HasError() const { return mHasError; }
+			const std::string& GetErrorMessage() const { return mErrorMessage; }
+			int GetErrorLine() const { return mErrorLine; }
+			int GetErrorColumn() const { return mErrorColumn; }
+
+		protected:
+			void SkipWhitespace();
+			bool Expect(char c);
+			bool ScanString(std::string_view& out);
+			bool ScanLiteral(std::string_view literal);
+
+			std::string_view mJson;
+			size_t mPos;
+
+			// one entry per open object or array, set once it has had a member
+			std::vector<bool> mScopeHasItems;
+
+			bool mHasError;
+			std::string mErrorMessage;
+			int mErrorLine;
+			int mErrorColumn;
+		};
+	}
+}
@@ -1,28 +1,43 @@
 #include "Level.h"
 #include "Vent.h"
 #include "JsonParser.h"
-#include <fstream>
+#include "LevelCooker.h"
+#include "Assets.h"
+#include "LoadProfiler.h"
 
 using namespace NCL::CSC8503;
 
 
-Level::Level(std::string levelPath) {
-	mLevelName = levelPath.substr(24, levelPath.size()-29);
+Level::Level() {
 	mPlayerStartTransforms = new Transform[MAX_PLAYERS];
-	std::ifstream levelFile(levelPath);
-	std::string line;
-	getline(levelFile, line);
+	mGuardCount = 0;
+	mCCTVCount = 0;
+	mPrisonDoor = nullptr;
+}
+
+Level::Level(std::string levelPath) : Level() {
+	mLevelName = levelPath.substr(24, levelPath.size()-29);
+
+	std::string json;
+	if (!Assets::ReadTextFile(levelPath, json)) return;
+
+	uint64_t sourceHash = LevelCooker::HashSource(json);
+	std::string cookedPath = LevelCooker::GetCookedPath(levelPath);
+	if (LevelCooker::Load(cookedPath, sourceHash, *this)) return;
 
 	JsonParser parser = JsonParser();
 
-	parser.ParseJson(line, this, nullptr);
+	if (parser.ParseJson(json, this, nullptr, levelPath)) {
+		LoadMarker marker("Cook level", cookedPath);
+		LevelCooker::Cook(*this, sourceHash, cookedPath);
+	}
 }
 
 Level::~Level() {
 	for (auto const& [key, val] : mRoomList) {
 		delete(val);
-		mRoomList.erase(key);
 	}
+	mRoomList.clear();
 	for (int i = 0; i < mLights.size(); i++) {
 		delete(mLights[i]);
 	}
@@ -31,4 +46,5 @@ Level::~Level() {
 		delete(mVents[i]);
 	}
 	mVents.clear();
+	delete[] mPlayerStartTransforms;
 }
@@ -11,6 +11,7 @@ namespace NCL {
 
 		class Level {
 		public:
+			Level();
 			Level(std::string levelPath);
 			~Level();
 			const std::map<Vector3, TileType>& GetTileMap() { return mTileMap; }
@@ -30,6 +31,7 @@ namespace NCL {
 			PrisonDoor* GetPrisonDoor() const { return mPrisonDoor; }
 
 			friend class JsonParser;
+			friend class LevelCooker;
 		protected:
 			std::string mLevelName;
 			std::map<Vector3, TileType> mTileMap;
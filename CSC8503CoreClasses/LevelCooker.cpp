@@ -0,0 +1,444 @@
+#include "LevelCooker.h"
+#include "Level.h"
+#include "Vent.h"
+#include "PointLight.h"
+#include "SpotLight.h"
+#include "AssetFile.h"
+#include <filesystem>
+#include <fstream>
+#include <span>
+#include <thread>
+
+using namespace NCL;
+using namespace CSC8503;
+
+namespace {
+	constexpr uint32_t COOKED_LEVEL_MAGIC = 0x424C564C; // "LVLB"
+
+	enum CookedKind : uint32_t {
+		KIND_LEVEL,
+		KIND_ROOM
+	};
+
+	enum CookedSection {
+		SECTION_TILES,
+		SECTION_ROOMS,
+		SECTION_PATHS,
+		SECTION_PATH_NODES,
+		SECTION_CCTV,
+		SECTION_PLAYER_STARTS,
+		SECTION_LIGHTS,
+		SECTION_ITEMS,
+		SECTION_VENTS,
+		SECTION_DOORS,
+		SECTION_COUNT
+	};
+
+	static_assert(sizeof(Vector3) == 3 * sizeof(float), "cooked levels store Vector3 directly");
+	static_assert(sizeof(Vector4) == 4 * sizeof(float), "cooked levels store Vector4 directly");
+	static_assert(sizeof(Quaternion) == 4 * sizeof(float), "cooked levels store Quaternion directly");
+
+	struct CookedTransform {
+		Vector3 position;
+		Quaternion orientation;
+	};
+
+	//A tile, or a room placed in a level
+	struct CookedPlacement {
+		Vector3 position;
+		int32_t type;
+	};
+
+	//A range of the path node section
+	struct CookedPath {
+		uint32_t firstNode;
+		uint32_t nodeCount;
+	};
+
+	struct CookedLight {
+		int32_t type;
+		Vector3 position;
+		Vector4 colour;
+		Vector3 direction;
+		float radius;
+		float angle;
+	};
+
+	struct CookedVent {
+		CookedTransform transform;
+		int32_t connection;
+	};
+
+	struct SectionRange {
+		uint32_t offset;
+		uint32_t count;
+	};
+
+	struct CookedHeader {
+		uint32_t magic;
+		uint32_t version;
+		uint32_t kind;
+		uint32_t sectionCount;
+		uint64_t sourceHash;
+
+		int32_t roomType;
+		int32_t guardCount;
+		int32_t cctvCount;
+		int32_t hasPrisonDoor;
+		Vector3 prisonPosition;
+		Vector3 helipadPosition;
+		CookedTransform prisonDoor;
+
+		SectionRange sections[SECTION_COUNT];
+	};
+
+	constexpr size_t SECTION_STRIDES[SECTION_COUNT] = {
+		sizeof(CookedPlacement),
+		sizeof(CookedPlacement),
+		sizeof(CookedPath),
+		sizeof(Vector3),
+		sizeof(CookedTransform),
+		sizeof(CookedTransform),
+		sizeof(CookedLight),
+		sizeof(Vector3),
+		sizeof(CookedVent),
+		sizeof(CookedTransform)
+	};
+
+	CookedTransform ToCooked(const Transform& transform) {
+		return { transform.GetPosition(), transform.GetOrientation() };
+	}
+
+	Transform FromCooked(const CookedTransform& cooked) {
+		Transform transform = Transform();
+		transform.SetPosition(cooked.position).SetOrientation(cooked.orientation);
+		return transform;
+	}
+
+	class CookedWriter {
+	public:
+		CookedWriter(CookedKind kind, uint64_t sourceHash) {
+			mHeader = {};
+			mHeader.magic = COOKED_LEVEL_MAGIC;
+			mHeader.version = LevelCooker::VERSION;
+			mHeader.kind = kind;
+			mHeader.sectionCount = SECTION_COUNT;
+			mHeader.sourceHash = sourceHash;
+			mBuffer.resize(sizeof(CookedHeader));
+		}
+
+		CookedHeader& GetHeader() {
+			return mHeader;
+		}
+
+		template<typename T>
+		void WriteSection(CookedSection section, const std::vector<T>& items) {
+			static_assert(std::is_trivially_copyable_v<T>);
+			mHeader.sections[section].offset = (uint32_t)mBuffer.size();
+			mHeader.sections[section].count = (uint32_t)items.size();
+			const char* bytes = (const char*)items.data();
+			mBuffer.insert(mBuffer.end(), bytes, bytes + items.size() * sizeof(T));
+		}
+
+		void WriteTiles(const std::map<Vector3, TileType>& tileMap) {
+			std::vector<CookedPlacement> tiles;
+			tiles.reserve(tileMap.size());
+			for (const auto& [position, type] : tileMap) {
+				tiles.push_back({ position, (int32_t)type });
+			}
+			WriteSection(SECTION_TILES, tiles);
+		}
+
+		void WriteLights(const std::vector<Light*>& lights) {
+			std::vector<CookedLight> cooked;
+			cooked.reserve(lights.size());
+			for (const Light* light : lights) {
+				CookedLight entry = {};
+				entry.type = light->GetType();
+				entry.colour = light->GetColour();
+				if (light->GetType() == Light::Point || light->GetType() == Light::Spot) {
+					const PointLight* pointLight = (const PointLight*)light;
+					entry.position = pointLight->GetPosition();
+					entry.radius = pointLight->GetRadius();
+				}
+				if (light->GetType() == Light::Spot) {
+					const SpotLight* spotLight = (const SpotLight*)light;
+					entry.direction = spotLight->GetDirection();
+					entry.angle = spotLight->GetAngle();
+				}
+				else if (light->GetType() != Light::Point) {
+					continue;
+				}
+				cooked.push_back(entry);
+			}
+			WriteSection(SECTION_LIGHTS, cooked);
+		}
+
+		void WriteTransforms(CookedSection section, const Transform* transforms, size_t count) {
+			std::vector<CookedTransform> cooked;
+			cooked.reserve(count);
+			for (size_t i = 0; i < count; i++) {
+				cooked.push_back(ToCooked(transforms[i]));
+			}
+			WriteSection(section, cooked);
+		}
+
+		template<typename T>
+		void WriteObjectTransforms(CookedSection section, const std::vector<T*>& objects) {
+			std::vector<CookedTransform> cooked;
+			cooked.reserve(objects.size());
+			for (T* object : objects) {
+				cooked.push_back(ToCooked(object->GetTransform()));
+			}
+			WriteSection(section, cooked);
+		}
+
+		bool Save(const std::string& cookedPath) {
+			memcpy(mBuffer.data(), &mHeader, sizeof(CookedHeader));
+			// written under a temporary name and moved into place, so a level
+			// loading on another thread never maps a half written file
+			std::string tempPath = cookedPath + "." + std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id())) + ".tmp";
+			{
+				std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+				if (!file.write(mBuffer.data(), mBuffer.size())) {
+					std::cout << "LevelCooker: can't write " << cookedPath << "\n";
+					return false;
+				}
+			}
+			std::error_code error;
+			std::filesystem::rename(tempPath, cookedPath, error);
+			if (error) {
+				std::filesystem::remove(tempPath, error);
+				std::cout << "LevelCooker: can't write " << cookedPath << "\n";
+				return false;
+			}
+			return true;
+		}
+
+	protected:
+		CookedHeader mHeader;
+		std::vector<char> mBuffer;
+	};
+
+	class CookedReader {
+	public:
+		bool Open(const std::string& cookedPath, CookedKind kind, uint64_t sourceHash) {
+			if (!mFile.Open(cookedPath) || mFile.GetSize() < sizeof(CookedHeader)) {
+				return false;
+			}
+			memcpy(&mHeader, mFile.GetData(), sizeof(CookedHeader));
+			if (mHeader.magic != COOKED_LEVEL_MAGIC || mHeader.version != LevelCooker::VERSION ||
+				mHeader.kind != kind || mHeader.sectionCount != SECTION_COUNT || mHeader.sourceHash != sourceHash) {
+				return false;
+			}
+			for (int i = 0; i < SECTION_COUNT; i++) {
+				const SectionRange& range = mHeader.sections[i];
+				if (range.count == 0) continue;
+				if (range.offset % alignof(float) != 0 || range.offset > mFile.GetSize() ||
+					range.count > (mFile.GetSize() - range.offset) / SECTION_STRIDES[i]) {
+					return false;
+				}
+			}
+			std::span<const CookedPath> paths = GetSection<CookedPath>(SECTION_PATHS);
+			uint32_t nodeCount = mHeader.sections[SECTION_PATH_NODES].count;
+			for (const CookedPath& path : paths) {
+				if (path.firstNode > nodeCount || path.nodeCount > nodeCount - path.firstNode) {
+					return false;
+				}
+			}
+			return true;
+		}
+
+		const CookedHeader& GetHeader() const {
+			return mHeader;
+		}
+
+		template<typename T>
+		std::span<const T> GetSection(CookedSection section) const {
+			const SectionRange& range = mHeader.sections[section];
+			if (range.count == 0) return {};
+			return std::span<const T>((const T*)(mFile.GetData() + range.offset), range.count);
+		}
+
+		void ReadTiles(std::map<Vector3, TileType>& tileMap) const {
+			// tiles were written in map order, so each one goes on the end
+			for (const CookedPlacement& tile : GetSection<CookedPlacement>(SECTION_TILES)) {
+				tileMap.emplace_hint(tileMap.end(), tile.position, (TileType)tile.type);
+			}
+		}
+
+		void ReadLights(std::vector<Light*>& lights) const {
+			std::span<const CookedLight> cooked = GetSection<CookedLight>(SECTION_LIGHTS);
+			lights.reserve(lights.size() + cooked.size());
+			for (const CookedLight& light : cooked) {
+				if (light.type == Light::Spot) {
+					lights.push_back((Light*)new SpotLight(light.direction, light.position, light.colour, light.radius, light.angle, 1.0f));
+				}
+				else {
+					lights.push_back((Light*)new PointLight(light.position, light.colour, light.radius));
+				}
+			}
+		}
+
+		void ReadTransforms(CookedSection section, std::vector<Transform>& transforms) const {
+			std::span<const CookedTransform> cooked = GetSection<CookedTransform>(section);
+			transforms.reserve(transforms.size() + cooked.size());
+			for (const CookedTransform& transform : cooked) {
+				transforms.push_back(FromCooked(transform));
+			}
+		}
+
+		void ReadDoors(std::vector<Door*>& doors) const {
+			std::span<const CookedTransform> cooked = GetSection<CookedTransform>(SECTION_DOORS);
+			doors.reserve(doors.size() + cooked.size());
+			for (const CookedTransform& transform : cooked) {
+				Door* door = new Door();
+				door->GetTransform().SetPosition(transform.position).SetOrientation(transform.orientation);
+				doors.push_back(door);
+			}
+		}
+
+		void ReadItems(std::vector<Vector3>& items) const {
+			std::span<const Vector3> cooked = GetSection<Vector3>(SECTION_ITEMS);
+			items.insert(items.end(), cooked.begin(), cooked.end());
+		}
+
+	protected:
+		AssetFile mFile;
+		CookedHeader mHeader;
+	};
+}
+
+std::string LevelCooker::GetCookedPath(const std::string& sourcePath) {
+	return std::filesystem::path(sourcePath).replace_extension(".lvlb").string();
+}
+
+uint64_t LevelCooker::HashSource(std::string_view source) {
+	// FNV-1a, only used to notice the source has changed
+	uint64_t hash = 14695981039346656037ull;
+	for (char c : source) {
+		hash ^= (uint8_t)c;
+		hash *= 1099511628211ull;
+	}
+	return hash;
+}
+
+bool LevelCooker::Cook(const Level& level, uint64_t sourceHash, const std::string& cookedPath) {
+	CookedWriter writer(KIND_LEVEL, sourceHash);
+	CookedHeader& header = writer.GetHeader();
+	header.guardCount = level.mGuardCount;
+	header.cctvCount = level.mCCTVCount;
+	header.prisonPosition = level.mPrisonPosition;
+	header.helipadPosition = level.mHelipadPosition;
+	header.hasPrisonDoor = level.mPrisonDoor != nullptr;
+	if (level.mPrisonDoor) {
+		header.prisonDoor = ToCooked(level.mPrisonDoor->GetTransform());
+	}
+
+	writer.WriteTiles(level.mTileMap);
+
+	std::vector<CookedPlacement> rooms;
+	for (const auto& [position, room] : level.mRoomList) {
+		rooms.push_back({ position, (int32_t)room->GetType() });
+	}
+	writer.WriteSection(SECTION_ROOMS, rooms);
+
+	std::vector<CookedPath> paths;
+	std::vector<Vector3> pathNodes;
+	for (const std::vector<Vector3>& path : level.mGuardPaths) {
+		paths.push_back({ (uint32_t)pathNodes.size(), (uint32_t)path.size() });
+		pathNodes.insert(pathNodes.end(), path.begin(), path.end());
+	}
+	writer.WriteSection(SECTION_PATHS, paths);
+	writer.WriteSection(SECTION_PATH_NODES, pathNodes);
+
+	writer.WriteTransforms(SECTION_CCTV, level.mCCTVTransforms.data(), level.mCCTVTransforms.size());
+	writer.WriteTransforms(SECTION_PLAYER_STARTS, level.mPlayerStartTransforms, MAX_PLAYERS);
+	writer.WriteLights(level.mLights);
+	writer.WriteSection(SECTION_ITEMS, level.mItemPositions);
+
+	std::vector<CookedVent> vents;
+	for (size_t i = 0; i < level.mVents.size(); i++) {
+		int connection = i < level.mVentConnections.size() ? level.mVentConnections[i] : 0;
+		vents.push_back({ ToCooked(level.mVents[i]->GetTransform()), connection });
+	}
+	writer.WriteSection(SECTION_VENTS, vents);
+	writer.WriteObjectTransforms(SECTION_DOORS, level.mDoors);
+
+	return writer.Save(cookedPath);
+}
+
+bool LevelCooker::Cook(const Room& room, uint64_t sourceHash, const std::string& cookedPath) {
+	CookedWriter writer(KIND_ROOM, sourceHash);
+	writer.GetHeader().roomType = room.mType;
+
+	writer.WriteTiles(room.mTileMap);
+	writer.WriteTransforms(SECTION_CCTV, room.mCCTVTransforms.data(), room.mCCTVTransforms.size());
+	writer.WriteLights(room.mLights);
+	writer.WriteSection(SECTION_ITEMS, room.mItemPositions);
+	writer.WriteObjectTransforms(SECTION_DOORS, room.mDoors);
+
+	return writer.Save(cookedPath);
+}
+
+bool LevelCooker::Load(const std::string& cookedPath, uint64_t sourceHash, Level& level) {
+	CookedReader reader;
+	if (!reader.Open(cookedPath, KIND_LEVEL, sourceHash)) {
+		return false;
+	}
+	const CookedHeader& header = reader.GetHeader();
+	level.mGuardCount = header.guardCount;
+	level.mCCTVCount = header.cctvCount;
+	level.mPrisonPosition = header.prisonPosition;
+	level.mHelipadPosition = header.helipadPosition;
+	if (header.hasPrisonDoor) {
+		level.mPrisonDoor = new PrisonDoor();
+		level.mPrisonDoor->GetTransform().SetPosition(header.prisonDoor.position).SetOrientation(header.prisonDoor.orientation);
+	}
+
+	reader.ReadTiles(level.mTileMap);
+
+	for (const CookedPlacement& room : reader.GetSection<CookedPlacement>(SECTION_ROOMS)) {
+		level.mRoomList[room.position] = new Room(room.type);
+	}
+
+	std::span<const Vector3> pathNodes = reader.GetSection<Vector3>(SECTION_PATH_NODES);
+	for (const CookedPath& path : reader.GetSection<CookedPath>(SECTION_PATHS)) {
+		std::span<const Vector3> nodes = pathNodes.subspan(path.firstNode, path.nodeCount);
+		level.mGuardPaths.emplace_back(nodes.begin(), nodes.end());
+	}
+
+	reader.ReadTransforms(SECTION_CCTV, level.mCCTVTransforms);
+
+	std::span<const CookedTransform> playerStarts = reader.GetSection<CookedTransform>(SECTION_PLAYER_STARTS);
+	for (size_t i = 0; i < playerStarts.size() && i < MAX_PLAYERS; i++) {
+		level.mPlayerStartTransforms[i] = FromCooked(playerStarts[i]);
+	}
+
+	reader.ReadLights(level.mLights);
+	reader.ReadItems(level.mItemPositions);
+
+	for (const CookedVent& cooked : reader.GetSection<CookedVent>(SECTION_VENTS)) {
+		Vent* vent = new Vent();
+		vent->GetTransform().SetPosition(cooked.transform.position).SetOrientation(cooked.transform.orientation);
+		level.mVents.push_back(vent);
+		level.mVentConnections.push_back(cooked.connection);
+	}
+	reader.ReadDoors(level.mDoors);
+	return true;
+}
+
+bool LevelCooker::Load(const std::string& cookedPath, uint64_t sourceHash, Room& room) {
+	CookedReader reader;
+	if (!reader.Open(cookedPath, KIND_ROOM, sourceHash)) {
+		return false;
+	}
+	room.mType = (RoomType)reader.GetHeader().roomType;
+
+	reader.ReadTiles(room.mTileMap);
+	reader.ReadTransforms(SECTION_CCTV, room.mCCTVTransforms);
+	reader.ReadLights(room.mLights);
+	reader.ReadItems(room.mItemPositions);
+	reader.ReadDoors(room.mDoors);
+	return true;
+}
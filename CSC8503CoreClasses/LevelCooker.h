@@ -0,0 +1,35 @@
+#pragma once
+#include <string_view>
+
+namespace NCL {
+	namespace CSC8503 {
+		class Level;
+		class Room;
+
+		/*
+		Converts parsed levels and rooms to and from a versioned binary file kept
+		beside the JSON source. The file is a fixed header followed by flat
+		arrays of tiles, rooms, paths, transforms, lights and vents, each found
+		through an offset and count in the header, with everything already in
+		world space. Loading maps the file and copies the arrays straight out.
+
+		The header stores a hash of the JSON it was cooked from, so an edited
+		source no longer matches and the caller falls back to the JSON parser
+		and recooks.
+		*/
+		class LevelCooker {
+		public:
+			static constexpr uint32_t VERSION = 1;
+
+			static std::string GetCookedPath(const std::string& sourcePath);
+			static uint64_t HashSource(std::string_view source);
+
+			static bool Cook(const Level& level, uint64_t sourceHash, const std::string& cookedPath);
+			static bool Cook(const Room& room, uint64_t sourceHash, const std::string& cookedPath);
+
+			//Returns false if the file is missing, stale or malformed
+			static bool Load(const std::string& cookedPath, uint64_t sourceHash, Level& level);
+			static bool Load(const std::string& cookedPath, uint64_t sourceHash, Room& room);
+		};
+	}
+}
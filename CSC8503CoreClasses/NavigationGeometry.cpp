@@ -0,0 +1,50 @@
+#include "NavigationGeometry.h"
+#include "Level.h"
+#include "Mesh.h"
+
+using namespace NCL;
+using namespace Rendering;
+using namespace CSC8503;
+
+namespace {
+	void AddBox(const Mesh& cube, const Vector3& position, const Vector3& halfSize,
+		std::vector<float>& verts, std::vector<unsigned int>& tris) {
+		unsigned int firstVert = (unsigned int)(verts.size() / 3);
+		Vector3 scale = halfSize * 2;
+		for (const Vector3& vert : cube.GetPositionData()) {
+			Vector3 worldVert = (vert * scale) + position;
+			verts.insert(verts.end(), { worldVert.x, worldVert.y, worldVert.z });
+		}
+		for (unsigned int index : cube.GetIndexData()) {
+			tris.push_back(index + firstVert);
+		}
+	}
+
+	//Walls, and floors below ground level, as LevelManager lays a tile map out
+	void AddTiles(const Mesh& cube, const std::map<Vector3, TileType>& tileMap, const Vector3& offset,
+		std::vector<float>& verts, std::vector<unsigned int>& tris) {
+		for (auto const& [key, val] : tileMap) {
+			Vector3 position = key + offset;
+			if (val == Wall) {
+				AddBox(cube, position, NavigationGeometry::WALL_HALF_SIZE, verts, tris);
+			}
+			else if (val == Floor && position.y < 0) {
+				AddBox(cube, position, NavigationGeometry::FLOOR_HALF_SIZE, verts, tris);
+			}
+		}
+	}
+}
+
+void NavigationGeometry::Build(Level& level, const std::vector<Room*>& rooms, const Mesh& cube,
+	std::vector<float>& verts, std::vector<unsigned int>& tris) {
+	AddTiles(cube, level.GetTileMap(), Vector3(), verts, tris);
+	AddBox(cube, level.GetHelipadPosition(), HELIPAD_HALF_SIZE, verts, tris);
+	for (auto const& [offset, levelRoom] : level.GetRooms()) {
+		for (const Room* room : rooms) {
+			if (room && room->GetType() == levelRoom->GetType() && room->GetType() == Medium) {
+				AddTiles(cube, room->GetTileMap(), offset, verts, tris);
+				break;
+			}
+		}
+	}
+}
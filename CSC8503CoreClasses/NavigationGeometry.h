@@ -0,0 +1,31 @@
+#pragma once
+#include "Vector3.h"
+#include <vector>
+
+namespace NCL {
+	namespace Rendering {
+		class Mesh;
+	}
+	namespace CSC8503 {
+		class Level;
+		class Room;
+
+		/*
+		The geometry a level's navmesh is built from: its walls, its sunken
+		floors and the helipad, then the same tiles of every room it streams in,
+		each a box of the cube mesh scaled and moved into world space. The game
+		and the AssetCooker both build the navmesh from this, so the cooker's
+		cache is found under the same hash when the game loads the level.
+		*/
+		class NavigationGeometry {
+		public:
+			static constexpr Maths::Vector3 WALL_HALF_SIZE = Maths::Vector3(5, 5, 5);
+			static constexpr Maths::Vector3 FLOOR_HALF_SIZE = Maths::Vector3(5, 0.5f, 5);
+			static constexpr Maths::Vector3 HELIPAD_HALF_SIZE = Maths::Vector3(15, 0.5f, 15);
+
+			//rooms are every room loaded, of which the level uses the first of each type
+			static void Build(Level& level, const std::vector<Room*>& rooms, const Rendering::Mesh& cube,
+				std::vector<float>& verts, std::vector<unsigned int>& tris);
+		};
+	}
+}
@@ -1,7 +1,12 @@
 #include "NavigationGrid.h"
 #include "Assets.h"
 
+#include <algorithm>
+#include <cfloat>
+#include <chrono>
 #include <fstream>
+#include <iostream>
+#include <random>
 
 using namespace NCL;
 using namespace CSC8503;
@@ -14,11 +19,144 @@ const int BOTTOM_NODE	= 3;
 const char WALL_NODE	= 'x';
 const char FLOOR_NODE	= '.';
 
+namespace {
+	// an entrance between clusters at least this wide gets a transition at
+	// each end rather than one in the middle, so paths along a wide opening
+	// don't all bend through its centre
+	constexpr int ENTRANCE_SPLIT_WIDTH = 6;
+
+	constexpr int BENCHMARK_PATHS = 200;
+	constexpr int BENCHMARK_CLUSTER_SIZE = 16;
+	constexpr int BENCHMARK_ROOM_SIZE = 16;
+	constexpr float BENCHMARK_PILLAR_CHANCE = 0.1f;
+
+	double MillisecondsSince(std::chrono::high_resolution_clock::time_point start) {
+		return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+	}
+
+	int Sign(int value) {
+		return (value > 0) - (value < 0);
+	}
+
+	//Rooms of roomSize cells with a doorway or two in each wall, scattered with pillars
+	std::vector<std::string> GenerateRows(int width, int height, int roomSize, float pillarChance, unsigned int seed) {
+		std::mt19937 random(seed);
+		std::uniform_real_distribution<float> chance(0.0f, 1.0f);
+		std::vector<std::string> rows(height, std::string(width, FLOOR_NODE));
+		for (int z = 0; z < height; ++z) {
+			for (int x = 0; x < width; ++x) {
+				bool edge = x == 0 || z == 0 || x == width - 1 || z == height - 1;
+				bool wall = x % roomSize == 0 || z % roomSize == 0;
+				if (edge || (wall && chance(random) > 0.15f) || chance(random) < pillarChance) {
+					rows[z][x] = WALL_NODE;
+				}
+			}
+		}
+		return rows;
+	}
+}
+
+void GridSearch::OpenList::Begin(size_t nodeCount) {
+	if (nodes.size() != nodeCount) {
+		nodes.assign(nodeCount, NodeState());
+		generation = 0;
+	}
+	heap.clear();
+	// once the stamp wraps round, old ones could pass for current
+	if (++generation == 0) {
+		for (NodeState& node : nodes) {
+			node.generation = 0;
+		}
+		generation = 1;
+	}
+}
+
+GridSearch::NodeState& GridSearch::OpenList::Get(int node) {
+	NodeState& state = nodes[node];
+	if (state.generation != generation) {
+		state = { FLT_MAX, FLT_MAX, -1, -1, generation, false };
+	}
+	return state;
+}
+
+// ties go to the node furthest along, which is usually nearest the goal
+bool GridSearch::OpenList::Before(int a, int b) const {
+	const NodeState& first = nodes[a];
+	const NodeState& second = nodes[b];
+	return first.f < second.f || (first.f == second.f && first.g > second.g);
+}
+
+void GridSearch::OpenList::Push(int node) {
+	nodes[node].heapIndex = (int)heap.size();
+	heap.push_back(node);
+	SiftUp((int)heap.size() - 1);
+}
+
+void GridSearch::OpenList::Reprioritise(int node) {
+	SiftUp(nodes[node].heapIndex);
+}
+
+int GridSearch::OpenList::Pop() {
+	int top = heap.front();
+	int last = heap.back();
+	heap.pop_back();
+	if (!heap.empty()) {
+		heap.front() = last;
+		nodes[last].heapIndex = 0;
+		SiftDown(0);
+	}
+	nodes[top].heapIndex = -1;
+	return top;
+}
+
+void GridSearch::OpenList::SiftUp(int position) {
+	int node = heap[position];
+	while (position > 0) {
+		int parent = (position - 1) / 2;
+		if (!Before(node, heap[parent])) {
+			break;
+		}
+		heap[position] = heap[parent];
+		nodes[heap[position]].heapIndex = position;
+		position = parent;
+	}
+	heap[position] = node;
+	nodes[node].heapIndex = position;
+}
+
+void GridSearch::OpenList::SiftDown(int position) {
+	int node = heap[position];
+	int count = (int)heap.size();
+	while (true) {
+		int child = position * 2 + 1;
+		if (child >= count) {
+			break;
+		}
+		if (child + 1 < count && Before(heap[child + 1], heap[child])) {
+			child++;
+		}
+		if (!Before(heap[child], node)) {
+			break;
+		}
+		heap[position] = heap[child];
+		nodes[heap[position]].heapIndex = position;
+		position = child;
+	}
+	heap[position] = node;
+	nodes[node].heapIndex = position;
+}
+
 NavigationGrid::NavigationGrid()	{
 	nodeSize	= 0;
 	gridWidth	= 0;
 	gridHeight	= 0;
+	uniformCost	= false;
+	minCost		= 1.0f;
 	allNodes	= nullptr;
+	searchMode	= AStar;
+	clusterSize	= 0;
+	clustersX	= 0;
+	clustersZ	= 0;
 }
 
 NavigationGrid::NavigationGrid(const std::string&filename) : NavigationGrid() {
@@ -28,22 +166,43 @@ NavigationGrid::NavigationGrid(const std::string&filename) : NavigationGrid() {
 	infile >> gridWidth;
 	infile >> gridHeight;
 
+	std::vector<std::string> rows(gridHeight, std::string(gridWidth, 0));
+	for (int y = 0; y < gridHeight; ++y) {
+		for (int x = 0; x < gridWidth; ++x) {
+			infile >> rows[y][x];
+		}
+	}
+	BuildNodes(rows);
+}
+
+NavigationGrid::NavigationGrid(const std::vector<std::string>& rows, int nodeSize) : NavigationGrid() {
+	this->nodeSize = nodeSize;
+	gridHeight = (int)rows.size();
+	gridWidth = rows.empty() ? 0 : (int)rows[0].size();
+	BuildNodes(rows);
+}
+
+NavigationGrid::~NavigationGrid()	{
+	delete[] allNodes;
+}
+
+void NavigationGrid::BuildNodes(const std::vector<std::string>& rows) {
 	allNodes = new GridNode[gridWidth * gridHeight];
 
 	for (int y = 0; y < gridHeight; ++y) {
 		for (int x = 0; x < gridWidth; ++x) {
 			GridNode&n = allNodes[(gridWidth * y) + x];
-			char type = 0;
-			infile >> type;
-			n.type = type;
+			n.type = rows[y][x];
 			n.position = Vector3((float)(x * nodeSize), 0, (float)(y * nodeSize));
 		}
 	}
-	
+
 	//now to build the connectivity between the nodes
+	uniformCost = true;
+	minCost = FLT_MAX;
 	for (int y = 0; y < gridHeight; ++y) {
 		for (int x = 0; x < gridWidth; ++x) {
-			GridNode&n = allNodes[(gridWidth * y) + x];		
+			GridNode&n = allNodes[(gridWidth * y) + x];
 
 			if (y > 0) { //get the above node
 				n.connected[0] = &allNodes[(gridWidth * (y - 1)) + x];
@@ -59,23 +218,29 @@ NavigationGrid::NavigationGrid(const std::string&filename) : NavigationGrid() {
 			}
 			for (int i = 0; i < 4; ++i) {
 				if (n.connected[i]) {
-					if (n.connected[i]->type == '.') {
-						n.costs[i]		= 1;
-					}
-					if (n.connected[i]->type == 'x') {
+					// every open cell is a step, whatever else is marked on it
+					n.costs[i]		= 1;
+					if (n.connected[i]->type == WALL_NODE) {
 						n.connected[i] = nullptr; //actually a wall, disconnect!
 					}
 				}
+				if (n.connected[i]) {
+					uniformCost &= n.costs[i] == 1;
+					minCost = std::min(minCost, (float)n.costs[i]);
+				}
 			}
-		}	
+		}
+	}
+	if (minCost == FLT_MAX) {
+		minCost = 1.0f;
 	}
 }
 
-NavigationGrid::~NavigationGrid()	{
-	delete[] allNodes;
+bool NavigationGrid::FindPath(const Vector3& from, const Vector3& to, NavigationPath& outPath) {
+	return FindPath(from, to, outPath, defaultSearch, searchMode);
 }
 
-bool NavigationGrid::FindPath(const Vector3& from, const Vector3& to, NavigationPath& outPath) {
+bool NavigationGrid::FindPath(const Vector3& from, const Vector3& to, NavigationPath& outPath, GridSearch& search, SearchMode mode) const {
 	//need to work out which node 'from' sits in, and 'to' sits in
 	// get node coordinates in grid format, not world space
 	int fromX = ((int)from.x / nodeSize);
@@ -95,85 +260,535 @@ bool NavigationGrid::FindPath(const Vector3& from, const Vector3& to, Navigation
 		return false;
 	}
 
-	// define starting and end nodes
-	GridNode* startNode = &allNodes[(fromZ * gridWidth) + fromX];
-	GridNode* endNode	= &allNodes[(toZ * gridWidth) + toX];
-	// define open and closed list to store unsearched and searched nodes respectively
-	std::vector<GridNode*>  openList;
-	std::vector<GridNode*>  closedList;
+	int startCell = (fromZ * gridWidth) + fromX;
+	int endCell = (toZ * gridWidth) + toX;
+	auto start = std::chrono::high_resolution_clock::now();
+	search.mStats.searches++;
+	// nothing leads into a wall, so there's no need to search everywhere to find that out
+	if (startCell != endCell && !IsWalkable(toX, toZ)) {
+		search.mStats.failures++;
+		return false;
+	}
+
+	bool hierarchical = mode == Hierarchical && clusterSize > 0;
+	float cost;
+	if (hierarchical) {
+		cost = SearchHierarchy(startCell, endCell, search);
+	}
+	else if (mode == JumpPoint && uniformCost) {
+		cost = SearchJumpPoints(startCell, endCell, search);
+	}
+	else {
+		cost = SearchCells(startCell, endCell, nullptr, search);
+	}
+	search.mStats.searchTime += MillisecondsSince(start);
+	if (cost < 0.0f) {
+		search.mStats.failures++;
+		return false;
+	}
+	search.mLastCost = cost;
+
+	// waypoints go in end first, to be popped off from the start
+	if (hierarchical) {
+		for (auto i = search.mRoute.rbegin(); i != search.mRoute.rend(); ++i) {
+			outPath.PushWaypoint(allNodes[*i].position);
+		}
+		return true;
+	}
+	// jump point paths only hold the cells they turn at, which are all in line
+	for (int cell = endCell; cell != -1; cell = search.mCells.nodes[cell].parent) {
+		outPath.PushWaypoint(allNodes[cell].position);
+	}
+	return true;
+}
+
+float NavigationGrid::Heuristic(int cell, int endCell) const {
+	int dx = abs(cell % gridWidth - endCell % gridWidth);
+	int dz = abs(cell / gridWidth - endCell / gridWidth);
+	return (dx + dz) * minCost;
+}
 
-	// define starting node
-	openList.push_back(startNode);
-	startNode->f = 0;
-	startNode->g = 0;
-	startNode->parent = nullptr;
+/*
+Without diagonal moves no path can be shorter than the steps along each axis,
+at the cheapest step cost, so the heuristic never overestimates and a node
+never needs reopening once it's closed.
+*/
+float NavigationGrid::SearchCells(int start, int end, const Bounds* bounds, GridSearch& search) const {
+	GridSearch::OpenList& list = search.mCells;
+	list.Begin((size_t)gridWidth * gridHeight);
 
-	GridNode* currentBestNode = nullptr;
-	// begin searching algorithm until open list is empty (all nodes have been checked)
-	while (!openList.empty()) {
-		currentBestNode = RemoveBestNode(openList);
+	GridSearch::NodeState& startState = list.Get(start);
+	startState.g = 0.0f;
+	startState.f = end < 0 ? 0.0f : Heuristic(start, end);
+	list.Push(start);
 
-		if (currentBestNode == endNode) {			//we've found the path!
-			GridNode* node = endNode;
-			while (node != nullptr) {
-				outPath.PushWaypoint(node->position);
-				node = node->parent;
+	while (!list.IsEmpty()) {
+		int current = list.Pop();
+		GridSearch::NodeState& state = list.Get(current);
+		state.closed = true;
+		search.mStats.expanded++;
+		if (current == end) {
+			return state.g;
+		}
+		const GridNode& node = allNodes[current];
+		for (int i = 0; i < 4; ++i) {
+			if (!node.connected[i]) { //might not be connected...
+				continue;
+			}
+			int neighbour = CellIndex(node.connected[i]);
+			if (bounds) {
+				int x = neighbour % gridWidth;
+				int z = neighbour / gridWidth;
+				if (x < bounds->minX || x > bounds->maxX || z < bounds->minZ || z > bounds->maxZ) {
+					continue;
+				}
 			}
-			return true;
+			GridSearch::NodeState& neighbourState = list.Get(neighbour);
+			float g = state.g + node.costs[i];
+			if (neighbourState.closed || g >= neighbourState.g) {
+				continue;
+			}
+			neighbourState.g = g;
+			neighbourState.f = g + (end < 0 ? 0.0f : Heuristic(neighbour, end));
+			neighbourState.parent = current;
+			if (neighbourState.heapIndex < 0) {
+				list.Push(neighbour);
+			}
+			else {
+				list.Reprioritise(neighbour);
+			}
+		}
+	}
+	return end < 0 ? 0.0f : -1.0f; //open list emptied out with no path!
+}
+
+/*
+Jump point search for a grid without diagonals. Any shortest path can be
+reshuffled so it only turns from a row onto a column where a wall forces it
+to, while turning from a column onto a row is always allowed. So rows are
+jumped along until a wall behind opens up beside them, columns are jumped
+along until a row leaving them leads somewhere worth going, and only the
+cells jumps stop at are ever put on the open list.
+*/
+float NavigationGrid::SearchJumpPoints(int start, int end, GridSearch& search) const {
+	GridSearch::OpenList& list = search.mCells;
+	list.Begin((size_t)gridWidth * gridHeight);
+
+	GridSearch::NodeState& startState = list.Get(start);
+	startState.g = 0.0f;
+	startState.f = Heuristic(start, end);
+	list.Push(start);
+
+	while (!list.IsEmpty()) {
+		int current = list.Pop();
+		GridSearch::NodeState& state = list.Get(current);
+		state.closed = true;
+		search.mStats.expanded++;
+		if (current == end) {
+			return state.g;
+		}
+		int x = current % gridWidth;
+		int z = current / gridWidth;
+
+		// which way the cell was reached decides which ways are worth trying
+		int directions[4][2];
+		int directionCount = 0;
+		if (state.parent < 0) {
+			directions[directionCount][0] = 1; directions[directionCount++][1] = 0;
+			directions[directionCount][0] = -1; directions[directionCount++][1] = 0;
+			directions[directionCount][0] = 0; directions[directionCount++][1] = 1;
+			directions[directionCount][0] = 0; directions[directionCount++][1] = -1;
 		}
 		else {
-			for (int i = 0; i < 4; ++i) {
-				GridNode* neighbour = currentBestNode->connected[i];
-				if (!neighbour) { //might not be connected...
-					continue;
-				}	
-				bool inClosed	= NodeInList(neighbour, closedList);
-				if (inClosed) {
-					continue; //already discarded this neighbour...
+			int dx = Sign(x - state.parent % gridWidth);
+			int dz = Sign(z - state.parent / gridWidth);
+			if (dz != 0) {
+				directions[directionCount][0] = 0; directions[directionCount++][1] = dz;
+				directions[directionCount][0] = 1; directions[directionCount++][1] = 0;
+				directions[directionCount][0] = -1; directions[directionCount++][1] = 0;
+			}
+			else {
+				directions[directionCount][0] = dx; directions[directionCount++][1] = 0;
+				for (int side : { 1, -1 }) {
+					if (IsWalkable(x, z + side) && !IsWalkable(x - dx, z + side)) {
+						directions[directionCount][0] = 0; directions[directionCount++][1] = side;
+					}
 				}
+			}
+		}
+
+		for (int i = 0; i < directionCount; ++i) {
+			int jump = directions[i][0] != 0 ? JumpHorizontal(x, z, directions[i][0], end) : JumpVertical(x, z, directions[i][1], end);
+			if (jump < 0) {
+				continue;
+			}
+			GridSearch::NodeState& jumpState = list.Get(jump);
+			float g = state.g + (float)(abs(jump % gridWidth - x) + abs(jump / gridWidth - z));
+			if (jumpState.closed || g >= jumpState.g) {
+				continue;
+			}
+			jumpState.g = g;
+			jumpState.f = g + Heuristic(jump, end);
+			jumpState.parent = current;
+			if (jumpState.heapIndex < 0) {
+				list.Push(jump);
+			}
+			else {
+				list.Reprioritise(jump);
+			}
+		}
+	}
+	return -1.0f;
+}
+
+int NavigationGrid::JumpHorizontal(int x, int z, int dx, int end) const {
+	while (true) {
+		x += dx;
+		if (!IsWalkable(x, z)) {
+			return -1;
+		}
+		int cell = (gridWidth * z) + x;
+		if (cell == end) {
+			return cell;
+		}
+		// a way up or down that the cell behind couldn't have taken
+		if ((IsWalkable(x, z + 1) && !IsWalkable(x - dx, z + 1)) ||
+			(IsWalkable(x, z - 1) && !IsWalkable(x - dx, z - 1))) {
+			return cell;
+		}
+	}
+}
+
+int NavigationGrid::JumpVertical(int x, int z, int dz, int end) const {
+	while (true) {
+		z += dz;
+		if (!IsWalkable(x, z)) {
+			return -1;
+		}
+		int cell = (gridWidth * z) + x;
+		if (cell == end) {
+			return cell;
+		}
+		if (JumpHorizontal(x, z, 1, end) >= 0 || JumpHorizontal(x, z, -1, end) >= 0) {
+			return cell;
+		}
+	}
+}
+
+int NavigationGrid::ClusterOf(int cell) const {
+	return (cell / gridWidth / clusterSize) * clustersX + (cell % gridWidth) / clusterSize;
+}
+
+NavigationGrid::Bounds NavigationGrid::ClusterBounds(int cluster) const {
+	int minX = (cluster % clustersX) * clusterSize;
+	int minZ = (cluster / clustersX) * clusterSize;
+	return { minX, minZ, std::min(minX + clusterSize, gridWidth) - 1, std::min(minZ + clusterSize, gridHeight) - 1 };
+}
 
-				float h = Heuristic(neighbour, endNode);				
-				float g = currentBestNode->g + currentBestNode->costs[i];
-				float f = h + g;
+/*
+Every run of open cells along the edge between two clusters is an entrance,
+and gets a transition on each side of it. Transitions in the same cluster are
+then linked by what it costs to walk between them without leaving it.
+*/
+void NavigationGrid::BuildHierarchy(int clusterSize) {
+	transitions.clear();
+	clusterTransitions.clear();
+	this->clusterSize = 0;
+	if (clusterSize <= 0 || !allNodes) {
+		return;
+	}
+	this->clusterSize = clusterSize;
+	clustersX = (gridWidth + clusterSize - 1) / clusterSize;
+	clustersZ = (gridHeight + clusterSize - 1) / clusterSize;
+	clusterTransitions.resize(clustersX * clustersZ);
+	cellTransitions.assign(gridWidth * gridHeight, -1);
 
-				bool inOpen		= NodeInList(neighbour, openList);
+	auto addEntrance = [this](int cellA, int cellB, int stepAlong, int width, int costIndexA, int costIndexB) {
+		auto link = [&](int offset) {
+			int a = cellA + offset * stepAlong;
+			int b = cellB + offset * stepAlong;
+			AddTransition(a, b, (float)allNodes[a].costs[costIndexA]);
+			AddTransition(b, a, (float)allNodes[b].costs[costIndexB]);
+		};
+		if (width >= ENTRANCE_SPLIT_WIDTH) {
+			link(0);
+			link(width - 1);
+		}
+		else {
+			link(width / 2);
+		}
+	};
 
-				if (!inOpen) { //first time we've seen this neighbour
-					openList.emplace_back(neighbour);
+	// columns where one cluster meets the next along x
+	for (int x = clusterSize - 1; x + 1 < gridWidth; x += clusterSize) {
+		for (int clusterZ = 0; clusterZ < clustersZ; ++clusterZ) {
+			int maxZ = std::min((clusterZ + 1) * clusterSize, gridHeight);
+			for (int z = clusterZ * clusterSize; z < maxZ; ++z) {
+				int first = z;
+				while (z < maxZ && IsWalkable(x, z) && IsWalkable(x + 1, z)) {
+					z++;
 				}
-				if (!inOpen || f < neighbour->f) {//might be a better route to this neighbour
-					neighbour->parent = currentBestNode;
-					neighbour->f = f;
-					neighbour->g = g;
+				if (z > first) {
+					addEntrance((gridWidth * first) + x, (gridWidth * first) + x + 1, gridWidth, z - first, 3, 2);
 				}
 			}
-			closedList.emplace_back(currentBestNode);
 		}
 	}
-	return false; //open list emptied out with no path!
+	// and rows where they meet along z
+	for (int z = clusterSize - 1; z + 1 < gridHeight; z += clusterSize) {
+		for (int clusterX = 0; clusterX < clustersX; ++clusterX) {
+			int maxX = std::min((clusterX + 1) * clusterSize, gridWidth);
+			for (int x = clusterX * clusterSize; x < maxX; ++x) {
+				int first = x;
+				while (x < maxX && IsWalkable(x, z) && IsWalkable(x, z + 1)) {
+					x++;
+				}
+				if (x > first) {
+					addEntrance((gridWidth * z) + first, (gridWidth * (z + 1)) + first, 1, x - first, 1, 0);
+				}
+			}
+		}
+	}
+
+	for (int cluster = 0; cluster < (int)clusterTransitions.size(); ++cluster) {
+		LinkCluster(cluster, defaultSearch);
+	}
+	defaultSearch.ResetStats();
 }
 
-bool NavigationGrid::NodeInList(GridNode* n, std::vector<GridNode*>& list) const {
-	std::vector<GridNode*>::iterator i = std::find(list.begin(), list.end(), n);
-	return i == list.end() ? false : true;
+void NavigationGrid::AddTransition(int cellA, int cellB, float cost) {
+	for (int cell : { cellA, cellB }) {
+		if (cellTransitions[cell] < 0) {
+			cellTransitions[cell] = (int)transitions.size();
+			transitions.push_back({ cell, ClusterOf(cell), {} });
+			clusterTransitions[ClusterOf(cell)].push_back(cellTransitions[cell]);
+		}
+	}
+	transitions[cellTransitions[cellA]].edges.push_back({ cellTransitions[cellB], cost });
 }
 
-GridNode*  NavigationGrid::RemoveBestNode(std::vector<GridNode*>& list) const {
-	std::vector<GridNode*>::iterator bestI = list.begin();
+void NavigationGrid::LinkCluster(int cluster, GridSearch& search) {
+	Bounds bounds = ClusterBounds(cluster);
+	for (int from : clusterTransitions[cluster]) {
+		SearchCells(transitions[from].cell, -1, &bounds, search);
+		for (int to : clusterTransitions[cluster]) {
+			int cell = transitions[to].cell;
+			if (to != from && search.mCells.WasReached(cell) && search.mCells.nodes[cell].g < FLT_MAX) {
+				transitions[from].edges.push_back({ to, search.mCells.nodes[cell].g });
+			}
+		}
+	}
+}
+
+/*
+Searches the graph of transitions, with the start and end joined to the ones
+in their own clusters, then walks each step of that within its cluster. Paths
+come out a little longer than A* finds, bending through transitions, but only
+a few clusters' worth of cells are ever searched. Costs back to the end are
+taken from a search outward from it, so step costs are assumed the same both
+ways.
+*/
+float NavigationGrid::SearchHierarchy(int start, int end, GridSearch& search) const {
+	std::vector<int>& route = search.mRoute;
+	route.clear();
+	int startCluster = ClusterOf(start);
+	int endCluster = ClusterOf(end);
 
-	GridNode* bestNode = *list.begin();
+	// close by, the cluster alone usually has the way
+	if (startCluster == endCluster) {
+		Bounds bounds = ClusterBounds(startCluster);
+		float cost = SearchCells(start, end, &bounds, search);
+		if (cost >= 0.0f) {
+			route.push_back(start);
+			AppendCells(start, end, search.mCells, route);
+			return cost;
+		}
+	}
 
-	for (auto i = list.begin(); i != list.end(); ++i) {
-		if ((*i)->f < bestNode->f) {
-			bestNode	= (*i);
-			bestI		= i;
+	const std::vector<int>& startTransitions = clusterTransitions[startCluster];
+	const std::vector<int>& endTransitions = clusterTransitions[endCluster];
+	Bounds startBounds = ClusterBounds(startCluster);
+	SearchCells(start, -1, &startBounds, search);
+	search.mStartCosts.assign(startTransitions.size(), FLT_MAX);
+	for (size_t i = 0; i < startTransitions.size(); ++i) {
+		int cell = transitions[startTransitions[i]].cell;
+		if (search.mCells.WasReached(cell)) {
+			search.mStartCosts[i] = search.mCells.nodes[cell].g;
+		}
+	}
+	Bounds endBounds = ClusterBounds(endCluster);
+	SearchCells(end, -1, &endBounds, search);
+	search.mGoalCosts.assign(endTransitions.size(), FLT_MAX);
+	for (size_t i = 0; i < endTransitions.size(); ++i) {
+		int cell = transitions[endTransitions[i]].cell;
+		if (search.mCells.WasReached(cell)) {
+			search.mGoalCosts[i] = search.mCells.nodes[cell].g;
 		}
 	}
-	list.erase(bestI);
 
-	return bestNode;
+	// the start and end go after the transitions
+	int startNode = (int)transitions.size();
+	int endNode = startNode + 1;
+	auto cellOf = [&](int node) {
+		return node == startNode ? start : (node == endNode ? end : transitions[node].cell);
+	};
+	GridSearch::OpenList& list = search.mClusters;
+	list.Begin(transitions.size() + 2);
+	GridSearch::NodeState& startState = list.Get(startNode);
+	startState.g = 0.0f;
+	startState.f = Heuristic(start, end);
+	list.Push(startNode);
+
+	auto relax = [&](int from, int to, float cost) {
+		GridSearch::NodeState& state = list.Get(to);
+		float g = list.nodes[from].g + cost;
+		if (cost == FLT_MAX || state.closed || g >= state.g) {
+			return;
+		}
+		state.g = g;
+		state.f = g + Heuristic(cellOf(to), end);
+		state.parent = from;
+		if (state.heapIndex < 0) {
+			list.Push(to);
+		}
+		else {
+			list.Reprioritise(to);
+		}
+	};
+
+	bool found = false;
+	while (!list.IsEmpty()) {
+		int current = list.Pop();
+		list.Get(current).closed = true;
+		search.mStats.expanded++;
+		if (current == endNode) {
+			found = true;
+			break;
+		}
+		if (current == startNode) {
+			for (size_t i = 0; i < startTransitions.size(); ++i) {
+				relax(current, startTransitions[i], search.mStartCosts[i]);
+			}
+			continue;
+		}
+		for (const ClusterEdge& edge : transitions[current].edges) {
+			relax(current, edge.to, edge.cost);
+		}
+		if (transitions[current].cluster == endCluster) {
+			auto i = std::find(endTransitions.begin(), endTransitions.end(), current);
+			relax(current, endNode, search.mGoalCosts[i - endTransitions.begin()]);
+		}
+	}
+	if (!found) {
+		return -1.0f;
+	}
+
+	std::vector<int>& nodes = search.mSegment;
+	nodes.clear();
+	for (int node = endNode; node != -1; node = list.nodes[node].parent) {
+		nodes.push_back(node);
+	}
+	std::reverse(nodes.begin(), nodes.end());
+
+	// steps between clusters are to the next cell over, the rest are searched for
+	route.push_back(start);
+	for (size_t i = 1; i < nodes.size(); ++i) {
+		int from = cellOf(nodes[i - 1]);
+		int to = cellOf(nodes[i]);
+		if (from == to) {
+			continue;
+		}
+		if (ClusterOf(from) != ClusterOf(to)) {
+			route.push_back(to);
+			continue;
+		}
+		Bounds bounds = ClusterBounds(ClusterOf(from));
+		SearchCells(from, to, &bounds, search);
+		AppendCells(from, to, search.mCells, route);
+	}
+	return list.nodes[endNode].g;
+}
+
+void NavigationGrid::AppendCells(int start, int end, const GridSearch::OpenList& list, std::vector<int>& route) const {
+	size_t first = route.size();
+	for (int cell = end; cell != start && cell != -1; cell = list.nodes[cell].parent) {
+		route.push_back(cell);
+	}
+	std::reverse(route.begin() + first, route.end());
 }
 
-float NavigationGrid::Heuristic(GridNode* hNode, GridNode* endNode) const {
-	return (hNode->position - endNode->position).Length();
-}
\ No newline at end of file
+void NavigationGrid::RunBenchmark(std::ostream& out) {
+	struct BenchmarkGrid {
+		std::string name;
+		NavigationGrid* grid;
+	};
+	std::vector<BenchmarkGrid> grids;
+	grids.push_back({ "TestGrid1.txt", new NavigationGrid("TestGrid1.txt") });
+	grids.push_back({ "256x256 rooms", new NavigationGrid(GenerateRows(256, 256, BENCHMARK_ROOM_SIZE, 0.0f, 8503), 1) });
+	grids.push_back({ "512x512 rooms with pillars", new NavigationGrid(GenerateRows(512, 512, BENCHMARK_ROOM_SIZE, BENCHMARK_PILLAR_CHANCE, 8503), 1) });
+	grids.push_back({ "1024x1024 rooms", new NavigationGrid(GenerateRows(1024, 1024, BENCHMARK_ROOM_SIZE, 0.0f, 8503), 1) });
+
+	for (BenchmarkGrid& benchmark : grids) {
+		NavigationGrid& grid = *benchmark.grid;
+		out << "Grid benchmark: " << benchmark.name << ", " << grid.gridWidth << "x" << grid.gridHeight << " cells, "
+			<< BENCHMARK_PATHS << " paths\n";
+		if (grid.gridWidth == 0 || grid.gridHeight == 0) {
+			out << "  grid didn't load\n";
+			delete benchmark.grid;
+			continue;
+		}
+		auto buildStart = std::chrono::high_resolution_clock::now();
+		grid.BuildHierarchy(BENCHMARK_CLUSTER_SIZE);
+		double buildTime = MillisecondsSince(buildStart);
+
+		// the same random pairs of open cells for every mode
+		std::mt19937 random(8503);
+		std::vector<std::pair<Vector3, Vector3>> paths;
+		auto randomCell = [&]() {
+			while (true) {
+				int x = std::uniform_int_distribution<int>(0, grid.gridWidth - 1)(random);
+				int z = std::uniform_int_distribution<int>(0, grid.gridHeight - 1)(random);
+				if (grid.IsWalkable(x, z)) {
+					return grid.allNodes[(grid.gridWidth * z) + x].position;
+				}
+			}
+		};
+		for (int i = 0; i < BENCHMARK_PATHS; ++i) {
+			paths.push_back({ randomCell(), randomCell() });
+		}
+
+		std::vector<float> shortest(paths.size(), -1.0f);
+		for (SearchMode mode : { AStar, JumpPoint, Hierarchical }) {
+			GridSearch search;
+			double extraCost = 0.0;
+			double shortestCost = 0.0;
+			for (size_t i = 0; i < paths.size(); ++i) {
+				NavigationPath path;
+				if (!grid.FindPath(paths[i].first, paths[i].second, path, search, mode)) {
+					continue;
+				}
+				if (mode == AStar) {
+					shortest[i] = search.GetLastCost();
+				}
+				else if (shortest[i] >= 0.0f) {
+					extraCost += search.GetLastCost() - shortest[i];
+					shortestCost += shortest[i];
+				}
+			}
+			const GridSearch::Stats& stats = search.GetStats();
+			int found = stats.searches - stats.failures;
+			out << (mode == AStar ? "  A*: " : (mode == JumpPoint ? "  jump point: " : "  hierarchical: "))
+				<< stats.searchTime * 1000.0 / std::max(stats.searches, 1) << "us a path, "
+				<< stats.expanded / std::max(stats.searches, 1) << " nodes expanded, " << found << " found";
+			if (mode == Hierarchical) {
+				out << ", " << (shortestCost > 0.0 ? extraCost * 100.0 / shortestCost : 0.0) << "% longer; "
+					<< grid.transitions.size() << " transitions built in " << buildTime << "ms";
+			}
+			else if (mode == JumpPoint) {
+				out << (extraCost == 0.0 ? ", all as short as A*" : ", NOT as short as A*");
+			}
+			out << "\n";
+		}
+		delete benchmark.grid;
+	}
+}
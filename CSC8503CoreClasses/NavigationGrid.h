@@ -1,19 +1,16 @@
 #pragma once
 #include "NavigationMap.h"
+#include <iosfwd>
 #include <string>
+#include <vector>
 namespace NCL {
 	namespace CSC8503 {
 		struct GridNode {
-			GridNode* parent;
-
 			GridNode* connected[4];
 			int		  costs[4];
 
 			Vector3		position;
 
-			float f;
-			float g;
-
 			int type;
 
 			GridNode() {
@@ -21,31 +18,182 @@ namespace NCL {
 					connected[i] = nullptr;
 					costs[i] = 0;
 				}
-				f = 0;
-				g = 0;
 				type = 0;
-				parent = nullptr;
 			}
 			~GridNode() {	}
 		};
 
+		/*
+		Everything one search writes as it goes, kept out of the grid so any
+		number of searches can run over the same grid at once, one GridSearch
+		each. Node state is stamped with the search it belongs to, so starting a
+		search doesn't have to clear what the last one left behind.
+		*/
+		class GridSearch {
+		public:
+			struct Stats {
+				int		searches	= 0;
+				int		failures	= 0;
+				int		expanded	= 0;	//nodes taken off the open list, summed over every search
+				double	searchTime	= 0.0;	//milliseconds
+			};
+
+			//What the last path found cost, in the grid's step costs
+			float GetLastCost() const {
+				return mLastCost;
+			}
+
+			const Stats& GetStats() const {
+				return mStats;
+			}
+
+			void ResetStats() {
+				mStats = Stats();
+			}
+
+		protected:
+			friend class NavigationGrid;
+
+			struct NodeState {
+				float			g;
+				float			f;
+				int				parent;
+				int				heapIndex;	//-1 once off the open list
+				unsigned int	generation;
+				bool			closed;
+			};
+
+			//Per-node state for one graph, with an open list that's a binary
+			//heap indexed by node, so a node found a shorter way moves up in place
+			struct OpenList {
+				std::vector<NodeState>	nodes;
+				std::vector<int>		heap;
+				unsigned int			generation = 0;
+
+				void Begin(size_t nodeCount);
+				NodeState& Get(int node);
+				bool WasReached(int node) const {
+					return nodes[node].generation == generation;
+				}
+				bool IsEmpty() const {
+					return heap.empty();
+				}
+				void Push(int node);
+				void Reprioritise(int node);
+				int Pop();
+
+			protected:
+				bool Before(int a, int b) const;
+				void SiftUp(int position);
+				void SiftDown(int position);
+			};
+
+			OpenList				mCells;
+			OpenList				mClusters;
+			std::vector<float>		mStartCosts;	//to each transition in the start's cluster
+			std::vector<float>		mGoalCosts;
+			std::vector<int>		mRoute;
+			std::vector<int>		mSegment;
+			float					mLastCost = 0.0f;
+			Stats					mStats;
+		};
+
 		class NavigationGrid : public NavigationMap	{
 		public:
+			enum SearchMode {
+				AStar,
+				JumpPoint,		//uniform cost grids only, A* otherwise
+				Hierarchical	//needs BuildHierarchy, A* otherwise
+			};
+
 			NavigationGrid();
 			NavigationGrid(const std::string&filename);
+			//One string per row, 'x' for walls and '.' for floor
+			NavigationGrid(const std::vector<std::string>& rows, int nodeSize);
 			~NavigationGrid();
 
 			bool FindPath(const Vector3& from, const Vector3& to, NavigationPath& outPath) override;
-				
+			//Doesn't change the grid, so searches with their own GridSearch can run at once
+			bool FindPath(const Vector3& from, const Vector3& to, NavigationPath& outPath, GridSearch& search, SearchMode mode) const;
+
+			//Splits the grid into clusters of clusterSize cells a side and links
+			//their shared edges, for Hierarchical searches
+			void BuildHierarchy(int clusterSize);
+
+			void SetSearchMode(SearchMode mode) {
+				searchMode = mode;
+			}
+
+			bool IsUniformCost() const {
+				return uniformCost;
+			}
+
+			//Times every search mode on TestGrid1.txt and on larger generated
+			//grids, and how much longer hierarchical paths come out
+			static void RunBenchmark(std::ostream& out);
+
 		protected:
-			bool		NodeInList(GridNode* n, std::vector<GridNode*>& list) const;
-			GridNode*	RemoveBestNode(std::vector<GridNode*>& list) const;
-			float		Heuristic(GridNode* hNode, GridNode* endNode) const;
+			struct Bounds {
+				int minX;
+				int minZ;
+				int maxX;
+				int maxZ;
+			};
+
+			struct ClusterEdge {
+				int		to;
+				float	cost;
+			};
+
+			//A cell on a cluster's edge that leads into the next cluster
+			struct Transition {
+				int							cell;
+				int							cluster;
+				std::vector<ClusterEdge>	edges;
+			};
+
+			void BuildNodes(const std::vector<std::string>& rows);
+
+			bool IsWalkable(int x, int z) const {
+				return x >= 0 && x < gridWidth && z >= 0 && z < gridHeight && allNodes[(gridWidth * z) + x].type != 'x';
+			}
+			int CellIndex(const GridNode* node) const {
+				return (int)(node - allNodes);
+			}
+			int ClusterOf(int cell) const;
+			Bounds ClusterBounds(int cluster) const;
+			float Heuristic(int cell, int endCell) const;
+
+			//A* from start to end, kept inside bounds if there are any, or the
+			//cost to everywhere in bounds when end is -1
+			float SearchCells(int start, int end, const Bounds* bounds, GridSearch& search) const;
+			float SearchJumpPoints(int start, int end, GridSearch& search) const;
+			int JumpHorizontal(int x, int z, int dx, int end) const;
+			int JumpVertical(int x, int z, int dz, int end) const;
+			float SearchHierarchy(int start, int end, GridSearch& search) const;
+			//Appends the cells after start on the path ending at end, from the last search
+			void AppendCells(int start, int end, const GridSearch::OpenList& list, std::vector<int>& route) const;
+
+			void AddTransition(int cellA, int cellB, float cost);
+			void LinkCluster(int cluster, GridSearch& search);
+
 			int nodeSize;
 			int gridWidth;
 			int gridHeight;
+			bool uniformCost;
+			float minCost;
 
 			GridNode* allNodes;
+
+			SearchMode searchMode;
+			GridSearch defaultSearch;
+
+			int clusterSize;
+			int clustersX;
+			int clustersZ;
+			std::vector<Transition> transitions;
+			std::vector<std::vector<int>> clusterTransitions;
+			std::vector<int> cellTransitions;	//each cell's transition, -1 for most
 		};
 	}
 }
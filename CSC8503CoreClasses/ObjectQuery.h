@@ -0,0 +1,68 @@
+#pragma once
+#include <span>
+
+namespace NCL {
+	namespace CSC8503 {
+		class GameObject;
+
+		/*
+		Typed view over one of GameWorld's object buckets. The bucket only ever
+		holds objects tagged with T::Type, so the cast is a plain static_cast and
+		no RTTI is needed to walk it. Subclasses that keep their parent's tag
+		(e.g. NetworkPlayer) show up in the parent's query.
+		*/
+		template<class T>
+		class ObjectQuery {
+		public:
+			class Iterator {
+			public:
+				Iterator(GameObject* const* current) : mCurrent(current) {}
+
+				T* operator*() const {
+					return static_cast<T*>(*mCurrent);
+				}
+
+				Iterator& operator++() {
+					++mCurrent;
+					return *this;
+				}
+
+				bool operator!=(const Iterator& other) const {
+					return mCurrent != other.mCurrent;
+				}
+
+			protected:
+				GameObject* const* mCurrent;
+			};
+
+			ObjectQuery(std::span<GameObject* const> objects) : mObjects(objects) {}
+
+			Iterator begin() const {
+				return Iterator(mObjects.data());
+			}
+
+			Iterator end() const {
+				return Iterator(mObjects.data() + mObjects.size());
+			}
+
+			T* operator[](size_t i) const {
+				return static_cast<T*>(mObjects[i]);
+			}
+
+			size_t size() const {
+				return mObjects.size();
+			}
+
+			bool empty() const {
+				return mObjects.empty();
+			}
+
+			std::span<GameObject* const> GetObjects() const {
+				return mObjects;
+			}
+
+		protected:
+			std::span<GameObject* const> mObjects;
+		};
+	}
+}
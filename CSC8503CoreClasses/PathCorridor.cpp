@@ -0,0 +1,211 @@
+#include "PathCorridor.h"
+#include "RecastBuilder.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iterator>
+
+using namespace NCL;
+using namespace CSC8503;
+
+namespace {
+	// guards stand a capsule's half height above the floor the navmesh is on
+	constexpr float SEARCH_EXTENTS[3] = { 2.0f, 4.0f, 2.0f };
+	constexpr int MAX_VISITED = 16;
+	constexpr int MAX_CORNERS = 3;
+	// corners closer than this have been reached, so the one after is used
+	constexpr float CORNER_REACHED_DISTANCE = 0.5f;
+	constexpr float TARGET_REACH_DISTANCE = 1.0f;
+
+	double MillisecondsSince(std::chrono::high_resolution_clock::time_point start) {
+		return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+	}
+
+	float FlatDistanceSquared(const Vector3& a, const Vector3& b) {
+		float dx = a.x - b.x;
+		float dz = a.z - b.z;
+		return dx * dx + dz * dz;
+	}
+
+	/*
+	The start moved across visited, first to last. Everything in the path up
+	to the furthest polygon it shares with visited is behind the agent now, so
+	it is swapped for the way back from where the agent ended up.
+	*/
+	void MergeStartMoved(std::vector<dtPolyRef>& path, const dtPolyRef* visited, int visitedCount) {
+		for (int i = (int)path.size() - 1; i >= 0; --i) {
+			for (int j = 0; j < visitedCount; ++j) {
+				if (path[i] != visited[j]) {
+					continue;
+				}
+				// done in place, the path keeps the capacity planning gave it
+				path.erase(path.begin(), path.begin() + i + 1);
+				path.insert(path.begin(), std::make_reverse_iterator(visited + visitedCount), std::make_reverse_iterator(visited + j));
+				if (path.size() > PathCorridor::MAX_POLYS) {
+					path.resize(PathCorridor::MAX_POLYS);
+				}
+				return;
+			}
+		}
+	}
+
+	//The end moved across visited, so everything after the first shared polygon is replaced
+	void MergeEndMoved(std::vector<dtPolyRef>& path, const dtPolyRef* visited, int visitedCount) {
+		for (int i = 0; i < (int)path.size(); ++i) {
+			for (int j = 0; j < visitedCount; ++j) {
+				if (path[i] != visited[j]) {
+					continue;
+				}
+				path.resize(i + 1);
+				for (int k = j + 1; k < visitedCount && path.size() < PathCorridor::MAX_POLYS; ++k) {
+					path.push_back(visited[k]);
+				}
+				return;
+			}
+		}
+	}
+}
+
+PathCorridor::PathCorridor() {
+	mQuery = nullptr;
+	mFilter.setIncludeFlags(SAMPLE_POLYFLAGS_WALK | SAMPLE_POLYFLAGS_DOOR);
+	mFilter.setExcludeFlags(SAMPLE_POLYFLAGS_DISABLED);
+}
+
+PathCorridor::~PathCorridor() {
+}
+
+void PathCorridor::SetQuery(dtNavMeshQuery* query) {
+	mQuery = query;
+	mPath.clear();
+}
+
+void PathCorridor::Clear() {
+	mPath.clear();
+}
+
+bool PathCorridor::FindNearest(const Vector3& position, dtPolyRef& ref, Vector3& nearest) const {
+	ref = 0;
+	dtStatus status = mQuery->findNearestPoly(&position.x, SEARCH_EXTENTS, &mFilter, &ref, &nearest.x);
+	return dtStatusSucceed(status) && ref != 0;
+}
+
+bool PathCorridor::Plan(const Vector3& start, const Vector3& target) {
+	auto planStart = std::chrono::high_resolution_clock::now();
+	mPath.clear();
+	mTarget = target;
+
+	dtPolyRef startRef;
+	dtPolyRef endRef;
+	Vector3 startPosition;
+	Vector3 endPosition;
+	if (mQuery && FindNearest(start, startRef, startPosition) && FindNearest(target, endRef, endPosition)) {
+		// a target out of reach still gets a path to the closest point that isn't
+		mPath.resize(MAX_POLYS);
+		int count = 0;
+		dtStatus status = mQuery->findPath(startRef, endRef, &startPosition.x, &endPosition.x, &mFilter, mPath.data(), &count, MAX_POLYS);
+		mPath.resize(dtStatusSucceed(status) ? count : 0);
+		mPosition = startPosition;
+		mTarget = endPosition;
+	}
+
+	double planTime = MillisecondsSince(planStart);
+	mStats.plans++;
+	mStats.failedPlans += mPath.empty() ? 1 : 0;
+	mStats.planTime += planTime;
+	mStats.maxPlanTime = std::max(mStats.maxPlanTime, planTime);
+	return !mPath.empty();
+}
+
+void PathCorridor::SetPath(const std::vector<dtPolyRef>& path, const Vector3& start, const Vector3& target, double planTime) {
+	mPath.assign(path.begin(), path.begin() + std::min((int)path.size(), MAX_POLYS));
+	mPosition = start;
+	mTarget = target;
+
+	mStats.plans++;
+	mStats.failedPlans += mPath.empty() ? 1 : 0;
+	mStats.planTime += planTime;
+	mStats.maxPlanTime = std::max(mStats.maxPlanTime, planTime);
+}
+
+bool PathCorridor::MovePosition(const Vector3& position) {
+	if (mPath.empty()) {
+		return false;
+	}
+	auto moveStart = std::chrono::high_resolution_clock::now();
+	dtPolyRef visited[MAX_VISITED];
+	int visitedCount = 0;
+	Vector3 result;
+	dtStatus status = mQuery->moveAlongSurface(mPath[0], &mPosition.x, &position.x, &mFilter, &result.x, visited, &visitedCount, MAX_VISITED);
+	if (dtStatusSucceed(status)) {
+		MergeStartMoved(mPath, visited, visitedCount);
+		// moveAlongSurface works in 2D, the height is only needed for the corner search
+		float height = result.y;
+		if (dtStatusSucceed(mQuery->getPolyHeight(mPath[0], &result.x, &height))) {
+			result.y = height;
+		}
+		mPosition = result;
+	}
+	mStats.updates++;
+	mStats.followTime += MillisecondsSince(moveStart);
+	return dtStatusSucceed(status);
+}
+
+bool PathCorridor::MoveTarget(const Vector3& target) {
+	if (mPath.empty()) {
+		return false;
+	}
+	auto moveStart = std::chrono::high_resolution_clock::now();
+	dtPolyRef visited[MAX_VISITED];
+	int visitedCount = 0;
+	Vector3 result;
+	dtStatus status = mQuery->moveAlongSurface(mPath.back(), &mTarget.x, &target.x, &mFilter, &result.x, visited, &visitedCount, MAX_VISITED);
+	bool reached = false;
+	if (dtStatusSucceed(status)) {
+		MergeEndMoved(mPath, visited, visitedCount);
+		mTarget = result;
+		reached = FlatDistanceSquared(result, target) < TARGET_REACH_DISTANCE * TARGET_REACH_DISTANCE;
+	}
+	mStats.followTime += MillisecondsSince(moveStart);
+	return reached;
+}
+
+bool PathCorridor::GetNextCorner(Vector3& corner) {
+	if (mPath.empty()) {
+		return false;
+	}
+	auto cornerStart = std::chrono::high_resolution_clock::now();
+	float corners[MAX_CORNERS * 3];
+	unsigned char flags[MAX_CORNERS];
+	dtPolyRef refs[MAX_CORNERS];
+	int cornerCount = 0;
+	dtStatus status = mQuery->findStraightPath(&mPosition.x, &mTarget.x, mPath.data(), (int)mPath.size(),
+		corners, flags, refs, &cornerCount, MAX_CORNERS);
+	bool found = false;
+	if (dtStatusSucceed(status)) {
+		// the first corner is the start point itself
+		for (int i = 0; i < cornerCount; ++i) {
+			Vector3 point(corners[i * 3], corners[i * 3 + 1], corners[i * 3 + 2]);
+			if ((flags[i] & DT_STRAIGHTPATH_END) || FlatDistanceSquared(point, mPosition) > CORNER_REACHED_DISTANCE * CORNER_REACHED_DISTANCE) {
+				corner = point;
+				found = true;
+				break;
+			}
+		}
+	}
+	mStats.followTime += MillisecondsSince(cornerStart);
+	return found;
+}
+
+bool PathCorridor::IsValid(int lookAhead) const {
+	if (!mQuery || mPath.empty()) {
+		return false;
+	}
+	int count = std::min(lookAhead, (int)mPath.size());
+	for (int i = 0; i < count; ++i) {
+		if (!mQuery->isValidPolyRef(mPath[i], &mFilter)) {
+			return false;
+		}
+	}
+	return true;
+}
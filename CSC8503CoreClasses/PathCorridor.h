@@ -0,0 +1,91 @@
+#pragma once
+#include "Vector3.h"
+#include "../Detour/Include/DetourNavMeshQuery.h"
+
+#include <vector>
+
+namespace NCL {
+	using namespace NCL::Maths;
+	namespace CSC8503 {
+		/*
+		A planned route across the navmesh, kept as the list of polygons from
+		the agent to its target. Planning runs a full findPath, but after that
+		the ends are slid along the surface as the agent and target move, and
+		only the polygons each end crossed are spliced in or dropped, so
+		following a path costs a couple of short local queries a frame. Steering
+		only ever needs the next corner, which comes from a findStraightPath
+		over the corridor.
+
+		Works in the same manner as Detour's dtPathCorridor, which isn't part of
+		the Detour library this project builds.
+		*/
+		class PathCorridor {
+		public:
+			static constexpr int MAX_POLYS = 256;
+
+			struct Stats {
+				int		plans		= 0;
+				int		failedPlans	= 0;
+				int		updates		= 0;
+				double	planTime	= 0.0;	//milliseconds
+				double	maxPlanTime	= 0.0;
+				double	followTime	= 0.0;
+			};
+
+			PathCorridor();
+			~PathCorridor();
+
+			void SetQuery(dtNavMeshQuery* query);
+
+			//Runs a full search from start to target and replaces the corridor
+			bool Plan(const Vector3& start, const Vector3& target);
+			//Takes a path searched for elsewhere, from start to target, in place of planning
+			void SetPath(const std::vector<dtPolyRef>& path, const Vector3& start, const Vector3& target, double planTime);
+			void Clear();
+
+			//Slides the start of the corridor to position; fails if the
+			//corridor is gone, and the caller should plan again
+			bool MovePosition(const Vector3& position);
+			//Slides the end of the corridor toward target, false if it
+			//couldn't get within reach of it along the surface
+			bool MoveTarget(const Vector3& target);
+
+			//The next point to steer at; the target itself when nothing is in the way
+			bool GetNextCorner(Vector3& corner);
+
+			//Checks the first few polygons are still in the navmesh and pass the filter
+			bool IsValid(int lookAhead = 8) const;
+
+			bool HasPath() const {
+				return !mPath.empty();
+			}
+
+			//Where the corridor starts, which is the last position moved to, on the navmesh
+			const Vector3& GetPosition() const {
+				return mPosition;
+			}
+
+			const Vector3& GetTarget() const {
+				return mTarget;
+			}
+
+			const Stats& GetStats() const {
+				return mStats;
+			}
+
+			dtQueryFilter& GetFilter() {
+				return mFilter;
+			}
+
+		protected:
+			bool FindNearest(const Vector3& position, dtPolyRef& ref, Vector3& nearest) const;
+
+			dtNavMeshQuery*			mQuery;
+			dtQueryFilter			mFilter;
+			std::vector<dtPolyRef>	mPath;
+			Vector3					mPosition;
+			Vector3					mTarget;
+			Stats					mStats;
+		};
+	}
+}
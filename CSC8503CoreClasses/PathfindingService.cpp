@@ -0,0 +1,361 @@
+#include "PathfindingService.h"
+#include "RecastBuilder.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <random>
+
+using namespace NCL;
+using namespace CSC8503;
+
+namespace {
+	constexpr float SEARCH_EXTENTS[3] = { 2.0f, 4.0f, 2.0f };
+	constexpr int QUERY_NODES = 2048;
+	// budget is taken from the shared pool this many iterations at a time
+	constexpr int ITERATION_SLICE = 64;
+
+	double MillisecondsSince(std::chrono::high_resolution_clock::time_point start) {
+		return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+	}
+
+	std::mt19937 benchmarkRandom;
+
+	float BenchmarkRandom() {
+		return std::uniform_real_distribution<float>(0.0f, 1.0f)(benchmarkRandom);
+	}
+}
+
+PathfindingService::PathfindingService(const dtNavMesh* navMesh, int iterationBudget) {
+	mFilter.setIncludeFlags(SAMPLE_POLYFLAGS_WALK | SAMPLE_POLYFLAGS_DOOR);
+	mFilter.setExcludeFlags(SAMPLE_POLYFLAGS_DISABLED);
+	mNextID = 1;
+	mNextSequence = 0;
+	mBudget = 0;
+	mIterationBudget = iterationBudget;
+	mFrame = 0;
+
+	unsigned int slotCount = std::max(1u, JobSystem::GetJobSystem()->GetThreadCount());
+	for (unsigned int i = 0; i < slotCount; ++i) {
+		std::unique_ptr<Slot> slot = std::make_unique<Slot>();
+		slot->query = dtAllocNavMeshQuery();
+		slot->active = false;
+		if (!slot->query || dtStatusFailed(slot->query->init(navMesh, QUERY_NODES))) {
+			std::cout << __FUNCTION__ << " can't create a navmesh query\n";
+			dtFreeNavMeshQuery(slot->query);
+			continue;
+		}
+		mSlots.push_back(std::move(slot));
+	}
+}
+
+PathfindingService::~PathfindingService() {
+	Wait();
+	for (auto& slot : mSlots) {
+		dtFreeNavMeshQuery(slot->query);
+	}
+}
+
+//The heap keeps whatever doesn't come after anything else on top
+bool PathfindingService::ComesAfter(const PendingRequest& a, const PendingRequest& b) {
+	return a.priority != b.priority ? a.priority < b.priority : a.sequence > b.sequence;
+}
+
+PathfindingService::RequestID PathfindingService::Request(const Vector3& start, const Vector3& end, int priority, const Callback& callback) {
+	std::lock_guard<std::mutex> lock(mQueueLock);
+	RequestID id = mNextID++;
+	mQueue.push_back({ id, priority, mNextSequence++, mFrame, start, end, callback });
+	std::push_heap(mQueue.begin(), mQueue.end(), ComesAfter);
+	mStats.requests++;
+	mStats.maxQueued = std::max(mStats.maxQueued, mQueue.size());
+	return id;
+}
+
+std::future<PathfindingService::Result> PathfindingService::Request(const Vector3& start, const Vector3& end, int priority) {
+	std::shared_ptr<std::promise<Result>> promise = std::make_shared<std::promise<Result>>();
+	std::future<Result> future = promise->get_future();
+	Request(start, end, priority, [promise](const Result& result) {
+		promise->set_value(result);
+	});
+	return future;
+}
+
+void PathfindingService::Cancel(RequestID id) {
+	std::lock_guard<std::mutex> lock(mQueueLock);
+	mCancelled.insert(id);
+}
+
+size_t PathfindingService::GetQueuedCount() {
+	std::lock_guard<std::mutex> lock(mQueueLock);
+	return mQueue.size();
+}
+
+void PathfindingService::Wait() {
+	JobSystem::GetJobSystem()->Wait(mCounter);
+}
+
+void PathfindingService::RestartSearches() {
+	Wait();
+	std::lock_guard<std::mutex> lock(mQueueLock);
+	for (auto& slot : mSlots) {
+		if (!slot->active) {
+			continue;
+		}
+		// the request keeps its place in the queue, and the frame it was made on
+		slot->active = false;
+		mQueue.push_back(std::move(slot->request));
+		std::push_heap(mQueue.begin(), mQueue.end(), ComesAfter);
+	}
+}
+
+void PathfindingService::Update() {
+	auto waitStart = std::chrono::high_resolution_clock::now();
+	Wait();
+	mStats.waitTime += MillisecondsSince(waitStart);
+	mFrame++;
+
+	std::vector<Finished> finished;
+	{
+		std::lock_guard<std::mutex> lock(mQueueLock);
+		finished.swap(mFinished);
+	}
+	for (Finished& done : finished) {
+		done.result.frames = (int)(mFrame - done.request.frame);
+		mStats.completed++;
+		mStats.failed += done.result.status == Failed ? 1 : 0;
+		mStats.iterations += done.result.iterations;
+		mStats.searchTime += done.result.searchTime;
+		mStats.latencyFrames += done.result.frames;
+		mStats.maxLatency = std::max(mStats.maxLatency, done.result.frames);
+
+		bool cancelled = false;
+		{
+			std::lock_guard<std::mutex> lock(mQueueLock);
+			cancelled = mCancelled.erase(done.request.id) > 0;
+		}
+		// callbacks run without the lock held, so they can ask for another path
+		if (!cancelled && done.request.callback) {
+			done.request.callback(done.result);
+		}
+	}
+}
+
+void PathfindingService::Dispatch() {
+	Wait();
+	size_t jobCount = 0;
+	{
+		std::lock_guard<std::mutex> lock(mQueueLock);
+		size_t idle = 0;
+		for (auto& slot : mSlots) {
+			jobCount += slot->active ? 1 : 0;
+			idle += slot->active ? 0 : 1;
+		}
+		jobCount += std::min(idle, mQueue.size());
+	}
+	if (jobCount == 0) {
+		return;
+	}
+	mBudget = mIterationBudget;
+	// busy slots first, as their searches are furthest along
+	JobSystem* jobSystem = JobSystem::GetJobSystem();
+	for (auto& slot : mSlots) {
+		if (slot->active && jobCount > 0) {
+			Slot* target = slot.get();
+			jobSystem->Submit([this, target]() { RunSlot(*target); }, &mCounter);
+			jobCount--;
+		}
+	}
+	for (auto& slot : mSlots) {
+		if (!slot->active && jobCount > 0) {
+			Slot* target = slot.get();
+			jobSystem->Submit([this, target]() { RunSlot(*target); }, &mCounter);
+			jobCount--;
+		}
+	}
+}
+
+int PathfindingService::TakeBudget(int iterations) {
+	int available = mBudget.load(std::memory_order_relaxed);
+	while (available > 0) {
+		int taken = std::min(iterations, available);
+		if (mBudget.compare_exchange_weak(available, available - taken, std::memory_order_relaxed)) {
+			return taken;
+		}
+	}
+	return 0;
+}
+
+void PathfindingService::RunSlot(Slot& slot) {
+	for (;;) {
+		if (!slot.active && !StartNext(slot)) {
+			return;
+		}
+		int slice = TakeBudget(ITERATION_SLICE);
+		if (slice == 0) {
+			return;
+		}
+		auto sliceStart = std::chrono::high_resolution_clock::now();
+		int done = 0;
+		dtStatus status = slot.query->updateSlicedFindPath(slice, &done);
+		if (done < slice) {
+			mBudget.fetch_add(slice - done, std::memory_order_relaxed);
+		}
+		slot.result.iterations += done;
+		slot.result.searchTime += MillisecondsSince(sliceStart);
+		if (!dtStatusInProgress(status)) {
+			Finish(slot, status);
+		}
+	}
+}
+
+bool PathfindingService::StartNext(Slot& slot) {
+	for (;;) {
+		{
+			std::lock_guard<std::mutex> lock(mQueueLock);
+			if (mQueue.empty()) {
+				return false;
+			}
+			std::pop_heap(mQueue.begin(), mQueue.end(), ComesAfter);
+			slot.request = std::move(mQueue.back());
+			mQueue.pop_back();
+			if (mCancelled.erase(slot.request.id) > 0) {
+				continue;
+			}
+		}
+
+		auto startTime = std::chrono::high_resolution_clock::now();
+		slot.result = Result();
+		slot.result.id = slot.request.id;
+		slot.result.status = Failed;
+		slot.result.start = slot.request.start;
+		slot.result.end = slot.request.end;
+
+		dtPolyRef startRef = 0;
+		dtPolyRef endRef = 0;
+		slot.query->findNearestPoly(&slot.request.start.x, SEARCH_EXTENTS, &mFilter, &startRef, &slot.result.start.x);
+		slot.query->findNearestPoly(&slot.request.end.x, SEARCH_EXTENTS, &mFilter, &endRef, &slot.result.end.x);
+		// a search that's under way is neither a success nor a failure yet
+		if (startRef != 0 && endRef != 0 &&
+			!dtStatusFailed(slot.query->initSlicedFindPath(startRef, endRef, &slot.result.start.x, &slot.result.end.x, &mFilter))) {
+			slot.result.searchTime = MillisecondsSince(startTime);
+			slot.active = true;
+			return true;
+		}
+		// ends off the navmesh fail straight away, and the slot moves on
+		slot.result.searchTime = MillisecondsSince(startTime);
+		std::lock_guard<std::mutex> lock(mQueueLock);
+		mFinished.push_back({ std::move(slot.request), std::move(slot.result) });
+	}
+}
+
+void PathfindingService::Finish(Slot& slot, dtStatus status) {
+	auto finishStart = std::chrono::high_resolution_clock::now();
+	slot.active = false;
+	Result& result = slot.result;
+	if (dtStatusSucceed(status)) {
+		result.polys.resize(MAX_POLYS);
+		int polyCount = 0;
+		status = slot.query->finalizeSlicedFindPath(result.polys.data(), &polyCount, MAX_POLYS);
+		result.polys.resize(dtStatusSucceed(status) ? polyCount : 0);
+	}
+	if (!result.polys.empty()) {
+		bool partial = dtStatusDetail(status, DT_PARTIAL_RESULT) || dtStatusDetail(status, DT_OUT_OF_NODES);
+		// a partial path ends at the closest point to the target it could get to
+		Vector3 end = result.end;
+		if (partial) {
+			slot.query->closestPointOnPoly(result.polys.back(), &result.end.x, &end.x, nullptr);
+		}
+		std::vector<float> corners(MAX_POLYS * 3);
+		int cornerCount = 0;
+		slot.query->findStraightPath(&result.start.x, &end.x, result.polys.data(), (int)result.polys.size(),
+			corners.data(), nullptr, nullptr, &cornerCount, MAX_POLYS);
+		for (int i = 0; i < cornerCount; ++i) {
+			result.points.emplace_back(corners[i * 3], corners[i * 3 + 1], corners[i * 3 + 2]);
+		}
+		result.end = end;
+		result.status = partial ? Partial : Found;
+	}
+	result.searchTime += MillisecondsSince(finishStart);
+
+	std::lock_guard<std::mutex> lock(mQueueLock);
+	mFinished.push_back({ std::move(slot.request), std::move(slot.result) });
+}
+
+void PathfindingService::RunBenchmark(const dtNavMesh* navMesh, int agentCount, int frames, std::ostream& out) {
+	benchmarkRandom.seed(8503);
+	dtNavMeshQuery* query = dtAllocNavMeshQuery();
+	if (!query || dtStatusFailed(query->init(navMesh, QUERY_NODES))) {
+		out << __FUNCTION__ << " can't create a navmesh query\n";
+		dtFreeNavMeshQuery(query);
+		return;
+	}
+	dtQueryFilter filter;
+	filter.setIncludeFlags(SAMPLE_POLYFLAGS_WALK | SAMPLE_POLYFLAGS_DOOR);
+	filter.setExcludeFlags(SAMPLE_POLYFLAGS_DISABLED);
+	auto randomPoint = [&]() {
+		dtPolyRef ref = 0;
+		Vector3 point;
+		query->findRandomPoint(&filter, BenchmarkRandom, &ref, &point.x);
+		return point;
+	};
+
+	// the same searches go through both, so the comparison is like for like
+	std::vector<std::pair<Vector3, Vector3>> trips;
+	for (int i = 0; i < agentCount * 8; ++i) {
+		trips.emplace_back(randomPoint(), randomPoint());
+	}
+
+	PathfindingService service(navMesh);
+	size_t nextTrip = 0;
+	std::function<void(const Result&)> onArrival;
+	auto requestTrip = [&]() {
+		const auto& [from, to] = trips[nextTrip++ % trips.size()];
+		service.Request(from, to, 0, onArrival);
+	};
+	onArrival = [&](const Result&) {
+		requestTrip();
+	};
+
+	// every agent asks at once, as when an alarm goes off
+	auto start = std::chrono::high_resolution_clock::now();
+	for (int i = 0; i < agentCount; ++i) {
+		requestTrip();
+	}
+	double worstFrame = 0.0;
+	for (int frame = 0; frame < frames; ++frame) {
+		auto frameStart = std::chrono::high_resolution_clock::now();
+		service.Update();
+		service.Dispatch();
+		worstFrame = std::max(worstFrame, MillisecondsSince(frameStart));
+	}
+	service.Wait();
+	double serviceTime = MillisecondsSince(start);
+	const Stats& stats = service.GetStats();
+
+	size_t searched = (size_t)stats.completed;
+	std::vector<dtPolyRef> polys(MAX_POLYS);
+	start = std::chrono::high_resolution_clock::now();
+	for (size_t i = 0; i < searched; ++i) {
+		dtPolyRef startRef = 0;
+		dtPolyRef endRef = 0;
+		Vector3 from;
+		Vector3 to;
+		const auto& [tripStart, tripEnd] = trips[i % trips.size()];
+		query->findNearestPoly(&tripStart.x, SEARCH_EXTENTS, &filter, &startRef, &from.x);
+		query->findNearestPoly(&tripEnd.x, SEARCH_EXTENTS, &filter, &endRef, &to.x);
+		int polyCount = 0;
+		query->findPath(startRef, endRef, &from.x, &to.x, &filter, polys.data(), &polyCount, MAX_POLYS);
+	}
+	double serialTime = MillisecondsSince(start);
+	dtFreeNavMeshQuery(query);
+
+	out << "Pathfinding benchmark: " << agentCount << " agents, " << frames << " frames, "
+		<< service.mSlots.size() << " query threads, " << service.mIterationBudget << " iterations a frame\n"
+		<< "  " << stats.completed << " paths (" << stats.failed << " failed) in " << serviceTime << "ms, "
+		<< (stats.completed > 0 ? stats.iterations / stats.completed : 0) << " iterations each\n"
+		<< "  latency " << (stats.completed > 0 ? (double)stats.latencyFrames / stats.completed : 0.0) << " frames average, "
+		<< stats.maxLatency << " max; most queued " << stats.maxQueued << "\n"
+		<< "  main thread " << stats.waitTime / std::max(frames, 1) << "ms a frame waiting, worst frame " << worstFrame << "ms\n"
+		<< "  search time " << stats.searchTime << "ms across threads, against " << serialTime << "ms for "
+		<< searched << " blocking findPath calls on one thread\n";
+}
@@ -0,0 +1,150 @@
+#pragma once
+#include "Vector3.h"
+#include "JobSystem.h"
+#include "../Detour/Include/DetourNavMeshQuery.h"
+
+#include <future>
+#include <iosfwd>
+#include <unordered_set>
+
+namespace NCL {
+	using namespace NCL::Maths;
+	namespace CSC8503 {
+		/*
+		Finds paths across the navmesh on the job threads. Requests queue up by
+		priority, and each frame Dispatch hands them to one job per job system
+		thread. Every job owns a dtNavMeshQuery, so searches never share node
+		pools, and runs them with Detour's sliced search out of a shared budget
+		of iterations for the frame. A search that runs out of budget carries
+		on from where it stopped the next frame, on the same query.
+
+		Finished paths are handed over in Update, on the thread that calls it,
+		through the request's callback or future. The navmesh mustn't change
+		between Dispatch and the next Update or Wait.
+		*/
+		class PathfindingService {
+		public:
+			typedef uint32_t RequestID;
+
+			static constexpr int MAX_POLYS = 256;
+			static constexpr int ITERATION_BUDGET_DEFAULT = 4096;
+
+			enum ResultStatus {
+				Found,
+				Partial,	//the target couldn't be reached, this gets as close as it can
+				Failed
+			};
+
+			struct Result {
+				RequestID				id;
+				ResultStatus			status;
+				std::vector<dtPolyRef>	polys;
+				std::vector<Vector3>	points;		//corners of the straight path, start and end included
+				Vector3					start;		//the request's ends, moved onto the navmesh
+				Vector3					end;
+				int						iterations;
+				int						frames;		//Updates between the request and the result
+				double					searchTime;	//milliseconds spent on it on the job threads
+			};
+
+			typedef std::function<void(const Result&)> Callback;
+
+			struct Stats {
+				uint64_t	requests		= 0;
+				uint64_t	completed		= 0;
+				uint64_t	failed			= 0;
+				uint64_t	iterations		= 0;
+				uint64_t	latencyFrames	= 0;
+				int			maxLatency		= 0;
+				size_t		maxQueued		= 0;
+				double		searchTime		= 0.0;	//milliseconds, summed across threads
+				double		waitTime		= 0.0;	//milliseconds Update spent waiting on the jobs
+			};
+
+			PathfindingService(const dtNavMesh* navMesh, int iterationBudget = ITERATION_BUDGET_DEFAULT);
+			~PathfindingService();
+
+			PathfindingService(const PathfindingService&) = delete;
+			PathfindingService& operator=(const PathfindingService&) = delete;
+
+			//Higher priorities are searched first, and requests of the same
+			//priority in the order they came in. Safe from any thread
+			RequestID Request(const Vector3& start, const Vector3& end, int priority, const Callback& callback);
+			std::future<Result> Request(const Vector3& start, const Vector3& end, int priority);
+
+			//The callback won't be called, and a future is left broken. Only from
+			//the thread that calls Update
+			void Cancel(RequestID id);
+
+			//Waits for the last Dispatch and hands over finished paths
+			void Update();
+			//Starts searching on the job threads, which carry on while the frame does
+			void Dispatch();
+			void Wait();
+			//Searches part way through hold polygons the navmesh may no longer
+			//have, so after it changes they're queued again to start over
+			void RestartSearches();
+
+			void SetIterationBudget(int iterations) {
+				mIterationBudget = iterations;
+			}
+
+			size_t GetQueuedCount();
+
+			const Stats& GetStats() const {
+				return mStats;
+			}
+
+			//Sends agentCount agents between random points, each asking for a
+			//new path as soon as it has one, for the given number of frames,
+			//and compares it against the same searches run one by one
+			static void RunBenchmark(const dtNavMesh* navMesh, int agentCount, int frames, std::ostream& out);
+
+		protected:
+			struct PendingRequest {
+				RequestID	id;
+				int			priority;
+				uint64_t	sequence;
+				uint64_t	frame;
+				Vector3		start;
+				Vector3		end;
+				Callback	callback;
+			};
+
+			struct Slot {
+				dtNavMeshQuery* query;
+				bool			active;
+				PendingRequest	request;
+				Result			result;
+			};
+
+			struct Finished {
+				PendingRequest	request;
+				Result			result;
+			};
+
+			static bool ComesAfter(const PendingRequest& a, const PendingRequest& b);
+
+			void RunSlot(Slot& slot);
+			bool StartNext(Slot& slot);
+			void Finish(Slot& slot, dtStatus status);
+			int TakeBudget(int iterations);
+
+			dtQueryFilter mFilter;
+			std::vector<std::unique_ptr<Slot>> mSlots;
+			JobCounter mCounter;
+
+			std::mutex						mQueueLock;
+			std::vector<PendingRequest>		mQueue;		//a heap, highest priority first
+			std::unordered_set<RequestID>	mCancelled;
+			std::vector<Finished>			mFinished;
+			RequestID						mNextID;
+			uint64_t						mNextSequence;
+
+			std::atomic<int>	mBudget;
+			int					mIterationBudget;
+			uint64_t			mFrame;
+			Stats				mStats;
+		};
+	}
+}
@@ -1,11 +1,12 @@
 #include "PhysicsObject.h"
 #include "PhysicsSystem.h"
 #include "Transform.h"
+#include "GameObject.h"
 using namespace NCL;
 using namespace CSC8503;
 
-PhysicsObject::PhysicsObject(Transform* parentTransform, const CollisionVolume* parentVolume, float inverseMass, float dynamicFriction, float staticFriction, float elasticity)	{
-	mTransform	= parentTransform;
+PhysicsObject::PhysicsObject(GameObject* owner, const CollisionVolume* parentVolume, float inverseMass, float dynamicFriction, float staticFriction, float elasticity)	{
+	mOwner		= owner;
 	mVolume		= parentVolume;
 
 	mInverseMass = inverseMass;
@@ -20,6 +21,10 @@ PhysicsObject::~PhysicsObject()	{
 
 }
 
+const Transform& PhysicsObject::GetTransform() const {
+	return mOwner->GetTransform();
+}
+
 void PhysicsObject::ApplyAngularImpulse(const Vector3& force) {
 	mAngularVelocity += mInverseInteriaTensor * force;
 }
@@ -33,7 +38,7 @@ void PhysicsObject::AddForce(const Vector3& addedForce) {
 }
 
 void PhysicsObject::AddForceAtPosition(const Vector3& addedForce, const Vector3& position) {
-	Vector3 localPos = position - mTransform->GetPosition();
+	Vector3 localPos = position - GetTransform().GetPosition();
 
 	mForce  += addedForce;
 	mTorque += Vector3::Cross(localPos, addedForce);
@@ -49,7 +54,7 @@ void PhysicsObject::ClearForces() {
 }
 
 void PhysicsObject::InitCubeInertia() {
-	Vector3 dimensions	= mTransform->GetScale();
+	Vector3 dimensions	= GetTransform().GetScale();
 
 	Vector3 fullWidth = dimensions * 2;
 
@@ -61,7 +66,7 @@ void PhysicsObject::InitCubeInertia() {
 }
 
 void PhysicsObject::InitSphereInertia(bool isHollow) {
-	float radius	= mTransform->GetScale().GetMaxElement();
+	float radius	= GetTransform().GetScale().GetMaxElement();
 	float i;
 	if (!isHollow)
 		i = 2.5f * mInverseMass / (radius*radius);
@@ -72,7 +77,7 @@ void PhysicsObject::InitSphereInertia(bool isHollow) {
 }
 
 void PhysicsObject::UpdateInertiaTensor() {
-	Quaternion q = mTransform->GetOrientation();
+	Quaternion q = GetTransform().GetOrientation();
 	
 	Matrix3 invOrientation	= Matrix3(q.Conjugate());
 	Matrix3 orientation		= Matrix3(q);
@@ -6,10 +6,11 @@ namespace NCL {
 
 	namespace CSC8503 {
 		class Transform;
+		class GameObject;
 
 		class PhysicsObject {
 		public:
-			PhysicsObject(Transform* parentTransform, const CollisionVolume* parentVolume, float inverseMass = 1.0f, float dynamicFriction = 0, float staticFriction = 0, float elasticity = 1.0f);
+			PhysicsObject(GameObject* owner, const CollisionVolume* parentVolume, float inverseMass = 1.0f, float dynamicFriction = 0, float staticFriction = 0, float elasticity = 1.0f);
 			~PhysicsObject();
 
 			Vector3 GetLinearVelocity() const {
@@ -71,8 +72,10 @@ namespace NCL {
 			float GetElasticity() { return mElasticity; }
 
 		protected:
+			const Transform& GetTransform() const;
+
 			const CollisionVolume* mVolume;
-			Transform* mTransform;
+			GameObject* mOwner;
 
 			float mInverseMass;
 			float mElasticity;
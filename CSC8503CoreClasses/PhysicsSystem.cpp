@@ -7,6 +7,7 @@
 #include "CollisionDetection.h"
 #include "Debug.h"
 #include "Window.h"
+#include "JobSystem.h"
 #include <functional>
 using namespace NCL;
 using namespace CSC8503;
@@ -50,6 +51,32 @@ any collisions they are in.
 */
 void PhysicsSystem::Clear() {
 	mAllCollisions.clear();
+	mCollisionEvents.clear();
+}
+
+/*
+Static objects are only put into the broadphase once, so this must be called
+whenever any are added to or removed from the world. The base tree is
+repopulated on the next update.
+*/
+void PhysicsSystem::ClearStaticGeometry() {
+	baseTree = QuadTree<GameObject*>(Vector2(mBroadphaseX, mBroadphaseZ), 7, 6);
+}
+
+void PhysicsSystem::RemoveCollisionsWith(const GameObject* object) {
+	for (auto i = mAllCollisions.begin(); i != mAllCollisions.end();) {
+		if (i->a == object || i->b == object) {
+			i = mAllCollisions.erase(i);
+		}
+		else {
+			++i;
+		}
+	}
+	for (CollisionEvent& e : mCollisionEvents) {
+		if (e.a == object || e.b == object) {
+			e.a = nullptr;
+		}
+	}
 }
 
 /*
@@ -150,16 +177,14 @@ rocket launcher, gaining a point when the player hits the gold coin, and so on).
 void PhysicsSystem::UpdateCollisionList() {
 	for (std::set<CollisionDetection::CollisionInfo>::iterator i = mAllCollisions.begin(); i != mAllCollisions.end(); ) {
 		if ((*i).framesLeft == mNumCollisionFrames) {
-			i->a->OnCollisionBegin(i->b);
-			i->b->OnCollisionBegin(i->a);
+			mCollisionEvents.push_back({ i->a, i->b, true });
 		}
 
 		CollisionDetection::CollisionInfo& in = const_cast<CollisionDetection::CollisionInfo&>(*i);
 		in.framesLeft--;
 
 		if ((*i).framesLeft < 0) {
-			i->a->OnCollisionEnd(i->b);
-			i->b->OnCollisionEnd(i->a);
+			mCollisionEvents.push_back({ i->a, i->b, false });
 			i = mAllCollisions.erase(i);
 		}
 		else {
@@ -168,10 +193,31 @@ void PhysicsSystem::UpdateCollisionList() {
 	}
 }
 
+void PhysicsSystem::DeliverCollisionEvents() {
+	// RemoveCollisionsWith blanks the events of anything a callback takes out
+	for (size_t i = 0; i < mCollisionEvents.size(); ++i) {
+		CollisionEvent e = mCollisionEvents[i];
+		if (!e.a) {
+			continue;
+		}
+		if (e.begin) {
+			e.a->OnCollisionBegin(e.b);
+			e.b->OnCollisionBegin(e.a);
+		}
+		else {
+			e.a->OnCollisionEnd(e.b);
+			e.b->OnCollisionEnd(e.a);
+		}
+	}
+	mCollisionEvents.clear();
+}
+
 void PhysicsSystem::UpdateObjectAABBs() {
 	mGameWorld.OperateOnContents(
 		[](GameObject* g) {
-			g->UpdateBroadphaseAABB();
+			if (g->IsActive()) {
+				g->UpdateBroadphaseAABB();
+			}
 		}
 	);
 }
@@ -191,10 +237,10 @@ void PhysicsSystem::BasicCollisionDetection() {
 	mGameWorld.GetObjectIterators(first, last);
 
 	for (auto i = first; i != last; i++) {
-		if ((*i)->GetPhysicsObject() == nullptr)
+		if ((*i)->GetPhysicsObject() == nullptr || !(*i)->IsActive())
 			continue;
 		for (auto j = i + 1; j != last; j++) {
-			if ((*j)->GetPhysicsObject() == nullptr)
+			if ((*j)->GetPhysicsObject() == nullptr || !(*j)->IsActive())
 				continue;
 			CollisionDetection::CollisionInfo info;
 			if (CollisionDetection::ObjectIntersection(*i, *j, info)) {
@@ -371,16 +417,22 @@ void PhysicsSystem::BroadPhase() {
 	QuadTree<GameObject*> tree;
 	tree.CopyTree(&baseTree, Vector2(mBroadphaseX, mBroadphaseZ));
 	bool populateBase = baseTree.Empty();
-	// add all objects to tree
-	for (auto i = first; i != last; i++) {
-		if (!populateBase && (*i)->GetCollisionLayer() & StaticObj || !(*i)->HasPhysics()) continue;
-		Vector3 halfSizes;
-		if (!(*i)->GetBroadphaseAABB(halfSizes))
-			continue;
-		Vector3 pos = (*i)->GetTransform().GetPosition();
-		tree.Insert(*i, pos, halfSizes, (*i)->GetCollisionLayer() & STATIC_COLLISION_LAYERS);
-		if (populateBase && (*i)->GetCollisionLayer() & StaticObj) {
-			baseTree.Insert(*i, pos, halfSizes, true);
+	// add objects to tree a layer at a time, so each entry knows if it is static
+	// up front. Static geometry is only added once, and NoCollide objects never
+	// form pairs so they are left out entirely
+	for (int layer = StaticObj; layer <= NoSpecialFeatures; layer <<= 1) {
+		if (layer == NoCollide || (!populateBase && layer == StaticObj)) continue;
+		bool isStatic = layer & STATIC_COLLISION_LAYERS;
+		for (GameObject* obj : mGameWorld.ByLayer((CollisionLayer)layer)) {
+			if (!obj->HasPhysics()) continue;
+			Vector3 halfSizes;
+			if (!obj->GetBroadphaseAABB(halfSizes))
+				continue;
+			Vector3 pos = obj->GetTransform().GetPosition();
+			tree.Insert(obj, pos, halfSizes, isStatic);
+			if (populateBase && layer == StaticObj) {
+				baseTree.Insert(obj, pos, halfSizes, true);
+			}
 		}
 	}
 
@@ -389,18 +441,11 @@ void PhysicsSystem::BroadPhase() {
 		CollisionDetection::CollisionInfo info;
 		for (auto i = data.begin(); i != data.end(); i++) {
 			for (auto j = std::next(i); j != data.end(); j++) {
-				info.a = std::min((*i).object, (*j).object);
-				info.b = std::max((*i).object, (*j).object);
-				if ((info.a->GetCollisionLayer() & Player && info.b->GetCollisionLayer() & Collectable) || 
-					(info.b->GetCollisionLayer() & Player && info.a->GetCollisionLayer() & Collectable)) {
-					int test = 12;
-				}
-				if (info.a->GetCollisionLayer() & NoCollide || info.b->GetCollisionLayer() & NoCollide) {
+				if ((*i).isStatic && (*j).isStatic) {
 					continue;
 				}
-				if (info.a->GetCollisionLayer() & STATIC_COLLISION_LAYERS && info.b->GetCollisionLayer() & STATIC_COLLISION_LAYERS) {
-					continue;
-				}				
+				info.a = std::min((*i).object, (*j).object);
+				info.b = std::max((*i).object, (*j).object);
 				mBroadphaseCollisions.insert(info);
 			}
 		}
@@ -439,40 +484,44 @@ based on any forces that have been accumulated in the objects during
 the course of the previous game frame.
 */
 void PhysicsSystem::IntegrateAccel(float dt) {
-	std::vector<GameObject*>::const_iterator first;
-	std::vector<GameObject*>::const_iterator last;
-	mGameWorld.GetObjectIterators(first, last);
-
-	for (auto i = first; i != last; i++) {
-		PhysicsObject* object = (*i)->GetPhysicsObject();
-		if (object == nullptr)
-			continue;
-		// inverse mass for multiplication instead of division and unmoving object
-		float inverseMass = object->GetInverseMass();
+	ComponentPool<PhysicsObject>& physicsPool = mGameWorld.GetComponentPool<PhysicsObject>();
+
+	// every object only touches its own state, so the pool is split across the job threads
+	JobSystem::GetJobSystem()->ParallelFor(physicsPool.Size(), 128, [&](size_t begin, size_t end) {
+		for (size_t i = begin; i < end; ++i) {
+			// objects with physics switched off stay frozen where they are
+			GameObject* owner = physicsPool.GetOwner(i);
+			if (!owner->HasPhysics() || !owner->IsActive()) {
+				continue;
+			}
+			PhysicsObject* object = &physicsPool.GetComponent(i);
+			// inverse mass for multiplication instead of division and unmoving object
+			float inverseMass = object->GetInverseMass();
 
-		Vector3 linearVel = object->GetLinearVelocity();
-		Vector3 force = object->GetForce();
-		Vector3 accel = force * inverseMass;
+			Vector3 linearVel = object->GetLinearVelocity();
+			Vector3 force = object->GetForce();
+			Vector3 accel = force * inverseMass;
 
-		if (mApplyGravity && inverseMass > 0)
-			accel += mGravity;
+			if (mApplyGravity && inverseMass > 0)
+				accel += mGravity;
 
-		linearVel += accel * dt;
-		object->SetLinearVelocity(linearVel);
+			linearVel += accel * dt;
+			object->SetLinearVelocity(linearVel);
 
-		// get objects current torque and angular velocity
-		Vector3 torque = object->GetTorque();
-		Vector3 angVel = object->GetAngularVelocity();
+			// get objects current torque and angular velocity
+			Vector3 torque = object->GetTorque();
+			Vector3 angVel = object->GetAngularVelocity();
 
-		// update objects orientation
-		object->UpdateInertiaTensor();
+			// update objects orientation
+			object->UpdateInertiaTensor();
 
-		// get angular accel using new orientation * torque
-		Vector3 angAccel = object->GetInertiaTensor() * torque;
-		// scale by dt and set as new angular velocity
-		angVel += angAccel * dt;
-		object->SetAngularVelocity(angVel);
-	}
+			// get angular accel using new orientation * torque
+			Vector3 angAccel = object->GetInertiaTensor() * torque;
+			// scale by dt and set as new angular velocity
+			angVel += angAccel * dt;
+			object->SetAngularVelocity(angVel);
+		}
+	});
 }
 
 /*
@@ -482,37 +531,40 @@ throughout a physics update, to slowly move the objects through
 the world, looking for collisions.
 */
 void PhysicsSystem::IntegrateVelocity(float dt) {
-	std::vector<GameObject*>::const_iterator first;
-	std::vector<GameObject*>::const_iterator last;
-	mGameWorld.GetObjectIterators(first, last);
 	float frameLinearDampening = 1.0f - (0.4f * dt);
+	ComponentPool<PhysicsObject>& physicsPool = mGameWorld.GetComponentPool<PhysicsObject>();
+	ComponentPool<Transform>& transformPool = mGameWorld.GetComponentPool<Transform>();
 
-	for (auto i = first; i != last; i++) {
-		PhysicsObject* object = (*i)->GetPhysicsObject();
-		if (object == nullptr)
-			continue;
-		// determine position
-		Transform& transform = (*i)->GetTransform();
-		Vector3 position = transform.GetPosition();
-		Vector3 linearVel = object->GetLinearVelocity();
-		position += linearVel * dt;
-		transform.SetPosition(position);
-		// linear dampening
-		linearVel = linearVel * frameLinearDampening;
-		object->SetLinearVelocity(linearVel);
-
-		// orientation
-		Quaternion orientation = transform.GetOrientation();
-		Vector3 angVel = object->GetAngularVelocity();
-		orientation = orientation + (Quaternion(angVel * dt * 0.5f, 0.0f) * orientation);
-		orientation.Normalise();
-		transform.SetOrientation(orientation);
-
-		// dampen new angular velocity
-		float frameAngularDamping = 1.0f - (0.4f * dt);
-		angVel = angVel * frameAngularDamping;
-		object->SetAngularVelocity(angVel);
-	}
+	JobSystem::GetJobSystem()->ParallelFor(physicsPool.Size(), 128, [&](size_t begin, size_t end) {
+		for (size_t i = begin; i < end; ++i) {
+			GameObject* owner = physicsPool.GetOwner(i);
+			if (!owner->HasPhysics() || !owner->IsActive()) {
+				continue;
+			}
+			PhysicsObject& object = physicsPool.GetComponent(i);
+			Transform& transform = *transformPool.Get(physicsPool.GetEntity(i));
+			// determine position
+			Vector3 position = transform.GetPosition();
+			Vector3 linearVel = object.GetLinearVelocity();
+			position += linearVel * dt;
+			transform.SetPosition(position);
+			// linear dampening
+			linearVel = linearVel * frameLinearDampening;
+			object.SetLinearVelocity(linearVel);
+
+			// orientation
+			Quaternion orientation = transform.GetOrientation();
+			Vector3 angVel = object.GetAngularVelocity();
+			orientation = orientation + (Quaternion(angVel * dt * 0.5f, 0.0f) * orientation);
+			orientation.Normalise();
+			transform.SetOrientation(orientation);
+
+			// dampen new angular velocity
+			float frameAngularDamping = 1.0f - (0.4f * dt);
+			angVel = angVel * frameAngularDamping;
+			object.SetAngularVelocity(angVel);
+		}
+	});
 }
 
 /*
@@ -521,11 +573,9 @@ clear out any accumulated forces, ready to receive new
 ones in the next 'game' frame.
 */
 void PhysicsSystem::ClearForces() {
-	mGameWorld.OperateOnContents(
-		[](GameObject* o) {
-			o->GetPhysicsObject()->ClearForces();
-		}
-	);
+	for (PhysicsObject& object : mGameWorld.GetComponentPool<PhysicsObject>().GetComponents()) {
+		object.ClearForces();
+	}
 }
 
 
@@ -12,6 +12,11 @@ namespace NCL {
 
 			void Update(float dt);
 
+			//Calls OnCollisionBegin/End for everything the last Update found. Update
+			//only queues them, so it can run on a job thread while gameplay code,
+			//which adds objects to the world, still runs on the main thread
+			void DeliverCollisionEvents();
+
 			void UseGravity(bool state) {
 				mApplyGravity = state;
 			}
@@ -23,6 +28,8 @@ namespace NCL {
 			void SetGravity(const Vector3& g);
 
 			void SetNewBroadphaseSize(const Vector3& levelSize);
+			void ClearStaticGeometry();
+			void RemoveCollisionsWith(const GameObject* object);
 		protected:
 			bool AreBothCollidersStatic(const CollisionDetection::CollisionInfo info);
 			bool IsEitherColliderNoCollide(const CollisionDetection::CollisionInfo& info);
@@ -70,7 +77,14 @@ namespace NCL {
 			float	mDTOffset;
 			float	mGlobalDamping;
 
+			struct CollisionEvent {
+				GameObject*	a;
+				GameObject*	b;
+				bool		begin;
+			};
+
 			std::set<CollisionDetection::CollisionInfo> mAllCollisions;
+			std::vector<CollisionEvent> mCollisionEvents;
 			std::set<CollisionDetection::CollisionInfo> mBroadphaseCollisions;
 			std::vector<CollisionDetection::CollisionInfo> mBroadphaseCollisionsVec;
 			QuadTree<GameObject*> baseTree;
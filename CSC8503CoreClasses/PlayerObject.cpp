@@ -29,6 +29,7 @@ namespace {
 PlayerObject::PlayerObject(GameWorld* world, const std::string& objName, InventoryBuffSystemClass* inventoryBuffSystemClassPtr, int playerID,
 	int walkSpeed, int sprintSpeed, int crouchSpeed, Vector3 boundingVolumeOffset) {
 	mName = objName;
+	mObjectType = Type;
 	mGameWorld = world;
 	mInventoryBuffSystemClassPtr = inventoryBuffSystemClassPtr;
 
@@ -50,6 +51,25 @@ PlayerObject::~PlayerObject() {
 }
 
 
+void PlayerObject::SaveState() {
+	GameObject::SaveState();
+	mSavedPlayerState.isCrouched		= mIsCrouched;
+	mSavedPlayerState.movementSpeed		= mMovementSpeed;
+	mSavedPlayerState.activeItemSlot	= mActiveItemSlot;
+	mSavedPlayerState.playerPoints		= mPlayerPoints;
+	mSavedPlayerState.playerState		= mPlayerState;
+}
+
+void PlayerObject::RestoreState() {
+	GameObject::RestoreState();
+	mIsCrouched		= mSavedPlayerState.isCrouched;
+	mMovementSpeed	= mSavedPlayerState.movementSpeed;
+	mActiveItemSlot	= mSavedPlayerState.activeItemSlot;
+	mPlayerPoints	= mSavedPlayerState.playerPoints;
+	mPlayerState	= mSavedPlayerState.playerState;
+	ChangeCharacterSize(mIsCrouched ? CHAR_CROUCH_HEIGHT : CHAR_STANDING_HEIGHT);
+}
+
 void PlayerObject::UpdateObject(float dt) {
 	MovePlayer(dt);
 	RayCastFromPlayer(mGameWorld);
@@ -83,16 +103,16 @@ void PlayerObject::MovePlayer(float dt) {
 	Vector3 rightAxis = mGameWorld->GetMainCamera().GetRightVector();
 
 	if (Window::GetKeyboard()->KeyDown(KeyCodes::W))
-		mPhysicsObject->AddForce(fwdAxis * mMovementSpeed);
+		GetPhysicsObject()->AddForce(fwdAxis * mMovementSpeed);
 
 	if (Window::GetKeyboard()->KeyDown(KeyCodes::S))
-		mPhysicsObject->AddForce(fwdAxis * mMovementSpeed);
+		GetPhysicsObject()->AddForce(fwdAxis * mMovementSpeed);
 
 	if (Window::GetKeyboard()->KeyDown(KeyCodes::A))
-		mPhysicsObject->AddForce(rightAxis * mMovementSpeed);
+		GetPhysicsObject()->AddForce(rightAxis * mMovementSpeed);
 
 	if (Window::GetKeyboard()->KeyDown(KeyCodes::D))
-		mPhysicsObject->AddForce(rightAxis * mMovementSpeed);
+		GetPhysicsObject()->AddForce(rightAxis * mMovementSpeed);
 
 	bool isSprinting = Window::GetKeyboard()->KeyDown(KeyCodes::SHIFT);
 	bool isCrouching = Window::GetKeyboard()->KeyPressed(KeyCodes::CONTROL);
@@ -146,7 +166,7 @@ void PlayerObject::RayCastFromPlayer(GameWorld* world){
 				Interactable* interactablePtr = dynamic_cast<Interactable*>(objectHit);
 				if (interactablePtr != nullptr)
 				{
-					interactablePtr->Interact(interactType);
+					interactablePtr->Interact(interactType, this, GetEquippedItem());
 					return;
 				}
 
@@ -236,21 +256,21 @@ void PlayerObject::ChangeCharacterSize(float newSize) {
 }
 
 void PlayerObject::EnforceMaxSpeeds() {
-	Vector3 velocityDirection = mPhysicsObject->GetLinearVelocity();
+	Vector3 velocityDirection = GetPhysicsObject()->GetLinearVelocity();
 	velocityDirection.Normalise();
 
 	switch (mPlayerState) {
 	case(Crouch):
-		if (mPhysicsObject->GetLinearVelocity().Length() > MAX_CROUCH_SPEED)
-			mPhysicsObject->SetLinearVelocity(velocityDirection * MAX_CROUCH_SPEED);
+		if (GetPhysicsObject()->GetLinearVelocity().Length() > MAX_CROUCH_SPEED)
+			GetPhysicsObject()->SetLinearVelocity(velocityDirection * MAX_CROUCH_SPEED);
 		break;
 	case(Walk):
-		if (mPhysicsObject->GetLinearVelocity().Length() > MAX_WALK_SPEED)
-			mPhysicsObject->SetLinearVelocity(velocityDirection * MAX_WALK_SPEED);
+		if (GetPhysicsObject()->GetLinearVelocity().Length() > MAX_WALK_SPEED)
+			GetPhysicsObject()->SetLinearVelocity(velocityDirection * MAX_WALK_SPEED);
 		break;
 	case(Sprint):
-		if (mPhysicsObject->GetLinearVelocity().Length() > MAX_SPRINT_SPEED)
-			mPhysicsObject->SetLinearVelocity(velocityDirection * MAX_SPRINT_SPEED);
+		if (GetPhysicsObject()->GetLinearVelocity().Length() > MAX_SPRINT_SPEED)
+			GetPhysicsObject()->SetLinearVelocity(velocityDirection * MAX_SPRINT_SPEED);
 		break;
 	}
 }
@@ -261,9 +281,9 @@ void PlayerObject::MatchCameraRotation(float yawValue) {
 }
 
 void PlayerObject::StopSliding() {
-	if ((mPhysicsObject->GetLinearVelocity().Length() < 1) && (mPhysicsObject->GetForce() == Vector3(0, 0, 0))) {
-		float fallingSpeed = mPhysicsObject->GetLinearVelocity().y;
-		mPhysicsObject->SetLinearVelocity(Vector3(0, fallingSpeed, 0));
+	if ((GetPhysicsObject()->GetLinearVelocity().Length() < 1) && (GetPhysicsObject()->GetForce() == Vector3(0, 0, 0))) {
+		float fallingSpeed = GetPhysicsObject()->GetLinearVelocity().y;
+		GetPhysicsObject()->SetLinearVelocity(Vector3(0, fallingSpeed, 0));
 	}
 }
 
@@ -12,6 +12,8 @@ namespace NCL {
 
 		class PlayerObject : public GameObject {
 		public:
+			static constexpr GameObjectType Type = GameObjectType::Player;
+
 			PlayerObject(GameWorld* world, const std::string& objName = "", InventoryBuffSystemClass* inventoryBuffSystemClassPtr = nullptr, int playerID = 0,
 				int walkSpeed = 40, int sprintSpeed = 50, int crouchSpeed = 35, Vector3 offset = Vector3(0, 0, 0));
 			~PlayerObject();
@@ -39,6 +41,9 @@ namespace NCL {
 
 			PlayerInventory::item GetEquippedItem();
 
+			virtual void SaveState() override;
+			virtual void RestoreState() override;
+
 
 		protected:
 			bool mIsCrouched;
@@ -55,6 +60,15 @@ namespace NCL {
 
 			PlayerState mPlayerState;
 
+			struct SavedPlayerState {
+				bool		isCrouched;
+				int			movementSpeed;
+				int			activeItemSlot;
+				int			playerPoints;
+				PlayerState	playerState;
+			};
+			SavedPlayerState mSavedPlayerState;
+
 			GameWorld* mGameWorld;
 			InventoryBuffSystemClass* mInventoryBuffSystemClassPtr;
 
@@ -0,0 +1,66 @@
+#include "ProximityGrid.h"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace NCL;
+using namespace CSC8503;
+
+ProximityGrid::ProximityGrid(int maxItems, float cellSize) {
+	mCellSize = cellSize;
+	mInvCellSize = 1.0f / cellSize;
+	mItems.reserve(maxItems);
+
+	// a few buckets per item keeps chains short even when everyone bunches up
+	int bucketCount = 1;
+	while (bucketCount < std::max(maxItems, 1) * 4) {
+		bucketCount <<= 1;
+	}
+	mBuckets.assign(bucketCount, -1);
+	mBucketMask = bucketCount - 1;
+}
+
+void ProximityGrid::Clear() {
+	std::fill(mBuckets.begin(), mBuckets.end(), -1);
+	mItems.clear();
+}
+
+void ProximityGrid::AddItem(int id, float x, float z) {
+	int cellX = (int)floorf(x * mInvCellSize);
+	int cellZ = (int)floorf(z * mInvCellSize);
+	int bucket = HashCell(cellX, cellZ);
+	mItems.push_back({ id, x, z, (int16_t)cellX, (int16_t)cellZ, mBuckets[bucket] });
+	mBuckets[bucket] = (int)mItems.size() - 1;
+}
+
+int ProximityGrid::QueryItems(float x, float z, float range, int* ids, int maxIds) const {
+	int minX = (int)floorf((x - range) * mInvCellSize);
+	int minZ = (int)floorf((z - range) * mInvCellSize);
+	int maxX = (int)floorf((x + range) * mInvCellSize);
+	int maxZ = (int)floorf((z + range) * mInvCellSize);
+
+	float rangeSquared = range * range;
+	int count = 0;
+	for (int cellZ = minZ; cellZ <= maxZ; ++cellZ) {
+		for (int cellX = minX; cellX <= maxX; ++cellX) {
+			// other cells share the bucket, so each item's own cell is checked
+			for (int i = mBuckets[HashCell(cellX, cellZ)]; i != -1; i = mItems[i].next) {
+				const Item& item = mItems[i];
+				if (item.cellX != (int16_t)cellX || item.cellZ != (int16_t)cellZ) {
+					continue;
+				}
+				// the cells cover a square, so the corners are left out here
+				float dx = item.x - x;
+				float dz = item.z - z;
+				if (dx * dx + dz * dz > rangeSquared) {
+					continue;
+				}
+				if (count < maxIds) {
+					ids[count] = item.id;
+				}
+				count++;
+			}
+		}
+	}
+	return count;
+}
@@ -0,0 +1,53 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+namespace NCL {
+	namespace CSC8503 {
+		/*
+		A spatial hash over the ground plane for finding whatever is near a
+		point. Items go in by their centre, so each sits in exactly one cell,
+		and a query walks every cell its range touches. Cells hash into a
+		fixed table of buckets, so the grid needs no bounds and clearing it
+		each frame costs nothing but resetting the buckets.
+
+		Works in the same manner as Detour's dtProximityGrid, which isn't part
+		of the Detour library this project builds.
+		*/
+		class ProximityGrid {
+		public:
+			ProximityGrid(int maxItems, float cellSize);
+
+			void Clear();
+			void AddItem(int id, float x, float z);
+
+			//Every item within range of (x, z), in no order; returns how many
+			//were found, which can be more than maxIds
+			int QueryItems(float x, float z, float range, int* ids, int maxIds) const;
+
+			float GetCellSize() const {
+				return mCellSize;
+			}
+
+		protected:
+			struct Item {
+				int			id;
+				float		x;
+				float		z;
+				int16_t		cellX;
+				int16_t		cellZ;
+				int			next;
+			};
+
+			int HashCell(int cellX, int cellZ) const {
+				return (int)(((unsigned int)cellX * 73856093u) ^ ((unsigned int)cellZ * 19349663u)) & mBucketMask;
+			}
+
+			float				mCellSize;
+			float				mInvCellSize;
+			std::vector<Item>	mItems;
+			std::vector<int>	mBuckets;	//first item in each bucket, -1 when empty
+			int					mBucketMask;
+		};
+	}
+}
@@ -14,11 +14,13 @@ namespace NCL {
 			Vector3 pos;
 			Vector3 size;
 			T object;
+			bool isStatic;
 
-			QuadTreeEntry(T obj, Vector3 pos, Vector3 size) {
+			QuadTreeEntry(T obj, Vector3 pos, Vector3 size, bool isStatic = false) {
 				object = obj;
 				this->pos = pos;
 				this->size = size;
+				this->isStatic = isStatic;
 			}
 		};
 
@@ -51,14 +53,14 @@ namespace NCL {
 					}
 				}
 				else {
-					contents.push_back(QuadTreeEntry<T>(object, objectPos, objectSize));
+					contents.push_back(QuadTreeEntry<T>(object, objectPos, objectSize, addingStatic));
 					if ((int)contents.size() > maxSize && depthLeft > 0) {
 						if (!children) {
 							Split();
 							for (const auto& i : contents) {
 								for (int j = 0; j < 4; j++) {
 									auto entry = i;
-									children[j].Insert(entry.object, entry.pos, entry.size, depthLeft - 1, maxSize, addingStatic);
+									children[j].Insert(entry.object, entry.pos, entry.size, depthLeft - 1, maxSize, entry.isStatic);
 								}
 							}
 							contents.clear();
@@ -1,302 +1,982 @@
 #include "RecastBuilder.h"
-#include "RenderObject.h"
-#include "GameObject.h"
-#include "../OpenGLRendering/OGLRenderer.h"
+#include "../Recast/Include/RecastAlloc.h"
 #include "../Detour/Include/DetourNavMeshBuilder.h"
-
+#include "../Detour/Include/DetourAlloc.h"
+#include "../Detour/Include/DetourCommon.h"
+#include "../DetourTileCache/Include/DetourTileCacheBuilder.h"
+#include "AssetFile.h"
+#include "LoadProfiler.h"
+#include "JobSystem.h"
+#include "Assets.h"
+
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <thread>
+
+using namespace NCL;
 using namespace NCL::CSC8503;
+using namespace NCL::Maths;
+
+namespace {
+	constexpr uint32_t NAVMESH_CACHE_MAGIC = 0x4356414e; // "NAVC"
+
+	/*
+	A cached navmesh is this header, the dtNavMeshParams and dtTileCacheParams
+	the tiles were laid out with, then every tile cache layer followed by every
+	navmesh tile, each as its size and the data exactly as Detour produced it.
+	The input hash covers the level geometry and build parameters; Detour
+	checks its own tile and layer versions as they're added.
+	*/
+	struct NavMeshCacheHeader {
+		uint32_t magic;
+		uint32_t version;
+		uint64_t inputHash;
+		uint64_t layerCount;
+		uint64_t tileCount;
+	};
+
+	// a tile reaches this many cells past its edges, so the erosion by the
+	// guard's radius sees the geometry on the far side
+	constexpr int TILE_BORDER_PADDING = 3;
+	// floors stacked over one another each get a layer; the levels are flat,
+	// so this only bounds how many tiles the navmesh and tile cache can hold
+	constexpr int MAX_LAYERS_PER_TILE = 4;
+	// the solo and tiled builds are each timed this many times, keeping the fastest
+	constexpr int BENCHMARK_REPEATS = 3;
+
+	double MillisecondsSince(std::chrono::high_resolution_clock::time_point start) {
+		return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+	}
+
+	// Recast and Detour allocate with malloc rather than new, so their
+	// allocations are passed on to the load profiler by hand
+	void* CountedRecastAlloc(size_t size, rcAllocHint) {
+		LoadProfiler::CountAllocation(size);
+		return malloc(size);
+	}
+
+	void* CountedDetourAlloc(size_t size, dtAllocHint) {
+		LoadProfiler::CountAllocation(size);
+		return malloc(size);
+	}
+
+	void SetPolyFlags(unsigned char* areas, unsigned short* flags, int polyCount) {
+		for (int i = 0; i < polyCount; ++i) {
+			if (areas[i] == RC_WALKABLE_AREA)
+				areas[i] = SAMPLE_POLYAREA_GROUND;
+
+			if (areas[i] == SAMPLE_POLYAREA_GROUND ||
+				areas[i] == SAMPLE_POLYAREA_GRASS ||
+				areas[i] == SAMPLE_POLYAREA_ROAD)
+			{
+				flags[i] = SAMPLE_POLYFLAGS_WALK;
+			}
+			else if (areas[i] == SAMPLE_POLYAREA_WATER)
+			{
+				flags[i] = SAMPLE_POLYFLAGS_SWIM;
+			}
+			else if (areas[i] == SAMPLE_POLYAREA_DOOR)
+			{
+				flags[i] = SAMPLE_POLYFLAGS_WALK | SAMPLE_POLYFLAGS_DOOR;
+			}
+		}
+	}
+
+	// layers are kept as they are; a level's worth is small, and a tile
+	// rebuilt under an obstacle then has nothing to unpack
+	struct UncompressedLayers : public dtTileCacheCompressor {
+		int maxCompressedSize(const int bufferSize) override {
+			return bufferSize;
+		}
+
+		dtStatus compress(const unsigned char* buffer, const int bufferSize,
+			unsigned char* compressed, const int maxCompressedSize, int* compressedSize) override {
+			if (bufferSize > maxCompressedSize) {
+				return DT_FAILURE | DT_BUFFER_TOO_SMALL;
+			}
+			memcpy(compressed, buffer, bufferSize);
+			*compressedSize = bufferSize;
+			return DT_SUCCESS;
+		}
+
+		dtStatus decompress(const unsigned char* compressed, const int compressedSize,
+			unsigned char* buffer, const int maxBufferSize, int* bufferSize) override {
+			if (compressedSize > maxBufferSize) {
+				return DT_FAILURE | DT_BUFFER_TOO_SMALL;
+			}
+			memcpy(buffer, compressed, compressedSize);
+			*bufferSize = compressedSize;
+			return DT_SUCCESS;
+		}
+	};
+
+	// gives the polygons the tile cache builds the same areas and flags as the rest
+	struct NavMeshPolyFlags : public dtTileCacheMeshProcess {
+		void process(dtNavMeshCreateParams* params, unsigned char* polyAreas, unsigned short* polyFlags) override {
+			SetPolyFlags(polyAreas, polyFlags, params->polyCount);
+		}
+	};
+}
 
 RecastBuilder::RecastBuilder() {
-	mTriAreas = nullptr;
-	mSolid = nullptr;
-	mCompHF = nullptr;
-	mContSet = nullptr;
-	mPolyMesh = nullptr;
-	mMeshDetail = nullptr;
 	mNavMesh = nullptr;
 	mNavMeshQuery = nullptr;
+	mTileCache = nullptr;
+	mTileCacheAlloc = new dtTileCacheAlloc();
+	mTileCacheCompressor = new UncompressedLayers();
+	mTileCacheMeshProcess = new NavMeshPolyFlags();
+	mObstaclesPending = false;
+	mTileCount = 0;
+	mLoadedFromCache = false;
+
+	rcAllocSetCustom(CountedRecastAlloc, free);
+	dtAllocSetCustom(CountedDetourAlloc, free);
 }
 
 RecastBuilder::~RecastBuilder() {
 	cleanup();
+	delete mTileCacheAlloc;
+	delete mTileCacheCompressor;
+	delete mTileCacheMeshProcess;
+}
+
+RecastBuilder::TileBuild::~TileBuild() {
+	rcFreeHeightField(solid);
+	rcFreeCompactHeightfield(compHF);
+	rcFreeHeightfieldLayerSet(layers);
+	rcFreeContourSet(contSet);
+	rcFreePolyMesh(polyMesh);
+	rcFreePolyMeshDetail(meshDetail);
 }
 
-float* RecastBuilder::BuildNavMesh(std::vector<GameObject*> objects) {
-	if (objects.empty()) return nullptr;
+float* RecastBuilder::BuildNavMesh(std::vector<float> verts, std::vector<unsigned int> tris) {
+	if (verts.empty() || tris.empty()) return nullptr;
+	LoadMarker buildMarker("BuildNavMesh");
 
 	cleanup();
+	mLoadedFromCache = false;
+
+	InputGeometry input;
+	input.verts = std::move(verts);
+	input.tris = std::move(tris);
+	float* bmin = input.bmin;
+	float* bmax = input.bmax;
+	for (int axis = x; axis <= z; axis++) {
+		bmin[axis] = std::numeric_limits<float>::max();
+		bmax[axis] = -std::numeric_limits<float>::max();
+	}
+	for (size_t i = 0; i < input.verts.size(); i += 3) {
+		for (int axis = x; axis <= z; axis++) {
+			bmin[axis] = std::min(bmin[axis], input.verts[i + axis]);
+			bmax[axis] = std::max(bmax[axis], input.verts[i + axis]);
+		}
+	}
+
+	uint64_t inputHash = HashInput(input.verts, input.tris);
+	std::string cachePath = GetCachePath(inputHash);
+	mCachePath = cachePath;
+	if (LoadCachedNavMesh(cachePath, inputHash)) {
+		mLoadedFromCache = true;
+	}
+	else {
+		cleanup();
+		if (!Build(input)) {
+			cleanup();
+			return nullptr;
+		}
 
-	// Translating the meshes into useable values for Recast
-	float* bmin = new float[3] {std::numeric_limits<float>::max(), std::numeric_limits<float>::max(), std::numeric_limits<float>::max()};
-	float* bmax = new float[3] {-std::numeric_limits<float>::max(), -std::numeric_limits<float>::max(), -std::numeric_limits<float>::max()};
-	int currentTriCount = 0;
-	int vertCount = 0;
-	int trisCount = 0;
-	for (int i = 0; i < objects.size(); i++) {
-		vertCount += objects[i]->GetRenderObject()->GetMesh()->GetVertexCount();
-		trisCount += objects[i]->GetRenderObject()->GetMesh()->GetPrimitiveCount();
-	}
-	float* verts = new float[vertCount * 3];
-	unsigned int* tris = new unsigned int[trisCount * 3];
-	int vCount = 0;
-	int tCount = 0;
-	vertCount = 0;
-	for (int i = 0; i < objects.size(); i++) {
-		int lastVertCount = vertCount;
-		std::vector<Vector3> vertsVector = objects[i]->GetRenderObject()->GetMesh()->GetPositionData();
-		for (int j = 0; j < vertsVector.size(); j++) {
-			verts[vCount++] = (vertsVector[j].x * objects[i]->GetTransform().GetScale().x) + objects[i]->GetTransform().GetPosition().x;
-			verts[vCount++] = (vertsVector[j].y * objects[i]->GetTransform().GetScale().y) + objects[i]->GetTransform().GetPosition().y;
-			verts[vCount++] = (vertsVector[j].z * objects[i]->GetTransform().GetScale().z) + objects[i]->GetTransform().GetPosition().z;
-			bmin[x] = std::min(bmin[x], verts[vCount + (x-3)]);
-			bmin[y] = std::min(bmin[y], verts[vCount + (y-3)]);
-			bmin[z] = std::min(bmin[z], verts[vCount + (z-3)]);
-			bmax[x] = std::max(bmax[x], verts[vCount + (x-3)]);
-			bmax[y] = std::max(bmax[y], verts[vCount + (y-3)]);
-			bmax[z] = std::max(bmax[z], verts[vCount + (z-3)]);
+		if (!SaveCachedNavMesh(cachePath, inputHash)) {
+			std::cout << __FUNCTION__ << " can't write navmesh cache " << cachePath << "\n";
 		}
+	}
+
+	float* levelSize = new float[3] {bmax[x] - bmin[x], bmax[y] - bmin[y], bmax[z] - bmin[z]};
+	mInput = std::move(input);
+	return levelSize;
+}
+
+/*
+Builds straight into the navmesh for a tile size of 0, otherwise into the tile
+cache, whose layers then make the navmesh tiles.
+*/
+bool RecastBuilder::Build(const InputGeometry& input) {
+	rcConfig config;
+	InitialiseConfig(input.bmin, input.bmax, config);
+	std::vector<TileData> tiles;
+	if (!BuildTiles(input, mTileSize, tiles)) return false;
+	if (mTileSize <= 0) {
+		return InitNavMesh(GetNavMeshParams(config, 0), tiles);
+	}
+	std::vector<TileData> navTiles;
+	return InitTileCache(GetTileCacheParams(config), GetNavMeshParams(config, mTileSize), tiles, navTiles);
+}
+
+std::string RecastBuilder::GetCachePath(uint64_t inputHash) {
+	char name[17];
+	snprintf(name, sizeof(name), "%016llx", (unsigned long long)inputHash);
+	return Assets::DATADIR + "NavMeshCache/" + name + ".navcache";
+}
 
-		std::vector<unsigned int> trisVector = objects[i]->GetRenderObject()->GetMesh()->GetIndexData();
-		for (int j = 0; j < trisVector.size(); j++) {
-			tris[tCount] = trisVector[j] + lastVertCount;
-			tCount++;
+uint64_t RecastBuilder::HashInput(const std::vector<float>& verts, const std::vector<unsigned int>& tris) const {
+	LoadMarker marker("Hash navmesh input");
+	// FNV-1a over the world space geometry and everything that shapes the
+	// build, so changing a parameter below can never pick up a stale tile
+	uint64_t hash = 14695981039346656037ull;
+	auto hashBytes = [&hash](const void* data, size_t size) {
+		for (size_t i = 0; i < size; ++i) {
+			hash ^= ((const uint8_t*)data)[i];
+			hash *= 1099511628211ull;
 		}
-		vertCount += objects[i]->GetRenderObject()->GetMesh()->GetVertexCount();
-	}
-	if (!InitialiseConfig(bmin, bmax)) return nullptr;
-	if (!RasterizeInputPolygon(verts, vertCount, tris, trisCount)) return nullptr;
-	if (!FilterWalkableSurfaces()) return nullptr;
-	if (!PartitionWalkableSurface()) return nullptr;
-	if (!TraceContours()) return nullptr;
-	if (!BuildPoly()) return nullptr;
-	if (!BuildDetailPoly()) return nullptr;
-	if (!CreateDetourData()) return nullptr;
-
-	return new float[3] {bmax[x] - bmin[x], bmax[y] - bmin[y], bmax[z] - bmin[z]};
-}
-
-bool RecastBuilder::InitialiseConfig(const float* bmin, const float* bmax) {
-	memset(&mConfig, 0, sizeof(mConfig));
-
-	mConfig.cs = mCellSize;
-	mConfig.ch = mCellHeight;
-	mConfig.walkableSlopeAngle = mGuardMaxSlope;
-	mConfig.walkableHeight = mConfig.ch != 0 ? (int)ceilf(mGuardHeight / mConfig.ch) : 0;
-	mConfig.walkableClimb = mConfig.ch != 0 ? (int)floorf(mGuardMaxClimb / mConfig.ch) : 0;
-	mConfig.walkableRadius = mConfig.cs != 0 ? (int)ceilf(mGuardRadius / mConfig.cs) : 0;
-	mConfig.maxEdgeLen = mConfig.cs != 0 ? (int)(mMaxEdgeLength / mConfig.cs) : 0;
-	mConfig.maxSimplificationError = mMaxEdgeError;
-	mConfig.minRegionArea = (int)rcSqr(mMinRegionSize);		// Note: area = size*size
-	mConfig.mergeRegionArea = (int)rcSqr(mMergedRegionSize);	// Note: area = size*size
-	mConfig.maxVertsPerPoly = mVertsPerPoly;
-	mConfig.detailSampleDist = mSampleDistance < 0.9f ? 0 : mConfig.cs * mSampleDistance;
-	mConfig.detailSampleMaxError = mConfig.ch * mMaxSampleError;
-
-	rcVcopy(mConfig.bmin, bmin);
-	rcVcopy(mConfig.bmax, bmax);
-	rcCalcGridSize(mConfig.bmin, mConfig.bmax, mConfig.cs, &mConfig.width, &mConfig.height);
+	};
+	const float floatParams[] = { mCellSize, mCellHeight, mGuardMaxSlope, mGuardRadius, mGuardHeight,
+		mGuardMaxClimb, mMaxEdgeLength, mMaxEdgeError };
+	const int intParams[] = { mVertsPerPoly, mMinRegionSize, mMergedRegionSize, mSampleDistance, mMaxSampleError,
+		mTileSize, TILE_BORDER_PADDING, DT_NAVMESH_VERSION, DT_VERTS_PER_POLYGON };
+	const uint64_t counts[] = { CACHE_VERSION, verts.size(), tris.size() };
+	hashBytes(counts, sizeof(counts));
+	hashBytes(floatParams, sizeof(floatParams));
+	hashBytes(intParams, sizeof(intParams));
+	hashBytes(verts.data(), verts.size() * sizeof(float));
+	hashBytes(tris.data(), tris.size() * sizeof(unsigned int));
+	return hash;
+}
+
+bool RecastBuilder::LoadCachedNavMesh(const std::string& path, uint64_t inputHash) {
+	LoadMarker marker("Load navmesh cache");
+	AssetFile file;
+	if (!file.Open(path) || file.GetSize() < sizeof(NavMeshCacheHeader) + sizeof(dtNavMeshParams) + sizeof(dtTileCacheParams)) {
+		return false;
+	}
+	NavMeshCacheHeader header;
+	memcpy(&header, file.GetData(), sizeof(header));
+	if (header.magic != NAVMESH_CACHE_MAGIC || header.version != CACHE_VERSION || header.inputHash != inputHash) {
+		return false;
+	}
+	dtNavMeshParams params;
+	dtTileCacheParams cacheParams;
+	memcpy(&params, file.GetData() + sizeof(header), sizeof(params));
+	memcpy(&cacheParams, file.GetData() + sizeof(header) + sizeof(params), sizeof(cacheParams));
+	if (header.tileCount == 0 || header.tileCount > (uint64_t)params.maxTiles ||
+		(header.layerCount > 0 && header.layerCount > (uint64_t)cacheParams.maxTiles)) {
+		return false;
+	}
+
+	// Detour keeps and frees the tile data itself, so every tile needs its own copy
+	size_t offset = sizeof(header) + sizeof(params) + sizeof(cacheParams);
+	auto readTiles = [&file, &offset](uint64_t count, std::vector<TileData>& tiles) {
+		for (uint64_t i = 0; i < count; ++i) {
+			int32_t dataSize = 0;
+			if (file.GetSize() - offset < sizeof(dataSize)) {
+				return false;
+			}
+			memcpy(&dataSize, file.GetData() + offset, sizeof(dataSize));
+			offset += sizeof(dataSize);
+			if (dataSize <= 0 || file.GetSize() - offset < (size_t)dataSize) {
+				return false;
+			}
+			unsigned char* data = (unsigned char*)dtAlloc(dataSize, DT_ALLOC_PERM);
+			if (!data) {
+				return false;
+			}
+			memcpy(data, file.GetData() + offset, dataSize);
+			offset += dataSize;
+			tiles.push_back({ data, dataSize });
+		}
+		return true;
+	};
+	std::vector<TileData> layers;
+	std::vector<TileData> tiles;
+	if (!readTiles(header.layerCount, layers) || !readTiles(header.tileCount, tiles) || offset != file.GetSize()) {
+		FreeTiles(layers);
+		FreeTiles(tiles);
+		return false;
+	}
+	bool loaded = header.layerCount > 0 ? InitTileCache(cacheParams, params, layers, tiles) : InitNavMesh(params, tiles);
+	if (!loaded) {
+		cleanup();
+		return false;
+	}
 	return true;
 }
 
-bool RecastBuilder::RasterizeInputPolygon(float* verts, const int vertCount, const unsigned int* tris, const int trisCount) {
-	mSolid = rcAllocHeightfield();
-	if (!mSolid) {
-		std::cout << "Recast Error: Out of memory 'mSolid'\n";
+bool RecastBuilder::SaveCachedNavMesh(const std::string& path, uint64_t inputHash) const {
+	LoadMarker marker("Save navmesh cache");
+	const dtNavMesh* navMesh = mNavMesh;
+	if (!navMesh) {
 		return false;
 	}
-	if (!rcCreateHeightfield(nullptr, *mSolid, mConfig.width, mConfig.height, mConfig.bmin, mConfig.bmax, mConfig.cs, mConfig.ch)) {
-		std::cout << "Recast Error: Could not create solid heightfield\n";
+	std::vector<const dtMeshTile*> tiles;
+	for (int i = 0; i < navMesh->getMaxTiles(); ++i) {
+		const dtMeshTile* tile = navMesh->getTile(i);
+		if (tile && tile->header && tile->data && tile->dataSize > 0) {
+			tiles.push_back(tile);
+		}
+	}
+	if (tiles.empty()) {
+		return false;
+	}
+	// saved straight after a build, so no obstacle has touched the layers yet
+	std::vector<const dtCompressedTile*> layers;
+	dtTileCacheParams cacheParams = {};
+	if (mTileCache) {
+		cacheParams = *mTileCache->getParams();
+		for (int i = 0; i < mTileCache->getTileCount(); ++i) {
+			const dtCompressedTile* layer = mTileCache->getTile(i);
+			if (layer && layer->header && layer->data && layer->dataSize > 0) {
+				layers.push_back(layer);
+			}
+		}
+	}
+	NavMeshCacheHeader header = {};
+	header.magic		= NAVMESH_CACHE_MAGIC;
+	header.version		= CACHE_VERSION;
+	header.inputHash	= inputHash;
+	header.layerCount	= (uint64_t)layers.size();
+	header.tileCount	= (uint64_t)tiles.size();
+
+	std::error_code error;
+	std::filesystem::create_directories(std::filesystem::path(path).parent_path(), error);
+
+	// written under a temporary name and moved into place, so a second
+	// instance starting at the same time never reads a half written tile
+	std::string tempPath = path + "." + std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id())) + ".tmp";
+	{
+		std::ofstream out(tempPath, std::ios::binary | std::ios::trunc);
+		out.write((const char*)&header, sizeof(header));
+		out.write((const char*)navMesh->getParams(), sizeof(dtNavMeshParams));
+		out.write((const char*)&cacheParams, sizeof(cacheParams));
+		for (const dtCompressedTile* layer : layers) {
+			int32_t dataSize = layer->dataSize;
+			out.write((const char*)&dataSize, sizeof(dataSize));
+			out.write((const char*)layer->data, layer->dataSize);
+		}
+		for (const dtMeshTile* tile : tiles) {
+			int32_t dataSize = tile->dataSize;
+			out.write((const char*)&dataSize, sizeof(dataSize));
+			out.write((const char*)tile->data, tile->dataSize);
+		}
+		if (!out) {
+			return false;
+		}
+	}
+	std::filesystem::rename(tempPath, path, error);
+	if (error) {
+		std::filesystem::remove(tempPath, error);
+		return false;
+	}
+	return true;
+}
+
+void RecastBuilder::BenchmarkBuild(std::ostream& out) const {
+	if (mInput.verts.empty()) {
+		out << __FUNCTION__ << " needs a navmesh built first\n";
+		return;
+	}
+	// each build goes into a builder of its own, so the level's navmesh is left alone
+	auto timeBuild = [this](int tileSize, int& tileCount) {
+		double fastest = -1.0;
+		for (int i = 0; i < BENCHMARK_REPEATS; ++i) {
+			RecastBuilder builder;
+			builder.SetTileSize(tileSize);
+			auto start = std::chrono::high_resolution_clock::now();
+			bool built = builder.Build(mInput);
+			double time = MillisecondsSince(start);
+			tileCount = builder.GetTileCount();
+			if (!built) {
+				return -1.0;
+			}
+			fastest = fastest < 0.0 ? time : std::min(fastest, time);
+		}
+		return fastest;
+	};
+	int soloTiles = 0;
+	int tiledTiles = 0;
+	double soloTime = timeBuild(0, soloTiles);
+	double tiledTime = timeBuild(mTileSize, tiledTiles);
+	out << "Navmesh build: " << mInput.tris.size() / 3 << " triangles, solo " << soloTime << "ms, "
+		<< tiledTiles << " tiles of " << mTileSize << " cells " << tiledTime << "ms on "
+		<< JobSystem::GetJobSystem()->GetThreadCount() << " threads";
+	if (soloTime > 0.0 && tiledTime > 0.0) {
+		out << ", " << soloTime / tiledTime << "x";
+	}
+	out << "\n";
+}
+
+dtObstacleRef RecastBuilder::AddObstacle(const Vector3& centre, const Vector3& halfExtents, float yRadians) {
+	if (!mTileCache) {
+		return 0;
+	}
+	// grown the way erosion grows the walls, so paths keep the guard's radius
+	// clear of it, and tall enough to reach a floor the guard can step onto
+	Vector3 extents(halfExtents.x + mGuardRadius, halfExtents.y + mGuardMaxClimb, halfExtents.z + mGuardRadius);
+	dtObstacleRef obstacle = 0;
+	if (dtStatusFailed(mTileCache->addBoxObstacle(&centre.x, &extents.x, yRadians, &obstacle))) {
+		std::cout << __FUNCTION__ << " can't add a navmesh obstacle, the tile cache is full\n";
+		return 0;
+	}
+	mObstaclesPending = true;
+	return obstacle;
+}
+
+void RecastBuilder::RemoveObstacle(dtObstacleRef obstacle) {
+	if (!mTileCache || obstacle == 0) {
+		return;
+	}
+	if (dtStatusFailed(mTileCache->removeObstacle(obstacle))) {
+		std::cout << __FUNCTION__ << " can't remove a navmesh obstacle, the tile cache is full\n";
+		return;
+	}
+	mObstaclesPending = true;
+}
+
+/*
+Each update of the tile cache rebuilds one navmesh tile from its layers with
+the obstacles over it marked out, so a door only costs the tiles it touches,
+spread across as many frames as the budget needs.
+*/
+bool RecastBuilder::UpdateObstacles(double budget) {
+	if (!mObstaclesPending) {
+		return false;
+	}
+	auto start = std::chrono::high_resolution_clock::now();
+	bool upToDate = false;
+	do {
+		if (dtStatusFailed(mTileCache->update(0.0f, mNavMesh, &upToDate))) {
+			std::cout << __FUNCTION__ << " couldn't rebuild a navmesh tile\n";
+			break;
+		}
+	} while (!upToDate && MillisecondsSince(start) < budget);
+	mObstaclesPending = !upToDate;
+	return true;
+}
+
+void RecastBuilder::InitialiseConfig(const float* bmin, const float* bmax, rcConfig& config) const {
+	memset(&config, 0, sizeof(config));
+
+	config.cs = mCellSize;
+	config.ch = mCellHeight;
+	config.walkableSlopeAngle = mGuardMaxSlope;
+	config.walkableHeight = config.ch != 0 ? (int)ceilf(mGuardHeight / config.ch) : 0;
+	config.walkableClimb = config.ch != 0 ? (int)floorf(mGuardMaxClimb / config.ch) : 0;
+	config.walkableRadius = config.cs != 0 ? (int)ceilf(mGuardRadius / config.cs) : 0;
+	config.maxEdgeLen = config.cs != 0 ? (int)(mMaxEdgeLength / config.cs) : 0;
+	config.maxSimplificationError = mMaxEdgeError;
+	config.minRegionArea = (int)rcSqr(mMinRegionSize);		// Note: area = size*size
+	config.mergeRegionArea = (int)rcSqr(mMergedRegionSize);	// Note: area = size*size
+	config.maxVertsPerPoly = mVertsPerPoly;
+	config.detailSampleDist = mSampleDistance < 0.9f ? 0 : config.cs * mSampleDistance;
+	config.detailSampleMaxError = config.ch * mMaxSampleError;
+
+	rcVcopy(config.bmin, bmin);
+	rcVcopy(config.bmax, bmax);
+	rcCalcGridSize(config.bmin, config.bmax, config.cs, &config.width, &config.height);
+}
+
+void RecastBuilder::GetTileGrid(const rcConfig& config, int tileSize, int& tilesX, int& tilesY) const {
+	if (tileSize <= 0) {
+		tilesX = 1;
+		tilesY = 1;
+		return;
+	}
+	tilesX = (config.width + tileSize - 1) / tileSize;
+	tilesY = (config.height + tileSize - 1) / tileSize;
+}
+
+//The config for one tile of the grid, grown by the border on every side
+rcConfig RecastBuilder::GetTileConfig(const rcConfig& config, int tileSize, int tileX, int tileY) const {
+	if (tileSize <= 0) {
+		return config;
+	}
+	rcConfig tileConfig = config;
+	tileConfig.tileSize = tileSize;
+	tileConfig.borderSize = config.walkableRadius + TILE_BORDER_PADDING;
+	tileConfig.width = tileSize + tileConfig.borderSize * 2;
+	tileConfig.height = tileSize + tileConfig.borderSize * 2;
+
+	float tileWidth = tileSize * config.cs;
+	float border = tileConfig.borderSize * config.cs;
+	tileConfig.bmin[x] = config.bmin[x] + tileX * tileWidth - border;
+	tileConfig.bmin[z] = config.bmin[z] + tileY * tileWidth - border;
+	tileConfig.bmax[x] = config.bmin[x] + (tileX + 1) * tileWidth + border;
+	tileConfig.bmax[z] = config.bmin[z] + (tileY + 1) * tileWidth + border;
+	return tileConfig;
+}
+
+dtNavMeshParams RecastBuilder::GetNavMeshParams(const rcConfig& config, int tileSize) const {
+	int tilesX;
+	int tilesY;
+	GetTileGrid(config, tileSize, tilesX, tilesY);
+
+	dtNavMeshParams params;
+	memset(&params, 0, sizeof(params));
+	rcVcopy(params.orig, config.bmin);
+	params.tileWidth = tileSize > 0 ? tileSize * config.cs : config.bmax[x] - config.bmin[x];
+	params.tileHeight = tileSize > 0 ? tileSize * config.cs : config.bmax[z] - config.bmin[z];
+	// a polygon reference shares its bits between tile and polygon index, and
+	// Detour needs at least 10 of the 32 left over for the salt
+	int layers = tileSize > 0 ? MAX_LAYERS_PER_TILE : 1;
+	int tileBits = std::min((int)dtIlog2(dtNextPow2((unsigned int)(tilesX * tilesY * layers))), 14);
+	int polyBits = 22 - tileBits;
+	params.maxTiles = 1 << tileBits;
+	params.maxPolys = 1 << polyBits;
+	return params;
+}
+
+dtTileCacheParams RecastBuilder::GetTileCacheParams(const rcConfig& config) const {
+	int tilesX;
+	int tilesY;
+	GetTileGrid(config, mTileSize, tilesX, tilesY);
+
+	dtTileCacheParams params;
+	memset(&params, 0, sizeof(params));
+	rcVcopy(params.orig, config.bmin);
+	params.cs = config.cs;
+	params.ch = config.ch;
+	params.width = mTileSize;
+	params.height = mTileSize;
+	params.walkableHeight = mGuardHeight;
+	params.walkableRadius = mGuardRadius;
+	params.walkableClimb = mGuardMaxClimb;
+	params.maxSimplificationError = mMaxEdgeError;
+	params.maxTiles = tilesX * tilesY * MAX_LAYERS_PER_TILE;
+	params.maxObstacles = MAX_OBSTACLES;
+	return params;
+}
+
+/*
+Every triangle is handed to each tile its bounds reach, border included, and
+the tiles are then built side by side on the job threads. Tiles with nothing
+walkable in them come back without data.
+*/
+bool RecastBuilder::BuildTiles(const InputGeometry& input, int tileSize, std::vector<TileData>& tiles) const {
+	rcConfig config;
+	InitialiseConfig(input.bmin, input.bmax, config);
+	int tilesX;
+	int tilesY;
+	GetTileGrid(config, tileSize, tilesX, tilesY);
+
+	std::vector<std::vector<unsigned int>> tileTris(tilesX * tilesY);
+	if (tileSize <= 0) {
+		tileTris[0] = input.tris;
+	}
+	else {
+		LoadMarker marker("Bin navmesh triangles");
+		float tileWidth = tileSize * config.cs;
+		float border = (config.walkableRadius + TILE_BORDER_PADDING) * config.cs;
+		for (size_t i = 0; i + 2 < input.tris.size(); i += 3) {
+			float minX = std::numeric_limits<float>::max();
+			float minZ = std::numeric_limits<float>::max();
+			float maxX = -std::numeric_limits<float>::max();
+			float maxZ = -std::numeric_limits<float>::max();
+			for (int corner = 0; corner < 3; ++corner) {
+				const float* vert = &input.verts[input.tris[i + corner] * 3];
+				minX = std::min(minX, vert[x]);
+				minZ = std::min(minZ, vert[z]);
+				maxX = std::max(maxX, vert[x]);
+				maxZ = std::max(maxZ, vert[z]);
+			}
+			int firstX = std::clamp((int)floorf((minX - border - config.bmin[x]) / tileWidth), 0, tilesX - 1);
+			int firstY = std::clamp((int)floorf((minZ - border - config.bmin[z]) / tileWidth), 0, tilesY - 1);
+			int lastX = std::clamp((int)floorf((maxX + border - config.bmin[x]) / tileWidth), 0, tilesX - 1);
+			int lastY = std::clamp((int)floorf((maxZ + border - config.bmin[z]) / tileWidth), 0, tilesY - 1);
+			for (int tileY = firstY; tileY <= lastY; ++tileY) {
+				for (int tileX = firstX; tileX <= lastX; ++tileX) {
+					tileTris[tileY * tilesX + tileX].insert(tileTris[tileY * tilesX + tileX].end(),
+						{ input.tris[i], input.tris[i + 1], input.tris[i + 2] });
+				}
+			}
+		}
+	}
+
+	// a tile can make any number of layers, so each tile's go in a list of their own
+	std::vector<std::vector<TileData>> tileData(tileTris.size());
+	std::atomic<bool> failed = false;
+	{
+		LoadMarker marker("Build navmesh tiles", std::to_string(tilesX) + "x" + std::to_string(tilesY));
+		JobSystem::GetJobSystem()->ParallelFor(tileData.size(), 1, [&](size_t begin, size_t end) {
+			for (size_t i = begin; i < end && !failed; ++i) {
+				TileBuild build;
+				build.tileX = (int)i % tilesX;
+				build.tileY = (int)i / tilesX;
+				build.config = GetTileConfig(config, tileSize, build.tileX, build.tileY);
+				if (!BuildTile(input, tileTris[i], build, tileData[i])) {
+					failed = true;
+				}
+			}
+		});
+	}
+	for (std::vector<TileData>& data : tileData) {
+		tiles.insert(tiles.end(), data.begin(), data.end());
+	}
+	if (failed) {
+		FreeTiles(tiles);
 		return false;
 	}
+	return true;
+}
+
+bool RecastBuilder::BuildTile(const InputGeometry& input, const std::vector<unsigned int>& tris, TileBuild& build, std::vector<TileData>& tiles) const {
+	if (tris.empty()) {
+		return true;
+	}
+	LoadMarker marker("Build navmesh tile", std::to_string(build.tileX) + "," + std::to_string(build.tileY));
+	if (!RasterizeInputPolygon(build, input.verts.data(), (int)input.verts.size() / 3, tris.data(), (int)tris.size() / 3)) return false;
+	if (!FilterWalkableSurfaces(build)) return false;
+	if (!BuildCompactHeightfield(build)) return false;
+	if (build.config.tileSize > 0) {
+		return BuildTileLayers(build, tiles);
+	}
+	if (!PartitionWalkableSurface(build)) return false;
+	if (!TraceContours(build)) return false;
+	if (!BuildPoly(build)) return false;
+	if (!BuildDetailPoly(build)) return false;
+	TileData tile = { nullptr, 0 };
+	if (!CreateDetourData(build, tile)) return false;
+	if (tile.data) {
+		tiles.push_back(tile);
+	}
+	return true;
+}
+
+void RecastBuilder::FreeTiles(std::vector<TileData>& tiles) {
+	for (TileData& tile : tiles) {
+		dtFree(tile.data);
+		tile.data = nullptr;
+	}
+}
 
-	mTriAreas = new unsigned char[trisCount];
-	if (!mTriAreas) {
-		std::cout << "Recast Error: Out of memory 'mTriAreas'\n";
+bool RecastBuilder::RasterizeInputPolygon(TileBuild& build, const float* verts, const int vertCount, const unsigned int* tris, const int trisCount) const {
+	LoadMarker marker("Rasterize");
+	const rcConfig& config = build.config;
+	build.solid = rcAllocHeightfield();
+	if (!build.solid) {
+		std::cout << "Recast Error: Out of memory 'solid'\n";
+		return false;
+	}
+	if (!rcCreateHeightfield(nullptr, *build.solid, config.width, config.height, config.bmin, config.bmax, config.cs, config.ch)) {
+		std::cout << "Recast Error: Could not create solid heightfield\n";
 		return false;
 	}
 
-	memset(mTriAreas, 0, trisCount * sizeof(unsigned char));
-	rcMarkWalkableTriangles(nullptr, mConfig.walkableSlopeAngle, verts, vertCount, tris, trisCount, mTriAreas);
-	if (!rcRasterizeTriangles(nullptr, verts, vertCount, tris, mTriAreas, trisCount, *mSolid, mConfig.walkableClimb)) {
+	std::vector<unsigned char> triAreas(trisCount, 0);
+	rcMarkWalkableTriangles(nullptr, config.walkableSlopeAngle, verts, vertCount, tris, trisCount, triAreas.data());
+	if (!rcRasterizeTriangles(nullptr, verts, vertCount, tris, triAreas.data(), trisCount, *build.solid, config.walkableClimb)) {
 		std::cout << "Recast Error: Could not rasterize the triangles\n";
 		return false;
 	}
 	return true;
 }
 
-bool RecastBuilder::FilterWalkableSurfaces() {
-	rcFilterLowHangingWalkableObstacles(nullptr, mConfig.walkableClimb, *mSolid);
-	rcFilterLedgeSpans(nullptr, mConfig.walkableHeight, mConfig.walkableClimb, *mSolid);
-	rcFilterWalkableLowHeightSpans(nullptr, mConfig.walkableHeight, *mSolid);
+bool RecastBuilder::FilterWalkableSurfaces(TileBuild& build) const {
+	LoadMarker marker("Filter walkable surfaces");
+	const rcConfig& config = build.config;
+	rcFilterLowHangingWalkableObstacles(nullptr, config.walkableClimb, *build.solid);
+	rcFilterLedgeSpans(nullptr, config.walkableHeight, config.walkableClimb, *build.solid);
+	rcFilterWalkableLowHeightSpans(nullptr, config.walkableHeight, *build.solid);
 	return true;
 }
 
-bool RecastBuilder::PartitionWalkableSurface() {
-	mCompHF = rcAllocCompactHeightfield();
-	if (!mCompHF) {
-		std::cout << "Recast Error: Out of memory 'mCompHF'\n";
+bool RecastBuilder::BuildCompactHeightfield(TileBuild& build) const {
+	LoadMarker marker("Build compact heightfield");
+	const rcConfig& config = build.config;
+	build.compHF = rcAllocCompactHeightfield();
+	if (!build.compHF) {
+		std::cout << "Recast Error: Out of memory 'compHF'\n";
 		return false;
 	}
-	if (!rcBuildCompactHeightfield(nullptr, mConfig.walkableHeight, mConfig.walkableClimb, *mSolid, *mCompHF)) {
+	if (!rcBuildCompactHeightfield(nullptr, config.walkableHeight, config.walkableClimb, *build.solid, *build.compHF)) {
 		std::cout << "Recast Error: Could not build compact data\n";
 		return false;
 	}
+	// the heightfield isn't needed past here, and a tile build is one of many at once
+	rcFreeHeightField(build.solid);
+	build.solid = nullptr;
 
-	if (!rcErodeWalkableArea(nullptr, mConfig.walkableRadius, *mCompHF)) {
+	if (!rcErodeWalkableArea(nullptr, config.walkableRadius, *build.compHF)) {
 		std::cout << "Recast Error: Could not erode\n";
 		return false;
 	}
+	return true;
+}
+
+/*
+Splits the tile into layers that don't overlap each other, and packs each one
+the way the tile cache keeps it. The tile cache does the rest of the build,
+from regions on, whenever it makes the navmesh tiles.
+*/
+bool RecastBuilder::BuildTileLayers(TileBuild& build, std::vector<TileData>& layers) const {
+	LoadMarker marker("Build tile cache layers");
+	const rcConfig& config = build.config;
+	build.layers = rcAllocHeightfieldLayerSet();
+	if (!build.layers) {
+		std::cout << "Recast Error: Out of memory 'layers'\n";
+		return false;
+	}
+	// unlike the rest of Recast, building layers can't do without a context
+	rcContext context(false);
+	if (!rcBuildHeightfieldLayers(&context, *build.compHF, config.borderSize, config.walkableHeight, *build.layers)) {
+		std::cout << "Recast Error: Could not build heightfield layers\n";
+		return false;
+	}
 
-	if (!rcBuildRegionsMonotone(nullptr, *mCompHF, 0, mConfig.minRegionArea, mConfig.mergeRegionArea)) {
+	for (int i = 0; i < std::min(build.layers->nlayers, MAX_LAYERS_PER_TILE); ++i) {
+		const rcHeightfieldLayer& layer = build.layers->layers[i];
+		dtTileCacheLayerHeader header;
+		memset(&header, 0, sizeof(header));
+		header.magic = DT_TILECACHE_MAGIC;
+		header.version = DT_TILECACHE_VERSION;
+		header.tx = build.tileX;
+		header.ty = build.tileY;
+		header.tlayer = i;
+		dtVcopy(header.bmin, layer.bmin);
+		dtVcopy(header.bmax, layer.bmax);
+		header.width = (unsigned char)layer.width;
+		header.height = (unsigned char)layer.height;
+		header.minx = (unsigned char)layer.minx;
+		header.maxx = (unsigned char)layer.maxx;
+		header.miny = (unsigned char)layer.miny;
+		header.maxy = (unsigned char)layer.maxy;
+		header.hmin = (unsigned short)layer.hmin;
+		header.hmax = (unsigned short)layer.hmax;
+
+		TileData data = { nullptr, 0 };
+		if (dtStatusFailed(dtBuildTileCacheLayer(mTileCacheCompressor, &header, layer.heights, layer.areas, layer.cons, &data.data, &data.size))) {
+			std::cout << "Detour Error: Could not build a tile cache layer\n";
+			return false;
+		}
+		layers.push_back(data);
+	}
+	return true;
+}
+
+bool RecastBuilder::PartitionWalkableSurface(TileBuild& build) const {
+	LoadMarker marker("Partition regions");
+	const rcConfig& config = build.config;
+	if (!rcBuildRegionsMonotone(nullptr, *build.compHF, config.borderSize, config.minRegionArea, config.mergeRegionArea)) {
 		std::cout << "Recast Error: Could not build NavMesh regions\n";
 		return false;
 	}
 	return true;
 }
 
-bool RecastBuilder::TraceContours() {
-	mContSet = rcAllocContourSet();
-	if (!mContSet) {
-		std::cout << "Recast Error: Out of memory 'mContSet'\n";
+bool RecastBuilder::TraceContours(TileBuild& build) const {
+	LoadMarker marker("Trace contours");
+	build.contSet = rcAllocContourSet();
+	if (!build.contSet) {
+		std::cout << "Recast Error: Out of memory 'contSet'\n";
 		return false;
 	}
 
-	if (!rcBuildContours(nullptr, *mCompHF, mConfig.maxSimplificationError, mConfig.maxEdgeLen, *mContSet)) {
+	if (!rcBuildContours(nullptr, *build.compHF, build.config.maxSimplificationError, build.config.maxEdgeLen, *build.contSet)) {
 		std::cout << "Recast Error: Could not create contours\n";
 		return false;
 	}
 	return true;
 }
 
-bool RecastBuilder::BuildPoly() {
-	mPolyMesh = rcAllocPolyMesh();
-	if (!mPolyMesh) {
-		std::cout << "Recast Error: Out of memory 'mPolyMesh'\n";
+bool RecastBuilder::BuildPoly(TileBuild& build) const {
+	LoadMarker marker("Build poly mesh");
+	build.polyMesh = rcAllocPolyMesh();
+	if (!build.polyMesh) {
+		std::cout << "Recast Error: Out of memory 'polyMesh'\n";
 		return false;
 	}
-	if (!rcBuildPolyMesh(nullptr, *mContSet, mConfig.maxVertsPerPoly, *mPolyMesh)) {
+	if (!rcBuildPolyMesh(nullptr, *build.contSet, build.config.maxVertsPerPoly, *build.polyMesh)) {
 		std::cout << "Recast Error: Could not triangulate contours\n";
 		return false;
 	}
 	return true;
 }
 
-bool RecastBuilder::BuildDetailPoly() {
-	mMeshDetail = rcAllocPolyMeshDetail();
-	if (!mMeshDetail) {
-		std::cout << "Recast Error: Out of memory 'mMeshDetail'\n";
+bool RecastBuilder::BuildDetailPoly(TileBuild& build) const {
+	LoadMarker marker("Build detail mesh");
+	build.meshDetail = rcAllocPolyMeshDetail();
+	if (!build.meshDetail) {
+		std::cout << "Recast Error: Out of memory 'meshDetail'\n";
 		return false;
 	}
 
-	if (!rcBuildPolyMeshDetail(nullptr, *mPolyMesh, *mCompHF, mConfig.detailSampleDist, mConfig.detailSampleMaxError, *mMeshDetail)) {
+	if (!rcBuildPolyMeshDetail(nullptr, *build.polyMesh, *build.compHF, build.config.detailSampleDist, build.config.detailSampleMaxError, *build.meshDetail)) {
 		std::cout << "Recast Error: Could not build detail mesh\n";
 		return false;
 	}
 	return true;
 }
 
-bool RecastBuilder::CreateDetourData() {
-	if (mConfig.maxVertsPerPoly <= DT_VERTS_PER_POLYGON)
+bool RecastBuilder::CreateDetourData(TileBuild& build, TileData& tile) const {
+	LoadMarker marker("Create Detour data");
+	rcPolyMesh* polyMesh = build.polyMesh;
+	rcPolyMeshDetail* meshDetail = build.meshDetail;
+	// a tile of nothing but walls has no polygons, and is left out of the navmesh
+	if (build.config.maxVertsPerPoly <= DT_VERTS_PER_POLYGON && polyMesh->npolys > 0)
 	{
 		unsigned char* navData = 0;
 		int navDataSize = 0;
 
 		// Update poly flags from areas.
-		for (int i = 0; i < mPolyMesh->npolys; ++i) {
-			if (mPolyMesh->areas[i] == RC_WALKABLE_AREA)
-				mPolyMesh->areas[i] = SAMPLE_POLYAREA_GROUND;
-
-			if (mPolyMesh->areas[i] == SAMPLE_POLYAREA_GROUND ||
-				mPolyMesh->areas[i] == SAMPLE_POLYAREA_GRASS ||
-				mPolyMesh->areas[i] == SAMPLE_POLYAREA_ROAD)
-			{
-				mPolyMesh->flags[i] = SAMPLE_POLYFLAGS_WALK;
-			}
-			else if (mPolyMesh->areas[i] == SAMPLE_POLYAREA_WATER)
-			{
-				mPolyMesh->flags[i] = SAMPLE_POLYFLAGS_SWIM;
-			}
-			else if (mPolyMesh->areas[i] == SAMPLE_POLYAREA_DOOR)
-			{
-				mPolyMesh->flags[i] = SAMPLE_POLYFLAGS_WALK | SAMPLE_POLYFLAGS_DOOR;
-			}
-		}
+		SetPolyFlags(polyMesh->areas, polyMesh->flags, polyMesh->npolys);
 
 		dtNavMeshCreateParams params;
 		memset(&params, 0, sizeof(params));
-		params.verts = mPolyMesh->verts;
-		params.vertCount = mPolyMesh->nverts;
-		params.polys = mPolyMesh->polys;
-		params.polyAreas = mPolyMesh->areas;
-		params.polyFlags = mPolyMesh->flags;
-		params.polyCount = mPolyMesh->npolys;
-		params.nvp = mPolyMesh->nvp;
-		params.detailMeshes = mMeshDetail->meshes;
-		params.detailVerts = mMeshDetail->verts;
-		params.detailVertsCount = mMeshDetail->nverts;
-		params.detailTris = mMeshDetail->tris;
-		params.detailTriCount = mMeshDetail->ntris;
+		params.verts = polyMesh->verts;
+		params.vertCount = polyMesh->nverts;
+		params.polys = polyMesh->polys;
+		params.polyAreas = polyMesh->areas;
+		params.polyFlags = polyMesh->flags;
+		params.polyCount = polyMesh->npolys;
+		params.nvp = polyMesh->nvp;
+		params.detailMeshes = meshDetail->meshes;
+		params.detailVerts = meshDetail->verts;
+		params.detailVertsCount = meshDetail->nverts;
+		params.detailTris = meshDetail->tris;
+		params.detailTriCount = meshDetail->ntris;
 		params.walkableHeight = mGuardHeight;
 		params.walkableRadius = mGuardRadius;
 		params.walkableClimb = mGuardMaxClimb;
-		rcVcopy(params.bmin, mPolyMesh->bmin);
-		rcVcopy(params.bmax, mPolyMesh->bmax);
-		params.cs = mConfig.cs;
-		params.ch = mConfig.ch;
+		params.tileX = build.tileX;
+		params.tileY = build.tileY;
+		params.tileLayer = 0;
+		rcVcopy(params.bmin, polyMesh->bmin);
+		rcVcopy(params.bmax, polyMesh->bmax);
+		params.cs = build.config.cs;
+		params.ch = build.config.ch;
 		params.buildBvTree = true;
 
 		if (!dtCreateNavMeshData(&params, &navData, &navDataSize)) {
 			std::cout << "Detour Error: Could not build Detour navmesh\n";
 			return false;
 		}
+		tile.data = navData;
+		tile.size = navDataSize;
+	}
+	return true;
+}
+
+/*
+Adding tiles links them to their neighbours, which isn't safe to do from more
+than one thread, so it happens here once they're all built. The navmesh
+takes ownership of every tile's data, whether it's added or not.
+*/
+bool RecastBuilder::InitNavMesh(const dtNavMeshParams& params, std::vector<TileData>& tiles) {
+	mNavMesh = dtAllocNavMesh();
+	if (!mNavMesh || dtStatusFailed(mNavMesh->init(&params))) {
+		FreeTiles(tiles);
+		std::cout << "Detour Error: Could not create Detour navmesh\n";
+		return false;
+	}
+	if (!AddNavMeshTiles(tiles)) {
+		return false;
+	}
+	return InitNavMeshQuery();
+}
 
-		mNavMesh = dtAllocNavMesh();
-		if (!mNavMesh)
-		{
-			dtFree(navData);
-			std::cout << "Detour Error: Could not create Detour navmesh\n";
+/*
+The tile cache takes its layers the same way, then makes the navmesh tiles
+from them unless they came along too, out of the cache on disk.
+*/
+bool RecastBuilder::InitTileCache(const dtTileCacheParams& cacheParams, const dtNavMeshParams& params,
+	std::vector<TileData>& layers, std::vector<TileData>& tiles) {
+	mTileCache = dtAllocTileCache();
+	if (!mTileCache || dtStatusFailed(mTileCache->init(&cacheParams, mTileCacheAlloc, mTileCacheCompressor, mTileCacheMeshProcess))) {
+		FreeTiles(layers);
+		FreeTiles(tiles);
+		std::cout << "Detour Error: Could not create Detour tile cache\n";
+		return false;
+	}
+	{
+		LoadMarker marker("Add tile cache layers");
+		for (TileData& layer : layers) {
+			if (dtStatusFailed(mTileCache->addTile(layer.data, layer.size, DT_COMPRESSEDTILE_FREE_DATA, nullptr))) {
+				dtFree(layer.data);
+				std::cout << "Detour Error: Could not add a layer to the Detour tile cache\n";
+			}
+			layer.data = nullptr;
+		}
+	}
+	mNavMesh = dtAllocNavMesh();
+	if (!mNavMesh || dtStatusFailed(mNavMesh->init(&params))) {
+		FreeTiles(tiles);
+		std::cout << "Detour Error: Could not create Detour navmesh\n";
+		return false;
+	}
+	if (!tiles.empty()) {
+		if (!AddNavMeshTiles(tiles)) {
 			return false;
 		}
+		return InitNavMeshQuery();
+	}
 
-		dtStatus status;
+	LoadMarker marker("Build navmesh tiles from layers");
+	for (int i = 0; i < mTileCache->getTileCount(); ++i) {
+		const dtCompressedTile* layer = mTileCache->getTile(i);
+		// every layer of a tile is built at once, so only the first asks
+		if (!layer->header || layer->header->tlayer != 0) {
+			continue;
+		}
+		if (dtStatusFailed(mTileCache->buildNavMeshTilesAt(layer->header->tx, layer->header->ty, mNavMesh))) {
+			std::cout << "Detour Error: Could not build a navmesh tile from the tile cache\n";
+		}
+	}
+	const dtNavMesh* navMesh = mNavMesh;
+	mTileCount = 0;
+	for (int i = 0; i < navMesh->getMaxTiles(); ++i) {
+		const dtMeshTile* tile = navMesh->getTile(i);
+		if (tile && tile->header) {
+			mTileCount++;
+		}
+	}
+	if (mTileCount == 0) {
+		std::cout << "Detour Error: Nothing walkable to build a navmesh from\n";
+		return false;
+	}
+	return InitNavMeshQuery();
+}
 
-		status = mNavMesh->init(navData, navDataSize, DT_TILE_FREE_DATA);
-		if (dtStatusFailed(status))
-		{
-			dtFree(navData);
-			std::cout << "Detour Error: Could not init Detour navmesh\n";
-			return false;
+bool RecastBuilder::AddNavMeshTiles(std::vector<TileData>& tiles) {
+	LoadMarker marker("Add navmesh tiles");
+	mTileCount = 0;
+	for (TileData& tile : tiles) {
+		if (!tile.data) {
+			continue;
 		}
-		mNavMeshQuery = dtAllocNavMeshQuery();
-		if (!mNavMeshQuery) {
-			std::cout << "Detour Error: Could not create Detour navmesh query\n";
-			return false;
+		if (dtStatusFailed(mNavMesh->addTile(tile.data, tile.size, DT_TILE_FREE_DATA, 0, nullptr))) {
+			dtFree(tile.data);
+			std::cout << "Detour Error: Could not add a tile to the Detour navmesh\n";
 		}
-		status = mNavMeshQuery->init(mNavMesh, 2048);
-		if (dtStatusFailed(status))
-		{
-			std::cout << "Detour Error: Could not init Detour navmesh query\n";
-			return false;
+		else {
+			mTileCount++;
 		}
+		tile.data = nullptr;
+	}
+	if (mTileCount == 0) {
+		std::cout << "Detour Error: Nothing walkable to build a navmesh from\n";
+		return false;
+	}
+	return true;
+}
+
+bool RecastBuilder::InitNavMeshQuery() {
+	mNavMeshQuery = dtAllocNavMeshQuery();
+	if (!mNavMeshQuery) {
+		std::cout << "Detour Error: Could not create Detour navmesh query\n";
+		return false;
+	}
+	if (dtStatusFailed(mNavMeshQuery->init(mNavMesh, 2048))) {
+		std::cout << "Detour Error: Could not init Detour navmesh query\n";
+		return false;
 	}
 	return true;
 }
 
 void RecastBuilder::cleanup() {
-	delete[] mTriAreas;
-	mTriAreas = NULL;
-	rcFreeHeightField(mSolid);
-	mSolid = NULL;
-	rcFreeCompactHeightfield(mCompHF);
-	mCompHF = NULL;
-	rcFreeContourSet(mContSet);
-	mContSet = NULL;
-	rcFreePolyMesh(mPolyMesh);
-	mPolyMesh = NULL;
-	rcFreePolyMeshDetail(mMeshDetail);
-	mMeshDetail = NULL;
 	dtFreeNavMesh(mNavMesh);
 	mNavMesh = NULL;
 	dtFreeNavMeshQuery(mNavMeshQuery);
 	mNavMeshQuery = NULL;
+	dtFreeTileCache(mTileCache);
+	mTileCache = NULL;
+	mObstaclesPending = false;
+	mTileCount = 0;
 }
@@ -1,11 +1,17 @@
 #pragma once
+#include "Vector3.h"
 #include "../Recast/Include/Recast.h"
 #include "../Detour/Include/DetourNavMesh.h"
 #include "../Detour/Include/DetourNavMeshQuery.h"
+#include "../DetourTileCache/Include/DetourTileCache.h"
+
+#include <algorithm>
+#include <iosfwd>
+#include <string>
+#include <vector>
 
 namespace NCL {
 	namespace CSC8503 {
-		class GameObject;
 		enum SamplePolyAreas
 		{
 			SAMPLE_POLYAREA_GROUND,
@@ -27,32 +33,131 @@ namespace NCL {
 		constexpr int x = 0;
 		constexpr int y = 1;
 		constexpr int z = 2;
+		/*
+		Builds the level's navmesh from its geometry. The level is cut into
+		square tiles, each rasterized on the job threads with its own
+		heightfield and kept as compact layers in a dtTileCache; a tile reaches
+		a few cells into its neighbours so their edges line up. The navmesh
+		tiles are built from those layers, and built again from them whenever
+		an obstacle is added or removed on top, which is far cheaper than going
+		back to the geometry. A tile size of 0 builds the whole level as one
+		tile straight from Recast, the way it was before tiling, and has no
+		obstacles.
+
+		The layers and navmesh tiles are cached on disk under a hash of the
+		input geometry and every build parameter, so loading the same layout
+		again skips Recast entirely and hands the stored tiles straight to
+		Detour.
+		*/
 		class RecastBuilder {
 		public:
+			static constexpr uint32_t CACHE_VERSION = 3;
+			static constexpr int TILE_SIZE_DEFAULT = 96;
+			// tile cache layers store their size in a byte, border included
+			static constexpr int TILE_SIZE_MAX = 224;
+			static constexpr int MAX_OBSTACLES = 128;
+
 			RecastBuilder();
 			~RecastBuilder();
-			float* BuildNavMesh(std::vector<GameObject*> objects);
+			//World space vertex positions, three floats each, and the triangles'
+			//indices into them. Returns the level's size, for the caller to delete
+			float* BuildNavMesh(std::vector<float> verts, std::vector<unsigned int> tris);
 			dtNavMeshQuery* GetNavMeshQuery() const { return mNavMeshQuery; }
+			dtNavMesh* GetNavMesh() const { return mNavMesh; }
+
+			bool WasLoadedFromCache() const { return mLoadedFromCache; }
+			int GetTileCount() const { return mTileCount; }
+
+			//In cells along each side; takes effect on the next build
+			void SetTileSize(int cells) { mTileSize = std::clamp(cells, 0, TILE_SIZE_MAX); }
+			int GetTileSize() const { return mTileSize; }
+
+			//An oriented box turned about y, kept off the navmesh until it's
+			//removed. Returns 0 when there's no tile cache or it's full
+			dtObstacleRef AddObstacle(const Maths::Vector3& centre, const Maths::Vector3& halfExtents, float yRadians);
+			void RemoveObstacle(dtObstacleRef obstacle);
+			//Rebuilds the tiles obstacles have changed, one at a time, until
+			//they're all done or budget milliseconds have gone; at least one is
+			//always built. Returns whether the navmesh changed. No search may
+			//be running on the navmesh while it does
+			bool UpdateObstacles(double budget);
+			bool HasPendingObstacles() const { return mObstaclesPending; }
+
+			//Rebuilds the last level's geometry as one tile and as tiles, without
+			//the cache, and prints how long each took
+			void BenchmarkBuild(std::ostream& out) const;
+
+			static std::string GetCachePath(uint64_t inputHash);
+			//The cache file the last build loaded or wrote
+			const std::string& GetCachePath() const { return mCachePath; }
 		protected:
-			bool InitialiseConfig(const float* bmin, const float* bmax);
-			bool RasterizeInputPolygon(float* verts, const int vertCount, const unsigned int* tris, const int trisCount);
-			bool FilterWalkableSurfaces();
-			bool PartitionWalkableSurface();
-			bool TraceContours();
-			bool BuildPoly();
-			bool BuildDetailPoly();
-			bool CreateDetourData();
-
-			unsigned char* mTriAreas;
-
-			rcHeightfield* mSolid;
-			rcCompactHeightfield* mCompHF;
-			rcContourSet* mContSet;
-			rcPolyMesh* mPolyMesh;
-			rcConfig mConfig;
-			rcPolyMeshDetail* mMeshDetail;
+			struct InputGeometry {
+				std::vector<float>			verts;
+				std::vector<unsigned int>	tris;
+				float						bmin[3];
+				float						bmax[3];
+			};
+
+			// everything Recast makes on the way to one tile, freed as it goes out of scope
+			struct TileBuild {
+				rcConfig				config;
+				int						tileX		= 0;
+				int						tileY		= 0;
+				rcHeightfield*			solid		= nullptr;
+				rcCompactHeightfield*	compHF		= nullptr;
+				rcHeightfieldLayerSet*	layers		= nullptr;
+				rcContourSet*			contSet		= nullptr;
+				rcPolyMesh*				polyMesh	= nullptr;
+				rcPolyMeshDetail*		meshDetail	= nullptr;
+
+				~TileBuild();
+			};
+
+			struct TileData {
+				unsigned char*	data;
+				int				size;
+			};
+
+			uint64_t HashInput(const std::vector<float>& verts, const std::vector<unsigned int>& tris) const;
+			bool LoadCachedNavMesh(const std::string& path, uint64_t inputHash);
+			bool SaveCachedNavMesh(const std::string& path, uint64_t inputHash) const;
+			bool Build(const InputGeometry& input);
+			bool InitNavMesh(const dtNavMeshParams& params, std::vector<TileData>& tiles);
+			bool InitTileCache(const dtTileCacheParams& cacheParams, const dtNavMeshParams& params,
+				std::vector<TileData>& layers, std::vector<TileData>& tiles);
+			bool AddNavMeshTiles(std::vector<TileData>& tiles);
+			bool InitNavMeshQuery();
+
+			void InitialiseConfig(const float* bmin, const float* bmax, rcConfig& config) const;
+			void GetTileGrid(const rcConfig& config, int tileSize, int& tilesX, int& tilesY) const;
+			rcConfig GetTileConfig(const rcConfig& config, int tileSize, int tileX, int tileY) const;
+			dtNavMeshParams GetNavMeshParams(const rcConfig& config, int tileSize) const;
+			dtTileCacheParams GetTileCacheParams(const rcConfig& config) const;
+
+			//Navmesh tiles for a tile size of 0, otherwise tile cache layers
+			bool BuildTiles(const InputGeometry& input, int tileSize, std::vector<TileData>& tiles) const;
+			bool BuildTile(const InputGeometry& input, const std::vector<unsigned int>& tris, TileBuild& build, std::vector<TileData>& tiles) const;
+			static void FreeTiles(std::vector<TileData>& tiles);
+
+			bool RasterizeInputPolygon(TileBuild& build, const float* verts, const int vertCount, const unsigned int* tris, const int trisCount) const;
+			bool FilterWalkableSurfaces(TileBuild& build) const;
+			bool BuildCompactHeightfield(TileBuild& build) const;
+			bool BuildTileLayers(TileBuild& build, std::vector<TileData>& layers) const;
+			bool PartitionWalkableSurface(TileBuild& build) const;
+			bool TraceContours(TileBuild& build) const;
+			bool BuildPoly(TileBuild& build) const;
+			bool BuildDetailPoly(TileBuild& build) const;
+			bool CreateDetourData(TileBuild& build, TileData& tile) const;
+
 			dtNavMesh* mNavMesh;
 			dtNavMeshQuery* mNavMeshQuery;
+			dtTileCache* mTileCache;
+			dtTileCacheAlloc* mTileCacheAlloc;
+			dtTileCacheCompressor* mTileCacheCompressor;
+			dtTileCacheMeshProcess* mTileCacheMeshProcess;
+			bool mObstaclesPending;
+			// kept from the last build for BenchmarkBuild
+			InputGeometry mInput;
 
 			float mCellSize = 0.3f;
 			float mCellHeight = 0.2f;
@@ -72,6 +177,12 @@ namespace NCL {
 			int mSampleDistance = 6;
 			int mMaxSampleError = 1;
 
+			int mTileSize = TILE_SIZE_DEFAULT;
+			int mTileCount;
+
+			bool mLoadedFromCache;
+			std::string mCachePath;
+
 			void cleanup();
 		};
 	}
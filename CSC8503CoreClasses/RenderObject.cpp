@@ -1,17 +1,18 @@
 #include "RenderObject.h"
 #include "Mesh.h"
+#include "GameObject.h"
 
 using namespace NCL::CSC8503;
 using namespace NCL;
 
 
-RenderObject::RenderObject(Transform* parentTransform, Mesh* mesh, Texture* albedoTex, Texture* normalTex, Shader* shader, float cullSphereRadius) {
+RenderObject::RenderObject(GameObject* owner, SharedMesh mesh, SharedTexture albedoTex, SharedTexture normalTex, SharedShader shader, float cullSphereRadius) {
 
-	mTransform	= parentTransform;
-	mMesh		= mesh;
-	mAlbedoTex	= albedoTex;
-	mNormalTex = normalTex;
-	mShader	= shader;
+	mOwner		= owner;
+	mMesh		= std::move(mesh);
+	mAlbedoTex	= std::move(albedoTex);
+	mNormalTex = std::move(normalTex);
+	mShader	= std::move(shader);
 	mColour	= Vector4(1.0f, 1.0f, 1.0f, 1.0f);
 	mCullSphereRadius = cullSphereRadius;
 	mSqDistToCam = FLT_MAX;
@@ -24,13 +25,13 @@ RenderObject::RenderObject(Transform* parentTransform, Mesh* mesh, Texture* albe
 	
 }
 
-RenderObject::RenderObject(Transform* parentTransform, Mesh* mesh, Texture* albedoTex, Texture* normalTex, Shader* shader, Vector4 colour, float cullSphereRadius) {
+RenderObject::RenderObject(GameObject* owner, SharedMesh mesh, SharedTexture albedoTex, SharedTexture normalTex, SharedShader shader, Vector4 colour, float cullSphereRadius) {
 
-	mTransform = parentTransform;
-	mMesh = mesh;
-	mAlbedoTex = albedoTex;
-	mNormalTex = normalTex;
-	mShader = shader;	
+	mOwner = owner;
+	mMesh = std::move(mesh);
+	mAlbedoTex = std::move(albedoTex);
+	mNormalTex = std::move(normalTex);
+	mShader = std::move(shader);
 	mColour = colour;
 	mCullSphereRadius = cullSphereRadius;
 	mSqDistToCam = FLT_MAX;
@@ -41,6 +42,10 @@ RenderObject::RenderObject(Transform* parentTransform, Mesh* mesh, Texture* albe
 	vector<Matrix4> mFrameMatrices = {};
 }
 
-RenderObject::~RenderObject() {
+Transform* RenderObject::GetTransform() const {
+	return &mOwner->GetTransform();
+}
 
+void RenderObject::SetSqDistToCam(const Vector3& camPos) {
+	mSqDistToCam = (camPos - mOwner->GetTransform().GetPosition()).LengthSquared();
 }
\ No newline at end of file
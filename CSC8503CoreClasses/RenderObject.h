@@ -15,41 +15,41 @@ namespace NCL {
 
 	namespace CSC8503 {
 		class Transform;
+		class GameObject;
 		using namespace Maths;
 
 		class RenderObject
 		{
 		public:
-			RenderObject(Transform* parentTransform, Mesh* mesh, Texture* albedo, Texture* normal, Shader* shader, float cullSphereRadius);
-			RenderObject(Transform* parentTransform, Mesh* mesh, Texture* albedo, Texture* normal, Shader* shader, Vector4 colour, float cullSphereRadius);
-			~RenderObject();
+			//Keeps its assets alive for as long as it exists, even once they are released from their caches
+			RenderObject(GameObject* owner, SharedMesh mesh, SharedTexture albedo, SharedTexture normal, SharedShader shader, float cullSphereRadius);
+			RenderObject(GameObject* owner, SharedMesh mesh, SharedTexture albedo, SharedTexture normal, SharedShader shader, Vector4 colour, float cullSphereRadius);
 
-			void SetAlbedoTexture(Texture* t) {
-				mAlbedoTex = t;
+			void SetAlbedoTexture(SharedTexture t) {
+				mAlbedoTex = std::move(t);
 			}
 
 			Texture* GetAlbedoTexture() const {
-				return mAlbedoTex;
+				return mAlbedoTex.get();
 			}
 
-			void SetNormalTexture(Texture* t) {
-				mNormalTex = t;
+			void SetNormalTexture(SharedTexture t) {
+				mNormalTex = std::move(t);
 			}
 
 			Texture* GetNormalTexture() const {
-				return mNormalTex;
+				return mNormalTex.get();
 			}
 
 			Mesh*	GetMesh() const {
-				return mMesh;
+				return mMesh.get();
 			}
 
-			Transform*		GetTransform() const {
-				return mTransform;
-			}
+			//Looked up through the owner, as the world moves transforms around in its pool
+			Transform*		GetTransform() const;
 
 			Shader*		GetShader() const {
-				return mShader;
+				return mShader.get();
 			}
 
 			void SetColour(const Vector4& c) {
@@ -68,9 +68,7 @@ namespace NCL {
 				return mSqDistToCam;
 			}
 
-			void SetSqDistToCam(const Vector3& camPos) {
-				mSqDistToCam = (camPos - mTransform->GetPosition()).LengthSquared();
-			}
+			void SetSqDistToCam(const Vector3& camPos);
 
 			void SetSqDistToCam(float sqDist) {
 				mSqDistToCam = sqDist;
@@ -125,24 +123,29 @@ namespace NCL {
 				mMatTextures = matTextures;
 			}
 
-			vector<GLuint>  GetMatTextures() const{
+			const vector<GLuint>& GetMatTextures() const{
 				return mMatTextures;
 			}
 
-			void SetFrameMatricesVec(std::vector<std::vector<Matrix4>> frameMatrices) {
-				mFrameMatricesVec = frameMatrices;
+			//Copies over the sub mesh's previous matrices, so once an object has been
+			//skinned this reuses their storage rather than allocating
+			void SetFrameMatrices(unsigned int subMesh, const Matrix4* matrices, unsigned int count) {
+				if (subMesh >= mFrameMatricesVec.size()) {
+					mFrameMatricesVec.resize(subMesh + 1);
+				}
+				mFrameMatricesVec[subMesh].assign(matrices, matrices + count);
 			}
 
-			std::vector<std::vector<Matrix4>>  GetFrameMatricesVec() const {
+			const std::vector<std::vector<Matrix4>>& GetFrameMatricesVec() const {
 				return mFrameMatricesVec;
 			}
 
 		protected:
-			Mesh*		mMesh;
-			Texture* mAlbedoTex;
-			Texture* mNormalTex;
-			Shader*		mShader;
-			Transform*	mTransform;
+			SharedMesh		mMesh;
+			SharedTexture	mAlbedoTex;
+			SharedTexture	mNormalTex;
+			SharedShader	mShader;
+			GameObject*	mOwner;
 			MeshAnimation* mAnimation;
 			MeshMaterial* mMaterial;
 			Vector4		mColour;
@@ -1,6 +1,8 @@
 #include "Room.h"
 #include "JsonParser.h"
-#include <fstream>
+#include "LevelCooker.h"
+#include "Assets.h"
+#include "LoadProfiler.h"
 
 using namespace NCL::CSC8503;
 
@@ -17,13 +19,21 @@ Room::Room(int type) {
 
 Room::Room(std::string roomPath) {
 	mRoomName = roomPath.substr(23, roomPath.size() - 28);
-	std::ifstream roomFile(roomPath);
-	std::string line;
-	getline(roomFile, line);
+	mType = INVALID;
+
+	std::string json;
+	if (!Assets::ReadTextFile(roomPath, json)) return;
+
+	uint64_t sourceHash = LevelCooker::HashSource(json);
+	std::string cookedPath = LevelCooker::GetCookedPath(roomPath);
+	if (LevelCooker::Load(cookedPath, sourceHash, *this)) return;
 
 	JsonParser parser = JsonParser();
 
-	parser.ParseJson(line, nullptr, this);
+	if (parser.ParseJson(json, nullptr, this, roomPath)) {
+		LoadMarker marker("Cook room", cookedPath);
+		LevelCooker::Cook(*this, sourceHash, cookedPath);
+	}
 }
 
 Room::~Room() {
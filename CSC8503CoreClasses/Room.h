@@ -16,12 +16,13 @@ namespace NCL {
 			Room(std::string roomPath);
 			~Room();
 			RoomType GetType() const { return mType; }
-			std::map<Vector3, TileType> GetTileMap() const { return mTileMap; }
-			std::vector<Light*> GetLights() const { return mLights; }
+			const std::map<Vector3, TileType>& GetTileMap() const { return mTileMap; }
+			const std::vector<Light*>& GetLights() const { return mLights; }
 			std::vector<Transform> GetCCTVTransforms() const { return mCCTVTransforms; }
-			std::vector<Vector3> GetItemPositions() const { return mItemPositions; }
-			std::vector<Door*> GetDoors() const { return mDoors; }
+			const std::vector<Vector3>& GetItemPositions() const { return mItemPositions; }
+			const std::vector<Door*>& GetDoors() const { return mDoors; }
 			friend class JsonParser;
+			friend class LevelCooker;
 		protected:
 			std::string mRoomName;
 			RoomType mType;
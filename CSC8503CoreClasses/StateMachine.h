@@ -18,6 +18,14 @@ namespace NCL {
 
 			virtual void Update(float dt); //made it virtual!
 
+			State* GetActiveState() const {
+				return activeState;
+			}
+
+			void SetActiveState(State* s) {
+				activeState = s;
+			}
+
 		protected:
 			State * activeState;
 
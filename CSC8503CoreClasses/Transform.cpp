@@ -4,33 +4,80 @@ using namespace NCL::CSC8503;
 
 Transform::Transform()	{
 	scale = Vector3(1, 1, 1);
+	mIsDirty = false;
 }
 
 Transform::~Transform()	{
 
 }
 
+//Equivalent to Translation(position) * Matrix4(orientation) * Scale(scale), but
+//written straight into the columns rather than doing two full matrix multiplies
+Matrix4 Transform::BuildMatrix() const {
+	Matrix4 matrix;
+	const float xx = orientation.x * orientation.x;
+	const float yy = orientation.y * orientation.y;
+	const float zz = orientation.z * orientation.z;
+	const float xy = orientation.x * orientation.y;
+	const float xz = orientation.x * orientation.z;
+	const float yz = orientation.y * orientation.z;
+	const float xw = orientation.x * orientation.w;
+	const float yw = orientation.y * orientation.w;
+	const float zw = orientation.z * orientation.w;
+
+	float* m = &matrix.array[0][0];
+
+	m[0]  = (1 - 2 * yy - 2 * zz) * scale.x;
+	m[1]  = (2 * xy + 2 * zw) * scale.x;
+	m[2]  = (2 * xz - 2 * yw) * scale.x;
+	m[3]  = 0.0f;
+
+	m[4]  = (2 * xy - 2 * zw) * scale.y;
+	m[5]  = (1 - 2 * xx - 2 * zz) * scale.y;
+	m[6]  = (2 * yz + 2 * xw) * scale.y;
+	m[7]  = 0.0f;
+
+	m[8]  = (2 * xz + 2 * yw) * scale.z;
+	m[9]  = (2 * yz - 2 * xw) * scale.z;
+	m[10] = (1 - 2 * xx - 2 * yy) * scale.z;
+	m[11] = 0.0f;
+
+	m[12] = position.x;
+	m[13] = position.y;
+	m[14] = position.z;
+	m[15] = 1.0f;
+
+	return matrix;
+}
+
 void Transform::UpdateMatrix() {
-	mMatrix =
-		Matrix4::Translation(position) *
-		Matrix4(orientation) *
-		Matrix4::Scale(scale);
+	mMatrix = BuildMatrix();
+	mIsDirty = false;
+}
+
+void Transform::UpdateMatrices(Transform* transforms, size_t count) {
+	for (size_t i = 0; i < count; i++) {
+		Transform& t = transforms[i];
+		if (t.mIsDirty) {
+			t.UpdateMatrix();
+		}
+	}
 }
 
 Transform& Transform::SetPosition(const Vector3& worldPos) {
 	position = worldPos;
-	UpdateMatrix();
+	mIsDirty = true;
 	return *this;
 }
 
 Transform& Transform::SetScale(const Vector3& worldScale) {
 	scale = worldScale;
-	UpdateMatrix();
+	mIsDirty = true;
 	return *this;
 }
 
 Transform& Transform::SetOrientation(const Quaternion& worldOrientation) {
 	orientation = worldOrientation;
-	UpdateMatrix();
+	mIsDirty = true;
 	return *this;
-}
\ No newline at end of file
+}
@@ -28,16 +28,30 @@ namespace NCL {
 				return orientation;
 			}
 
+			//Setters only mark the stored matrix as stale, and GameWorld::UpdateTransforms
+			//rebuilds every stale one in a batch. Reading a stale matrix builds a copy
+			//without storing it, so it is always right and still safe from any thread.
 			Matrix4 GetMatrix() const {
-				return mMatrix;
+				return mIsDirty ? BuildMatrix() : mMatrix;
 			}
 
-			void SetMatrix(Matrix4 matrix) {
+			void SetMatrix(const Matrix4& matrix) {
 				mMatrix = matrix;
+				mIsDirty = false;
 			}
+
+			bool IsDirty() const {
+				return mIsDirty;
+			}
+
 			void UpdateMatrix();
+
+			static void UpdateMatrices(Transform* transforms, size_t count);
 		protected:
+			Matrix4 BuildMatrix() const;
+
 			Matrix4		mMatrix;
+			bool		mIsDirty;
 			Quaternion	orientation;
 			Vector3		position;
 
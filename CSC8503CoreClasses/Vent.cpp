@@ -1,6 +1,4 @@
 #include "Vent.h"
-#include "../CSC8503/LevelManager.h"
-#include "PlayerObject.h"
 
 using namespace NCL::CSC8503;
 
@@ -9,20 +7,28 @@ namespace {
 }
 
 Vent::Vent() {
+	mObjectType = Type;
 	mIsOpen = false;
 	mConnectedVent = nullptr;
 }
 
+void Vent::SaveState() {
+	GameObject::SaveState();
+	mSavedIsOpen = mIsOpen;
+}
+
+void Vent::RestoreState() {
+	GameObject::RestoreState();
+	mIsOpen = mSavedIsOpen;
+}
+
 void Vent::ConnectVent(Vent* vent) {
 	if (vent == nullptr) return;
 	mConnectedVent = vent;
 }
 
-void NCL::CSC8503::Vent::HandleItemUse() {
+void NCL::CSC8503::Vent::HandleItemUse(InventoryBuffSystem::PlayerInventory::item usedItem) {
 	if (!mIsOpen) {
-		auto* localPlayer = LevelManager::GetLevelManager()->GetTempPlayer();
-		PlayerInventory::item usedItem = localPlayer->GetEquippedItem();
-
 		switch (usedItem) {
 		case InventoryBuffSystem::PlayerInventory::screwdriver:
 			mIsOpen = true;
@@ -33,11 +39,10 @@ void NCL::CSC8503::Vent::HandleItemUse() {
 	}
 }
 
-void NCL::CSC8503::Vent::HandlePlayerUse() {
+void NCL::CSC8503::Vent::HandlePlayerUse(GameObject* user) {
 	if (mIsOpen) {
-		auto* localPlayer = (GameObject*)(LevelManager::GetLevelManager()->GetTempPlayer());
-		Transform& playerTransform = localPlayer->GetTransform();
-		const Vector3& playerPos = localPlayer->GetTransform().GetPosition();
+		Transform& playerTransform = user->GetTransform();
+		const Vector3& playerPos = user->GetTransform().GetPosition();
 
 		const Vector3& teleportPos = mConnectedVent->GetTransform().GetPosition();
 		const Vector3 newPlayerPos = Vector3(teleportPos.x + VENT_TP_X_OFFSET, playerPos.y, teleportPos.z);
@@ -47,14 +52,14 @@ void NCL::CSC8503::Vent::HandlePlayerUse() {
 	}
 }
 
-void Vent::Interact(NCL::CSC8503::InteractType interactType) {
+void Vent::Interact(NCL::CSC8503::InteractType interactType, GameObject* user, InventoryBuffSystem::PlayerInventory::item usedItem) {
 
 	switch (interactType) {
 	case NCL::CSC8503::Use:
-		HandlePlayerUse();
+		HandlePlayerUse(user);
 		break;
 	case NCL::CSC8503::ItemUse:
-		HandleItemUse();
+		HandleItemUse(usedItem);
 		break;
 	default:
 		break;
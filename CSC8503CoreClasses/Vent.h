@@ -6,15 +6,21 @@ namespace NCL {
     namespace CSC8503 {
         class Vent : public GameObject, public Interactable {
         public:
+            static constexpr GameObjectType Type = GameObjectType::Vent;
+
             Vent();
             void ConnectVent(Vent* vent);
             bool IsOpen() { return mIsOpen; }
             void ToggleOpen() { mIsOpen = !mIsOpen; }
-            void HandleItemUse();
-            void HandlePlayerUse();
-            void Interact(NCL::CSC8503::InteractType interactType) override;
+            void HandleItemUse(InventoryBuffSystem::PlayerInventory::item usedItem);
+            void HandlePlayerUse(GameObject* user);
+            void Interact(NCL::CSC8503::InteractType interactType, GameObject* user, InventoryBuffSystem::PlayerInventory::item usedItem) override;
+
+            virtual void SaveState() override;
+            virtual void RestoreState() override;
         protected:
             bool mIsOpen;
+            bool mSavedIsOpen;
             Vent* mConnectedVent;
         };
     }
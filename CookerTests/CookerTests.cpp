@@ -0,0 +1,318 @@
+/*
+Checks the cooked formats against what they were cooked from, on data made
+up here so no asset has to be present:
+
+    CookerTests [animation|texture|navmesh]
+
+With no argument every test runs. The exit code is the number that failed.
+*/
+#include "Assets.h"
+#include "JobSystem.h"
+#include "MeshAnimation.h"
+#include "TextureCompressor.h"
+#include "RecastBuilder.h"
+
+#include <filesystem>
+
+using namespace NCL;
+using namespace NCL::Maths;
+using namespace NCL::Rendering;
+using namespace NCL::CSC8503;
+
+namespace {
+	int failures = 0;
+
+	void Check(bool condition, const std::string& what) {
+		if (!condition) {
+			std::cout << "  FAILED: " << what << "\n";
+			++failures;
+		}
+	}
+
+	/*
+	Four joints over 120 frames: one that never moves, one turning about y
+	while it bobs, one swinging about a tilted axis at twice its size, and one
+	that jumps halfway through, which no interpolated key can smooth over.
+	*/
+	MeshAnimation MakeClip() {
+		const size_t jointCount = 4;
+		const size_t frameCount = 120;
+		std::vector<Matrix4> frames;
+		frames.reserve(jointCount * frameCount);
+		for (size_t frame = 0; frame < frameCount; ++frame) {
+			float t = (float)frame / (frameCount - 1);
+			frames.emplace_back(Matrix4::Translation(Vector3(0.0f, 1.0f, 0.0f)));
+			frames.emplace_back(Matrix4::Translation(Vector3(0.5f, sinf(t * 6.2831853f) * 0.25f, 0.0f)) *
+				Matrix4(Quaternion::AxisAngleToQuaterion(Vector3(0, 1, 0), t * 360.0f)));
+			frames.emplace_back(Matrix4::Translation(Vector3(0.0f, 0.0f, 2.0f * t)) *
+				Matrix4(Quaternion::AxisAngleToQuaterion(Vector3(1, 1, 0).Normalised(), sinf(t * 12.566371f) * 75.0f)) *
+				Matrix4::Scale(Vector3(2.0f, 2.0f, 2.0f)));
+			frames.emplace_back(Matrix4::Translation(Vector3(frame < frameCount / 2 ? -1.0f : 1.0f, 0.0f, t)));
+		}
+		return MeshAnimation(jointCount, frameCount, 30.0f, frames);
+	}
+
+	void TestAnimation() {
+		std::cout << "Animation compression\n";
+		// there is no text source beside it, so the compressed clip loads back on its own
+		const std::string name = "CookerTestClip.anm";
+		MeshAnimation source = MakeClip();
+		Check(source.WriteBinaryAnimation(name), "writing the compressed clip");
+
+		MeshAnimation cooked;
+		bool loaded = cooked.LoadBinaryAnimation(name);
+		Check(loaded, "loading the compressed clip back");
+		std::error_code error;
+		std::filesystem::remove(MeshAnimation::GetBinaryAnimationPath(name), error);
+		if (!loaded) {
+			return;
+		}
+		Check(cooked.GetJointCount() == source.GetJointCount() && cooked.GetFrameCount() == source.GetFrameCount() &&
+			cooked.GetFrameRate() == source.GetFrameRate(), "the clip keeps its shape and frame rate");
+
+		float maxError = 0.0f;
+		for (size_t frame = 0; frame < source.GetFrameCount(); ++frame) {
+			const Matrix4* a = source.GetJointData(frame);
+			const Matrix4* b = cooked.GetJointData(frame);
+			for (size_t joint = 0; joint < source.GetJointCount(); ++joint) {
+				for (int i = 0; i < 16; ++i) {
+					maxError = std::max(maxError, fabsf(a[joint].array[i / 4][i % 4] - b[joint].array[i / 4][i % 4]));
+				}
+			}
+		}
+		std::cout << "  max joint error " << maxError << "\n";
+		Check(maxError <= MeshAnimation::MAX_JOINT_ERROR, "every joint within MAX_JOINT_ERROR");
+	}
+
+	using Image = std::vector<uint8_t>;
+
+	Image MakeSolid(int width, int height, const uint8_t colour[4]) {
+		Image image((size_t)width * height * 4);
+		for (size_t i = 0; i < image.size(); ++i) {
+			image[i] = colour[i % 4];
+		}
+		return image;
+	}
+
+	//Blends from one colour to another along the diagonal, so even a block
+	//covering the whole image lies on one line through colour space, the way
+	//the formats' palettes do
+	Image MakeGradient(int width, int height) {
+		const int from[4] = { 60, 90, 150, 230 };
+		const int to[4] = { 150, 170, 70, 140 };
+		Image image((size_t)width * height * 4);
+		for (int y = 0; y < height; ++y) {
+			for (int x = 0; x < width; ++x) {
+				float t = (float)(x + y) / std::max(1, width + height - 2);
+				for (int c = 0; c < 4; ++c) {
+					image[((size_t)y * width + x) * 4 + c] = (uint8_t)(from[c] + (to[c] - from[c]) * t + 0.5f);
+				}
+			}
+		}
+		return image;
+	}
+
+	//Largest difference in any channel the format keeps
+	int RoundTripError(TextureFormat format, const Image& image, int width, int height) {
+		// anything written past the level's size lands on the guard bytes
+		const size_t guardBytes = 16;
+		size_t levelBytes = TextureCompressor::GetLevelBytes(format, width, height);
+		std::vector<uint8_t> compressed(levelBytes + guardBytes, 0xCD);
+		TextureCompressor::Compress(format, image.data(), width, height, compressed.data());
+		for (size_t i = levelBytes; i < compressed.size(); ++i) {
+			if (compressed[i] != 0xCD) {
+				return 255;
+			}
+		}
+		Image decoded((size_t)width * height * 4);
+		TextureCompressor::Decompress(format, compressed.data(), width, height, decoded.data());
+
+		int channels = format == TextureFormat::BC1 ? 3 : format == TextureFormat::BC5 ? 2 : 4;
+		int error = 0;
+		for (size_t texel = 0; texel < (size_t)width * height; ++texel) {
+			for (int c = 0; c < channels; ++c) {
+				error = std::max(error, abs((int)image[texel * 4 + c] - (int)decoded[texel * 4 + c]));
+			}
+		}
+		return error;
+	}
+
+	void TestTexture() {
+		std::cout << "Texture compression\n";
+		const TextureFormat formats[] = { TextureFormat::BC1, TextureFormat::BC3, TextureFormat::BC5 };
+		const char* formatNames[] = { "BC1", "BC3", "BC5" };
+		// a 565 endpoint is off by up to 4 in red and blue, the alpha and
+		// BC5 channels by up to half an eighth of their range
+		const int solidTolerance = 4;
+		// a block spanning the whole gradient puts a texel at most half of one
+		// of the palette's three steps from the nearest entry, plus the rounding
+		const int gradientTolerance = 20;
+
+		const uint8_t colour[4] = { 200, 100, 50, 128 };
+		for (int f = 0; f < 3; ++f) {
+			int solid = RoundTripError(formats[f], MakeSolid(16, 16, colour), 16, 16);
+			int gradient = RoundTripError(formats[f], MakeGradient(16, 16), 16, 16);
+			std::cout << "  " << formatNames[f] << ": solid " << solid << ", gradient " << gradient << "\n";
+			Check(solid <= solidTolerance, std::string(formatNames[f]) + " solid colour");
+			Check(gradient <= gradientTolerance, std::string(formatNames[f]) + " gradient");
+		}
+
+		// every level of a 13x7 chain has blocks hanging off its edges, and
+		// the last levels are smaller than a block
+		for (int f = 0; f < 3; ++f) {
+			int width = 13;
+			int height = 7;
+			Image level = MakeGradient(width, height);
+			int worst = 0;
+			while (true) {
+				Check(TextureCompressor::GetLevelBytes(formats[f], width, height) ==
+					(size_t)((width + 3) / 4) * ((height + 3) / 4) * TextureCompressor::GetBlockBytes(formats[f]),
+					std::string(formatNames[f]) + " level size for " + std::to_string(width) + "x" + std::to_string(height));
+				worst = std::max(worst, RoundTripError(formats[f], level, width, height));
+				if (width == 1 && height == 1) {
+					break;
+				}
+				int nextWidth = std::max(1, width / 2);
+				int nextHeight = std::max(1, height / 2);
+				Image next((size_t)nextWidth * nextHeight * 4);
+				TextureCompressor::Downsample(level.data(), width, height, next.data(), false);
+				level = std::move(next);
+				width = nextWidth;
+				height = nextHeight;
+			}
+			std::cout << "  " << formatNames[f] << " 13x7 mip chain: " << worst << "\n";
+			Check(worst <= gradientTolerance, std::string(formatNames[f]) + " mip chain");
+		}
+	}
+
+	//Facing up, wound the way Recast counts as walkable
+	void AddQuad(std::vector<float>& verts, std::vector<unsigned int>& tris, const Vector3& a, const Vector3& b, const Vector3& c, const Vector3& d) {
+		unsigned int first = (unsigned int)(verts.size() / 3);
+		for (const Vector3& v : { a, b, c, d }) {
+			verts.insert(verts.end(), { v.x, v.y, v.z });
+		}
+		tris.insert(tris.end(), { first, first + 1, first + 2, first, first + 2, first + 3 });
+	}
+
+	void AddBox(std::vector<float>& verts, std::vector<unsigned int>& tris, const Vector3& min, const Vector3& max) {
+		AddQuad(verts, tris, Vector3(min.x, max.y, min.z), Vector3(min.x, max.y, max.z), Vector3(max.x, max.y, max.z), Vector3(max.x, max.y, min.z));
+		AddQuad(verts, tris, Vector3(min.x, min.y, min.z), Vector3(min.x, max.y, min.z), Vector3(max.x, max.y, min.z), Vector3(max.x, min.y, min.z));
+		AddQuad(verts, tris, Vector3(min.x, min.y, max.z), Vector3(max.x, min.y, max.z), Vector3(max.x, max.y, max.z), Vector3(min.x, max.y, max.z));
+		AddQuad(verts, tris, Vector3(min.x, min.y, min.z), Vector3(min.x, min.y, max.z), Vector3(min.x, max.y, max.z), Vector3(min.x, max.y, min.z));
+		AddQuad(verts, tris, Vector3(max.x, min.y, min.z), Vector3(max.x, max.y, min.z), Vector3(max.x, max.y, max.z), Vector3(max.x, min.y, max.z));
+	}
+
+	//A 60 unit floor, so it takes several tiles, crossed by walls with gaps in them
+	void MakeLevel(std::vector<float>& verts, std::vector<unsigned int>& tris) {
+		AddQuad(verts, tris, Vector3(0, 0, 0), Vector3(0, 0, 60), Vector3(60, 0, 60), Vector3(60, 0, 0));
+		AddBox(verts, tris, Vector3(15, 0, 0), Vector3(17, 4, 45));
+		AddBox(verts, tris, Vector3(30, 0, 15), Vector3(32, 4, 60));
+		AddBox(verts, tris, Vector3(45, 0, 0), Vector3(47, 4, 45));
+		AddBox(verts, tris, Vector3(20, 0, 50), Vector3(26, 4, 56));
+	}
+
+	struct QueryResult {
+		std::vector<dtPolyRef>	polys;
+		std::vector<float>		points;
+	};
+
+	std::vector<QueryResult> RunQueries(const RecastBuilder& builder) {
+		const Vector3 ends[][2] = {
+			{ Vector3(5, 0, 5),   Vector3(55, 0, 5) },
+			{ Vector3(5, 0, 55),  Vector3(55, 0, 55) },
+			{ Vector3(24, 0, 10), Vector3(38, 0, 40) },
+			{ Vector3(10, 0, 30), Vector3(23, 0, 58) },
+			{ Vector3(52, 0, 50), Vector3(3, 0, 20) },
+		};
+		const float extents[3] = { 2.0f, 4.0f, 2.0f };
+		const int maxPolys = 256;
+		dtQueryFilter filter;
+		dtNavMeshQuery* query = builder.GetNavMeshQuery();
+
+		std::vector<QueryResult> results;
+		for (const auto& pair : ends) {
+			QueryResult result;
+			dtPolyRef startPoly = 0;
+			dtPolyRef endPoly = 0;
+			float start[3];
+			float end[3];
+			query->findNearestPoly(&pair[0].x, extents, &filter, &startPoly, start);
+			query->findNearestPoly(&pair[1].x, extents, &filter, &endPoly, end);
+			result.polys.resize(maxPolys);
+			int polyCount = 0;
+			query->findPath(startPoly, endPoly, start, end, &filter, result.polys.data(), &polyCount, maxPolys);
+			result.polys.resize(polyCount);
+
+			result.points.resize(maxPolys * 3);
+			int pointCount = 0;
+			if (polyCount > 0) {
+				query->findStraightPath(start, end, result.polys.data(), polyCount, result.points.data(), nullptr, nullptr, &pointCount, maxPolys);
+			}
+			result.points.resize(pointCount * 3);
+			results.emplace_back(std::move(result));
+		}
+		return results;
+	}
+
+	void TestNavMesh() {
+		std::cout << "Navmesh cache\n";
+		std::vector<float> verts;
+		std::vector<unsigned int> tris;
+		MakeLevel(verts, tris);
+
+		RecastBuilder fresh;
+		delete[] fresh.BuildNavMesh(verts, tris);
+		if (fresh.WasLoadedFromCache()) {
+			// left by a run that didn't finish
+			std::error_code error;
+			std::filesystem::remove(fresh.GetCachePath(), error);
+			delete[] fresh.BuildNavMesh(verts, tris);
+		}
+		Check(fresh.GetNavMesh() && !fresh.WasLoadedFromCache(), "building the navmesh from the geometry");
+		Check(fresh.GetTileCount() > 1, "the level takes more than one tile");
+
+		RecastBuilder cached;
+		delete[] cached.BuildNavMesh(verts, tris);
+		Check(cached.GetNavMesh() && cached.WasLoadedFromCache(), "loading the same navmesh from the cache");
+
+		std::error_code error;
+		std::filesystem::remove(fresh.GetCachePath(), error);
+		if (!fresh.GetNavMesh() || !cached.GetNavMesh()) {
+			return;
+		}
+
+		std::vector<QueryResult> freshResults = RunQueries(fresh);
+		std::vector<QueryResult> cachedResults = RunQueries(cached);
+		size_t detours = 0;
+		for (size_t i = 0; i < freshResults.size(); ++i) {
+			std::string query = "query " + std::to_string(i);
+			Check(!freshResults[i].polys.empty(), query + " finds a path");
+			Check(freshResults[i].polys == cachedResults[i].polys, query + " crosses the same polygons");
+			Check(freshResults[i].points == cachedResults[i].points, query + " takes the same corners");
+			if (freshResults[i].points.size() > 2 * 3) {
+				++detours;
+			}
+		}
+		std::cout << "  " << fresh.GetTileCount() << " tiles, " << detours << " of " << freshResults.size() << " paths go round a wall\n";
+		Check(detours > 0, "the walls are in the way of some paths");
+	}
+}
+
+int main(int argc, char** argv) {
+	JobSystem::Initialise(std::max(1u, std::thread::hardware_concurrency()) - 1);
+
+	std::string only = argc > 1 ? argv[1] : "";
+	if (only.empty() || only == "animation") {
+		TestAnimation();
+	}
+	if (only.empty() || only == "texture") {
+		TestTexture();
+	}
+	if (only.empty() || only == "navmesh") {
+		TestNavMesh();
+	}
+
+	JobSystem::Destroy();
+	std::cout << (failures ? std::to_string(failures) + " checks failed" : "All checks passed") << "\n";
+	return failures;
+}
@@ -0,0 +1,141 @@
+#pragma once
+#include <mutex>
+#include <unordered_map>
+#include "Assets.h"
+
+namespace NCL {
+	/*
+	Keeps one copy of each loaded asset, keyed by its normalised path, and hands
+	out shared handles to it. Every Acquire or Add counts as a reference; Release
+	gives one back and the asset is unloaded when the last one goes, while Unload
+	drops it straight away. Handles already given out keep the asset alive until
+	they are destroyed, so unloading never pulls memory out from under a caller.
+
+	All access is locked, so loading jobs can add assets as they finish.
+	*/
+	template<class T>
+	class AssetCache {
+	public:
+		using Handle = std::shared_ptr<T>;
+
+		AssetCache() {
+			mHits = 0;
+			mMisses = 0;
+		}
+
+		AssetCache(const AssetCache&) = delete;
+		AssetCache& operator=(const AssetCache&) = delete;
+
+		//Returns nullptr, and counts a miss, if the asset hasn't been added
+		Handle Acquire(std::string_view path) {
+			std::lock_guard<std::mutex> lock(mLock);
+			auto i = mEntries.find(Assets::NormalisePath(path));
+			if (i == mEntries.end()) {
+				mMisses++;
+				return nullptr;
+			}
+			mHits++;
+			i->second.refCount++;
+			return i->second.asset;
+		}
+
+		//If another caller added the same path first, theirs is kept and returned
+		Handle Add(std::string_view path, Handle asset, size_t residentBytes = 0) {
+			std::lock_guard<std::mutex> lock(mLock);
+			auto [i, added] = mEntries.try_emplace(Assets::NormalisePath(path));
+			if (added) {
+				i->second.asset = std::move(asset);
+				i->second.residentBytes = residentBytes;
+			}
+			i->second.refCount++;
+			return i->second.asset;
+		}
+
+		//For assets added before their data had finished loading
+		void SetResidentBytes(std::string_view path, size_t residentBytes) {
+			std::lock_guard<std::mutex> lock(mLock);
+			auto i = mEntries.find(Assets::NormalisePath(path));
+			if (i != mEntries.end()) {
+				i->second.residentBytes = residentBytes;
+			}
+		}
+
+		bool Release(std::string_view path) {
+			std::lock_guard<std::mutex> lock(mLock);
+			auto i = mEntries.find(Assets::NormalisePath(path));
+			if (i == mEntries.end()) {
+				return false;
+			}
+			if (--i->second.refCount == 0) {
+				mEntries.erase(i);
+			}
+			return true;
+		}
+
+		//For callers that kept the handle rather than the path it was loaded from
+		bool Release(const Handle& asset) {
+			std::lock_guard<std::mutex> lock(mLock);
+			for (auto i = mEntries.begin(); i != mEntries.end(); ++i) {
+				if (i->second.asset == asset) {
+					if (--i->second.refCount == 0) {
+						mEntries.erase(i);
+					}
+					return true;
+				}
+			}
+			return false;
+		}
+
+		bool Unload(std::string_view path) {
+			std::lock_guard<std::mutex> lock(mLock);
+			return mEntries.erase(Assets::NormalisePath(path)) > 0;
+		}
+
+		void Clear() {
+			std::lock_guard<std::mutex> lock(mLock);
+			mEntries.clear();
+		}
+
+		int GetRefCount(std::string_view path) const {
+			std::lock_guard<std::mutex> lock(mLock);
+			auto i = mEntries.find(Assets::NormalisePath(path));
+			return i == mEntries.end() ? 0 : i->second.refCount;
+		}
+
+		size_t GetAssetCount() const {
+			std::lock_guard<std::mutex> lock(mLock);
+			return mEntries.size();
+		}
+
+		size_t GetResidentBytes() const {
+			std::lock_guard<std::mutex> lock(mLock);
+			size_t total = 0;
+			for (const auto& [path, entry] : mEntries) {
+				total += entry.residentBytes;
+			}
+			return total;
+		}
+
+		size_t GetHitCount() const {
+			std::lock_guard<std::mutex> lock(mLock);
+			return mHits;
+		}
+
+		size_t GetMissCount() const {
+			std::lock_guard<std::mutex> lock(mLock);
+			return mMisses;
+		}
+
+	protected:
+		struct Entry {
+			Handle asset;
+			size_t residentBytes = 0;
+			int refCount = 0;
+		};
+
+		std::unordered_map<std::string, Entry> mEntries;
+		mutable std::mutex mLock;
+		size_t mHits;
+		size_t mMisses;
+	};
+}
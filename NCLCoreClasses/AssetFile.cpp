@@ -0,0 +1,52 @@
+#include "AssetFile.h"
+#include "LoadProfiler.h"
+
+using namespace NCL;
+
+AssetFile::AssetFile() {
+	mData	= nullptr;
+	mSize	= 0;
+	mPacked = false;
+}
+
+AssetFile::~AssetFile() {
+}
+
+bool AssetFile::Open(const std::string& filepath) {
+	Close();
+	AssetPack::Entry entry;
+	std::string name = AssetPack::GetEntryName(filepath);
+	if (!name.empty() && AssetPack::FindMounted(name, entry)) {
+		if (entry.compressed) {
+			mInflated.resize(entry.size);
+			if (!AssetPack::Inflate(entry, mInflated.data())) {
+				Close();
+				return false;
+			}
+			mData = mInflated.data();
+		}
+		else {
+			mData = entry.data;
+		}
+		mSize	= entry.size;
+		mPacked = true;
+		LoadProfiler::AddBytesRead(entry.storedSize);
+		return true;
+	}
+	if (!mFile.Open(filepath)) {
+		return false;
+	}
+	mData = mFile.GetData();
+	mSize = mFile.GetSize();
+	LoadProfiler::AddBytesRead(mSize);
+	return true;
+}
+
+void AssetFile::Close() {
+	mFile.Close();
+	mInflated.clear();
+	mInflated.shrink_to_fit();
+	mData	= nullptr;
+	mSize	= 0;
+	mPacked = false;
+}
@@ -0,0 +1,50 @@
+#pragma once
+#include "AssetPack.h"
+
+namespace NCL {
+	/*
+	Read only view of a whole asset, wherever it lives. Open looks the path up
+	in the mounted packs first and falls back to mapping the loose file, so
+	loaders see the same bytes either way. A stored pack entry is a view into
+	the pack's mapping; a compressed one is inflated into a buffer owned by
+	the AssetFile.
+	*/
+	class AssetFile {
+	public:
+		AssetFile();
+		~AssetFile();
+
+		AssetFile(const AssetFile&) = delete;
+		AssetFile& operator=(const AssetFile&) = delete;
+
+		bool Open(const std::string& filepath);
+		void Close();
+
+		bool IsOpen() const {
+			return mData != nullptr;
+		}
+
+		bool IsPacked() const {
+			return mPacked;
+		}
+
+		const char* GetData() const {
+			return mData;
+		}
+
+		size_t GetSize() const {
+			return mSize;
+		}
+
+		std::string_view GetText() const {
+			return std::string_view(mData, mSize);
+		}
+
+	protected:
+		const char*			mData;
+		size_t				mSize;
+		bool				mPacked;
+		MappedFile			mFile;
+		std::vector<char>	mInflated;
+	};
+}
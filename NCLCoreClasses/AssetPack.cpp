@@ -0,0 +1,287 @@
+#include "AssetPack.h"
+#include "Assets.h"
+
+#include "./stb/stb_image.h"
+
+#include <filesystem>
+#include <thread>
+
+//stb_image_write builds this for its PNG writer but doesn't declare it
+extern "C" unsigned char* stbi_zlib_compress(unsigned char* data, int data_len, int* out_len, int quality);
+
+using namespace NCL;
+
+std::vector<std::unique_ptr<AssetPack>> AssetPack::mountedPacks;
+
+namespace {
+	constexpr uint32_t ASSET_PACK_MAGIC = 0x4B41504E; // "NPAK"
+	constexpr size_t ASSET_PACK_ALIGNMENT = 16;
+	constexpr uint32_t ENTRY_COMPRESSED = 1;
+
+	/*
+	A pack is this header, then each entry's data at a 16 byte aligned offset,
+	then the entry table, the hash slots and the packed names. Slots hold an
+	entry index plus one, or zero when empty, and there are always at least
+	twice as many slots as entries, a power of two, probed linearly.
+	*/
+	struct PackHeader {
+		uint32_t magic;
+		uint32_t version;
+		uint64_t entryCount;
+		uint64_t slotCount;
+		uint64_t entriesOffset;
+		uint64_t slotsOffset;
+		uint64_t namesOffset;
+		uint64_t namesSize;
+	};
+
+	struct PackEntry {
+		uint64_t nameHash;
+		uint64_t offset;
+		uint64_t size;
+		uint64_t storedSize;
+		uint32_t nameOffset;
+		uint32_t nameLength;
+		uint32_t flags;
+		uint32_t padding;
+	};
+
+	size_t AlignUp(size_t value) {
+		return (value + ASSET_PACK_ALIGNMENT - 1) & ~(ASSET_PACK_ALIGNMENT - 1);
+	}
+
+	bool TableFits(uint64_t offset, uint64_t count, size_t elementSize, size_t fileSize) {
+		return offset <= fileSize && count <= (fileSize - offset) / elementSize;
+	}
+}
+
+AssetPack::AssetPack() {
+	mEntryCount = 0;
+	mSlotCount	= 0;
+	mEntries	= nullptr;
+	mSlots		= nullptr;
+	mNames		= nullptr;
+	mNamesSize	= 0;
+}
+
+AssetPack::~AssetPack() {
+}
+
+bool AssetPack::Open(const std::string& path) {
+	if (!mFile.Open(path) || mFile.GetSize() < sizeof(PackHeader)) {
+		mFile.Close();
+		return false;
+	}
+	PackHeader header;
+	memcpy(&header, mFile.GetData(), sizeof(header));
+	size_t fileSize = mFile.GetSize();
+	if (header.magic != ASSET_PACK_MAGIC || header.version != VERSION ||
+		header.slotCount < header.entryCount * 2 || (header.slotCount & (header.slotCount - 1)) != 0 ||
+		!TableFits(header.entriesOffset, header.entryCount, sizeof(PackEntry), fileSize) ||
+		!TableFits(header.slotsOffset, header.slotCount, sizeof(uint32_t), fileSize) ||
+		!TableFits(header.namesOffset, header.namesSize, 1, fileSize)) {
+		mFile.Close();
+		return false;
+	}
+
+	// every entry is checked up front, so Find never has to
+	for (uint64_t i = 0; i < header.entryCount; ++i) {
+		PackEntry entry;
+		memcpy(&entry, mFile.GetData() + header.entriesOffset + i * sizeof(PackEntry), sizeof(entry));
+		bool compressed = (entry.flags & ENTRY_COMPRESSED) != 0;
+		if (!TableFits(entry.offset, entry.storedSize, 1, fileSize) ||
+			(!compressed && entry.storedSize != entry.size) || (compressed && entry.size > (uint64_t)std::numeric_limits<int>::max()) ||
+			entry.nameOffset > header.namesSize || entry.nameLength > header.namesSize - entry.nameOffset) {
+			mFile.Close();
+			return false;
+		}
+	}
+	for (uint64_t i = 0; i < header.slotCount; ++i) {
+		uint32_t slot;
+		memcpy(&slot, mFile.GetData() + header.slotsOffset + i * sizeof(uint32_t), sizeof(slot));
+		if (slot > header.entryCount) {
+			mFile.Close();
+			return false;
+		}
+	}
+
+	mEntryCount = (size_t)header.entryCount;
+	mSlotCount	= (size_t)header.slotCount;
+	mEntries	= mFile.GetData() + header.entriesOffset;
+	mSlots		= mFile.GetData() + header.slotsOffset;
+	mNames		= mFile.GetData() + header.namesOffset;
+	mNamesSize	= (size_t)header.namesSize;
+	return true;
+}
+
+bool AssetPack::Find(std::string_view name, Entry& entry) const {
+	if (mSlotCount == 0) {
+		return false;
+	}
+	uint64_t hash = HashName(name);
+	for (size_t i = (size_t)hash & (mSlotCount - 1); ; i = (i + 1) & (mSlotCount - 1)) {
+		uint32_t slot;
+		memcpy(&slot, mSlots + i * sizeof(uint32_t), sizeof(slot));
+		if (slot == 0) {
+			return false;
+		}
+		PackEntry packed;
+		memcpy(&packed, mEntries + (slot - 1) * sizeof(PackEntry), sizeof(packed));
+		if (packed.nameHash == hash && std::string_view(mNames + packed.nameOffset, packed.nameLength) == name) {
+			entry.data			= mFile.GetData() + packed.offset;
+			entry.size			= (size_t)packed.size;
+			entry.storedSize	= (size_t)packed.storedSize;
+			entry.compressed	= (packed.flags & ENTRY_COMPRESSED) != 0;
+			return true;
+		}
+	}
+}
+
+bool AssetPack::Inflate(const Entry& entry, char* out) {
+	if (!entry.compressed) {
+		memcpy(out, entry.data, entry.size);
+		return true;
+	}
+	return stbi_zlib_decode_buffer(out, (int)entry.size, entry.data, (int)entry.storedSize) == (int)entry.size;
+}
+
+bool AssetPack::Write(const std::string& path, const std::vector<SourceFile>& files) {
+	std::vector<PackEntry> entries;
+	std::string names;
+	size_t slotCount = 1;
+	while (slotCount < files.size() * 2) {
+		slotCount *= 2;
+	}
+	std::vector<uint32_t> slots(slotCount, 0);
+
+	// written under a temporary name and moved into place, so a game
+	// starting up meanwhile never maps a half written pack
+	std::string tempPath = path + "." + std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id())) + ".tmp";
+	std::ofstream out(tempPath, std::ios::binary | std::ios::trunc);
+	PackHeader header = {};
+	out.write((const char*)&header, sizeof(header));
+
+	auto pad = [&out]() {
+		static const char zeroes[ASSET_PACK_ALIGNMENT] = {};
+		size_t position = (size_t)out.tellp();
+		out.write(zeroes, AlignUp(position) - position);
+		return AlignUp(position);
+	};
+
+	for (const SourceFile& file : files) {
+		MappedFile source;
+		if (!source.Open(file.path)) {
+			std::cout << __FUNCTION__ << " can't read " << file.path << "\n";
+			out.close();
+			std::error_code error;
+			std::filesystem::remove(tempPath, error);
+			return false;
+		}
+		std::string name = Assets::NormalisePath(file.name);
+
+		PackEntry entry = {};
+		entry.nameHash		= HashName(name);
+		entry.offset		= pad();
+		entry.size			= source.GetSize();
+		entry.storedSize	= source.GetSize();
+		entry.nameOffset	= (uint32_t)names.size();
+		entry.nameLength	= (uint32_t)name.size();
+		names += name;
+
+		int compressedSize = 0;
+		unsigned char* compressed = nullptr;
+		if (file.compress && source.GetSize() <= (size_t)std::numeric_limits<int>::max()) {
+			compressed = stbi_zlib_compress((unsigned char*)source.GetData(), (int)source.GetSize(), &compressedSize, 8);
+		}
+		if (compressed && (size_t)compressedSize <= source.GetSize() / 4 * 3) {
+			entry.storedSize = (uint64_t)compressedSize;
+			entry.flags |= ENTRY_COMPRESSED;
+			out.write((const char*)compressed, compressedSize);
+		}
+		else {
+			out.write(source.GetData(), source.GetSize());
+		}
+		free(compressed);
+
+		size_t slot = (size_t)entry.nameHash & (slotCount - 1);
+		while (slots[slot] != 0) {
+			slot = (slot + 1) & (slotCount - 1);
+		}
+		entries.push_back(entry);
+		slots[slot] = (uint32_t)entries.size();
+	}
+
+	header.magic			= ASSET_PACK_MAGIC;
+	header.version			= VERSION;
+	header.entryCount		= entries.size();
+	header.slotCount		= slotCount;
+	header.entriesOffset	= pad();
+	out.write((const char*)entries.data(), entries.size() * sizeof(PackEntry));
+	header.slotsOffset		= pad();
+	out.write((const char*)slots.data(), slots.size() * sizeof(uint32_t));
+	header.namesOffset		= pad();
+	header.namesSize		= names.size();
+	out.write(names.data(), names.size());
+	out.seekp(0);
+	out.write((const char*)&header, sizeof(header));
+	out.close();
+
+	std::error_code error;
+	if (!out) {
+		std::filesystem::remove(tempPath, error);
+		return false;
+	}
+	std::filesystem::rename(tempPath, path, error);
+	if (error) {
+		std::filesystem::remove(tempPath, error);
+		return false;
+	}
+	return true;
+}
+
+bool AssetPack::Mount(const std::string& path) {
+	std::unique_ptr<AssetPack> pack = std::make_unique<AssetPack>();
+	if (!pack->Open(path)) {
+		return false;
+	}
+	mountedPacks.push_back(std::move(pack));
+	return true;
+}
+
+void AssetPack::UnmountAll() {
+	mountedPacks.clear();
+}
+
+bool AssetPack::FindMounted(std::string_view name, Entry& entry) {
+	// the newest pack wins, so a patch pack can override the base one
+	for (auto i = mountedPacks.rbegin(); i != mountedPacks.rend(); ++i) {
+		if ((*i)->Find(name, entry)) {
+			return true;
+		}
+	}
+	return false;
+}
+
+std::string AssetPack::GetEntryName(const std::string& path) {
+	static const std::filesystem::path root = std::filesystem::absolute(Assets::ASSETROOT).lexically_normal();
+	std::error_code error;
+	std::filesystem::path absolute = std::filesystem::absolute(path, error).lexically_normal();
+	if (error) {
+		return {};
+	}
+	std::filesystem::path relative = absolute.lexically_relative(root);
+	if (relative.empty() || *relative.begin() == "..") {
+		return {};
+	}
+	return Assets::NormalisePath(relative.generic_string());
+}
+
+uint64_t AssetPack::HashName(std::string_view name) {
+	// FNV-1a
+	uint64_t hash = 14695981039346656037ull;
+	for (char c : name) {
+		hash ^= (uint8_t)c;
+		hash *= 1099511628211ull;
+	}
+	return hash;
+}
@@ -0,0 +1,73 @@
+#pragma once
+#include "MappedFile.h"
+
+#include <string_view>
+
+namespace NCL {
+	/*
+	A single file holding many assets, mapped into memory once. Each asset is
+	found by its path relative to the asset root through a hash table in the
+	pack, so opening one is a lookup rather than a trip to the file system.
+	Entries are either stored as they are, and handed out as a view straight
+	into the mapping, or zlib compressed and inflated on open.
+
+	Packs are mounted at startup, before anything loads, and stay mounted
+	until UnmountAll; AssetFile looks in them before the loose files.
+	*/
+	class AssetPack {
+	public:
+		static constexpr uint32_t VERSION = 1;
+
+		struct Entry {
+			const char*	data;
+			size_t		size;		//size once inflated
+			size_t		storedSize;
+			bool		compressed;
+		};
+
+		struct SourceFile {
+			std::string name;	//relative to the asset root
+			std::string path;
+			bool		compress;
+		};
+
+		AssetPack();
+		~AssetPack();
+
+		bool Open(const std::string& path);
+
+		bool Find(std::string_view name, Entry& entry) const;
+
+		size_t GetEntryCount() const {
+			return mEntryCount;
+		}
+
+		//Inflates a compressed entry into out, which has to hold entry.size bytes
+		static bool Inflate(const Entry& entry, char* out);
+
+		//Packs the given files; a file asked to be compressed is only stored
+		//that way if it shrinks by at least a quarter
+		static bool Write(const std::string& path, const std::vector<SourceFile>& files);
+
+		static bool Mount(const std::string& path);
+		static void UnmountAll();
+		static bool FindMounted(std::string_view name, Entry& entry);
+
+		//The name an asset is packed under: its path relative to the asset
+		//root, normalised. Empty if the path is outside the asset root
+		static std::string GetEntryName(const std::string& path);
+
+	protected:
+		static uint64_t HashName(std::string_view name);
+
+		MappedFile	mFile;
+		size_t		mEntryCount;
+		size_t		mSlotCount;
+		const char* mEntries;
+		const char* mSlots;
+		const char* mNames;
+		size_t		mNamesSize;
+
+		static std::vector<std::unique_ptr<AssetPack>> mountedPacks;
+	};
+}
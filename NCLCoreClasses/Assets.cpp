@@ -1,16 +1,12 @@
 #include "Assets.h"
+#include "AssetFile.h"
 
 using namespace NCL;
 
 bool Assets::ReadTextFile(const std::string &filepath, std::string& result) {
-	std::ifstream file(filepath, std::ios::in);
-	if (file) {
-		std::ostringstream stream;
-
-		stream << file.rdbuf();
-
-		result = stream.str();
-
+	AssetFile file;
+	if (file.Open(filepath)) {
+		result.assign(file.GetData(), file.GetSize());
 		return true;
 	}
 	else {
@@ -20,26 +16,33 @@ bool Assets::ReadTextFile(const std::string &filepath, std::string& result) {
 }
 
 bool	Assets::ReadBinaryFile(const std::string& filename, char** into, size_t& size) {
-	std::ifstream file(filename, std::ios::binary);
-
-	if (!file) {
+	AssetFile file;
+	if (!file.Open(filename)) {
 		return false;
 	}
 
-	file.seekg(0, std::ios_base::end);
-
-	std::streamoff filesize = file.tellg();
-
-	file.seekg(0, std::ios_base::beg);
+	char* data = new char[file.GetSize()];
 
-	char* data = new char[(unsigned int)filesize];
-
-	file.read(data, filesize);
-
-	file.close();
+	memcpy(data, file.GetData(), file.GetSize());
 
 	*into = data;
-	size = filesize;
+	size = file.GetSize();
+
+	return true;
+}
 
-	return data != NULL ? true : false;
-}
\ No newline at end of file
+std::string Assets::NormalisePath(std::string_view path) {
+	std::string result;
+	result.reserve(path.size());
+	for (size_t i = 0; i < path.size(); i++) {
+		char c = path[i];
+		if (c == '\\') c = '/';
+		if (c == '/' && (result.empty() || result.back() == '/')) continue;
+		if (c == '.' && (result.empty() || result.back() == '/') && i + 1 < path.size() && (path[i + 1] == '/' || path[i + 1] == '\\')) {
+			i++;
+			continue;
+		}
+		result.push_back((char)std::tolower((unsigned char)c));
+	}
+	return result;
+}
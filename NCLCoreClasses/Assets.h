@@ -7,6 +7,7 @@ Comments and queries to: richard-gordon.davison AT ncl.ac.uk
 https://research.ncl.ac.uk/game/
 */
 #pragma once
+#include <string_view>
 
 namespace NCL::Assets {
 	const std::string ASSETROOT(ASSETROOTLOCATION);
@@ -19,4 +20,8 @@ namespace NCL::Assets {
 
 	extern bool ReadTextFile(const std::string& filepath, std::string& result);
 	extern bool ReadBinaryFile(const std::string& filepath, char** into, size_t& size);
+
+	//Lower case with forward slashes and no "./" or doubled separators, so any
+	//spelling of a path that Windows would open as the same file compares equal
+	extern std::string NormalisePath(std::string_view path);
 }
\ No newline at end of file
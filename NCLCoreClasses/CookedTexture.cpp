@@ -0,0 +1,185 @@
+#include "CookedTexture.h"
+#include "AssetFile.h"
+
+#include <cstring>
+#include <filesystem>
+#include <thread>
+
+using namespace NCL;
+using namespace Rendering;
+
+namespace {
+	constexpr uint32_t COOKED_TEXTURE_MAGIC = 0x58455443; // "CTEX"
+	constexpr uint32_t COOKED_TEXTURE_VERSION = 1;
+	constexpr size_t COOKED_TEXTURE_ALIGNMENT = 16;
+
+	/*
+	A cooked texture is this header, a table of mip levels from the largest
+	down to 1x1, then each level's data at a 16 byte aligned offset. The
+	source stamp is the size and write time of the image it was cooked from.
+	*/
+	struct CookedTextureHeader {
+		uint32_t magic;
+		uint32_t version;
+		uint64_t sourceSize;
+		int64_t	 sourceWriteTime;
+		uint32_t format;
+		uint32_t levelCount;
+	};
+
+	struct CookedTextureLevel {
+		uint32_t width;
+		uint32_t height;
+		uint64_t offset;
+		uint64_t size;
+	};
+
+	size_t AlignUp(size_t value) {
+		return (value + COOKED_TEXTURE_ALIGNMENT - 1) & ~(COOKED_TEXTURE_ALIGNMENT - 1);
+	}
+}
+
+CookedTexture::CookedTexture() {
+	mFormat = TextureFormat::RGBA8;
+}
+
+CookedTexture::~CookedTexture() {
+}
+
+void CookedTexture::Cook(const char* rgba, int width, int height, TextureFormat format, bool isNormalMap) {
+	mFormat = format;
+	mLevels.clear();
+	mFile.reset();
+
+	std::vector<std::pair<int, int>> sizes = { { width, height } };
+	while (sizes.back().first > 1 || sizes.back().second > 1) {
+		sizes.emplace_back(std::max(1, sizes.back().first / 2), std::max(1, sizes.back().second / 2));
+	}
+	std::vector<size_t> offsets;
+	size_t total = 0;
+	for (const auto& [levelWidth, levelHeight] : sizes) {
+		offsets.push_back(total);
+		total = AlignUp(total + TextureCompressor::GetLevelBytes(format, levelWidth, levelHeight));
+	}
+	mCookedData.assign(total, 0);
+
+	std::vector<uint8_t> level((const uint8_t*)rgba, (const uint8_t*)rgba + (size_t)width * height * 4);
+	std::vector<uint8_t> nextLevel;
+	for (size_t i = 0; i < sizes.size(); ++i) {
+		auto [levelWidth, levelHeight] = sizes[i];
+		TextureCompressor::Compress(format, level.data(), levelWidth, levelHeight, (uint8_t*)mCookedData.data() + offsets[i]);
+		mLevels.push_back({ levelWidth, levelHeight, mCookedData.data() + offsets[i], TextureCompressor::GetLevelBytes(format, levelWidth, levelHeight) });
+
+		if (i + 1 < sizes.size()) {
+			nextLevel.resize((size_t)sizes[i + 1].first * sizes[i + 1].second * 4);
+			TextureCompressor::Downsample(level.data(), levelWidth, levelHeight, nextLevel.data(), isNormalMap);
+			level.swap(nextLevel);
+		}
+	}
+}
+
+bool CookedTexture::Save(const std::string& path, uint64_t sourceSize, int64_t sourceWriteTime) const {
+	CookedTextureHeader header = {};
+	header.magic			= COOKED_TEXTURE_MAGIC;
+	header.version			= COOKED_TEXTURE_VERSION;
+	header.sourceSize		= sourceSize;
+	header.sourceWriteTime	= sourceWriteTime;
+	header.format			= (uint32_t)mFormat;
+	header.levelCount		= (uint32_t)mLevels.size();
+
+	size_t dataStart = AlignUp(sizeof(CookedTextureHeader) + mLevels.size() * sizeof(CookedTextureLevel));
+	std::vector<CookedTextureLevel> table;
+	size_t offset = dataStart;
+	for (const Level& level : mLevels) {
+		table.push_back({ (uint32_t)level.width, (uint32_t)level.height, offset, level.size });
+		offset = AlignUp(offset + level.size);
+	}
+	std::vector<char> file(offset, 0);
+	memcpy(file.data(), &header, sizeof(header));
+	memcpy(file.data() + sizeof(header), table.data(), table.size() * sizeof(CookedTextureLevel));
+	for (size_t i = 0; i < mLevels.size(); ++i) {
+		memcpy(file.data() + table[i].offset, mLevels[i].data, mLevels[i].size);
+	}
+
+	// written under a temporary name and moved into place, so a loader
+	// on another thread never maps a half written file
+	std::string tempPath = path + "." + std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id())) + ".tmp";
+	{
+		std::ofstream out(tempPath, std::ios::binary | std::ios::trunc);
+		if (!out.write(file.data(), file.size())) {
+			return false;
+		}
+	}
+	std::error_code error;
+	std::filesystem::rename(tempPath, path, error);
+	if (error) {
+		std::filesystem::remove(tempPath, error);
+		return false;
+	}
+	return true;
+}
+
+bool CookedTexture::Load(const std::string& path, uint64_t sourceSize, int64_t sourceWriteTime) {
+	std::unique_ptr<AssetFile> file = std::make_unique<AssetFile>();
+	if (!file->Open(path) || file->GetSize() < sizeof(CookedTextureHeader)) {
+		return false;
+	}
+	CookedTextureHeader header;
+	memcpy(&header, file->GetData(), sizeof(header));
+	if (header.magic != COOKED_TEXTURE_MAGIC || header.version != COOKED_TEXTURE_VERSION ||
+		header.format > (uint32_t)TextureFormat::BC5 || header.levelCount == 0 ||
+		header.levelCount > (file->GetSize() - sizeof(header)) / sizeof(CookedTextureLevel)) {
+		return false;
+	}
+	if (sourceSize != 0 && (header.sourceSize != sourceSize || header.sourceWriteTime != sourceWriteTime)) {
+		return false;
+	}
+
+	std::vector<CookedTextureLevel> table(header.levelCount);
+	memcpy(table.data(), file->GetData() + sizeof(header), table.size() * sizeof(CookedTextureLevel));
+
+	// everything is checked before the texture is touched, so a bad file leaves it empty
+	TextureFormat format = (TextureFormat)header.format;
+	for (const CookedTextureLevel& level : table) {
+		if (level.width == 0 || level.height == 0 || level.offset > file->GetSize() || level.size > file->GetSize() - level.offset ||
+			level.size != TextureCompressor::GetLevelBytes(format, level.width, level.height)) {
+			return false;
+		}
+	}
+
+	mFormat = format;
+	mCookedData.clear();
+	mLevels.clear();
+	for (const CookedTextureLevel& level : table) {
+		mLevels.push_back({ (int)level.width, (int)level.height, file->GetData() + level.offset, level.size });
+	}
+	mFile = std::move(file);
+	return true;
+}
+
+size_t CookedTexture::GetPayloadSize() const {
+	size_t size = 0;
+	for (const Level& level : mLevels) {
+		size += level.size;
+	}
+	return size;
+}
+
+TextureFormat CookedTexture::ChooseFormat(const char* rgba, int width, int height, bool isNormalMap) {
+	if (isNormalMap) {
+		return TextureFormat::BC5;
+	}
+	size_t texelCount = (size_t)width * height;
+	for (size_t i = 0; i < texelCount; ++i) {
+		if ((uint8_t)rgba[i * 4 + 3] != 255) {
+			return TextureFormat::BC3;
+		}
+	}
+	return TextureFormat::BC1;
+}
+
+bool CookedTexture::IsNormalMap(const std::string& filename) {
+	std::string stem = std::filesystem::path(filename).stem().string();
+	std::transform(stem.begin(), stem.end(), stem.begin(), [](unsigned char c) { return (char)std::tolower(c); });
+	return stem.find("normal") != std::string::npos;
+}
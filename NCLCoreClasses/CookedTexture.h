@@ -0,0 +1,65 @@
+#pragma once
+#include "TextureCompressor.h"
+
+namespace NCL {
+	class AssetFile;
+}
+
+namespace NCL::Rendering {
+	/*
+	A texture with its whole mip chain already built and compressed, ready to
+	hand straight to the GPU. Cooking builds it in memory from RGBA8 data;
+	loading maps a .ctex file written by Save, so the levels point into the
+	mapping and nothing is copied until upload.
+	*/
+	class CookedTexture {
+	public:
+		struct Level {
+			int			width;
+			int			height;
+			const char* data;
+			size_t		size;
+		};
+
+		CookedTexture();
+		~CookedTexture();
+
+		CookedTexture(const CookedTexture&) = delete;
+		CookedTexture& operator=(const CookedTexture&) = delete;
+
+		void Cook(const char* rgba, int width, int height, TextureFormat format, bool isNormalMap);
+
+		bool Save(const std::string& path, uint64_t sourceSize, int64_t sourceWriteTime) const;
+		//Fails if the file was cooked from a different version of the source; a
+		//zero source size skips that check, for textures shipped without theirs
+		bool Load(const std::string& path, uint64_t sourceSize, int64_t sourceWriteTime);
+
+		TextureFormat GetFormat() const {
+			return mFormat;
+		}
+
+		int GetWidth() const {
+			return mLevels.empty() ? 0 : mLevels[0].width;
+		}
+
+		int GetHeight() const {
+			return mLevels.empty() ? 0 : mLevels[0].height;
+		}
+
+		const std::vector<Level>& GetLevels() const {
+			return mLevels;
+		}
+
+		size_t GetPayloadSize() const;
+
+		//Normal maps go to BC5, anything with transparency to BC3 and the rest to BC1
+		static TextureFormat ChooseFormat(const char* rgba, int width, int height, bool isNormalMap);
+		static bool IsNormalMap(const std::string& filename);
+
+	protected:
+		TextureFormat			mFormat;
+		std::vector<Level>		mLevels;
+		std::vector<char>		mCookedData;
+		std::unique_ptr<AssetFile>	mFile;
+	};
+}
@@ -0,0 +1,240 @@
+#include "JobSystem.h"
+
+using namespace NCL;
+
+JobSystem* JobSystem::instance = nullptr;
+
+//Index of the calling thread's queue and allocator. Anything that isn't one of
+//our workers (i.e. the main thread) uses slot 0.
+static thread_local unsigned int tThreadIndex = 0;
+
+FrameAllocator::FrameAllocator(size_t size) {
+	mBuffer = new char[size];
+	mSize	= size;
+	mOffset = 0;
+}
+
+FrameAllocator::~FrameAllocator() {
+	Reset();
+	delete[] mBuffer;
+}
+
+void* FrameAllocator::Allocate(size_t bytes, size_t alignment) {
+	size_t base = (size_t)mBuffer;
+	size_t start = ((base + mOffset + alignment - 1) & ~(alignment - 1)) - base;
+	if (start + bytes <= mSize) {
+		mOffset = start + bytes;
+		return mBuffer + start;
+	}
+	//Arena is full, fall back to the heap until the next reset
+	char* overflow = new char[bytes + alignment];
+	mOverflow.emplace_back(overflow);
+	size_t address = ((size_t)overflow + alignment - 1) & ~(alignment - 1);
+	return (void*)address;
+}
+
+void FrameAllocator::Reset() {
+	for (char* c : mOverflow) {
+		delete[] c;
+	}
+	mOverflow.clear();
+	mOffset = 0;
+}
+
+JobSystem* JobSystem::GetJobSystem() {
+	if (instance == nullptr) {
+		unsigned int cores = std::thread::hardware_concurrency();
+		instance = new JobSystem(cores > 1 ? cores - 1 : 0);
+	}
+	return instance;
+}
+
+void JobSystem::Initialise(unsigned int workerCount) {
+	Destroy();
+	instance = new JobSystem(workerCount);
+}
+
+void JobSystem::Destroy() {
+	delete instance;
+	instance = nullptr;
+}
+
+JobSystem::JobSystem(unsigned int workerCount) {
+	mPendingJobs = 0;
+	mRunning = true;
+
+	for (unsigned int i = 0; i < workerCount + 1; ++i) {
+		mQueues.emplace_back(std::make_unique<WorkQueue>());
+		mAllocators.emplace_back(std::make_unique<FrameAllocator>());
+	}
+	for (unsigned int i = 0; i < workerCount; ++i) {
+		mWorkers.emplace_back(&JobSystem::WorkerLoop, this, i + 1);
+	}
+}
+
+JobSystem::~JobSystem() {
+	{
+		std::lock_guard<std::mutex> sleepLock(mSleepLock);
+		mRunning = false;
+	}
+	mWakeUp.notify_all();
+	for (std::thread& t : mWorkers) {
+		t.join();
+	}
+}
+
+void JobSystem::Submit(const Job& job, JobCounter* counter) {
+	if (counter) {
+		counter->mCount.fetch_add(1, std::memory_order_relaxed);
+	}
+	WorkQueue& queue = *mQueues[tThreadIndex];
+	{
+		std::lock_guard<std::mutex> queueLock(queue.lock);
+		queue.jobs.push_back({ job, counter });
+	}
+	mPendingJobs.fetch_add(1, std::memory_order_release);
+	{
+		std::lock_guard<std::mutex> sleepLock(mSleepLock);
+	}
+	mWakeUp.notify_one();
+}
+
+void JobSystem::Wait(JobCounter& counter) {
+	QueuedJob job;
+	while (!counter.IsDone()) {
+		if (PopJob(tThreadIndex, job)) {
+			RunJob(job);
+		}
+		else {
+			std::this_thread::yield();
+		}
+	}
+}
+
+void JobSystem::ParallelFor(size_t count, size_t grainSize, const RangeJob& job) {
+	if (count == 0) {
+		return;
+	}
+	if (mWorkers.empty()) {
+		job(0, count);
+		return;
+	}
+	grainSize = std::max<size_t>(grainSize, 1);
+	size_t chunkCount = std::min<size_t>((count + grainSize - 1) / grainSize, GetThreadCount() * 4);
+	if (chunkCount <= 1) {
+		job(0, count);
+		return;
+	}
+	size_t chunkSize = (count + chunkCount - 1) / chunkCount;
+
+	JobCounter counter;
+	for (size_t begin = chunkSize; begin < count; begin += chunkSize) {
+		size_t end = std::min(begin + chunkSize, count);
+		Submit([&job, begin, end]() { job(begin, end); }, &counter);
+	}
+	job(0, std::min(chunkSize, count));
+	Wait(counter);
+}
+
+FrameAllocator& JobSystem::GetThreadAllocator() {
+	return *mAllocators[tThreadIndex];
+}
+
+void JobSystem::ResetAllocators() {
+	for (auto& a : mAllocators) {
+		a->Reset();
+	}
+}
+
+bool JobSystem::PopJob(unsigned int threadIndex, QueuedJob& out) {
+	{
+		WorkQueue& own = *mQueues[threadIndex];
+		std::lock_guard<std::mutex> queueLock(own.lock);
+		if (!own.jobs.empty()) {
+			out = std::move(own.jobs.back());
+			own.jobs.pop_back();
+			mPendingJobs.fetch_sub(1, std::memory_order_relaxed);
+			return true;
+		}
+	}
+	unsigned int queueCount = (unsigned int)mQueues.size();
+	for (unsigned int i = 1; i < queueCount; ++i) {
+		WorkQueue& victim = *mQueues[(threadIndex + i) % queueCount];
+		std::lock_guard<std::mutex> queueLock(victim.lock);
+		if (!victim.jobs.empty()) {
+			out = std::move(victim.jobs.front());
+			victim.jobs.pop_front();
+			mPendingJobs.fetch_sub(1, std::memory_order_relaxed);
+			return true;
+		}
+	}
+	return false;
+}
+
+void JobSystem::RunJob(QueuedJob& job) {
+	job.job();
+	if (job.counter) {
+		job.counter->mCount.fetch_sub(1, std::memory_order_release);
+	}
+}
+
+void JobSystem::WorkerLoop(unsigned int threadIndex) {
+	tThreadIndex = threadIndex;
+	QueuedJob job;
+	while (true) {
+		if (PopJob(threadIndex, job)) {
+			RunJob(job);
+			continue;
+		}
+		std::unique_lock<std::mutex> sleepLock(mSleepLock);
+		mWakeUp.wait(sleepLock, [&]() {
+			return !mRunning || mPendingJobs.load(std::memory_order_acquire) > 0;
+		});
+		if (!mRunning) {
+			return;
+		}
+	}
+}
+
+TaskGraph::TaskID TaskGraph::AddTask(const std::string& name, const Job& job) {
+	auto task = std::make_unique<Task>();
+	task->name = name;
+	task->job = job;
+	mTasks.emplace_back(std::move(task));
+	return (TaskID)mTasks.size() - 1;
+}
+
+void TaskGraph::AddDependency(TaskID before, TaskID after) {
+	mTasks[before]->successors.emplace_back(after);
+	mTasks[after]->dependencyCount++;
+}
+
+void TaskGraph::Run(JobSystem& jobSystem) {
+	for (auto& t : mTasks) {
+		t->remaining = t->dependencyCount;
+	}
+	JobCounter counter;
+	for (TaskID i = 0; i < (TaskID)mTasks.size(); ++i) {
+		if (mTasks[i]->dependencyCount == 0) {
+			Launch(jobSystem, i, counter);
+		}
+	}
+	jobSystem.Wait(counter);
+}
+
+void TaskGraph::Clear() {
+	mTasks.clear();
+}
+
+void TaskGraph::Launch(JobSystem& jobSystem, TaskID task, JobCounter& counter) {
+	jobSystem.Submit([this, &jobSystem, &counter, task]() {
+		mTasks[task]->job();
+		//Successors are submitted before this job retires, so the counter
+		//can't reach zero while there is still work left in the graph
+		for (TaskID next : mTasks[task]->successors) {
+			if (mTasks[next]->remaining.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+				Launch(jobSystem, next, counter);
+			}
+		}
+	}, &counter);
+}
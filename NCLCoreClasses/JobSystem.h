@@ -0,0 +1,161 @@
+#pragma once
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <cstddef>
+
+namespace NCL {
+	typedef std::function<void()> Job;
+	typedef std::function<void(size_t begin, size_t end)> RangeJob;
+
+	/*
+	Tracks how many submitted jobs are still outstanding. Waiting on a counter
+	doesn't block the thread, it keeps pulling queued jobs until the count hits
+	zero, so it is safe to wait from inside a job.
+	*/
+	class JobCounter {
+	public:
+		JobCounter() : mCount(0) {}
+
+		bool IsDone() const {
+			return mCount.load(std::memory_order_acquire) == 0;
+		}
+
+	protected:
+		friend class JobSystem;
+		std::atomic<int> mCount;
+	};
+
+	/*
+	Simple linear allocator, one per job thread, for scratch memory that only
+	has to last the frame. Memory is only handed back when the whole arena is
+	reset, which the owner of the job system does once per frame when no jobs
+	are running. Nothing allocated here has its destructor run.
+	*/
+	class FrameAllocator {
+	public:
+		FrameAllocator(size_t size = 1024 * 1024);
+		~FrameAllocator();
+
+		void* Allocate(size_t bytes, size_t alignment = alignof(std::max_align_t));
+
+		template<class T>
+		T* AllocateArray(size_t count) {
+			return static_cast<T*>(Allocate(sizeof(T) * count, alignof(T)));
+		}
+
+		void Reset();
+
+		size_t GetBytesUsed() const {
+			return mOffset;
+		}
+
+	protected:
+		char*	mBuffer;
+		size_t	mSize;
+		size_t	mOffset;
+
+		std::vector<char*> mOverflow;
+	};
+
+	/*
+	Work-stealing job scheduler. Every thread has its own queue: a thread pops
+	its newest job first, and when its queue runs dry it steals the oldest job
+	from another thread. The thread that owns the JobSystem counts as thread 0
+	and helps out with work whenever it waits.
+	*/
+	class JobSystem {
+	public:
+		static JobSystem* GetJobSystem();
+		static void Initialise(unsigned int workerCount);
+		static void Destroy();
+
+		JobSystem(unsigned int workerCount);
+		~JobSystem();
+
+		void Submit(const Job& job, JobCounter* counter = nullptr);
+		void Wait(JobCounter& counter);
+
+		//Splits [0, count) into chunks of at least grainSize and runs them across all threads
+		void ParallelFor(size_t count, size_t grainSize, const RangeJob& job);
+
+		//The calling thread's allocator, only valid until the next ResetAllocators
+		FrameAllocator& GetThreadAllocator();
+		void ResetAllocators();
+
+		unsigned int GetThreadCount() const {
+			return (unsigned int)mQueues.size();
+		}
+
+		unsigned int GetWorkerCount() const {
+			return (unsigned int)mWorkers.size();
+		}
+
+	protected:
+		struct QueuedJob {
+			Job			job;
+			JobCounter*	counter;
+		};
+
+		struct WorkQueue {
+			std::mutex				lock;
+			std::deque<QueuedJob>	jobs;
+		};
+
+		bool PopJob(unsigned int threadIndex, QueuedJob& out);
+		void RunJob(QueuedJob& job);
+		void WorkerLoop(unsigned int threadIndex);
+
+		std::vector<std::thread>					mWorkers;
+		std::vector<std::unique_ptr<WorkQueue>>		mQueues;
+		std::vector<std::unique_ptr<FrameAllocator>> mAllocators;
+
+		std::mutex				mSleepLock;
+		std::condition_variable mWakeUp;
+		std::atomic<int>		mPendingJobs;
+		std::atomic<bool>		mRunning;
+
+		static JobSystem* instance;
+	};
+
+	/*
+	A set of jobs with ordering constraints between them. Tasks are launched
+	as soon as everything they depend on has finished, and Run returns once
+	every task in the graph has completed.
+	*/
+	class TaskGraph {
+	public:
+		typedef int TaskID;
+
+		TaskGraph() {}
+		~TaskGraph() {}
+
+		TaskID AddTask(const std::string& name, const Job& job);
+		void AddDependency(TaskID before, TaskID after);
+
+		void Run(JobSystem& jobSystem);
+		void Clear();
+
+		size_t GetTaskCount() const {
+			return mTasks.size();
+		}
+
+		const std::string& GetTaskName(TaskID task) const {
+			return mTasks[task]->name;
+		}
+
+	protected:
+		struct Task {
+			std::string			name;
+			Job					job;
+			std::vector<TaskID>	successors;
+			int					dependencyCount = 0;
+			std::atomic<int>	remaining;
+		};
+
+		void Launch(JobSystem& jobSystem, TaskID task, JobCounter& counter);
+
+		std::vector<std::unique_ptr<Task>> mTasks;
+	};
+}
@@ -0,0 +1,226 @@
+#include "LoadProfiler.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <new>
+#include <string_view>
+
+using namespace NCL;
+
+namespace {
+	struct OpenStage {
+		const char* name;
+		std::string detail;
+		std::chrono::steady_clock::time_point start;
+		uint64_t	bytesRead;
+		uint64_t	allocations;
+		uint64_t	allocatedBytes;
+	};
+
+	// plain counters only, as operator new touches these before anything else
+	// on the thread has been constructed
+	thread_local uint64_t threadBytesRead		= 0;
+	thread_local uint64_t threadAllocations		= 0;
+	thread_local uint64_t threadAllocatedBytes	= 0;
+
+	thread_local std::vector<OpenStage> openStages;
+
+	std::atomic<uint32_t> nextThreadIndex = 0;
+	std::mutex stageLock;
+	std::vector<LoadProfiler::Stage> stages;
+
+	uint32_t GetThreadIndex() {
+		thread_local uint32_t index = nextThreadIndex++;
+		return index;
+	}
+
+	std::chrono::steady_clock::time_point GetEpoch() {
+		static const std::chrono::steady_clock::time_point epoch = std::chrono::steady_clock::now();
+		return epoch;
+	}
+
+	int64_t ToMicroseconds(std::chrono::steady_clock::duration time) {
+		return std::chrono::duration_cast<std::chrono::microseconds>(time).count();
+	}
+
+	std::string EscapeJson(std::string_view text) {
+		std::string escaped;
+		for (char c : text) {
+			if (c == '"' || c == '\\') {
+				escaped += '\\';
+				escaped += c;
+			}
+			else if ((unsigned char)c < 0x20) {
+				char code[7];
+				snprintf(code, sizeof(code), "\\u%04x", (unsigned)c);
+				escaped += code;
+			}
+			else {
+				escaped += c;
+			}
+		}
+		return escaped;
+	}
+}
+
+void LoadProfiler::Begin(const char* name, const std::string& detail) {
+	GetEpoch();
+	GetThreadIndex();
+	if (openStages.capacity() == 0) {
+		openStages.reserve(16);
+	}
+	openStages.push_back({ name, detail, {}, 0, 0, 0 });
+	// taken last, so the profiler's own bookkeeping isn't charged to the stage
+	OpenStage& stage		= openStages.back();
+	stage.bytesRead			= threadBytesRead;
+	stage.allocations		= threadAllocations;
+	stage.allocatedBytes	= threadAllocatedBytes;
+	stage.start				= std::chrono::steady_clock::now();
+}
+
+void LoadProfiler::End() {
+	if (openStages.empty()) {
+		return;
+	}
+	auto end = std::chrono::steady_clock::now();
+	OpenStage& open = openStages.back();
+	Stage stage;
+	stage.name				= open.name;
+	stage.thread			= GetThreadIndex();
+	stage.depth				= (uint32_t)openStages.size() - 1;
+	stage.start				= ToMicroseconds(open.start - GetEpoch());
+	stage.duration			= ToMicroseconds(end - open.start);
+	stage.bytesRead			= threadBytesRead - open.bytesRead;
+	stage.allocations		= threadAllocations - open.allocations;
+	stage.allocatedBytes	= threadAllocatedBytes - open.allocatedBytes;
+	stage.detail			= std::move(open.detail);
+	openStages.pop_back();
+
+	std::lock_guard<std::mutex> lock(stageLock);
+	stages.push_back(std::move(stage));
+}
+
+void LoadProfiler::AddBytesRead(size_t bytes) {
+	threadBytesRead += bytes;
+}
+
+void LoadProfiler::CountAllocation(size_t bytes) {
+	threadAllocations++;
+	threadAllocatedBytes += bytes;
+}
+
+std::vector<LoadProfiler::Stage> LoadProfiler::GetStages() {
+	std::lock_guard<std::mutex> lock(stageLock);
+	return stages;
+}
+
+void LoadProfiler::Clear() {
+	std::lock_guard<std::mutex> lock(stageLock);
+	stages.clear();
+}
+
+bool LoadProfiler::WriteChromeTrace(const std::string& path) {
+	std::vector<Stage> recorded = GetStages();
+	std::ofstream out(path, std::ios::trunc);
+	if (!out) {
+		std::cout << __FUNCTION__ << " can't write " << path << "\n";
+		return false;
+	}
+	out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+	for (size_t i = 0; i < recorded.size(); ++i) {
+		const Stage& stage = recorded[i];
+		out << (i == 0 ? "\n" : ",\n")
+			<< "{\"name\":\"" << EscapeJson(stage.name) << "\",\"cat\":\"load\",\"ph\":\"X\""
+			<< ",\"ts\":" << stage.start << ",\"dur\":" << stage.duration
+			<< ",\"pid\":0,\"tid\":" << stage.thread
+			<< ",\"args\":{\"bytesRead\":" << stage.bytesRead
+			<< ",\"allocations\":" << stage.allocations
+			<< ",\"allocatedBytes\":" << stage.allocatedBytes;
+		if (!stage.detail.empty()) {
+			out << ",\"detail\":\"" << EscapeJson(stage.detail) << "\"";
+		}
+		out << "}}";
+	}
+	out << "\n]}\n";
+	return (bool)out;
+}
+
+void LoadProfiler::PrintSummary(std::ostream& out) {
+	struct Row {
+		std::string_view name;
+		uint32_t	depth;
+		uint64_t	calls;
+		int64_t		first;
+		int64_t		total;
+		int64_t		longest;
+		uint64_t	bytesRead;
+		uint64_t	allocations;
+		uint64_t	allocatedBytes;
+	};
+	std::vector<Stage> recorded = GetStages();
+	std::vector<Row> rows;
+	for (const Stage& stage : recorded) {
+		auto row = std::find_if(rows.begin(), rows.end(), [&stage](const Row& r) { return r.name == stage.name; });
+		if (row == rows.end()) {
+			rows.push_back({ stage.name, stage.depth, 0, stage.start, 0, 0, 0, 0, 0 });
+			row = rows.end() - 1;
+		}
+		row->depth			= std::min(row->depth, stage.depth);
+		row->first			= std::min(row->first, stage.start);
+		row->calls++;
+		row->total			+= stage.duration;
+		row->longest		= std::max(row->longest, stage.duration);
+		row->bytesRead		+= stage.bytesRead;
+		row->allocations	+= stage.allocations;
+		row->allocatedBytes += stage.allocatedBytes;
+	}
+	// stages are recorded as they end, so parents come after their children
+	std::stable_sort(rows.begin(), rows.end(), [](const Row& a, const Row& b) {
+		return a.first != b.first ? a.first < b.first : a.depth < b.depth;
+	});
+
+	char line[256];
+	snprintf(line, sizeof(line), "%-40s %6s %10s %10s %10s %10s %10s\n", "Stage", "Calls", "Total ms", "Max ms", "Read KB", "Allocs", "Alloc KB");
+	out << line;
+	for (const Row& row : rows) {
+		std::string name = std::string(row.depth * 2, ' ') + std::string(row.name);
+		snprintf(line, sizeof(line), "%-40s %6llu %10.2f %10.2f %10.1f %10llu %10.1f\n", name.c_str(),
+			(unsigned long long)row.calls, row.total / 1000.0, row.longest / 1000.0, row.bytesRead / 1024.0,
+			(unsigned long long)row.allocations, row.allocatedBytes / 1024.0);
+		out << line;
+	}
+}
+
+#ifdef NCL_PROFILE_ALLOCATIONS
+/*
+Every allocation in the program comes through here, so it does no more than
+bump two thread local counters on its way to malloc. The array and nothrow
+forms forward to these by default, and the sized delete is given too so no
+standard library can pair it with a different allocator.
+*/
+void* operator new(size_t size) {
+	LoadProfiler::CountAllocation(size);
+	for (;;) {
+		if (void* memory = malloc(size == 0 ? 1 : size)) {
+			return memory;
+		}
+		std::new_handler handler = std::get_new_handler();
+		if (!handler) {
+			throw std::bad_alloc();
+		}
+		handler();
+	}
+}
+
+void operator delete(void* memory) noexcept {
+	free(memory);
+}
+
+void operator delete(void* memory, size_t) noexcept {
+	free(memory);
+}
+#endif
@@ -0,0 +1,64 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <iosfwd>
+#include <cstdint>
+
+namespace NCL {
+	/*
+	Records how long each stage of startup and level loading takes, along with
+	the asset bytes it read and the heap allocations it made. Stages nest, and
+	each thread keeps its own stack of open stages, so work done on the job
+	threads shows up as its own stages rather than in whatever the main thread
+	was waiting on. Counts include any stages nested inside.
+
+	Allocations are counted by anything routed to CountAllocation by a library
+	with its own allocator hooks, and, in builds with NCL_PROFILE_ALLOCATIONS,
+	by a replacement global operator new.
+	*/
+	class LoadProfiler {
+	public:
+		struct Stage {
+			const char*	name;
+			std::string detail;
+			uint32_t	thread;
+			uint32_t	depth;
+			int64_t		start;		//microseconds since the first stage began
+			int64_t		duration;	//microseconds
+			uint64_t	bytesRead;
+			uint64_t	allocations;
+			uint64_t	allocatedBytes;
+		};
+
+		//name has to outlive the profiler, detail is copied
+		static void Begin(const char* name, const std::string& detail = std::string());
+		static void End();
+
+		static void AddBytesRead(size_t bytes);
+		static void CountAllocation(size_t bytes);
+
+		static std::vector<Stage> GetStages();
+		static void Clear();
+
+		//Chrome's trace event format, for chrome://tracing or Perfetto
+		static bool WriteChromeTrace(const std::string& path);
+
+		//One row per stage name in the order they first started, indented by
+		//nesting. Stages on the job threads overlap, so their totals can add
+		//up to more than the wall time around them
+		static void PrintSummary(std::ostream& out);
+	};
+
+	class LoadMarker {
+	public:
+		LoadMarker(const char* name, const std::string& detail = std::string()) {
+			LoadProfiler::Begin(name, detail);
+		}
+		~LoadMarker() {
+			LoadProfiler::End();
+		}
+
+		LoadMarker(const LoadMarker&) = delete;
+		LoadMarker& operator=(const LoadMarker&) = delete;
+	};
+}
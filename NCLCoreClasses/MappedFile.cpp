@@ -0,0 +1,108 @@
+#include "MappedFile.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace NCL;
+
+#ifdef _WIN32
+MappedFile::MappedFile() {
+	mData = nullptr;
+	mSize = 0;
+	mFile = INVALID_HANDLE_VALUE;
+	mMapping = nullptr;
+}
+
+bool MappedFile::Open(const std::string& filepath) {
+	Close();
+	mFile = CreateFileA(filepath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (mFile == INVALID_HANDLE_VALUE) {
+		return false;
+	}
+	LARGE_INTEGER size;
+	// an empty file can't be mapped, and is never a valid asset anyway
+	if (!GetFileSizeEx(mFile, &size) || size.QuadPart == 0) {
+		Close();
+		return false;
+	}
+	mMapping = CreateFileMappingA(mFile, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (!mMapping) {
+		Close();
+		return false;
+	}
+	mData = (const char*)MapViewOfFile(mMapping, FILE_MAP_READ, 0, 0, 0);
+	if (!mData) {
+		Close();
+		return false;
+	}
+	mSize = (size_t)size.QuadPart;
+	return true;
+}
+
+void MappedFile::Close() {
+	if (mData) {
+		UnmapViewOfFile(mData);
+	}
+	if (mMapping) {
+		CloseHandle(mMapping);
+	}
+	if (mFile != INVALID_HANDLE_VALUE) {
+		CloseHandle(mFile);
+	}
+	mData = nullptr;
+	mSize = 0;
+	mFile = INVALID_HANDLE_VALUE;
+	mMapping = nullptr;
+}
+#else
+MappedFile::MappedFile() {
+	mData = nullptr;
+	mSize = 0;
+	mFile = -1;
+}
+
+bool MappedFile::Open(const std::string& filepath) {
+	Close();
+	mFile = open(filepath.c_str(), O_RDONLY);
+	if (mFile < 0) {
+		return false;
+	}
+	struct stat info;
+	if (fstat(mFile, &info) != 0 || info.st_size == 0) {
+		Close();
+		return false;
+	}
+	void* data = mmap(nullptr, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, mFile, 0);
+	if (data == MAP_FAILED) {
+		Close();
+		return false;
+	}
+	mData = (const char*)data;
+	mSize = (size_t)info.st_size;
+	return true;
+}
+
+void MappedFile::Close() {
+	if (mData) {
+		munmap((void*)mData, mSize);
+	}
+	if (mFile >= 0) {
+		close(mFile);
+	}
+	mData = nullptr;
+	mSize = 0;
+	mFile = -1;
+}
+#endif
+
+MappedFile::~MappedFile() {
+	Close();
+}
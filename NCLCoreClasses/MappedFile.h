@@ -0,0 +1,42 @@
+#pragma once
+
+namespace NCL {
+	/*
+	Read only view of a whole file mapped into memory. The OS pages the file in
+	as it is touched, so opening is cheap and nothing is copied; the view stays
+	valid until the MappedFile is closed or destroyed.
+	*/
+	class MappedFile {
+	public:
+		MappedFile();
+		~MappedFile();
+
+		MappedFile(const MappedFile&) = delete;
+		MappedFile& operator=(const MappedFile&) = delete;
+
+		bool Open(const std::string& filepath);
+		void Close();
+
+		bool IsOpen() const {
+			return mData != nullptr;
+		}
+
+		const char* GetData() const {
+			return mData;
+		}
+
+		size_t GetSize() const {
+			return mSize;
+		}
+
+	protected:
+		const char* mData;
+		size_t mSize;
+#ifdef _WIN32
+		void* mFile;
+		void* mMapping;
+#else
+		int mFile;
+#endif
+	};
+}
@@ -121,6 +121,62 @@ void Mesh::SetVertexSkinIndices(const std::vector<Vector4i>& newSkinIndices) {
 	skinIndices = newSkinIndices;
 }
 
+void Mesh::AssignVertexPositions(std::span<const Vector3> newVerts) {
+	positions.assign(newVerts.begin(), newVerts.end());
+}
+
+void Mesh::AssignVertexTextureCoords(std::span<const Vector2> newTex) {
+	texCoords.assign(newTex.begin(), newTex.end());
+}
+
+void Mesh::AssignVertexColours(std::span<const Vector4> newColours) {
+	colours.assign(newColours.begin(), newColours.end());
+}
+
+void Mesh::AssignVertexNormals(std::span<const Vector3> newNorms) {
+	normals.assign(newNorms.begin(), newNorms.end());
+}
+
+void Mesh::AssignVertexTangents(std::span<const Vector4> newTans) {
+	tangents.assign(newTans.begin(), newTans.end());
+}
+
+void Mesh::AssignVertexIndices(std::span<const unsigned int> newIndices) {
+	indices.assign(newIndices.begin(), newIndices.end());
+}
+
+void Mesh::AssignVertexSkinWeights(std::span<const Vector4> newSkinWeights) {
+	skinWeights.assign(newSkinWeights.begin(), newSkinWeights.end());
+}
+
+void Mesh::AssignVertexSkinIndices(std::span<const Vector4i> newSkinIndices) {
+	skinIndices.assign(newSkinIndices.begin(), newSkinIndices.end());
+}
+
+void Mesh::AssignSubMeshes(std::span<const SubMesh> meshes) {
+	subMeshes.assign(meshes.begin(), meshes.end());
+}
+
+void Mesh::AssignJointParents(std::span<const int> newParents) {
+	jointParents.assign(newParents.begin(), newParents.end());
+}
+
+void Mesh::AssignBindPose(std::span<const Matrix4> newMats) {
+	bindPose.assign(newMats.begin(), newMats.end());
+}
+
+void Mesh::AssignInverseBindPose(std::span<const Matrix4> newMats) {
+	inverseBindPose.assign(newMats.begin(), newMats.end());
+}
+
+void Mesh::AssignBindPoseIndices(std::span<const int> newIndices) {
+	mBindPoseIndices.assign(newIndices.begin(), newIndices.end());
+}
+
+void Mesh::AssignBindPoseStates(std::span<const SubMeshPoses> newState) {
+	mBindPoseStates.assign(newState.begin(), newState.end());
+}
+
 void Mesh::SetDebugName(const std::string& newName) {
 	debugName = newName;
 }
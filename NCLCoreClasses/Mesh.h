@@ -8,6 +8,7 @@ https://research.ncl.ac.uk/game/
 */
 #pragma once
 #include <cstdint>
+#include <span>
 
 
 namespace NCL::Maths {
@@ -172,6 +173,12 @@ namespace NCL::Rendering {
 		void SetInverseBindPose(const std::vector<Matrix4>& newMats);
 		void CalculateInverseBindPose();
 
+		const std::vector<SubMesh>& GetSubMeshes() const { return subMeshes; }
+		const std::vector<std::string>& GetSubMeshNames() const { return subMeshNames; }
+		const std::vector<std::string>& GetJointNames() const { return jointNames; }
+		const std::vector<int>& GetBindPoseIndexData() const { return mBindPoseIndices; }
+		const std::vector<SubMeshPoses>& GetBindPoseStates() const { return mBindPoseStates; }
+
 		bool	GetVertexIndicesForTri(unsigned int i, unsigned int& a, unsigned int& b, unsigned int& c) const;
 		bool	GetTriangle(unsigned int i, Vector3& a, Vector3& b, Vector3& c) const;
 		bool	GetNormalForTri(unsigned int i, Vector3& n) const;
@@ -202,6 +209,23 @@ namespace NCL::Rendering {
 		void SetVertexSkinWeights(const std::vector<Vector4>& newSkinWeights);
 		void SetVertexSkinIndices(const std::vector<Vector4i>& newSkinIndices);
 
+		//Copy straight out of memory the caller owns, such as a mapped file. These
+		//aren't overloads of the setters so braced lists still pick the vector ones
+		void AssignVertexPositions(std::span<const Vector3> newVerts);
+		void AssignVertexTextureCoords(std::span<const Vector2> newTex);
+		void AssignVertexColours(std::span<const Vector4> newColours);
+		void AssignVertexNormals(std::span<const Vector3> newNorms);
+		void AssignVertexTangents(std::span<const Vector4> newTans);
+		void AssignVertexIndices(std::span<const unsigned int> newIndices);
+		void AssignVertexSkinWeights(std::span<const Vector4> newSkinWeights);
+		void AssignVertexSkinIndices(std::span<const Vector4i> newSkinIndices);
+		void AssignSubMeshes(std::span<const SubMesh> meshes);
+		void AssignJointParents(std::span<const int> newParents);
+		void AssignBindPose(std::span<const Matrix4> newMats);
+		void AssignInverseBindPose(std::span<const Matrix4> newMats);
+		void AssignBindPoseIndices(std::span<const int> newIndices);
+		void AssignBindPoseStates(std::span<const SubMeshPoses> newState);
+
 		void SetDebugName(const std::string& debugName);
 
 		virtual void UploadToGPU(Rendering::RendererBase* renderer = nullptr) = 0;
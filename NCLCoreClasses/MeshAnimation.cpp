@@ -1,11 +1,310 @@
 #include "MeshAnimation.h"
 #include "Matrix4.h"
+#include "Quaternion.h"
+#include "Vector3.h"
 #include "Assets.h"
+#include "AssetFile.h"
+
+#include <cmath>
+#include <filesystem>
+#include <limits>
+#include <spanstream>
+#include <thread>
 
 using namespace NCL;
 using namespace Rendering;
 using namespace Maths;
 
+namespace {
+	constexpr uint32_t BINARY_ANIM_MAGIC = 0x424D4E41; // "ANMB"
+	constexpr uint32_t BINARY_ANIM_VERSION = 1;
+
+	constexpr float ROTATION_LIMIT = 0.70710678f; // 1 / std::sqrt(2)
+	constexpr float ROTATION_STEPS = 32767.0f;
+	constexpr float TRANSLATION_STEPS = 65535.0f;
+
+	/*
+	A compressed clip is this header, a track per joint, then every track's
+	keys: a uint16 frame index each, then three uint16s of rotation each, then
+	three uint16s of translation each. A track's keys are the frames its
+	rotation and translation can't be linearly interpolated from the frames
+	either side within MeshAnimation::MAX_JOINT_ERROR. A track with one key
+	holds still for the whole clip, otherwise its keys start on the first
+	frame and end on the last.
+	Rotations are stored smallest three, translations as 16 bit steps across
+	the track's range, and scale is constant for the track.
+	The source stamp is the .anm file's size and write time when it was
+	converted, so a re-exported clip is picked up again.
+	*/
+	struct BinaryAnimHeader {
+		uint32_t magic;
+		uint32_t version;
+		uint64_t sourceSize;
+		int64_t	 sourceWriteTime;
+		uint32_t frameCount;
+		uint32_t jointCount;
+		float	 frameRate;
+		uint32_t keyCount;
+	};
+
+	struct BinaryAnimTrack {
+		uint32_t firstKey;
+		uint32_t keyCount;
+		float	 translationMin[3];
+		float	 translationRange[3];
+		float	 scale[3];
+	};
+
+	bool GetSourceStamp(const std::string& path, uint64_t& size, int64_t& writeTime) {
+		std::error_code error;
+		size = std::filesystem::file_size(path, error);
+		if (error) {
+			return false;
+		}
+		writeTime = (int64_t)std::filesystem::last_write_time(path, error).time_since_epoch().count();
+		return !error;
+	}
+
+	// Smallest three: the largest component is dropped and rebuilt from the
+	// others on load. The quaternion is negated if need be so that the dropped
+	// component is positive. The other three all lie within +-1/sqrt(2) and get
+	// 15 bits each, and the dropped component's index goes in the top bits of
+	// the first two
+	void PackRotation(const Quaternion& rotation, uint16_t* out) {
+		float components[4] = { rotation.x, rotation.y, rotation.z, rotation.w };
+		int largest = 0;
+		for (int i = 1; i < 4; ++i) {
+			if (std::abs(components[i]) > std::abs(components[largest])) {
+				largest = i;
+			}
+		}
+		float sign = components[largest] < 0.0f ? -1.0f : 1.0f;
+
+		int written = 0;
+		for (int i = 0; i < 4; ++i) {
+			if (i == largest) {
+				continue;
+			}
+			float value = std::clamp(components[i] * sign, -ROTATION_LIMIT, ROTATION_LIMIT);
+			out[written++] = (uint16_t)std::lround((value + ROTATION_LIMIT) / (2.0f * ROTATION_LIMIT) * ROTATION_STEPS);
+		}
+		out[0] |= (uint16_t)((largest & 1) << 15);
+		out[1] |= (uint16_t)((largest >> 1) << 15);
+	}
+
+	Quaternion UnpackRotation(const uint16_t* in) {
+		int largest = (in[0] >> 15) | ((in[1] >> 15) << 1);
+
+		float components[4];
+		float lengthSquared = 0.0f;
+		int read = 0;
+		for (int i = 0; i < 4; ++i) {
+			if (i == largest) {
+				continue;
+			}
+			float value = (in[read++] & 0x7FFF) / ROTATION_STEPS * (2.0f * ROTATION_LIMIT) - ROTATION_LIMIT;
+			components[i] = value;
+			lengthSquared += value * value;
+		}
+		components[largest] = std::sqrt(std::max(0.0f, 1.0f - lengthSquared));
+		return Quaternion(components[0], components[1], components[2], components[3]);
+	}
+
+	void PackTranslation(const Vector3& translation, const BinaryAnimTrack& track, uint16_t* out) {
+		for (int i = 0; i < 3; ++i) {
+			float t = track.translationRange[i] > 0.0f ? (translation[i] - track.translationMin[i]) / track.translationRange[i] : 0.0f;
+			out[i] = (uint16_t)std::lround(std::clamp(t, 0.0f, 1.0f) * TRANSLATION_STEPS);
+		}
+	}
+
+	Vector3 UnpackTranslation(const uint16_t* in, const BinaryAnimTrack& track) {
+		Vector3 translation;
+		for (int i = 0; i < 3; ++i) {
+			translation[i] = track.translationMin[i] + in[i] / TRANSLATION_STEPS * track.translationRange[i];
+		}
+		return translation;
+	}
+
+	// Quaternion(const Matrix4&) loses precision close to half turns, which
+	// joints hit all the time, so this picks the best conditioned diagonal
+	Quaternion RotationFromJoint(const Matrix4& joint, const Vector3& scale) {
+		float m[3][3];
+		for (int column = 0; column < 3; ++column) {
+			for (int row = 0; row < 3; ++row) {
+				m[column][row] = joint.array[column][row] / scale[column];
+			}
+		}
+		float trace = m[0][0] + m[1][1] + m[2][2];
+		Quaternion q;
+		if (trace > 0.0f) {
+			float s = std::sqrt(trace + 1.0f) * 2.0f;
+			q = Quaternion((m[1][2] - m[2][1]) / s, (m[2][0] - m[0][2]) / s, (m[0][1] - m[1][0]) / s, 0.25f * s);
+		}
+		else if (m[0][0] > m[1][1] && m[0][0] > m[2][2]) {
+			float s = std::sqrt(1.0f + m[0][0] - m[1][1] - m[2][2]) * 2.0f;
+			q = Quaternion(0.25f * s, (m[1][0] + m[0][1]) / s, (m[2][0] + m[0][2]) / s, (m[1][2] - m[2][1]) / s);
+		}
+		else if (m[1][1] > m[2][2]) {
+			float s = std::sqrt(1.0f + m[1][1] - m[0][0] - m[2][2]) * 2.0f;
+			q = Quaternion((m[1][0] + m[0][1]) / s, 0.25f * s, (m[2][1] + m[1][2]) / s, (m[2][0] - m[0][2]) / s);
+		}
+		else {
+			float s = std::sqrt(1.0f + m[2][2] - m[0][0] - m[1][1]) * 2.0f;
+			q = Quaternion((m[2][0] + m[0][2]) / s, (m[2][1] + m[1][2]) / s, 0.25f * s, (m[0][1] - m[1][0]) / s);
+		}
+		q.Normalise();
+		return q;
+	}
+
+	void ComposeJoint(const Quaternion& q, const Vector3& t, const Vector3& scale, Matrix4& out) {
+		float xx = q.x * q.x, yy = q.y * q.y, zz = q.z * q.z;
+		float xy = q.x * q.y, xz = q.x * q.z, yz = q.y * q.z;
+		float wx = q.w * q.x, wy = q.w * q.y, wz = q.w * q.z;
+
+		out.array[0][0] = (1.0f - 2.0f * (yy + zz)) * scale.x;
+		out.array[0][1] = (2.0f * (xy + wz)) * scale.x;
+		out.array[0][2] = (2.0f * (xz - wy)) * scale.x;
+		out.array[0][3] = 0.0f;
+
+		out.array[1][0] = (2.0f * (xy - wz)) * scale.y;
+		out.array[1][1] = (1.0f - 2.0f * (xx + zz)) * scale.y;
+		out.array[1][2] = (2.0f * (yz + wx)) * scale.y;
+		out.array[1][3] = 0.0f;
+
+		out.array[2][0] = (2.0f * (xz + wy)) * scale.z;
+		out.array[2][1] = (2.0f * (yz - wx)) * scale.z;
+		out.array[2][2] = (1.0f - 2.0f * (xx + yy)) * scale.z;
+		out.array[2][3] = 0.0f;
+
+		out.array[3][0] = t.x;
+		out.array[3][1] = t.y;
+		out.array[3][2] = t.z;
+		out.array[3][3] = 1.0f;
+	}
+
+	// normalised lerp, taking the short way round as neighbouring keys can
+	// come back from PackRotation on opposite hemispheres
+	Quaternion BlendRotation(const Quaternion& from, const Quaternion& to, float by) {
+		float toSign = Quaternion::Dot(from, to) < 0.0f ? -1.0f : 1.0f;
+		Quaternion q(
+			from.x + (to.x * toSign - from.x) * by,
+			from.y + (to.y * toSign - from.y) * by,
+			from.z + (to.z * toSign - from.z) * by,
+			from.w + (to.w * toSign - from.w) * by
+		);
+		q.Normalise();
+		return q;
+	}
+
+	float JointError(const Matrix4& a, const Matrix4& b) {
+		float error = 0.0f;
+		for (int i = 0; i < 4; ++i) {
+			for (int j = 0; j < 4; ++j) {
+				error = std::max(error, std::abs(a.array[i][j] - b.array[i][j]));
+			}
+		}
+		return error;
+	}
+
+	/*
+	Quantizes every frame of one joint, then keeps only the frames that
+	interpolating the kept frames either side can't reproduce. Errors are
+	measured on the quantized values, so what is written is what was checked.
+	Returns false if even the keyed frames miss the error bound, which only
+	happens if the joint has shear or a scale that changes over the clip.
+	*/
+	bool CompressTrack(const std::vector<Matrix4>& allJoints, size_t joint, size_t jointCount, size_t frameCount,
+		BinaryAnimTrack& track, std::vector<uint16_t>& keyFrames, std::vector<uint16_t>& rotations, std::vector<uint16_t>& translations) {
+		auto Source = [&](size_t frame) -> const Matrix4& {
+			return allJoints[frame * jointCount + joint];
+		};
+
+		Vector3 scale;
+		Vector3 minimum = Source(0).GetPositionVector();
+		Vector3 maximum = minimum;
+		for (size_t frame = 0; frame < frameCount; ++frame) {
+			const Matrix4& m = Source(frame);
+			for (int column = 0; column < 3; ++column) {
+				scale[column] += Vector3(m.array[column][0], m.array[column][1], m.array[column][2]).Length();
+			}
+			Vector3 position = m.GetPositionVector();
+			for (int i = 0; i < 3; ++i) {
+				minimum[i] = std::min(minimum[i], position[i]);
+				maximum[i] = std::max(maximum[i], position[i]);
+			}
+		}
+		scale = scale / (float)frameCount;
+		if (scale.x <= 0.0f || scale.y <= 0.0f || scale.z <= 0.0f) {
+			return false;
+		}
+		for (int i = 0; i < 3; ++i) {
+			track.translationMin[i] = minimum[i];
+			track.translationRange[i] = maximum[i] - minimum[i];
+			track.scale[i] = scale[i];
+		}
+
+		std::vector<uint16_t> packed(frameCount * 6);
+		std::vector<Quaternion> frameRotations(frameCount);
+		std::vector<Vector3> frameTranslations(frameCount);
+		for (size_t frame = 0; frame < frameCount; ++frame) {
+			PackRotation(RotationFromJoint(Source(frame), scale), &packed[frame * 6]);
+			PackTranslation(Source(frame).GetPositionVector(), track, &packed[frame * 6 + 3]);
+			frameRotations[frame] = UnpackRotation(&packed[frame * 6]);
+			frameTranslations[frame] = UnpackTranslation(&packed[frame * 6 + 3], track);
+		}
+
+		// checks every frame after 'from' up to and including 'to' against the blend of the two
+		auto SpanFits = [&](size_t from, size_t to) {
+			Matrix4 blended;
+			for (size_t frame = from + 1; frame <= to; ++frame) {
+				float by = (float)(frame - from) / (float)(to - from);
+				ComposeJoint(BlendRotation(frameRotations[from], frameRotations[to], by),
+					frameTranslations[from] + (frameTranslations[to] - frameTranslations[from]) * by, scale, blended);
+				if (JointError(blended, Source(frame)) > MeshAnimation::MAX_JOINT_ERROR) {
+					return false;
+				}
+			}
+			return true;
+		};
+
+		Matrix4 keyed;
+		ComposeJoint(frameRotations[0], frameTranslations[0], scale, keyed);
+		if (JointError(keyed, Source(0)) > MeshAnimation::MAX_JOINT_ERROR) {
+			return false;
+		}
+
+		std::vector<size_t> keys = { 0 };
+		bool still = true;
+		for (size_t frame = 1; frame < frameCount && still; ++frame) {
+			still = JointError(keyed, Source(frame)) <= MeshAnimation::MAX_JOINT_ERROR;
+		}
+		if (!still) {
+			size_t from = 0;
+			while (from < frameCount - 1) {
+				size_t to = from + 1;
+				ComposeJoint(frameRotations[to], frameTranslations[to], scale, keyed);
+				if (JointError(keyed, Source(to)) > MeshAnimation::MAX_JOINT_ERROR) {
+					return false;
+				}
+				while (to + 1 < frameCount && SpanFits(from, to + 1)) {
+					to++;
+				}
+				keys.push_back(to);
+				from = to;
+			}
+		}
+
+		track.firstKey = (uint32_t)keyFrames.size();
+		track.keyCount = (uint32_t)keys.size();
+		for (size_t frame : keys) {
+			keyFrames.push_back((uint16_t)frame);
+			rotations.insert(rotations.end(), &packed[frame * 6], &packed[frame * 6 + 3]);
+			translations.insert(translations.end(), &packed[frame * 6 + 3], &packed[frame * 6 + 6]);
+		}
+		return true;
+	}
+}
+
 MeshAnimation::MeshAnimation() {
 	jointCount	= 0;
 	frameCount	= 0;
@@ -20,7 +319,38 @@ MeshAnimation::MeshAnimation(size_t jointCount, size_t frameCount, float frameRa
 }
 
 MeshAnimation::MeshAnimation(const std::string& filename) : MeshAnimation() {
-	std::ifstream file(Assets::MESHDIR + filename);
+	if (LoadBinaryAnimation(filename)) {
+		return;
+	}
+	if (!LoadTextAnimation(filename)) {
+		return;
+	}
+	WriteBinaryAnimation(filename);
+}
+
+MeshAnimation::~MeshAnimation() {
+
+}
+
+const Matrix4* MeshAnimation::GetJointData(size_t frame) const {
+	if (frame >= frameCount) {
+		return nullptr;
+	}
+	int matStart = frame * jointCount;
+
+	Matrix4* dataStart = (Matrix4*)allJoints.data();
+
+	return dataStart + matStart;
+}
+
+std::string MeshAnimation::GetBinaryAnimationPath(const std::string& filename) {
+	return std::filesystem::path(Assets::MESHDIR + filename).replace_extension(".anmb").string();
+}
+
+bool MeshAnimation::LoadTextAnimation(const std::string& filename) {
+	AssetFile source;
+	source.Open(Assets::MESHDIR + filename);
+	std::ispanstream file(source.GetText());
 
 	std::string filetype;
 	int fileVersion;
@@ -29,13 +359,14 @@ MeshAnimation::MeshAnimation(const std::string& filename) : MeshAnimation() {
 
 	if (filetype != "MeshAnim") {
 		std::cout << __FUNCTION__ << " File is not a MeshAnim file!\n";
-		return;
+		return false;
 	}
 	file >> fileVersion;
 	file >> frameCount;
 	file >> jointCount;
 	file >> frameRate;
 
+	allJoints.clear();
 	allJoints.reserve((size_t)frameCount * jointCount);
 
 	for (unsigned int frame = 0; frame < frameCount; ++frame) {
@@ -49,19 +380,172 @@ MeshAnimation::MeshAnimation(const std::string& filename) : MeshAnimation() {
 			allJoints.emplace_back(mat);
 		}
 	}
+	return !file.fail();
 }
 
-MeshAnimation::~MeshAnimation() {
+bool MeshAnimation::LoadBinaryAnimation(const std::string& filename) {
+	AssetFile file;
+	if (!file.Open(GetBinaryAnimationPath(filename)) || file.GetSize() < sizeof(BinaryAnimHeader)) {
+		return false;
+	}
+	BinaryAnimHeader header;
+	memcpy(&header, file.GetData(), sizeof(header));
+	if (header.magic != BINARY_ANIM_MAGIC || header.version != BINARY_ANIM_VERSION ||
+		header.frameCount == 0 || header.jointCount == 0 || header.keyCount < header.jointCount) {
+		return false;
+	}
+	uint64_t expectedSize = sizeof(BinaryAnimHeader) + (uint64_t)header.jointCount * sizeof(BinaryAnimTrack) +
+		(uint64_t)header.keyCount * 7 * sizeof(uint16_t);
+	if (file.GetSize() != expectedSize) {
+		return false;
+	}
+
+	// a compressed clip can ship without its source, but if the source is there
+	// it has to be the one this was converted from
+	uint64_t sourceSize;
+	int64_t sourceWriteTime;
+	if (GetSourceStamp(Assets::MESHDIR + filename, sourceSize, sourceWriteTime) &&
+		(sourceSize != header.sourceSize || sourceWriteTime != header.sourceWriteTime)) {
+		return false;
+	}
+
+	std::vector<BinaryAnimTrack> tracks(header.jointCount);
+	memcpy(tracks.data(), file.GetData() + sizeof(header), tracks.size() * sizeof(BinaryAnimTrack));
+
+	std::vector<uint16_t> keyData((size_t)header.keyCount * 7);
+	memcpy(keyData.data(), file.GetData() + sizeof(header) + tracks.size() * sizeof(BinaryAnimTrack), keyData.size() * sizeof(uint16_t));
+	const uint16_t* keyFrames		= keyData.data();
+	const uint16_t* rotations		= keyFrames + header.keyCount;
+	const uint16_t* translations	= rotations + (size_t)header.keyCount * 3;
+
+	// everything is checked before the clip is touched, so a bad file leaves it empty
+	for (const BinaryAnimTrack& track : tracks) {
+		if (track.keyCount == 0 || track.firstKey > header.keyCount || track.keyCount > header.keyCount - track.firstKey) {
+			return false;
+		}
+		const uint16_t* frames = keyFrames + track.firstKey;
+		if (frames[0] != 0 || (track.keyCount > 1 && frames[track.keyCount - 1] != header.frameCount - 1)) {
+			return false;
+		}
+		for (uint32_t key = 1; key < track.keyCount; ++key) {
+			if (frames[key] <= frames[key - 1]) {
+				return false;
+			}
+		}
+	}
+
+	frameCount	= header.frameCount;
+	jointCount	= header.jointCount;
+	frameRate	= header.frameRate;
+
+	// Keys are expanded to a rotation, translation and scale per frame and
+	// joint first, then every joint matrix is built in one flat pass, in the
+	// frame major order GetJointData hands out
+	size_t poseCount = frameCount * jointCount;
+	std::vector<Quaternion> poseRotations(poseCount);
+	std::vector<Vector3> poseTranslations(poseCount);
+	std::vector<Vector3> poseScales(poseCount);
+
+	for (size_t joint = 0; joint < jointCount; ++joint) {
+		const BinaryAnimTrack& track = tracks[joint];
+		Vector3 scale(track.scale[0], track.scale[1], track.scale[2]);
+		for (size_t frame = 0; frame < frameCount; ++frame) {
+			poseScales[frame * jointCount + joint] = scale;
+		}
 
+		size_t firstKey = track.firstKey;
+		Quaternion fromRotation = UnpackRotation(&rotations[firstKey * 3]);
+		Vector3 fromTranslation = UnpackTranslation(&translations[firstKey * 3], track);
+		if (track.keyCount == 1) {
+			for (size_t frame = 0; frame < frameCount; ++frame) {
+				poseRotations[frame * jointCount + joint] = fromRotation;
+				poseTranslations[frame * jointCount + joint] = fromTranslation;
+			}
+			continue;
+		}
+		poseRotations[joint] = fromRotation;
+		poseTranslations[joint] = fromTranslation;
+
+		for (size_t key = firstKey + 1; key < firstKey + track.keyCount; ++key) {
+			Quaternion toRotation = UnpackRotation(&rotations[key * 3]);
+			Vector3 toTranslation = UnpackTranslation(&translations[key * 3], track);
+			size_t from = keyFrames[key - 1];
+			size_t to = keyFrames[key];
+			for (size_t frame = from + 1; frame <= to; ++frame) {
+				float by = (float)(frame - from) / (float)(to - from);
+				poseRotations[frame * jointCount + joint] = BlendRotation(fromRotation, toRotation, by);
+				poseTranslations[frame * jointCount + joint] = fromTranslation + (toTranslation - fromTranslation) * by;
+			}
+			fromRotation = toRotation;
+			fromTranslation = toTranslation;
+		}
+	}
+
+	allJoints.resize(poseCount);
+	for (size_t i = 0; i < poseCount; ++i) {
+		ComposeJoint(poseRotations[i], poseTranslations[i], poseScales[i], allJoints[i]);
+	}
+	return true;
 }
 
-const Matrix4* MeshAnimation::GetJointData(size_t frame) const {
-	if (frame >= frameCount) {
-		return nullptr;
+bool MeshAnimation::WriteBinaryAnimation(const std::string& filename) const {
+	if (frameCount == 0 || jointCount == 0 || frameCount > std::numeric_limits<uint16_t>::max() ||
+		allJoints.size() != frameCount * jointCount) {
+		return false;
 	}
-	int matStart = frame * jointCount;
 
-	Matrix4* dataStart = (Matrix4*)allJoints.data();
+	BinaryAnimHeader header = {};
+	header.magic		= BINARY_ANIM_MAGIC;
+	header.version		= BINARY_ANIM_VERSION;
+	header.frameCount	= (uint32_t)frameCount;
+	header.jointCount	= (uint32_t)jointCount;
+	header.frameRate	= frameRate;
+	GetSourceStamp(Assets::MESHDIR + filename, header.sourceSize, header.sourceWriteTime);
 
-	return dataStart + matStart;
-}
\ No newline at end of file
+	std::vector<BinaryAnimTrack> tracks(jointCount);
+	std::vector<uint16_t> keyFrames;
+	std::vector<uint16_t> rotations;
+	std::vector<uint16_t> translations;
+	for (size_t joint = 0; joint < jointCount; ++joint) {
+		if (!CompressTrack(allJoints, joint, jointCount, frameCount, tracks[joint], keyFrames, rotations, translations)) {
+			std::cout << __FUNCTION__ << " can't compress joint " << joint << " of " << filename << " within the error bound\n";
+			return false;
+		}
+	}
+	header.keyCount = (uint32_t)keyFrames.size();
+
+	std::string path = GetBinaryAnimationPath(filename);
+	// written under a temporary name and moved into place, so a loader
+	// on another thread never maps a half written file
+	std::string tempPath = path + "." + std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id())) + ".tmp";
+	{
+		std::ofstream out(tempPath, std::ios::binary | std::ios::trunc);
+		out.write((const char*)&header, sizeof(header));
+		out.write((const char*)tracks.data(), tracks.size() * sizeof(BinaryAnimTrack));
+		out.write((const char*)keyFrames.data(), keyFrames.size() * sizeof(uint16_t));
+		out.write((const char*)rotations.data(), rotations.size() * sizeof(uint16_t));
+		out.write((const char*)translations.data(), translations.size() * sizeof(uint16_t));
+		if (!out) {
+			std::cout << __FUNCTION__ << " can't write a compressed copy of " << filename << "\n";
+			return false;
+		}
+	}
+	std::error_code error;
+	std::filesystem::rename(tempPath, path, error);
+	if (error) {
+		std::filesystem::remove(tempPath, error);
+		return false;
+	}
+	return true;
+}
+
+float MeshAnimation::GetMaxJointError(const MeshAnimation& a, const MeshAnimation& b) {
+	if (a.frameCount != b.frameCount || a.jointCount != b.jointCount || a.allJoints.size() != b.allJoints.size()) {
+		return std::numeric_limits<float>::infinity();
+	}
+	float error = 0.0f;
+	for (size_t i = 0; i < a.allJoints.size(); ++i) {
+		error = std::max(error, JointError(a.allJoints[i], b.allJoints[i]));
+	}
+	return error;
+}
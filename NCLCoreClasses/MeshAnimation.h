@@ -18,8 +18,14 @@ namespace NCL::Rendering {
 
 	class MeshAnimation	{
 	public:
+		//A compressed clip never moves a joint matrix element further than this
+		//from the text clip it was made from
+		static constexpr float MAX_JOINT_ERROR = 0.002f;
+
 		MeshAnimation();
 		MeshAnimation(size_t jointCount, size_t frameCount, float frameRate, std::vector<Maths::Matrix4>& frames);
+		//Uses the compressed clip beside the .anm when it is up to date, otherwise
+		//reads the text file and writes a fresh compressed clip for next time
 		MeshAnimation(const std::string& filename);
 
 		virtual ~MeshAnimation();
@@ -38,6 +44,16 @@ namespace NCL::Rendering {
 
 		const Maths::Matrix4* GetJointData(size_t frame) const;
 
+		bool LoadTextAnimation(const std::string& filename);
+		bool LoadBinaryAnimation(const std::string& filename);
+		bool WriteBinaryAnimation(const std::string& filename) const;
+
+		static std::string GetBinaryAnimationPath(const std::string& filename);
+
+		//Largest difference between any joint matrix element of the two clips,
+		//or infinity if they don't have the same shape
+		static float GetMaxJointError(const MeshAnimation& a, const MeshAnimation& b);
+
 	protected:
 		size_t		jointCount;
 		size_t		frameCount;
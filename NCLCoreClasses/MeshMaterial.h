@@ -16,6 +16,8 @@ namespace NCL {
 	namespace Rendering {
 		class Texture;
 	}
+	using SharedMeshMaterial = std::shared_ptr<class MeshMaterial>;
+
 	class MeshMaterialEntry {
 		friend class MeshMaterial;
 	public:
@@ -13,14 +13,334 @@
 #include "Maths.h"
 
 #include "Mesh.h"
+#include "AssetFile.h"
+
+#include <filesystem>
+#include <spanstream>
+#include <thread>
 
 using namespace NCL;
 using namespace Rendering;
 using namespace Maths;
 
+namespace {
+	constexpr uint32_t BINARY_MESH_MAGIC = 0x4248534D; // "MSHB"
+	constexpr uint32_t BINARY_MESH_VERSION = 1;
+	constexpr size_t BINARY_MESH_ALIGNMENT = 16;
+
+	static_assert(sizeof(Vector2) == 2 * sizeof(float), "binary meshes store Vector2 directly");
+	static_assert(sizeof(Vector3) == 3 * sizeof(float), "binary meshes store Vector3 directly");
+	static_assert(sizeof(Vector4) == 4 * sizeof(float), "binary meshes store Vector4 directly");
+	static_assert(sizeof(Vector4i) == 4 * sizeof(int), "binary meshes store Vector4i directly");
+	static_assert(sizeof(Matrix4) == 16 * sizeof(float), "binary meshes store Matrix4 directly");
+
+	/*
+	A binary mesh is this header, a table of chunks, then each chunk's data
+	at a 16 byte aligned offset. Chunk types match the text format's, and
+	each chunk is a flat array of the type the Mesh stores it as. Name chunks
+	are a uint32 length per name followed by all the characters.
+	The source stamp is the .msh file's size and write time when it was
+	converted, so a re-exported mesh is picked up again.
+	*/
+	struct BinaryMeshHeader {
+		uint32_t magic;
+		uint32_t version;
+		uint64_t sourceSize;
+		int64_t	 sourceWriteTime;
+		uint32_t chunkCount;
+		uint32_t padding;
+	};
+
+	struct BinaryMeshChunk {
+		uint32_t type;
+		uint32_t count;
+		uint64_t offset;
+		uint64_t size;
+	};
+
+	size_t AlignUp(size_t value) {
+		return (value + BINARY_MESH_ALIGNMENT - 1) & ~(BINARY_MESH_ALIGNMENT - 1);
+	}
+
+	bool GetSourceStamp(const std::string& path, uint64_t& size, int64_t& writeTime) {
+		std::error_code error;
+		size = std::filesystem::file_size(path, error);
+		if (error) {
+			return false;
+		}
+		writeTime = (int64_t)std::filesystem::last_write_time(path, error).time_since_epoch().count();
+		return !error;
+	}
+
+	template<typename T>
+	std::span<const T> ChunkData(const AssetFile& file, const BinaryMeshChunk& chunk) {
+		return std::span<const T>((const T*)(file.GetData() + chunk.offset), chunk.count);
+	}
+
+	void ReadNames(const AssetFile& file, const BinaryMeshChunk& chunk, std::vector<std::string>& names) {
+		std::span<const uint32_t> lengths = ChunkData<uint32_t>(file, chunk);
+		const char* chars = file.GetData() + chunk.offset + chunk.count * sizeof(uint32_t);
+		names.reserve(chunk.count);
+		for (uint32_t length : lengths) {
+			names.emplace_back(chars, length);
+			chars += length;
+		}
+	}
+
+	bool NamesFit(const AssetFile& file, const BinaryMeshChunk& chunk) {
+		if (chunk.count > chunk.size / sizeof(uint32_t)) {
+			return false;
+		}
+		uint64_t total = chunk.count * sizeof(uint32_t);
+		for (uint32_t length : ChunkData<uint32_t>(file, chunk)) {
+			total += length;
+		}
+		return total == chunk.size;
+	}
+
+	class BinaryMeshWriter {
+	public:
+		template<typename T>
+		void AddChunk(uint32_t type, const std::vector<T>& data) {
+			if (!data.empty()) {
+				AddChunk(type, (uint32_t)data.size(), data.data(), data.size() * sizeof(T));
+			}
+		}
+
+		void AddNames(uint32_t type, const std::vector<std::string>& names) {
+			if (names.empty()) {
+				return;
+			}
+			std::vector<char> bytes(names.size() * sizeof(uint32_t));
+			for (size_t i = 0; i < names.size(); ++i) {
+				uint32_t length = (uint32_t)names[i].size();
+				memcpy(bytes.data() + i * sizeof(uint32_t), &length, sizeof(uint32_t));
+				bytes.insert(bytes.end(), names[i].begin(), names[i].end());
+			}
+			AddChunk(type, (uint32_t)names.size(), bytes.data(), bytes.size());
+		}
+
+		bool Save(const std::string& path, uint64_t sourceSize, int64_t sourceWriteTime) {
+			BinaryMeshHeader header = {};
+			header.magic			= BINARY_MESH_MAGIC;
+			header.version			= BINARY_MESH_VERSION;
+			header.sourceSize		= sourceSize;
+			header.sourceWriteTime	= sourceWriteTime;
+			header.chunkCount		= (uint32_t)mChunks.size();
+
+			size_t dataStart = AlignUp(sizeof(BinaryMeshHeader) + mChunks.size() * sizeof(BinaryMeshChunk));
+			for (BinaryMeshChunk& chunk : mChunks) {
+				chunk.offset += dataStart;
+			}
+			std::vector<char> file(dataStart, 0);
+			memcpy(file.data(), &header, sizeof(header));
+			memcpy(file.data() + sizeof(header), mChunks.data(), mChunks.size() * sizeof(BinaryMeshChunk));
+			file.insert(file.end(), mData.begin(), mData.end());
+
+			// written under a temporary name and moved into place, so a loader
+			// on another thread never maps a half written file
+			std::string tempPath = path + "." + std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id())) + ".tmp";
+			{
+				std::ofstream out(tempPath, std::ios::binary | std::ios::trunc);
+				if (!out.write(file.data(), file.size())) {
+					return false;
+				}
+			}
+			std::error_code error;
+			std::filesystem::rename(tempPath, path, error);
+			if (error) {
+				std::filesystem::remove(tempPath, error);
+				return false;
+			}
+			return true;
+		}
+
+	protected:
+		void AddChunk(uint32_t type, uint32_t count, const void* data, size_t size) {
+			size_t offset = AlignUp(mData.size());
+			mData.resize(offset + size);
+			memcpy(mData.data() + offset, data, size);
+			mChunks.push_back({ type, count, offset, size });
+		}
+
+		std::vector<BinaryMeshChunk> mChunks;
+		std::vector<char> mData;
+	};
+}
+
 bool MshLoader::LoadMesh(const std::string& filename, Mesh& destinationMesh) {
-	
-	std::ifstream file(Assets::MESHDIR + filename);
+	if (LoadBinaryMesh(filename, destinationMesh)) {
+		return true;
+	}
+	if (!LoadTextMesh(filename, destinationMesh)) {
+		return false;
+	}
+	WriteBinaryMesh(filename, destinationMesh);
+	return true;
+}
+
+std::string MshLoader::GetBinaryMeshPath(const std::string& filename) {
+	return std::filesystem::path(Assets::MESHDIR + filename).replace_extension(".mshb").string();
+}
+
+size_t MshLoader::GetBinaryElementSize(GeometryChunkTypes chunkType) {
+	switch (chunkType) {
+	case GeometryChunkTypes::VPositions:		return sizeof(Vector3);
+	case GeometryChunkTypes::VNormals:			return sizeof(Vector3);
+	case GeometryChunkTypes::VTangents:			return sizeof(Vector4);
+	case GeometryChunkTypes::VColors:			return sizeof(Vector4);
+	case GeometryChunkTypes::VTex0:				return sizeof(Vector2);
+	case GeometryChunkTypes::VWeightValues:		return sizeof(Vector4);
+	case GeometryChunkTypes::VWeightIndices:	return sizeof(Vector4i);
+	case GeometryChunkTypes::Indices:			return sizeof(unsigned int);
+	case GeometryChunkTypes::JointParents:		return sizeof(int);
+	case GeometryChunkTypes::BindPose:			return sizeof(Matrix4);
+	case GeometryChunkTypes::BindPoseInv:		return sizeof(Matrix4);
+	case GeometryChunkTypes::SubMeshes:			return sizeof(SubMesh);
+	case GeometryChunkTypes::BindPoseIndices:	return sizeof(int);
+	case GeometryChunkTypes::BindPoseStates:	return sizeof(Mesh::SubMeshPoses);
+	default:									return 0;
+	}
+}
+
+bool MshLoader::LoadBinaryMesh(const std::string& filename, Mesh& destinationMesh) {
+	AssetFile file;
+	if (!file.Open(GetBinaryMeshPath(filename)) || file.GetSize() < sizeof(BinaryMeshHeader)) {
+		return false;
+	}
+	BinaryMeshHeader header;
+	memcpy(&header, file.GetData(), sizeof(header));
+	if (header.magic != BINARY_MESH_MAGIC || header.version != BINARY_MESH_VERSION ||
+		header.chunkCount > (file.GetSize() - sizeof(header)) / sizeof(BinaryMeshChunk)) {
+		return false;
+	}
+
+	// a binary mesh can ship without its source, but if the source is there
+	// it has to be the one this was converted from
+	uint64_t sourceSize;
+	int64_t sourceWriteTime;
+	if (GetSourceStamp(Assets::MESHDIR + filename, sourceSize, sourceWriteTime) &&
+		(sourceSize != header.sourceSize || sourceWriteTime != header.sourceWriteTime)) {
+		return false;
+	}
+
+	std::vector<BinaryMeshChunk> chunks(header.chunkCount);
+	memcpy(chunks.data(), file.GetData() + sizeof(header), chunks.size() * sizeof(BinaryMeshChunk));
+
+	// everything is checked before the mesh is touched, so a bad file leaves it empty
+	for (const BinaryMeshChunk& chunk : chunks) {
+		if (chunk.offset % BINARY_MESH_ALIGNMENT != 0 || chunk.offset > file.GetSize() || chunk.size > file.GetSize() - chunk.offset) {
+			return false;
+		}
+		GeometryChunkTypes type = (GeometryChunkTypes)chunk.type;
+		if (type == GeometryChunkTypes::JointNames || type == GeometryChunkTypes::SubMeshNames) {
+			if (!NamesFit(file, chunk)) {
+				return false;
+			}
+		}
+		else if (GetBinaryElementSize(type) == 0 || (uint64_t)chunk.count * GetBinaryElementSize(type) != chunk.size) {
+			return false;
+		}
+	}
+
+	for (const BinaryMeshChunk& chunk : chunks) {
+		switch ((GeometryChunkTypes)chunk.type) {
+		case GeometryChunkTypes::VPositions:
+			destinationMesh.AssignVertexPositions(ChunkData<Vector3>(file, chunk));
+			break;
+		case GeometryChunkTypes::VNormals:
+			destinationMesh.AssignVertexNormals(ChunkData<Vector3>(file, chunk));
+			break;
+		case GeometryChunkTypes::VTangents:
+			destinationMesh.AssignVertexTangents(ChunkData<Vector4>(file, chunk));
+			break;
+		case GeometryChunkTypes::VColors:
+			destinationMesh.AssignVertexColours(ChunkData<Vector4>(file, chunk));
+			break;
+		case GeometryChunkTypes::VTex0:
+			destinationMesh.AssignVertexTextureCoords(ChunkData<Vector2>(file, chunk));
+			break;
+		case GeometryChunkTypes::VWeightValues:
+			destinationMesh.AssignVertexSkinWeights(ChunkData<Vector4>(file, chunk));
+			break;
+		case GeometryChunkTypes::VWeightIndices:
+			destinationMesh.AssignVertexSkinIndices(ChunkData<Vector4i>(file, chunk));
+			break;
+		case GeometryChunkTypes::Indices:
+			destinationMesh.AssignVertexIndices(ChunkData<unsigned int>(file, chunk));
+			break;
+		case GeometryChunkTypes::JointParents:
+			destinationMesh.AssignJointParents(ChunkData<int>(file, chunk));
+			break;
+		case GeometryChunkTypes::BindPose:
+			destinationMesh.AssignBindPose(ChunkData<Matrix4>(file, chunk));
+			break;
+		case GeometryChunkTypes::BindPoseInv:
+			destinationMesh.AssignInverseBindPose(ChunkData<Matrix4>(file, chunk));
+			break;
+		case GeometryChunkTypes::SubMeshes:
+			destinationMesh.AssignSubMeshes(ChunkData<SubMesh>(file, chunk));
+			break;
+		case GeometryChunkTypes::BindPoseIndices:
+			destinationMesh.AssignBindPoseIndices(ChunkData<int>(file, chunk));
+			break;
+		case GeometryChunkTypes::BindPoseStates:
+			destinationMesh.AssignBindPoseStates(ChunkData<Mesh::SubMeshPoses>(file, chunk));
+			break;
+		case GeometryChunkTypes::JointNames: {
+			std::vector<std::string> jointNames;
+			ReadNames(file, chunk, jointNames);
+			destinationMesh.SetJointNames(jointNames);
+		}break;
+		case GeometryChunkTypes::SubMeshNames: {
+			std::vector<std::string> subMeshNames;
+			ReadNames(file, chunk, subMeshNames);
+			destinationMesh.SetSubMeshNames(subMeshNames);
+		}break;
+		default:
+			break;
+		}
+	}
+
+	destinationMesh.SetPrimitiveType(GeometryPrimitive::Triangles);
+
+	return true;
+}
+
+bool MshLoader::WriteBinaryMesh(const std::string& filename, const Mesh& sourceMesh) {
+	uint64_t sourceSize = 0;
+	int64_t sourceWriteTime = 0;
+	GetSourceStamp(Assets::MESHDIR + filename, sourceSize, sourceWriteTime);
+
+	BinaryMeshWriter writer;
+	writer.AddChunk((uint32_t)GeometryChunkTypes::VPositions,		sourceMesh.GetPositionData());
+	writer.AddChunk((uint32_t)GeometryChunkTypes::VNormals,			sourceMesh.GetNormalData());
+	writer.AddChunk((uint32_t)GeometryChunkTypes::VTangents,		sourceMesh.GetTangentData());
+	writer.AddChunk((uint32_t)GeometryChunkTypes::VColors,			sourceMesh.GetColourData());
+	writer.AddChunk((uint32_t)GeometryChunkTypes::VTex0,			sourceMesh.GetTextureCoordData());
+	writer.AddChunk((uint32_t)GeometryChunkTypes::VWeightValues,	sourceMesh.GetSkinWeightData());
+	writer.AddChunk((uint32_t)GeometryChunkTypes::VWeightIndices,	sourceMesh.GetSkinIndexData());
+	writer.AddChunk((uint32_t)GeometryChunkTypes::Indices,			sourceMesh.GetIndexData());
+	writer.AddNames((uint32_t)GeometryChunkTypes::JointNames,		sourceMesh.GetJointNames());
+	writer.AddChunk((uint32_t)GeometryChunkTypes::JointParents,		sourceMesh.GetJointParents());
+	writer.AddChunk((uint32_t)GeometryChunkTypes::BindPose,			sourceMesh.GetBindPose());
+	writer.AddChunk((uint32_t)GeometryChunkTypes::BindPoseInv,		sourceMesh.GetInverseBindPose());
+	writer.AddChunk((uint32_t)GeometryChunkTypes::SubMeshes,		sourceMesh.GetSubMeshes());
+	writer.AddNames((uint32_t)GeometryChunkTypes::SubMeshNames,		sourceMesh.GetSubMeshNames());
+	writer.AddChunk((uint32_t)GeometryChunkTypes::BindPoseIndices,	sourceMesh.GetBindPoseIndexData());
+	writer.AddChunk((uint32_t)GeometryChunkTypes::BindPoseStates,	sourceMesh.GetBindPoseStates());
+
+	if (!writer.Save(GetBinaryMeshPath(filename), sourceSize, sourceWriteTime)) {
+		std::cout << __FUNCTION__ << " can't write a binary copy of " << filename << "\n";
+		return false;
+	}
+	return true;
+}
+
+bool MshLoader::LoadTextMesh(const std::string& filename, Mesh& destinationMesh) {
+	AssetFile source;
+	source.Open(Assets::MESHDIR + filename);
+	std::ispanstream file(source.GetText());
 
 	std::string filetype;
 	int fileVersion;
@@ -148,7 +468,7 @@ bool MshLoader::LoadMesh(const std::string& filename, Mesh& destinationMesh) {
 
 	return true;
 }
-void MshLoader::ReadIntegerArray(std::ifstream& file, vector<int>& into) {//New!
+void MshLoader::ReadIntegerArray(std::istream& file, vector<int>& into) {//New!
 	int count = 0;
 	file >> count;
 	for (int i = 0; i < count; ++i) {
@@ -158,7 +478,7 @@ void MshLoader::ReadIntegerArray(std::ifstream& file, vector<int>& into) {//New!
 	}
 }
 
-void MshLoader::ReadBindposes(std::ifstream& file, vector<Mesh::SubMeshPoses>& bindPoses) {//New!
+void MshLoader::ReadBindposes(std::istream& file, vector<Mesh::SubMeshPoses>& bindPoses) {//New!
 	int poseCount = 0;
 	file >> poseCount;
 
@@ -170,7 +490,7 @@ void MshLoader::ReadBindposes(std::ifstream& file, vector<Mesh::SubMeshPoses>& b
 	}
 }
 
-void MshLoader::ReadRigPose(std::ifstream& file, vector<Matrix4>& into) {
+void MshLoader::ReadRigPose(std::istream& file, vector<Matrix4>& into) {
 	int matCount = 0;
 	file >> matCount;
 
@@ -187,7 +507,7 @@ void MshLoader::ReadRigPose(std::ifstream& file, vector<Matrix4>& into) {
 	}
 }
 
-void MshLoader::ReadJointParents(std::ifstream& file, std::vector<int>& parentIDs) {
+void MshLoader::ReadJointParents(std::istream& file, std::vector<int>& parentIDs) {
 	int jointCount = 0;
 	file >> jointCount;
 
@@ -198,7 +518,7 @@ void MshLoader::ReadJointParents(std::ifstream& file, std::vector<int>& parentID
 	}
 }
 
-void MshLoader::ReadJointNames(std::ifstream& file, std::vector<std::string>& jointNames) {
+void MshLoader::ReadJointNames(std::istream& file, std::vector<std::string>& jointNames) {
 	int jointCount = 0;
 	file >> jointCount;
 	std::string jointName;
@@ -211,7 +531,7 @@ void MshLoader::ReadJointNames(std::ifstream& file, std::vector<std::string>& jo
 	}
 }
 
-void MshLoader::ReadSubMeshes(std::ifstream& file, int count, std::vector<SubMesh>& subMeshes) {
+void MshLoader::ReadSubMeshes(std::istream& file, int count, std::vector<SubMesh>& subMeshes) {
 	for (int i = 0; i < count; ++i) {
 		SubMesh m;
 		file >> m.start;
@@ -220,7 +540,7 @@ void MshLoader::ReadSubMeshes(std::ifstream& file, int count, std::vector<SubMes
 	}
 }
 
-void MshLoader::ReadSubMeshNames(std::ifstream& file, int count, std::vector<std::string>& subMeshNames) {
+void MshLoader::ReadSubMeshNames(std::istream& file, int count, std::vector<std::string>& subMeshNames) {
 	std::string scrap;
 	std::getline(file, scrap);
 
@@ -256,7 +576,7 @@ void* MshLoader::ReadVertexData(GeometryChunkData dataType, GeometryChunkTypes c
 	return data;
 }
 
-void MshLoader::ReadTextInts(std::ifstream& file, vector<Vector2i>& element, int numVertices) {
+void MshLoader::ReadTextInts(std::istream& file, vector<Vector2i>& element, int numVertices) {
 	for (int i = 0; i < numVertices; ++i) {
 		Vector2i temp;
 		file >> temp[0];
@@ -265,7 +585,7 @@ void MshLoader::ReadTextInts(std::ifstream& file, vector<Vector2i>& element, int
 	}
 }
 
-void MshLoader::ReadTeReadTextIntsxtFloats(std::ifstream& file, vector<Vector3i>& element, int numVertices) {
+void MshLoader::ReadTeReadTextIntsxtFloats(std::istream& file, vector<Vector3i>& element, int numVertices) {
 	for (int i = 0; i < numVertices; ++i) {
 		Vector3i temp;
 		file >> temp[0];
@@ -275,7 +595,7 @@ void MshLoader::ReadTeReadTextIntsxtFloats(std::ifstream& file, vector<Vector3i>
 	}
 }
 
-void MshLoader::ReadTextInts(std::ifstream& file, vector<Vector4i>& element, int numVertices) {
+void MshLoader::ReadTextInts(std::istream& file, vector<Vector4i>& element, int numVertices) {
 	for (int i = 0; i < numVertices; ++i) {
 		Vector4i temp;
 		file >> temp[0];
@@ -286,7 +606,7 @@ void MshLoader::ReadTextInts(std::ifstream& file, vector<Vector4i>& element, int
 	}
 }
 
-void MshLoader::ReadTextFloats(std::ifstream& file, vector<Vector2>& element, int numVertices) {
+void MshLoader::ReadTextFloats(std::istream& file, vector<Vector2>& element, int numVertices) {
 	for (int i = 0; i < numVertices; ++i) {
 		Vector2 temp;
 		file >> temp.x;
@@ -295,7 +615,7 @@ void MshLoader::ReadTextFloats(std::ifstream& file, vector<Vector2>& element, in
 	}
 }
 
-void MshLoader::ReadTextFloats(std::ifstream& file, vector<Vector3>& element, int numVertices) {
+void MshLoader::ReadTextFloats(std::istream& file, vector<Vector3>& element, int numVertices) {
 	for (int i = 0; i < numVertices; ++i) {
 		Vector3 temp;
 		file >> temp.x;
@@ -305,7 +625,7 @@ void MshLoader::ReadTextFloats(std::ifstream& file, vector<Vector3>& element, in
 	}
 }
 
-void MshLoader::ReadTextFloats(std::ifstream& file, vector<Vector4>& element, int numVertices) {
+void MshLoader::ReadTextFloats(std::istream& file, vector<Vector4>& element, int numVertices) {
 	for (int i = 0; i < numVertices; ++i) {
 		Vector4 temp;
 		file >> temp.x;
@@ -316,7 +636,7 @@ void MshLoader::ReadTextFloats(std::ifstream& file, vector<Vector4>& element, in
 	}
 }
 
-void MshLoader::ReadIntegers(std::ifstream& file, vector<unsigned int>& elements, int intCount) {
+void MshLoader::ReadIntegers(std::istream& file, vector<unsigned int>& elements, int intCount) {
 	for (int i = 0; i < intCount; ++i) {
 		unsigned int temp;
 		file >> temp;
@@ -56,27 +56,35 @@ namespace NCL::Rendering {
 	};
 
 	public:		
+		//Uses the binary copy beside the .msh when it is up to date, otherwise
+		//reads the text file and writes a fresh binary copy for next time
 		static bool LoadMesh(const std::string& filename, Mesh& destinationMesh);
 
+		static bool LoadTextMesh(const std::string& filename, Mesh& destinationMesh);
+		static bool LoadBinaryMesh(const std::string& filename, Mesh& destinationMesh);
+		static bool WriteBinaryMesh(const std::string& filename, const Mesh& sourceMesh);
 
+		static std::string GetBinaryMeshPath(const std::string& filename);
 
 	protected:
+		static size_t GetBinaryElementSize(GeometryChunkTypes chunkType);
+
 		static void* ReadVertexData(GeometryChunkData dataType, GeometryChunkTypes chunkType, int numVertices);
-		static void ReadTextInts(std::ifstream& file, vector<Maths::Vector2i>& element, int numVertices);
-		static void ReadTeReadTextIntsxtFloats(std::ifstream& file, vector<Maths::Vector3i>& element, int numVertices);
-		static void ReadTextInts(std::ifstream& file, vector<Maths::Vector4i>& element, int numVertices);
-		static void ReadTextFloats(std::ifstream& file, vector<Maths::Vector2>& element, int numVertices);
-		static void ReadTextFloats(std::ifstream& file, vector<Maths::Vector3>& element, int numVertices);
-		static void ReadTextFloats(std::ifstream& file, vector<Maths::Vector4>& element, int numVertices);
-		static void ReadIntegers(std::ifstream& file, vector<unsigned int>& elements, int intCount);
-
-		static void ReadRigPose(std::ifstream& file, vector<Maths::Matrix4>& into);
-		static void ReadJointParents(std::ifstream& file, std::vector<int>& parentIDs);
-		static void ReadJointNames(std::ifstream& file, std::vector<std::string>& names);
-		static void ReadSubMeshes(std::ifstream& file, int count, std::vector<struct SubMesh>& subMeshes);
-		static void ReadSubMeshNames(std::ifstream& file, int count, std::vector<std::string>& names);
-		static void ReadIntegerArray(std::ifstream& file, vector<int>& into);
-		static void ReadBindposes(std::ifstream& file, vector<Mesh::SubMeshPoses>& bindPoses);
+		static void ReadTextInts(std::istream& file, vector<Maths::Vector2i>& element, int numVertices);
+		static void ReadTeReadTextIntsxtFloats(std::istream& file, vector<Maths::Vector3i>& element, int numVertices);
+		static void ReadTextInts(std::istream& file, vector<Maths::Vector4i>& element, int numVertices);
+		static void ReadTextFloats(std::istream& file, vector<Maths::Vector2>& element, int numVertices);
+		static void ReadTextFloats(std::istream& file, vector<Maths::Vector3>& element, int numVertices);
+		static void ReadTextFloats(std::istream& file, vector<Maths::Vector4>& element, int numVertices);
+		static void ReadIntegers(std::istream& file, vector<unsigned int>& elements, int intCount);
+
+		static void ReadRigPose(std::istream& file, vector<Maths::Matrix4>& into);
+		static void ReadJointParents(std::istream& file, std::vector<int>& parentIDs);
+		static void ReadJointNames(std::istream& file, std::vector<std::string>& names);
+		static void ReadSubMeshes(std::istream& file, int count, std::vector<struct SubMesh>& subMeshes);
+		static void ReadSubMeshNames(std::istream& file, int count, std::vector<std::string>& names);
+		static void ReadIntegerArray(std::istream& file, vector<int>& into);
+		static void ReadBindposes(std::istream& file, vector<Mesh::SubMeshPoses>& bindPoses);
 
 		MshLoader() {}
 		~MshLoader() {}
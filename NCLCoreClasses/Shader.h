@@ -9,6 +9,8 @@ https://research.ncl.ac.uk/game/
 #pragma once
 
 namespace NCL::Rendering {
+	using SharedShader = std::shared_ptr<class Shader>;
+
 	namespace ShaderStages {
 		enum Type : uint32_t {
 			Vertex,
@@ -0,0 +1,345 @@
+#include "TextureCompressor.h"
+
+#include <cmath>
+#include <limits>
+
+using namespace NCL;
+using namespace Rendering;
+
+namespace {
+	uint16_t PackColour565(const float colour[3]) {
+		int r = std::clamp((int)std::lround(colour[0] * 31.0f / 255.0f), 0, 31);
+		int g = std::clamp((int)std::lround(colour[1] * 63.0f / 255.0f), 0, 63);
+		int b = std::clamp((int)std::lround(colour[2] * 31.0f / 255.0f), 0, 31);
+		return (uint16_t)((r << 11) | (g << 5) | b);
+	}
+
+	void UnpackColour565(uint16_t packed, int colour[3]) {
+		int r = (packed >> 11) & 31;
+		int g = (packed >> 5) & 63;
+		int b = packed & 31;
+		colour[0] = (r << 3) | (r >> 2);
+		colour[1] = (g << 2) | (g >> 4);
+		colour[2] = (b << 3) | (b >> 2);
+	}
+
+	//Both palettes follow the D3D rounding, which is what GL drivers match
+	void BuildColourPalette(uint16_t c0, uint16_t c1, int palette[4][4]) {
+		UnpackColour565(c0, palette[0]);
+		UnpackColour565(c1, palette[1]);
+		for (int i = 0; i < 3; ++i) {
+			if (c0 > c1) {
+				palette[2][i] = (2 * palette[0][i] + palette[1][i]) / 3;
+				palette[3][i] = (palette[0][i] + 2 * palette[1][i]) / 3;
+			}
+			else {
+				palette[2][i] = (palette[0][i] + palette[1][i]) / 2;
+				palette[3][i] = 0;
+			}
+		}
+		palette[0][3] = palette[1][3] = palette[2][3] = 255;
+		palette[3][3] = c0 > c1 ? 255 : 0;
+	}
+
+	void BuildChannelPalette(uint8_t a0, uint8_t a1, int palette[8]) {
+		palette[0] = a0;
+		palette[1] = a1;
+		if (a0 > a1) {
+			for (int i = 1; i < 7; ++i) {
+				palette[i + 1] = ((7 - i) * a0 + i * a1) / 7;
+			}
+		}
+		else {
+			for (int i = 1; i < 5; ++i) {
+				palette[i + 1] = ((5 - i) * a0 + i * a1) / 5;
+			}
+			palette[6] = 0;
+			palette[7] = 255;
+		}
+	}
+
+	void WriteLE(uint8_t* out, uint64_t value, int bytes) {
+		for (int i = 0; i < bytes; ++i) {
+			out[i] = (uint8_t)(value >> (i * 8));
+		}
+	}
+
+	uint64_t ReadLE(const uint8_t* in, int bytes) {
+		uint64_t value = 0;
+		for (int i = 0; i < bytes; ++i) {
+			value |= (uint64_t)in[i] << (i * 8);
+		}
+		return value;
+	}
+}
+
+size_t TextureCompressor::GetBlockBytes(TextureFormat format) {
+	switch (format) {
+	case TextureFormat::BC1:	return 8;
+	case TextureFormat::BC3:	return 16;
+	case TextureFormat::BC5:	return 16;
+	default:					return 0;
+	}
+}
+
+size_t TextureCompressor::GetLevelBytes(TextureFormat format, int width, int height) {
+	if (format == TextureFormat::RGBA8) {
+		return (size_t)width * height * 4;
+	}
+	size_t blocksWide = std::max(1, (width + 3) / 4);
+	size_t blocksHigh = std::max(1, (height + 3) / 4);
+	return blocksWide * blocksHigh * GetBlockBytes(format);
+}
+
+void TextureCompressor::Compress(TextureFormat format, const uint8_t* rgba, int width, int height, uint8_t* out) {
+	if (format == TextureFormat::RGBA8) {
+		memcpy(out, rgba, (size_t)width * height * 4);
+		return;
+	}
+	size_t blockBytes = GetBlockBytes(format);
+	uint8_t block[16][4];
+	for (int blockY = 0; blockY < height; blockY += 4) {
+		for (int blockX = 0; blockX < width; blockX += 4) {
+			for (int y = 0; y < 4; ++y) {
+				for (int x = 0; x < 4; ++x) {
+					int sourceX = std::min(blockX + x, width - 1);
+					int sourceY = std::min(blockY + y, height - 1);
+					memcpy(block[y * 4 + x], rgba + ((size_t)sourceY * width + sourceX) * 4, 4);
+				}
+			}
+			switch (format) {
+			case TextureFormat::BC1:
+				CompressColourBlock(block, out);
+				break;
+			case TextureFormat::BC3:
+				CompressChannelBlock(block, 3, out);
+				CompressColourBlock(block, out + 8);
+				break;
+			case TextureFormat::BC5:
+				CompressChannelBlock(block, 0, out);
+				CompressChannelBlock(block, 1, out + 8);
+				break;
+			default:
+				break;
+			}
+			out += blockBytes;
+		}
+	}
+}
+
+void TextureCompressor::Decompress(TextureFormat format, const uint8_t* in, int width, int height, uint8_t* rgba) {
+	if (format == TextureFormat::RGBA8) {
+		memcpy(rgba, in, (size_t)width * height * 4);
+		return;
+	}
+	size_t blockBytes = GetBlockBytes(format);
+	uint8_t block[16][4];
+	for (int blockY = 0; blockY < height; blockY += 4) {
+		for (int blockX = 0; blockX < width; blockX += 4) {
+			switch (format) {
+			case TextureFormat::BC1:
+				DecompressColourBlock(in, block);
+				break;
+			case TextureFormat::BC3:
+				DecompressColourBlock(in + 8, block);
+				DecompressChannelBlock(in, 3, block);
+				break;
+			case TextureFormat::BC5:
+				DecompressChannelBlock(in, 0, block);
+				DecompressChannelBlock(in + 8, 1, block);
+				for (int i = 0; i < 16; ++i) {
+					block[i][2] = 0;
+					block[i][3] = 255;
+				}
+				break;
+			default:
+				break;
+			}
+			for (int y = 0; y < 4 && blockY + y < height; ++y) {
+				for (int x = 0; x < 4 && blockX + x < width; ++x) {
+					memcpy(rgba + ((size_t)(blockY + y) * width + blockX + x) * 4, block[y * 4 + x], 4);
+				}
+			}
+			in += blockBytes;
+		}
+	}
+}
+
+void TextureCompressor::Downsample(const uint8_t* rgba, int width, int height, uint8_t* out, bool isNormalMap) {
+	int outWidth = std::max(1, width / 2);
+	int outHeight = std::max(1, height / 2);
+	for (int y = 0; y < outHeight; ++y) {
+		for (int x = 0; x < outWidth; ++x) {
+			int x0 = std::min(x * 2, width - 1);
+			int x1 = std::min(x * 2 + 1, width - 1);
+			int y0 = std::min(y * 2, height - 1);
+			int y1 = std::min(y * 2 + 1, height - 1);
+			const uint8_t* texels[4] = {
+				rgba + ((size_t)y0 * width + x0) * 4,
+				rgba + ((size_t)y0 * width + x1) * 4,
+				rgba + ((size_t)y1 * width + x0) * 4,
+				rgba + ((size_t)y1 * width + x1) * 4
+			};
+			float sum[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+			for (const uint8_t* texel : texels) {
+				for (int i = 0; i < 4; ++i) {
+					sum[i] += texel[i] * 0.25f;
+				}
+			}
+			if (isNormalMap) {
+				float normal[3];
+				float length = 0.0f;
+				for (int i = 0; i < 3; ++i) {
+					normal[i] = sum[i] / 127.5f - 1.0f;
+					length += normal[i] * normal[i];
+				}
+				length = std::sqrt(length);
+				if (length > 0.0f) {
+					for (int i = 0; i < 3; ++i) {
+						sum[i] = (normal[i] / length + 1.0f) * 127.5f;
+					}
+				}
+			}
+			uint8_t* texel = out + ((size_t)y * outWidth + x) * 4;
+			for (int i = 0; i < 4; ++i) {
+				texel[i] = (uint8_t)std::clamp((int)std::lround(sum[i]), 0, 255);
+			}
+		}
+	}
+}
+
+/*
+The endpoints are the block's extremes along its principal axis, pulled in
+slightly as the end colours are rarely hit exactly. The block is always
+written in four colour mode, so BC1 never picks up the punch through alpha.
+*/
+void TextureCompressor::CompressColourBlock(const uint8_t block[16][4], uint8_t* out) {
+	float mean[3] = { 0.0f, 0.0f, 0.0f };
+	for (int i = 0; i < 16; ++i) {
+		for (int c = 0; c < 3; ++c) {
+			mean[c] += block[i][c] / 16.0f;
+		}
+	}
+	float covariance[6] = { 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f };
+	for (int i = 0; i < 16; ++i) {
+		float r = block[i][0] - mean[0];
+		float g = block[i][1] - mean[1];
+		float b = block[i][2] - mean[2];
+		covariance[0] += r * r;
+		covariance[1] += r * g;
+		covariance[2] += r * b;
+		covariance[3] += g * g;
+		covariance[4] += g * b;
+		covariance[5] += b * b;
+	}
+	float axis[3] = { 1.0f, 1.0f, 1.0f };
+	for (int iteration = 0; iteration < 8; ++iteration) {
+		float next[3] = {
+			covariance[0] * axis[0] + covariance[1] * axis[1] + covariance[2] * axis[2],
+			covariance[1] * axis[0] + covariance[3] * axis[1] + covariance[4] * axis[2],
+			covariance[2] * axis[0] + covariance[4] * axis[1] + covariance[5] * axis[2]
+		};
+		float length = std::max({ std::abs(next[0]), std::abs(next[1]), std::abs(next[2]) });
+		if (length <= 0.0f) {
+			break;
+		}
+		for (int c = 0; c < 3; ++c) {
+			axis[c] = next[c] / length;
+		}
+	}
+
+	float minProjection = std::numeric_limits<float>::max();
+	float maxProjection = -std::numeric_limits<float>::max();
+	for (int i = 0; i < 16; ++i) {
+		float projection = (block[i][0] - mean[0]) * axis[0] + (block[i][1] - mean[1]) * axis[1] + (block[i][2] - mean[2]) * axis[2];
+		minProjection = std::min(minProjection, projection);
+		maxProjection = std::max(maxProjection, projection);
+	}
+	float axisLengthSquared = axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2];
+	float inset = (maxProjection - minProjection) / 16.0f;
+	float maxColour[3];
+	float minColour[3];
+	for (int c = 0; c < 3; ++c) {
+		maxColour[c] = mean[c] + axis[c] * (maxProjection - inset) / axisLengthSquared;
+		minColour[c] = mean[c] + axis[c] * (minProjection + inset) / axisLengthSquared;
+	}
+
+	uint16_t c0 = PackColour565(maxColour);
+	uint16_t c1 = PackColour565(minColour);
+	if (c0 < c1) {
+		std::swap(c0, c1);
+	}
+	uint32_t indices = 0;
+	if (c0 != c1) {
+		int palette[4][4];
+		BuildColourPalette(c0, c1, palette);
+		for (int i = 0; i < 16; ++i) {
+			int best = 0;
+			int bestDistance = std::numeric_limits<int>::max();
+			for (int p = 0; p < 4; ++p) {
+				int dr = block[i][0] - palette[p][0];
+				int dg = block[i][1] - palette[p][1];
+				int db = block[i][2] - palette[p][2];
+				int distance = dr * dr + dg * dg + db * db;
+				if (distance < bestDistance) {
+					bestDistance = distance;
+					best = p;
+				}
+			}
+			indices |= (uint32_t)best << (i * 2);
+		}
+	}
+	WriteLE(out, c0, 2);
+	WriteLE(out + 2, c1, 2);
+	WriteLE(out + 4, indices, 4);
+}
+
+//Always the eight value mode, so the block's own extremes come back exactly
+void TextureCompressor::CompressChannelBlock(const uint8_t block[16][4], int channel, uint8_t* out) {
+	uint8_t a0 = 0;
+	uint8_t a1 = 255;
+	for (int i = 0; i < 16; ++i) {
+		a0 = std::max(a0, block[i][channel]);
+		a1 = std::min(a1, block[i][channel]);
+	}
+	uint64_t indices = 0;
+	if (a0 != a1) {
+		int palette[8];
+		BuildChannelPalette(a0, a1, palette);
+		for (int i = 0; i < 16; ++i) {
+			int best = 0;
+			for (int p = 1; p < 8; ++p) {
+				if (std::abs(block[i][channel] - palette[p]) < std::abs(block[i][channel] - palette[best])) {
+					best = p;
+				}
+			}
+			indices |= (uint64_t)best << (i * 3);
+		}
+	}
+	out[0] = a0;
+	out[1] = a1;
+	WriteLE(out + 2, indices, 6);
+}
+
+void TextureCompressor::DecompressColourBlock(const uint8_t* in, uint8_t block[16][4]) {
+	uint16_t c0 = (uint16_t)ReadLE(in, 2);
+	uint16_t c1 = (uint16_t)ReadLE(in + 2, 2);
+	uint32_t indices = (uint32_t)ReadLE(in + 4, 4);
+	int palette[4][4];
+	BuildColourPalette(c0, c1, palette);
+	for (int i = 0; i < 16; ++i) {
+		int index = (indices >> (i * 2)) & 3;
+		for (int c = 0; c < 4; ++c) {
+			block[i][c] = (uint8_t)palette[index][c];
+		}
+	}
+}
+
+void TextureCompressor::DecompressChannelBlock(const uint8_t* in, int channel, uint8_t block[16][4]) {
+	uint64_t indices = ReadLE(in + 2, 6);
+	int palette[8];
+	BuildChannelPalette(in[0], in[1], palette);
+	for (int i = 0; i < 16; ++i) {
+		block[i][channel] = (uint8_t)palette[(indices >> (i * 3)) & 7];
+	}
+}
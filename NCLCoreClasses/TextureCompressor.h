@@ -0,0 +1,39 @@
+#pragma once
+
+namespace NCL::Rendering {
+	enum class TextureFormat : uint32_t {
+		RGBA8,
+		BC1,	//RGB, 4 bits per pixel
+		BC3,	//RGBA, 8 bits per pixel
+		BC5,	//RG, 8 bits per pixel, for normal maps
+	};
+
+	/*
+	CPU side block compression for cooking textures, plus the matching
+	decompression so cooked textures can be checked against their source.
+	Images are always tightly packed RGBA8; blocks that hang off the edge of
+	an image repeat its last row and column.
+	*/
+	class TextureCompressor {
+	public:
+		static size_t GetBlockBytes(TextureFormat format);
+		static size_t GetLevelBytes(TextureFormat format, int width, int height);
+
+		static void Compress(TextureFormat format, const uint8_t* rgba, int width, int height, uint8_t* out);
+		static void Decompress(TextureFormat format, const uint8_t* in, int width, int height, uint8_t* rgba);
+
+		//Halves an image with a box filter, rounding odd sizes down. Normal map
+		//texels are renormalised after filtering
+		static void Downsample(const uint8_t* rgba, int width, int height, uint8_t* out, bool isNormalMap);
+
+	protected:
+		static void CompressColourBlock(const uint8_t block[16][4], uint8_t* out);
+		static void CompressChannelBlock(const uint8_t block[16][4], int channel, uint8_t* out);
+
+		static void DecompressColourBlock(const uint8_t* in, uint8_t block[16][4]);
+		static void DecompressChannelBlock(const uint8_t* in, int channel, uint8_t block[16][4]);
+
+		TextureCompressor() {}
+		~TextureCompressor() {}
+	};
+}
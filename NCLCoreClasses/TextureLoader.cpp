@@ -11,7 +11,9 @@ https://research.ncl.ac.uk/game/
 
 #include "./stb/stb_image.h"
 
+#include "AssetFile.h"
 #include "Assets.h"
+#include "CookedTexture.h"
 
 using namespace NCL;
 using namespace Rendering;
@@ -29,11 +31,9 @@ bool TextureLoader::LoadTexture(const std::string& filename, char*& outData, int
 	
 	std::string extension = path.extension().string();
 
-	bool isAbsolute = path.is_absolute();
-
 	auto it = fileHandlers.find(extension);
 
-	std::string realPath = isAbsolute ? filename : Assets::TEXTUREDIR + filename;
+	std::string realPath = GetTexturePath(filename);
 
 	if (it != fileHandlers.end()) {
 		//There's a custom handler function for this, just use that
@@ -41,7 +41,11 @@ bool TextureLoader::LoadTexture(const std::string& filename, char*& outData, int
 		
 	}
 	//By default, attempt to use stb image to get this texture
-	stbi_uc *texData = stbi_load(realPath.c_str(), &width, &height, &channels, 4); //4 forces this to always be rgba!
+	AssetFile file;
+	stbi_uc* texData = nullptr;
+	if (file.Open(realPath) && file.GetSize() <= (size_t)std::numeric_limits<int>::max()) {
+		texData = stbi_load_from_memory((const stbi_uc*)file.GetData(), (int)file.GetSize(), &width, &height, &channels, 4); //4 forces this to always be rgba!
+	}
 
 	channels = 4; //it gets forced, we don't care about the 'real' channel size
 
@@ -69,4 +73,55 @@ std::string TextureLoader::GetFileExtension(const std::string& fileExtension) {
 
 void TextureLoader::DeleteTextureData(char* data) {
 	free(data);
-}
\ No newline at end of file
+}
+
+std::string TextureLoader::GetTexturePath(const std::string& filename) {
+	return std::filesystem::path(filename).is_absolute() ? filename : Assets::TEXTUREDIR + filename;
+}
+
+std::string TextureLoader::GetCookedTexturePath(const std::string& filename) {
+	return std::filesystem::path(GetTexturePath(filename)).replace_extension(".ctex").string();
+}
+
+bool TextureLoader::LoadCookedTexture(const std::string& filename, CookedTexture& into) {
+	if (filename.empty()) {
+		return false;
+	}
+	// a cooked texture can ship without its source, but if the source is there
+	// it has to be the one this was cooked from
+	std::error_code error;
+	std::string sourcePath = GetTexturePath(filename);
+	uint64_t sourceSize = std::filesystem::file_size(sourcePath, error);
+	int64_t sourceWriteTime = 0;
+	if (error) {
+		sourceSize = 0;
+	}
+	else {
+		sourceWriteTime = (int64_t)std::filesystem::last_write_time(sourcePath, error).time_since_epoch().count();
+	}
+	return into.Load(GetCookedTexturePath(filename), sourceSize, sourceWriteTime);
+}
+
+bool TextureLoader::CookTexture(const std::string& filename, CookedTexture& into) {
+	char* texData	= nullptr;
+	int width		= 0;
+	int height		= 0;
+	int channels	= 0;
+	int flags		= 0;
+	if (!LoadTexture(filename, texData, width, height, channels, flags)) {
+		return false;
+	}
+	bool isNormalMap = CookedTexture::IsNormalMap(filename);
+	into.Cook(texData, width, height, CookedTexture::ChooseFormat(texData, width, height, isNormalMap), isNormalMap);
+	DeleteTextureData(texData);
+
+	std::error_code error;
+	std::string sourcePath = GetTexturePath(filename);
+	uint64_t sourceSize = std::filesystem::file_size(sourcePath, error);
+	int64_t sourceWriteTime = (int64_t)std::filesystem::last_write_time(sourcePath, error).time_since_epoch().count();
+	if (error || !into.Save(GetCookedTexturePath(filename), sourceSize, sourceWriteTime)) {
+		std::cout << __FUNCTION__ << " can't write a cooked copy of " << filename << "\n";
+		return false;
+	}
+	return true;
+}
@@ -14,6 +14,7 @@ https://research.ncl.ac.uk/game/
 namespace NCL {
 	namespace Rendering {
 		class Texture;
+		class CookedTexture;
 	}
 
 	typedef std::function<bool(const std::string& filename, char*& outData, int& width, int &height, int &channels, int&flags)> TextureLoadFunction;
@@ -27,6 +28,16 @@ namespace NCL {
 		static void RegisterTextureLoadFunction(TextureLoadFunction f, const std::string&fileExtension);
 
 		static void DeleteTextureData(char* data);
+
+		//Maps the cooked copy beside a texture, if AssetCooker has made one and
+		//the source hasn't changed since
+		static bool LoadCookedTexture(const std::string& filename, Rendering::CookedTexture& into);
+		//Decodes the source image, builds its mip chain and compresses it, then
+		//writes the cooked copy beside it
+		static bool CookTexture(const std::string& filename, Rendering::CookedTexture& into);
+
+		static std::string GetCookedTexturePath(const std::string& filename);
+		static std::string GetTexturePath(const std::string& filename);
 	protected:
 
 		static std::string GetFileExtension(const std::string& fileExtension);
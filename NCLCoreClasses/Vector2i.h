@@ -97,11 +97,11 @@ namespace NCL::Maths {
 			y /= f;
 		}
 
-		inline constexpr int operator[](int i) const {
+		inline int operator[](int i) const {
 			return ((int*)this)[i];
 		}
 
-		inline constexpr int& operator[](int i) {
+		inline int& operator[](int i) {
 			return ((int*)this)[i];
 		}
 
@@ -43,7 +43,11 @@ void OGLMesh::BindVertexAttribute(int attribSlot, int buffer, int bindingID, int
 void OGLMesh::SetInstanceMatrices(const std::vector<Matrix4>& mat) {
 	mInstanceMatricesCount = mat.size();
 	glBindVertexArray(vao);
-	CreateVertexBuffer(attributeBuffers[VertexAttribute::InstanceMatrices], mat.size() * sizeof(Matrix4), (char*)&mat[0]);
+	//Instances are resent whenever level rooms stream in or out, so drop the old buffer first
+	if (attributeBuffers[VertexAttribute::InstanceMatrices]) {
+		glDeleteBuffers(1, &attributeBuffers[VertexAttribute::InstanceMatrices]);
+	}
+	CreateVertexBuffer(attributeBuffers[VertexAttribute::InstanceMatrices], mat.size() * sizeof(Matrix4), (char*)mat.data());
 	glEnableVertexAttribArray(VertexAttribute::InstanceMatrices);
 	glVertexAttribPointer(VertexAttribute::InstanceMatrices, 4, GL_FLOAT, GL_FALSE, sizeof(Matrix4), (void*)0);
 	glEnableVertexAttribArray(VertexAttribute::InstanceMatrices + 1);
@@ -9,16 +9,19 @@ License: MIT (see LICENSE file at the top of the source tree)
 #include "OGLRenderer.h"
 
 #include "TextureLoader.h"
+#include "CookedTexture.h"
 
 using namespace NCL;
 using namespace NCL::Rendering;
 
 OGLTexture::OGLTexture()	{
 	glGenTextures(1, &texID);
+	memorySize = 0;
 }
 
 OGLTexture::OGLTexture(GLuint texToOwn) {
 	texID = texToOwn;
+	memorySize = 0;
 }
 
 OGLTexture::~OGLTexture()	{
@@ -27,9 +30,12 @@ OGLTexture::~OGLTexture()	{
 
 UniqueOGLTexture OGLTexture::TextureFromData(char* data, int width, int height, int channels) {
 	UniqueOGLTexture tex = std::make_unique<OGLTexture>();
-	tex->dimensions = { width, height };
+	tex->UploadData(data, width, height, channels);
+	return tex;
+}
 
-	int dataSize = width * height * channels; //This always assumes data is 1 byte per channel
+void OGLTexture::UploadData(char* data, int width, int height, int channels) {
+	dimensions = { width, height };
 
 	int sourceType = GL_RGB;
 
@@ -40,7 +46,7 @@ UniqueOGLTexture OGLTexture::TextureFromData(char* data, int width, int height,
 		case 4: sourceType = GL_RGBA; break;
 	}
 	
-	glBindTexture(GL_TEXTURE_2D, tex->texID);
+	glBindTexture(GL_TEXTURE_2D, texID);
 	
 
 	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, sourceType, GL_UNSIGNED_BYTE, data);
@@ -51,11 +57,58 @@ UniqueOGLTexture OGLTexture::TextureFromData(char* data, int width, int height,
 	glGenerateMipmap(GL_TEXTURE_2D);
 
 	glBindTexture(GL_TEXTURE_2D, 0);
-	
-	return tex;
+
+	memorySize = (size_t)width * height * 4 * 4 / 3;
+}
+
+void OGLTexture::UploadCooked(const CookedTexture& cooked) {
+	dimensions = { cooked.GetWidth(), cooked.GetHeight() };
+
+	glBindTexture(GL_TEXTURE_2D, texID);
+
+	UploadCookedLevels(GL_TEXTURE_2D, cooked, cooked.GetLevels().size());
+
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, (GLint)cooked.GetLevels().size() - 1);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+	glBindTexture(GL_TEXTURE_2D, 0);
+
+	memorySize = cooked.GetPayloadSize();
+}
+
+GLenum OGLTexture::GetInternalFormat(const CookedTexture& cooked) {
+	switch (cooked.GetFormat()) {
+		case TextureFormat::BC1: return GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+		case TextureFormat::BC3: return GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+		case TextureFormat::BC5: return GL_COMPRESSED_RG_RGTC2;
+		default:				 return GL_RGBA8;
+	}
+}
+
+void OGLTexture::UploadCookedLevels(GLenum target, const CookedTexture& cooked, size_t levelCount) {
+	GLenum internalFormat = GetInternalFormat(cooked);
+	const std::vector<CookedTexture::Level>& levels = cooked.GetLevels();
+
+	for (size_t i = 0; i < levelCount && i < levels.size(); ++i) {
+		const CookedTexture::Level& level = levels[i];
+		if (cooked.GetFormat() == TextureFormat::RGBA8) {
+			glTexImage2D(target, (GLint)i, internalFormat, level.width, level.height, 0, GL_RGBA, GL_UNSIGNED_BYTE, level.data);
+		}
+		else {
+			glCompressedTexImage2D(target, (GLint)i, internalFormat, level.width, level.height, 0, (GLsizei)level.size, level.data);
+		}
+	}
 }
 
 UniqueOGLTexture OGLTexture::TextureFromFile(const std::string&name) {
+	CookedTexture cooked;
+	if (TextureLoader::LoadCookedTexture(name, cooked)) {
+		UniqueOGLTexture glTex = std::make_unique<OGLTexture>();
+		glTex->UploadCooked(cooked);
+		return glTex;
+	}
+
 	char* texData	= nullptr;
 	int width		= 0;
 	int height		= 0;
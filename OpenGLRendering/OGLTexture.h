@@ -10,6 +10,8 @@ License: MIT (see LICENSE file at the top of the source tree)
 #include "glad\gl.h"
 
 namespace NCL::Rendering {		
+	class CookedTexture;
+
 	using UniqueOGLTexture = std::unique_ptr<class OGLTexture>;
 	using SharedOGLTexture = std::shared_ptr<class OGLTexture>;
 
@@ -23,6 +25,16 @@ namespace NCL::Rendering {
 
 		static UniqueOGLTexture TextureFromFile(const std::string&name);
 
+		//Replaces the texture's contents, always assumes 1 byte per channel
+		void UploadData(char* data, int width, int height, int channels);
+		//Replaces the texture's contents with a cooked mip chain, as is
+		void UploadCooked(const CookedTexture& cooked);
+
+		//Uploads the first levelCount levels of a cooked texture to one target,
+		//such as a cubemap face
+		static void UploadCookedLevels(GLenum target, const CookedTexture& cooked, size_t levelCount);
+		static GLenum GetInternalFormat(const CookedTexture& cooked);
+
 
 		static UniqueOGLTexture LoadCubemap(
 			const std::string& xPosFile,
@@ -35,7 +47,13 @@ namespace NCL::Rendering {
 		GLuint GetObjectID() const	{
 			return texID;
 		}
+
+		//Bytes of GPU memory the uploaded contents take up, mip chain included
+		size_t GetMemorySize() const {
+			return memorySize;
+		}
 	protected:						
 		GLuint texID;
+		size_t memorySize;
 	};
 }
\ No newline at end of file